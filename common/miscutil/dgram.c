@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "dgram.h"
+
+#ifdef HAVE_SENDMMSG
+static int sendmmsg_unsupported = 0;
+#endif /* HAVE_SENDMMSG */
+#ifdef HAVE_RECVMMSG
+static int recvmmsg_unsupported = 0;
+#endif /* HAVE_RECVMMSG */
+
+#if defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+/* _dgram_msgs_setup
+ * - point msghdrs at the buffers and addresses in dgrams
+ */
+static void
+_dgram_msgs_setup (struct dgram *dgrams,
+                   unsigned int count,
+                   struct mmsghdr *msgs,
+                   struct iovec *iovs)
+{
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    {
+      iovs[i].iov_base = dgrams[i].buf;
+      iovs[i].iov_len = dgrams[i].len;
+      memset (&msgs[i], '\0', sizeof (struct mmsghdr));
+      msgs[i].msg_hdr.msg_name = &(dgrams[i].addr);
+      msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+#endif /* defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG) */
+
+int
+dgram_send_batch (int fd, struct dgram *dgrams, unsigned int count)
+{
+  unsigned int sent = 0;
+
+  assert (fd >= 0);
+  assert (dgrams || !count);
+
+  while (sent < count)
+    {
+#ifdef HAVE_SENDMMSG
+      if (!sendmmsg_unsupported)
+        {
+          struct mmsghdr msgs[DGRAM_BATCH_MAX];
+          struct iovec iovs[DGRAM_BATCH_MAX];
+          unsigned int n = count - sent;
+          int rv;
+
+          if (n > DGRAM_BATCH_MAX)
+            n = DGRAM_BATCH_MAX;
+
+          _dgram_msgs_setup (dgrams + sent, n, msgs, iovs);
+
+          if ((rv = sendmmsg (fd, msgs, n, 0)) < 0)
+            {
+              if (errno == EINTR)
+                continue;
+              /* libc supports it, but the kernel does not */
+              if (errno == ENOSYS)
+                {
+                  sendmmsg_unsupported++;
+                  continue;
+                }
+              return (sent ? sent : -1);
+            }
+
+          sent += rv;
+          continue;
+        }
+#endif /* HAVE_SENDMMSG */
+      if (sendto (fd,
+                  dgrams[sent].buf,
+                  dgrams[sent].len,
+                  0,
+                  (struct sockaddr *)&(dgrams[sent].addr),
+                  sizeof (struct sockaddr_in)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return (sent ? sent : -1);
+        }
+      sent++;
+    }
+
+  return (sent);
+}
+
+int
+dgram_recv_batch (int fd, struct dgram *dgrams, unsigned int count)
+{
+  unsigned int received = 0;
+
+  assert (fd >= 0);
+  assert (dgrams || !count);
+
+  while (received < count)
+    {
+      socklen_t addrlen = sizeof (struct sockaddr_in);
+      ssize_t len;
+
+#ifdef HAVE_RECVMMSG
+      if (!recvmmsg_unsupported)
+        {
+          struct mmsghdr msgs[DGRAM_BATCH_MAX];
+          struct iovec iovs[DGRAM_BATCH_MAX];
+          unsigned int n = count - received;
+          unsigned int i;
+          int rv;
+
+          if (n > DGRAM_BATCH_MAX)
+            n = DGRAM_BATCH_MAX;
+
+          _dgram_msgs_setup (dgrams + received, n, msgs, iovs);
+
+          if ((rv = recvmmsg (fd, msgs, n, MSG_DONTWAIT, NULL)) < 0)
+            {
+              if (errno == EINTR)
+                continue;
+              /* libc supports it, but the kernel does not */
+              if (errno == ENOSYS)
+                {
+                  recvmmsg_unsupported++;
+                  continue;
+                }
+              if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+              return (received ? received : -1);
+            }
+
+          for (i = 0; i < rv; i++)
+            dgrams[received + i].len = msgs[i].msg_len;
+          received += rv;
+
+          /* nothing more queued */
+          if (rv < n)
+            break;
+          continue;
+        }
+#endif /* HAVE_RECVMMSG */
+      if ((len = recvfrom (fd,
+                           dgrams[received].buf,
+                           dgrams[received].len,
+                           MSG_DONTWAIT,
+                           (struct sockaddr *)&(dgrams[received].addr),
+                           &addrlen)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+          return (received ? received : -1);
+        }
+      dgrams[received].len = len;
+      received++;
+    }
+
+  return (received);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifndef DGRAM_H
+#define DGRAM_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/* Max datagrams passed to the kernel in a single call */
+#define DGRAM_BATCH_MAX 64
+
+struct dgram
+{
+  void *buf;
+  unsigned int len;
+  struct sockaddr_in addr;
+};
+
+/* dgram_send_batch
+ * - send count datagrams on fd, each to its addr
+ * - uses sendmmsg() when available, sendto() otherwise
+ * - Returns number of datagrams sent, -1 on error
+ */
+int dgram_send_batch (int fd, struct dgram *dgrams, unsigned int count);
+
+/* dgram_recv_batch
+ * - receive up to count datagrams already queued on fd, does not block
+ * - buf and len of each dgram give the storage available, len and
+ *   addr are set for each datagram received
+ * - uses recvmmsg() when available, recvfrom() otherwise
+ * - Returns number of datagrams received, 0 if none, -1 on error
+ */
+int dgram_recv_batch (int fd, struct dgram *dgrams, unsigned int count);
+
+#endif /* DGRAM_H */
@@ -31,6 +31,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -38,12 +39,27 @@
 #include "hash.h"
 
 
+/*****************************************************************************
+ *  Notes
+ *****************************************************************************/
+/*
+ *  The table is open addressed with linear probing.  Each slot holds the
+ *  item's key, data, and the key's hash value, so probing compares the
+ *  stored hash values and only calls cmp_f when they are equal.  Removed
+ *  items leave a tombstone behind so probe sequences stay intact.  The
+ *  number of slots is a power of 2; the table is rehashed into a larger
+ *  (or same sized, to drop tombstones) table when more than 3/4 of the
+ *  slots are in use.
+ */
+
+
 /*****************************************************************************
  *  Constants
  *****************************************************************************/
 
-#define HASH_ALLOC      1024
-#define HASH_DEF_SIZE   1213
+#define HASH_DEF_SIZE   64
+#define HASH_MIN_SLOTS  8
+#define HASH_MAX_SLOTS  (1 << 30)
 #define HASH_MAGIC      0xDEADBEEF
 
 
@@ -51,16 +67,18 @@
  *  Data Types
  *****************************************************************************/
 
-struct hash_node {
-    struct hash_node   *next;           /* next node in list                 */
-    void               *data;           /* ptr to hashed item                */
+struct hash_slot {
     const void         *hkey;           /* ptr to hashed item's key          */
+    void               *data;           /* ptr to hashed item                */
+    unsigned int        hval;           /* hash value of hkey                */
 };
 
 struct hash {
     int                 count;          /* number of items in hash table     */
+    int                 used;           /* num slots with items or tombstones*/
     int                 size;           /* num slots allocated in hash table */
-    struct hash_node  **table;          /* hash table array of node ptrs     */
+    int                 shift;          /* 32 - log2 (size)                  */
+    struct hash_slot   *table;          /* hash table array of slots         */
     hash_cmp_f          cmp_f;          /* key comparison function           */
     hash_del_f          del_f;          /* item deletion function            */
     hash_key_f          key_f;          /* key hash function                 */
@@ -77,22 +95,22 @@ struct hash {
  *  Prototypes
  *****************************************************************************/
 
-static struct hash_node * hash_node_alloc (void);
+static int hash_slots (int size);
+
+static int hash_shift (int slots);
 
-static void hash_node_free (struct hash_node *node);
+static int hash_lookup (hash_t h, const void *key, unsigned int hval);
+
+static int hash_resize (hash_t h, int slots);
+
+static void hash_slot_free (hash_t h, int i);
 
 
 /*****************************************************************************
  *  Variables
  *****************************************************************************/
 
-#if 0
-static struct hash_node *hash_free_list = NULL;
-
-#if WITH_PTHREADS
-static pthread_mutex_t hash_free_lock = PTHREAD_MUTEX_INITIALIZER;
-#endif /* WITH_PTHREADS */
-#endif
+static const char hash_tombstone;
 
 
 /*****************************************************************************
@@ -117,6 +135,17 @@ static pthread_mutex_t hash_free_lock = PTHREAD_MUTEX_INITIALIZER;
 #  endif /* !lsd_nomem_error */
 #endif /* !WITH_LSD_NOMEM_ERROR_FUNC */
 
+#define HASH_TOMBSTONE  ((const void *) &hash_tombstone)
+
+#define HASH_SLOT_IN_USE(s) \
+    ((s)->hkey != NULL && (s)->hkey != HASH_TOMBSTONE)
+
+/*  Fibonacci hashing spreads weak hash values (eg. small integers or
+ *    aligned pointers) over the table before probing.
+ */
+#define HASH_INDEX(h, hval) \
+    ((int) ((uint32_t) ((uint32_t) (hval) * 2654435769U) >> (h)->shift))
+
 
 /*****************************************************************************
  *  Functions
@@ -126,6 +155,7 @@ hash_t
 hash_create (int size, hash_key_f key_f, hash_cmp_f cmp_f, hash_del_f del_f)
 {
     hash_t h;
+    int slots;
 
     if (!cmp_f || !key_f) {
         errno = EINVAL;
@@ -134,15 +164,18 @@ hash_create (int size, hash_key_f key_f, hash_cmp_f cmp_f, hash_del_f del_f)
     if (size <= 0) {
         size = HASH_DEF_SIZE;
     }
+    slots = hash_slots (size);
     if (!(h = malloc (sizeof (*h)))) {
         return (lsd_nomem_error (__FILE__, __LINE__, "hash_create"));
     }
-    if (!(h->table = calloc (size, sizeof (struct hash_node *)))) {
+    if (!(h->table = calloc (slots, sizeof (struct hash_slot)))) {
         free (h);
         return (lsd_nomem_error (__FILE__, __LINE__, "hash_create"));
     }
     h->count = 0;
-    h->size = size;
+    h->used = 0;
+    h->size = slots;
+    h->shift = hash_shift (slots);
     h->cmp_f = cmp_f;
     h->del_f = del_f;
     h->key_f = key_f;
@@ -156,7 +189,6 @@ void
 hash_destroy (hash_t h)
 {
     int i;
-    struct hash_node *p, *q;
 
     if (!h) {
         errno = EINVAL;
@@ -165,12 +197,8 @@ hash_destroy (hash_t h)
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
     for (i = 0; i < h->size; i++) {
-        for (p = h->table[i]; p != NULL; p = q) {
-            q = p->next;
-            if (h->del_f)
-                h->del_f (p->data);
-            hash_node_free (p);
-        }
+        if (HASH_SLOT_IN_USE (&h->table[i]) && h->del_f)
+            h->del_f (h->table[i].data);
     }
     assert (h->magic = ~HASH_MAGIC);    /* clear magic via assert abuse */
     lsd_mutex_unlock (&h->mutex);
@@ -218,8 +246,7 @@ hash_count (hash_t h)
 void *
 hash_find (hash_t h, const void *key)
 {
-    unsigned int slot;
-    struct hash_node *p;
+    int i;
     void *data = NULL;
 
     if (!h || !key) {
@@ -229,13 +256,8 @@ hash_find (hash_t h, const void *key)
     errno = 0;
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
-    for (p = h->table[slot]; p != NULL; p = p->next) {
-        if (!h->cmp_f (p->hkey, key)) {
-            data = p->data;
-            break;
-        }
-    }
+    if ((i = hash_lookup (h, key, h->key_f (key))) >= 0)
+        data = h->table[i].data;
     lsd_mutex_unlock (&h->mutex);
     return (data);
 }
@@ -244,8 +266,9 @@ hash_find (hash_t h, const void *key)
 void *
 hash_insert (hash_t h, const void *key, void *data)
 {
-    struct hash_node *p;
-    unsigned int slot;
+    struct hash_slot *s;
+    unsigned int hval;
+    int i;
 
     if (!h || !key || !data) {
         errno = EINVAL;
@@ -253,22 +276,27 @@ hash_insert (hash_t h, const void *key, void *data)
     }
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
-    for (p = h->table[slot]; p != NULL; p = p->next) {
-        if (!h->cmp_f (p->hkey, key)) {
-            errno = EEXIST;
-            data = NULL;
+    hval = h->key_f (key);
+    if (hash_lookup (h, key, hval) >= 0) {
+        errno = EEXIST;
+        data = NULL;
+        goto end;
+    }
+    if ((h->used + 1) * 4 > h->size * 3) {
+        if (hash_resize (h, hash_slots (h->count + 1)) < 0) {
+            data = lsd_nomem_error (__FILE__, __LINE__, "hash_insert");
             goto end;
         }
     }
-    if (!(p = hash_node_alloc ())) {
-        data = lsd_nomem_error (__FILE__, __LINE__, "hash_insert");
-        goto end;
-    }
-    p->hkey = key;
-    p->data = data;
-    p->next = h->table[slot];
-    h->table[slot] = p;
+    i = HASH_INDEX (h, hval);
+    while (HASH_SLOT_IN_USE (&h->table[i]))
+        i = (i + 1) & (h->size - 1);
+    s = &h->table[i];
+    if (!s->hkey)
+        h->used++;
+    s->hkey = key;
+    s->data = data;
+    s->hval = hval;
     h->count++;
 
 end:
@@ -280,9 +308,7 @@ end:
 void *
 hash_remove (hash_t h, const void *key)
 {
-    struct hash_node **pp;
-    struct hash_node *p;
-    unsigned int slot;
+    int i;
     void *data = NULL;
 
     if (!h || !key) {
@@ -292,15 +318,9 @@ hash_remove (hash_t h, const void *key)
     errno = 0;
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
-    for (pp = &(h->table[slot]); (p = *pp) != NULL; pp = &((*pp)->next)) {
-        if (!h->cmp_f (p->hkey, key)) {
-            data = p->data;
-            *pp = p->next;
-            hash_node_free (p);
-            h->count--;
-            break;
-        }
+    if ((i = hash_lookup (h, key, h->key_f (key))) >= 0) {
+        data = h->table[i].data;
+        hash_slot_free (h, i);
     }
     lsd_mutex_unlock (&h->mutex);
     return (data);
@@ -311,8 +331,7 @@ int
 hash_delete_if (hash_t h, hash_arg_f arg_f, void *arg)
 {
     int i;
-    struct hash_node **pp;
-    struct hash_node *p;
+    struct hash_slot *s;
     int n = 0;
 
     if (!h || !arg_f) {
@@ -322,19 +341,12 @@ hash_delete_if (hash_t h, hash_arg_f arg_f, void *arg)
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
     for (i = 0; i < h->size; i++) {
-        pp = &(h->table[i]);
-        while ((p = *pp) != NULL) {
-            if (arg_f (p->data, p->hkey, arg) > 0) {
-                if (h->del_f)
-                    h->del_f (p->data);
-                *pp = p->next;
-                hash_node_free (p);
-                h->count--;
-                n++;
-            }
-            else {
-                pp = &(p->next);
-            }
+        s = &h->table[i];
+        if (HASH_SLOT_IN_USE (s) && arg_f (s->data, s->hkey, arg) > 0) {
+            if (h->del_f)
+                h->del_f (s->data);
+            hash_slot_free (h, i);
+            n++;
         }
     }
     lsd_mutex_unlock (&h->mutex);
@@ -346,7 +358,7 @@ int
 hash_for_each (hash_t h, hash_arg_f arg_f, void *arg)
 {
     int i;
-    struct hash_node *p;
+    struct hash_slot *s;
     int n = 0;
 
     if (!h || !arg_f) {
@@ -356,10 +368,9 @@ hash_for_each (hash_t h, hash_arg_f arg_f, void *arg)
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
     for (i = 0; i < h->size; i++) {
-        for (p = h->table[i]; p != NULL; p = p->next) {
-            if (arg_f (p->data, p->hkey, arg) > 0) {
-                n++;
-            }
+        s = &h->table[i];
+        if (HASH_SLOT_IN_USE (s) && arg_f (s->data, s->hkey, arg) > 0) {
+            n++;
         }
     }
     lsd_mutex_unlock (&h->mutex);
@@ -374,12 +385,14 @@ hash_for_each (hash_t h, hash_arg_f arg_f, void *arg)
 unsigned int
 hash_key_string (const char *str)
 {
+/*  32-bit FNV-1a.
+ */
     unsigned char *p;
-    unsigned int hval = 0;
-    const unsigned int multiplier = 31;
+    uint32_t hval = 2166136261U;
 
     for (p = (unsigned char *) str; *p != '\0'; p++) {
-        hval += (multiplier * hval) + *p;
+        hval ^= *p;
+        hval *= 16777619U;
     }
     return (hval);
 }
@@ -389,58 +402,109 @@ hash_key_string (const char *str)
  *  Internal Functions
  *****************************************************************************/
 
-static struct hash_node *
-hash_node_alloc (void)
+static int
+hash_slots (int size)
 {
-/*  Allocates a hash node from the freelist.
- *  Memory is allocated in chunks of HASH_ALLOC.
- *  Returns a ptr to the object, or NULL if memory allocation fails.
+/*  Returns the number of slots needed to hold [size] items while no more
+ *    than half the slots are in use.
  */
-#if 0
-    int i;
-#endif
-    struct hash_node *p = NULL;
-
-    assert (HASH_ALLOC > 0);
-#if 0
-    lsd_mutex_lock (&hash_free_lock);
-    if (!hash_free_list) {
-        if ((hash_free_list = malloc (HASH_ALLOC * sizeof (*p)))) {
-            for (i = 0; i < HASH_ALLOC - 1; i++)
-                hash_free_list[i].next = &hash_free_list[i+1];
-            hash_free_list[i].next = NULL;
-        }
+    int slots = HASH_MIN_SLOTS;
+
+    while (slots / 2 < size && slots < HASH_MAX_SLOTS)
+        slots <<= 1;
+    return (slots);
+}
+
+
+static int
+hash_shift (int slots)
+{
+/*  Returns 32 - log2 ([slots]), [slots] must be a power of 2.
+ */
+    int shift = 32;
+
+    assert (slots > 0 && !(slots & (slots - 1)));
+    while (slots > 1) {
+        slots >>= 1;
+        shift--;
     }
-    if (hash_free_list) {
-        p = hash_free_list;
-        hash_free_list = p->next;
+    return (shift);
+}
+
+
+static int
+hash_lookup (hash_t h, const void *key, unsigned int hval)
+{
+/*  Returns the slot index of the item corresponding to [key] with hash
+ *    value [hval], or -1 if no matching item is found.
+ *  Probing always terminates since some slots are always empty.
+ */
+    struct hash_slot *s;
+    int i;
+
+    i = HASH_INDEX (h, hval);
+    while ((s = &h->table[i])->hkey != NULL) {
+        if (s->hkey != HASH_TOMBSTONE
+            && s->hval == hval
+            && !h->cmp_f (s->hkey, key))
+            return (i);
+        i = (i + 1) & (h->size - 1);
     }
-    else {
+    return (-1);
+}
+
+
+static int
+hash_resize (hash_t h, int slots)
+{
+/*  Rehashes all items into a new table of [slots] slots, dropping any
+ *    tombstones.  The stored hash values are reused, key_f is not called.
+ *  Returns 0 on success, or -1 with errno=ENOMEM if allocation fails.
+ */
+    struct hash_slot *table;
+    struct hash_slot *old_table = h->table;
+    int old_size = h->size;
+    int i, j;
+
+    if (!(table = calloc (slots, sizeof (struct hash_slot)))) {
         errno = ENOMEM;
+        return (-1);
     }
-    lsd_mutex_unlock (&hash_free_lock);
-#else
-    if (!(p = malloc (sizeof(*p))))
-        errno = ENOMEM;
-#endif
-    return (p);
+    h->table = table;
+    h->size = slots;
+    h->shift = hash_shift (slots);
+    for (i = 0; i < old_size; i++) {
+        if (!HASH_SLOT_IN_USE (&old_table[i]))
+            continue;
+        j = HASH_INDEX (h, old_table[i].hval);
+        while (table[j].hkey != NULL)
+            j = (j + 1) & (slots - 1);
+        table[j] = old_table[i];
+    }
+    h->used = h->count;
+    free (old_table);
+    return (0);
 }
 
 
 static void
-hash_node_free (struct hash_node *node)
+hash_slot_free (hash_t h, int i)
 {
-/*  De-allocates the object [node], returning it to the freelist.
+/*  Removes the item in slot [i].  The slot becomes a tombstone unless the
+ *    next slot is empty, in which case no probe sequence passes through it.
  */
-    assert (node != NULL);
-    memset (node, 0, sizeof (*node));
-#if 0
-    lsd_mutex_lock (&hash_free_lock);
-    node->next = hash_free_list;
-    hash_free_list = node;
-    lsd_mutex_unlock (&hash_free_lock);
-#else
-    free (node);
-#endif
+    struct hash_slot *s = &h->table[i];
+
+    assert (HASH_SLOT_IN_USE (s));
+    if (h->table[(i + 1) & (h->size - 1)].hkey == NULL) {
+        s->hkey = NULL;
+        h->used--;
+    }
+    else {
+        s->hkey = HASH_TOMBSTONE;
+    }
+    s->data = NULL;
+    s->hval = 0;
+    h->count--;
     return;
 }
@@ -33,6 +33,8 @@
 /*
  *  If an item's key is modified after insertion, the hash will be unable to
  *  locate it if the new key should hash to a different slot in the table.
+ *  Items are not kept in insertion order, and the order in which items are
+ *  visited by hash_for_each() changes when the table grows.
  *
  *  If NDEBUG is not defined, internal debug code will be enabled; this is
  *  intended for development use only.  Production code should define NDEBUG.
@@ -97,9 +99,9 @@ hash_t hash_create (int size,
  *  Creates and returns a new hash table on success.
  *    Returns lsd_nomem_error() with errno=ENOMEM if memory allocation fails.
  *    Returns NULL with errno=EINVAL if [keyf] or [cmpf] is not specified.
- *  The [size] is the number of slots in the table; a larger table requires
- *    more memory, but generally provide quicker access times.  If set <= 0,
- *    the default size is used.
+ *  The [size] is the number of items the table is expected to hold; the
+ *    table grows as items are inserted, so it only avoids early rehashing.
+ *    If set <= 0, the default size is used.
  *  The [keyf] function converts a key into a hash value.
  *  The [cmpf] function determines whether two keys are equal.
  *  The [delf] function de-allocates memory used by items in the hash;
@@ -170,7 +172,7 @@ int hash_for_each (hash_t h, hash_arg_f argf, void *arg);
 
 unsigned int hash_key_string (const char *str);
 /*
- *  A hash_key_f function that hashes the string [str].
+ *  A hash_key_f function that hashes the string [str] (32-bit FNV-1a).
  */
 
 
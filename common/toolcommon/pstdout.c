@@ -47,9 +47,14 @@
 #include <signal.h>
 #include <assert.h>
 #include <errno.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <sys/uio.h>
+#include <limits.h>
 
 #include "pstdout.h"
-#include "cbuf.h"
+#include "hash.h"
 #include "hostlist.h"
 #include "list.h"
 
@@ -62,6 +67,9 @@
  */
 #define PSTDOUT_BUFLEN            32768
 
+/* initial size of per state formatting and output buffers */
+#define PSTDOUT_STREAM_BUFLEN     1024
+
 static char * pstdout_errmsg[] =
   {
     "success",
@@ -76,46 +84,90 @@ static uint32_t pstdout_debug_flags = PSTDOUT_DEBUG_NONE;
 static uint32_t pstdout_output_flags = PSTDOUT_OUTPUT_STDOUT_DEFAULT | PSTDOUT_OUTPUT_STDERR_DEFAULT;
 static unsigned int pstdout_fanout = PSTDOUT_FANOUT_DEFAULT;
 
-static pthread_mutex_t pstdout_threadcount_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t pstdout_threadcount_cond = PTHREAD_COND_INITIALIZER;
-static int pstdout_threadcount = 0;
-
-struct pstdout_thread_data {
-  char *hostname;
-  pthread_t tid;
-  pthread_attr_t attr;
-  int exit_code;
+/* Hosts are handed out to a pool of at most 'fanout' worker threads.
+ * Each worker pulls the next host index off of the work queue until
+ * there are no more hosts.
+ */
+struct pstdout_workqueue {
+  char **hostnames;
+  int *exit_codes;
+  unsigned int hostnames_count;
+  unsigned int next;
+  pthread_mutex_t mutex;
   Pstdout_Thread pstdout_func;
   void *arg;
 };
 
+struct pstdout_worker {
+  pthread_t tid;
+  struct pstdout_workqueue *wq;
+  void *data;
+  Pstdout_Worker_Data_Destroy data_destroy;
+};
+
+/* Per stream output state.  'pending' holds a partial line not yet
+ * output, 'buffer' holds all output in buffered/consolidated modes.
+ * Memory is only grown, never shrunk, so it is reused across prints
+ * and across hosts handled by the same worker.
+ */
+struct pstdout_stream {
+  char *pending;
+  unsigned int pending_len;
+  unsigned int pending_size;
+  char *buffer;
+  unsigned int buffer_len;
+  unsigned int buffer_size;
+  int buffer_midline;
+};
+
 struct pstdout_state {
   uint32_t magic;
   char *hostname; 
-  cbuf_t p_stdout;
-  cbuf_t p_stderr;
-  char *buffer_stdout;
-  char *buffer_stderr;
-  unsigned int buffer_stdout_len;
-  unsigned int buffer_stderr_len;
+  struct pstdout_worker *worker;
+  struct pstdout_stream p_stdout;
+  struct pstdout_stream p_stderr;
+  char *fmtbuf;
+  unsigned int fmtbuf_size;
   int no_more_external_output;
   pthread_mutex_t mutex;
 };
 
 #define PSTDOUT_STATE_MAGIC    0x76309ab3
-#define PSTDOUT_STATE_CBUF_MIN 32
-#define PSTDOUT_STATE_CBUF_MAX 2048
+
+/* lines output in one writev(), a writev() is also capped at
+ * PIPE_BUF bytes so it is not interleaved with other writers to a
+ * pipe
+ */
+#define PSTDOUT_IOV_LINES      32
+
+#ifndef PIPE_BUF
+#define PIPE_BUF               512
+#endif /* PIPE_BUF */
 
 int pstdout_errnum = PSTDOUT_ERR_SUCCESS;
 
+/* Consolidated output is looked up by a 64 bit digest of the output,
+ * so a full compare of the output is only needed on a digest match.
+ */
+struct pstdout_consolidated_key {
+  uint64_t digest;
+  const char *output;
+};
+
 struct pstdout_consolidated_data {
   hostlist_t h;
   char *output;
+  struct pstdout_consolidated_key key;
 };
 
+#define PSTDOUT_CONSOLIDATED_HASH_SIZE 1024
+
 static List pstdout_consolidated_stdout = NULL;
 static List pstdout_consolidated_stderr = NULL;
 
+static hash_t pstdout_consolidated_stdout_hash = NULL;
+static hash_t pstdout_consolidated_stderr_hash = NULL;
+
 static pthread_mutex_t pstdout_consolidated_stdout_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t pstdout_consolidated_stderr_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -126,12 +178,17 @@ static pthread_mutex_t pstdout_launch_mutex = PTHREAD_MUTEX_INITIALIZER;
 static List pstdout_states = NULL;
 static pthread_mutex_t pstdout_states_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* serializes line output from all states */
+static pthread_mutex_t pstdout_output_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 #ifndef HAVE_SIGHANDLER_T
 typedef void (*sighandler_t)(int);
 #endif /* HAVE_SIGHANDLER_T */
 
 static struct pstdout_consolidated_data *
-_pstdout_consolidated_data_create(const char *hostname, const char *output)
+_pstdout_consolidated_data_create(const char *hostname, 
+                                  const char *output,
+                                  uint64_t digest)
 {
   struct pstdout_consolidated_data *cdata = NULL;
 
@@ -157,6 +214,8 @@ _pstdout_consolidated_data_create(const char *hostname, const char *output)
       goto cleanup;
     }
 
+  cdata->key.digest = digest;
+  cdata->key.output = cdata->output;
   return cdata;
 
  cleanup:
@@ -210,21 +269,57 @@ _pstdout_consolidated_data_compare(void *x, void *y)
   return 0;
 }
 
-static int
-_pstdout_consolidated_data_find(void *x, void *key)
+/* 64 bit FNV-1a */
+static uint64_t
+_pstdout_consolidated_digest(const char *output, unsigned int len)
 {
-  struct pstdout_consolidated_data *cdata;
+  uint64_t digest = 0xcbf29ce484222325ULL;
+  unsigned int i;
+
+  assert(output);
+
+  for (i = 0; i < len; i++)
+    {
+      digest ^= (unsigned char)output[i];
+      digest *= 0x100000001b3ULL;
+    }
+
+  return digest;
+}
+
+static unsigned int
+_pstdout_consolidated_hash_key(const void *key)
+{
+  const struct pstdout_consolidated_key *ckey;
 
-  assert(x);
   assert(key);
 
-  cdata = (struct pstdout_consolidated_data *)x;
-  
-  assert(cdata->output);
-  
-  if (!strcmp(cdata->output, (char *)key))
+  ckey = (const struct pstdout_consolidated_key *)key;
+  return (unsigned int)(ckey->digest ^ (ckey->digest >> 32));
+}
+
+static int
+_pstdout_consolidated_hash_cmp(const void *key1, const void *key2)
+{
+  const struct pstdout_consolidated_key *ckey1;
+  const struct pstdout_consolidated_key *ckey2;
+
+  assert(key1);
+  assert(key2);
+
+  ckey1 = (const struct pstdout_consolidated_key *)key1;
+  ckey2 = (const struct pstdout_consolidated_key *)key2;
+
+  if (ckey1->digest != ckey2->digest)
     return 1;
-  return 0;
+
+  return strcmp(ckey1->output, ckey2->output);
+}
+
+static int
+_pstdout_consolidated_hash_delete_all(void *data, const void *key, void *arg)
+{
+  return 1;
 }
 
 static int
@@ -261,6 +356,23 @@ pstdout_init(void)
           pstdout_errnum = PSTDOUT_ERR_OUTMEM;
           goto cleanup;
 	}
+      /* data is owned by the consolidated lists */
+      if (!(pstdout_consolidated_stdout_hash = hash_create(PSTDOUT_CONSOLIDATED_HASH_SIZE,
+                                                           _pstdout_consolidated_hash_key,
+                                                           _pstdout_consolidated_hash_cmp,
+                                                           NULL)))
+        {
+          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
+          goto cleanup;
+        }
+      if (!(pstdout_consolidated_stderr_hash = hash_create(PSTDOUT_CONSOLIDATED_HASH_SIZE,
+                                                           _pstdout_consolidated_hash_key,
+                                                           _pstdout_consolidated_hash_cmp,
+                                                           NULL)))
+        {
+          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
+          goto cleanup;
+        }
       pstdout_initialized++;
     }
 
@@ -273,6 +385,10 @@ pstdout_init(void)
     list_destroy(pstdout_consolidated_stderr);
   if (pstdout_states)
     list_destroy(pstdout_states);
+  if (pstdout_consolidated_stdout_hash)
+    hash_destroy(pstdout_consolidated_stdout_hash);
+  if (pstdout_consolidated_stderr_hash)
+    hash_destroy(pstdout_consolidated_stderr_hash);
   return -1;
 }
 
@@ -481,75 +597,403 @@ pstdout_hostnames_count(const char *hostnames)
 }
 
 static int
-_pstdout_print(pstdout_state_t pstate, 
-               int internal_to_pstdout,
+_pstdout_grow(char **buf, unsigned int *size, unsigned int len)
+{
+  unsigned int newsize;
+
+  assert(buf);
+  assert(size);
+
+  if (len <= *size)
+    return 0;
+
+  newsize = *size ? *size : PSTDOUT_STREAM_BUFLEN;
+  while (newsize < len)
+    newsize *= 2;
+
+  if (!(*buf = (char *)realloc(*buf, newsize)))
+    {
+      *size = 0;
+      pstdout_errnum = PSTDOUT_ERR_OUTMEM;
+      return -1;
+    }
+  *size = newsize;
+  return 0;
+}
+
+/* Format into the state's arena, only formatting a second time if
+ * the arena had to grow.
+ */
+static int
+_pstdout_format(pstdout_state_t pstate, const char *format, va_list ap)
+{
+  va_list vacpy;
+  int wlen;
+
+  assert(pstate);
+  assert(format);
+
+  va_copy(vacpy, ap);
+  wlen = vsnprintf(pstate->fmtbuf, pstate->fmtbuf_size, format, vacpy);
+  va_end(vacpy);
+
+  if (wlen < 0)
+    {
+      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+      return -1;
+    }
+
+  if (wlen >= pstate->fmtbuf_size)
+    {
+      if (_pstdout_grow(&(pstate->fmtbuf), &(pstate->fmtbuf_size), wlen + 1) < 0)
+        return -1;
+
+      va_copy(vacpy, ap);
+      wlen = vsnprintf(pstate->fmtbuf, pstate->fmtbuf_size, format, vacpy);
+      va_end(vacpy);
+
+      if (wlen < 0 || wlen >= pstate->fmtbuf_size)
+        {
+          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+          return -1;
+        }
+    }
+
+  return wlen;
+}
+
+static int
+_pstdout_append(char **buf,
+                unsigned int *len,
+                unsigned int *size,
+                const char *data,
+                unsigned int datalen)
+{
+  assert(buf);
+  assert(len);
+  assert(size);
+  assert(data || !datalen);
+
+  if (_pstdout_grow(buf, size, *len + datalen) < 0)
+    return -1;
+  memcpy(*buf + *len, data, datalen);
+  *len += datalen;
+  return 0;
+}
+
+static int
+_pstdout_writev(FILE *stream, struct iovec *iov, int iovcnt)
+{
+  ssize_t n;
+  int fd;
+  int rv = 0;
+
+  assert(stream);
+  assert(iov);
+
+  fd = fileno(stream);
+
+  while (iovcnt > 0)
+    {
+      if ((n = writev(fd, iov, iovcnt)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
+            fprintf(stderr, "writev: %s\n", strerror(errno));
+          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+          return -1;
+        }
+      rv += n;
+
+      /* partial write, skip what has been written */
+      while (iovcnt > 0 && n >= iov->iov_len)
+        {
+          n -= iov->iov_len;
+          iov++;
+          iovcnt--;
+        }
+      if (iovcnt > 0)
+        {
+          iov->iov_base = (char *)iov->iov_base + n;
+          iov->iov_len -= n;
+        }
+    }
+
+  return rv;
+}
+
+/* Output the complete lines in data, prefixing each with the
+ * hostname if requested.  A trailing partial line is held until a
+ * later call completes it.
+ *
+ * Lines are written in batches of at most PSTDOUT_IOV_LINES lines
+ * and PIPE_BUF bytes.  A single line longer than PIPE_BUF is written
+ * on its own.  All batches are written under the output mutex, so
+ * lines from different hosts never interleave.
+ */
+static int
+_pstdout_output_lines(struct pstdout_stream *pstream,
+                      FILE *stream,
+                      const char *prefix,
+                      const char *data,
+                      unsigned int datalen)
+{
+  struct iovec iov[PSTDOUT_IOV_LINES * 4];
+  unsigned int prefix_len = 0;
+  unsigned int iovcnt = 0;
+  unsigned int lines = 0;
+  unsigned int batch_len = 0;
+  unsigned int line_len;
+  unsigned int start = 0;
+  unsigned int i;
+  int mutex_locked = 0;
+  int n, rc, rv = -1, count = 0;
+
+  assert(pstream);
+  assert(stream);
+  assert(data || !datalen);
+
+  if (prefix)
+    prefix_len = strlen(prefix);
+
+  if ((rc = pthread_mutex_lock(&pstdout_output_mutex)))
+    {
+      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
+        fprintf(stderr, "pthread_mutex_lock: %s\n", strerror(rc));
+      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+      goto cleanup;
+    }
+  mutex_locked++;
+
+  /* stdio may still hold data from direct fprintf()s */
+  fflush(stream);
+
+  for (i = 0; i < datalen; i++)
+    {
+      if (data[i] != '\n')
+        continue;
+
+      line_len = i - start + 1 + pstream->pending_len;
+      if (prefix)
+        line_len += prefix_len + 2;
+
+      if (iovcnt && (batch_len + line_len) > PIPE_BUF)
+        {
+          if ((n = _pstdout_writev(stream, iov, iovcnt)) < 0)
+            goto cleanup;
+          count += n;
+          iovcnt = 0;
+          lines = 0;
+          batch_len = 0;
+        }
+
+      if (prefix)
+        {
+          iov[iovcnt].iov_base = (char *)prefix;
+          iov[iovcnt].iov_len = prefix_len;
+          iovcnt++;
+          iov[iovcnt].iov_base = ": ";
+          iov[iovcnt].iov_len = 2;
+          iovcnt++;
+        }
+      if (pstream->pending_len)
+        {
+          iov[iovcnt].iov_base = pstream->pending;
+          iov[iovcnt].iov_len = pstream->pending_len;
+          iovcnt++;
+        }
+      iov[iovcnt].iov_base = (char *)data + start;
+      iov[iovcnt].iov_len = i - start + 1;
+      iovcnt++;
+      start = i + 1;
+      lines++;
+      batch_len += line_len;
+
+      /* pending can be written out now, but not overwritten until
+       * after the writev below
+       */
+      if (lines == PSTDOUT_IOV_LINES || pstream->pending_len)
+        {
+          if ((n = _pstdout_writev(stream, iov, iovcnt)) < 0)
+            goto cleanup;
+          count += n;
+          pstream->pending_len = 0;
+          iovcnt = 0;
+          lines = 0;
+          batch_len = 0;
+        }
+    }
+
+  if (iovcnt)
+    {
+      if ((n = _pstdout_writev(stream, iov, iovcnt)) < 0)
+        goto cleanup;
+      count += n;
+    }
+
+  if (start < datalen)
+    {
+      if (_pstdout_append(&(pstream->pending),
+                          &(pstream->pending_len),
+                          &(pstream->pending_size),
+                          data + start,
+                          datalen - start) < 0)
+        goto cleanup;
+    }
+
+  rv = count;
+ cleanup:
+  if (mutex_locked)
+    pthread_mutex_unlock(&pstdout_output_mutex);
+  return rv;
+}
+
+/* Append data to the buffered output, prefixing each line with the
+ * hostname if requested.
+ */
+static int
+_pstdout_buffer_lines(struct pstdout_stream *pstream,
+                      const char *prefix,
+                      const char *data,
+                      unsigned int datalen)
+{
+  unsigned int prefix_len = 0;
+  unsigned int start = 0;
+  unsigned int i;
+
+  assert(pstream);
+  assert(data || !datalen);
+
+  if (!datalen)
+    return 0;
+
+  if (!prefix)
+    {
+      if (_pstdout_append(&(pstream->buffer),
+                          &(pstream->buffer_len),
+                          &(pstream->buffer_size),
+                          data,
+                          datalen) < 0)
+        return -1;
+      pstream->buffer_midline = (data[datalen - 1] != '\n');
+      return datalen;
+    }
+
+  prefix_len = strlen(prefix);
+  while (start < datalen)
+    {
+      for (i = start; i < datalen && data[i] != '\n'; i++)
+        ;
+      if (i < datalen)
+        i++;
+
+      if (!pstream->buffer_midline)
+        {
+          if (_pstdout_append(&(pstream->buffer),
+                              &(pstream->buffer_len),
+                              &(pstream->buffer_size),
+                              prefix,
+                              prefix_len) < 0)
+            return -1;
+          if (_pstdout_append(&(pstream->buffer),
+                              &(pstream->buffer_len),
+                              &(pstream->buffer_size),
+                              ": ",
+                              2) < 0)
+            return -1;
+        }
+
+      if (_pstdout_append(&(pstream->buffer),
+                          &(pstream->buffer_len),
+                          &(pstream->buffer_size),
+                          data + start,
+                          i - start) < 0)
+        return -1;
+
+      pstream->buffer_midline = (data[i - 1] != '\n');
+      start = i;
+    }
+
+  return datalen;
+}
+
+/* Output already formatted data according to the output flags.
+ * Must be called with the pstate mutex held.
+ */
+static int
+_pstdout_write(pstdout_state_t pstate,
                FILE *stream,
-               const char *format, 
-               va_list ap)
+               const char *data,
+               unsigned int datalen)
 {
-  char *buf = NULL;
-  char *linebuf = NULL;
-  size_t buflen = PSTDOUT_BUFLEN;
-  size_t linebuflen = PSTDOUT_BUFLEN;
-  cbuf_t whichcbuf;
+  struct pstdout_stream *pstream;
   uint32_t whichdefaultmask;
   uint32_t whichprependmask;
   uint32_t whichbuffermask;
   uint32_t whichconsolidatemask;
-  char **whichbuffer;
-  unsigned int *whichbufferlen;
-  int wlen;
-  int linelen;
-  int pstate_mutex_locked = 0;
-  int rc, rv = -1;
 
   assert(pstate);
   assert(pstate->magic == PSTDOUT_STATE_MAGIC);
-  assert(pstate->p_stdout);
-  assert(pstate->p_stderr);
   assert(stream);
   assert(stream == stdout || stream == stderr);
-  assert(format);
-  assert(ap);
+  assert(data);
 
   if (stream == stdout)
     {
-      whichcbuf = pstate->p_stdout;
+      pstream = &(pstate->p_stdout);
       whichdefaultmask = PSTDOUT_OUTPUT_STDOUT_DEFAULT;
       whichprependmask = PSTDOUT_OUTPUT_STDOUT_PREPEND_HOSTNAME;
       whichbuffermask = PSTDOUT_OUTPUT_BUFFER_STDOUT;
       whichconsolidatemask = PSTDOUT_OUTPUT_STDOUT_CONSOLIDATE;
-      whichbuffer = &(pstate->buffer_stdout);
-      whichbufferlen = &(pstate->buffer_stdout_len);
     }
   else
     {
-      whichcbuf = pstate->p_stderr;
+      pstream = &(pstate->p_stderr);
       whichdefaultmask = PSTDOUT_OUTPUT_STDERR_DEFAULT;
       whichprependmask = PSTDOUT_OUTPUT_STDERR_PREPEND_HOSTNAME;
       whichbuffermask = PSTDOUT_OUTPUT_BUFFER_STDERR;
       whichconsolidatemask = PSTDOUT_OUTPUT_STDERR_CONSOLIDATE;
-      whichbuffer = &(pstate->buffer_stderr);
-      whichbufferlen = &(pstate->buffer_stderr_len);
     }
 
-  while (1)
-    {
-      va_list vacpy;
+  if (!pstate->hostname 
+      || ((pstdout_output_flags & whichdefaultmask)
+          && !(pstdout_output_flags & whichbuffermask)
+          && !(pstdout_output_flags & whichconsolidatemask)))
+    return _pstdout_output_lines(pstream, stream, NULL, data, datalen);
+  else if (pstdout_output_flags & whichprependmask
+           && !(pstdout_output_flags & whichbuffermask)
+           && !(pstdout_output_flags & whichconsolidatemask))
+    return _pstdout_output_lines(pstream, stream, pstate->hostname, data, datalen);
+  else if (((pstdout_output_flags & whichdefaultmask)
+            && (pstdout_output_flags & whichbuffermask))
+           || (pstdout_output_flags & whichconsolidatemask))
+    return _pstdout_buffer_lines(pstream, NULL, data, datalen);
+  else if ((pstdout_output_flags & whichprependmask)
+           && (pstdout_output_flags & whichbuffermask))
+    return _pstdout_buffer_lines(pstream, pstate->hostname, data, datalen);
+
+  pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+  return -1;
+}
 
-      if (!(buf = (char *)realloc(buf, buflen)))
-        {
-          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-          goto cleanup;
-        }
-      memset(buf, '\0', PSTDOUT_BUFLEN);
-      va_copy(vacpy, ap);
-      wlen = vsnprintf(buf, buflen, format, vacpy);
-      va_end(vacpy);
-      if (wlen < buflen)
-        break;
-      buflen += PSTDOUT_BUFLEN;
-    }
+static int
+_pstdout_print(pstdout_state_t pstate, 
+               int internal_to_pstdout,
+               FILE *stream,
+               const char *format, 
+               va_list ap)
+{
+  int wlen;
+  int pstate_mutex_locked = 0;
+  int rc, rv = -1;
+
+  assert(pstate);
+  assert(pstate->magic == PSTDOUT_STATE_MAGIC);
+  assert(stream);
+  assert(stream == stdout || stream == stderr);
+  assert(format);
+  assert(ap);
 
   if ((rc = pthread_mutex_lock(&(pstate->mutex))))
     {
@@ -566,114 +1010,11 @@ _pstdout_print(pstdout_state_t pstate,
   if (!internal_to_pstdout && pstate->no_more_external_output)
     goto cleanup;
 
-  if (cbuf_write(whichcbuf, buf, wlen, NULL) < 0)
-    {
-      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-        fprintf(stderr, "cbuf_write: %s\n", strerror(errno));
-      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-      goto cleanup;
-    }
-
-  while (1)
-    {
-      if (!(linebuf = (char *)realloc(linebuf, linebuflen)))
-        {
-          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-          goto cleanup;
-        }
-      memset(linebuf, '\0', PSTDOUT_BUFLEN);
-      
-      while ((linelen = cbuf_read_line (whichcbuf, linebuf, linebuflen, 1)) > 0)
-        {
-          if (linelen >= linebuflen)
-            break;
-
-          if (!pstate->hostname 
-              || ((pstdout_output_flags & whichdefaultmask)
-                  && !(pstdout_output_flags & whichbuffermask)
-                  && !(pstdout_output_flags & whichconsolidatemask)))
-                      
-            {
-              rv = fprintf(stream, "%s", linebuf);
-              fflush(stream);
-            }
-          else if (pstdout_output_flags & whichprependmask
-                   && !(pstdout_output_flags & whichbuffermask)
-                   && !(pstdout_output_flags & whichconsolidatemask))
-            {
-              rv = fprintf(stream, "%s: %s", pstate->hostname, linebuf);
-              fflush(stream);
-            }
-          else if (((pstdout_output_flags & whichdefaultmask)
-                    && (pstdout_output_flags & whichbuffermask))
-                   || (pstdout_output_flags & whichconsolidatemask))
-            {
-              if (!(*whichbuffer = (char *)realloc(*whichbuffer, *whichbufferlen + linelen)))
-                {
-                  pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-                  goto cleanup;
-                }
-                  
-              /* Don't use snprintf, it will truncate b/c "snprintf and
-                 vsnprintf do not write more than size bytes (including
-                 the trailing '\0'). " */
-              memcpy(*whichbuffer + *whichbufferlen, linebuf, linelen);
-              *whichbufferlen += linelen;
-              rv = linelen;
-            }
-          else if ((pstdout_output_flags & whichprependmask)
-                   && (pstdout_output_flags & whichbuffermask))
-            {
-              unsigned int hostname_len;
-              unsigned int extra_len;
-                  
-              /* + 2 is for the ": " */
-              hostname_len = strlen(pstate->hostname);
-              extra_len = hostname_len + 2;
-              if (!(*whichbuffer = (char *)realloc(*whichbuffer, *whichbufferlen + linelen + extra_len)))
-                {
-                  pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-                  goto cleanup;
-                }
-              
-              /* Don't use snprintf, it will truncate b/c "snprintf and
-                 vsnprintf do not write more than size bytes (including
-                 the trailing '\0'). " */
-              memcpy(*whichbuffer + *whichbufferlen, 
-                     pstate->hostname, 
-                     hostname_len);
-              memcpy(*whichbuffer + *whichbufferlen + hostname_len, 
-                     ": ",
-                     2);
-              memcpy(*whichbuffer + *whichbufferlen + hostname_len + 2, 
-                     linebuf, 
-                     linelen);
-              *whichbufferlen += linelen + extra_len;
-              rv = linelen + extra_len;
-            }
-          else 
-            {
-              pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-              return -1;
-            }
-        }
-      
-      if (linelen < 0)
-        {
-          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "cbuf_read_line: %s\n", strerror(errno));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
-        }
-
-      if (!linelen)
-        break;
-
-      linebuflen += PSTDOUT_BUFLEN;
-    }
+  if ((wlen = _pstdout_format(pstate, format, ap)) < 0)
+    goto cleanup;
 
-  if (rv < 0)
-    rv = 0;
+  if ((rv = _pstdout_write(pstate, stream, pstate->fmtbuf, wlen)) < 0)
+    goto cleanup;
 
   pstdout_errnum = PSTDOUT_ERR_SUCCESS;
  cleanup:
@@ -686,8 +1027,6 @@ _pstdout_print(pstdout_state_t pstate,
 	  /* Don't change error code, just move on */
 	}
     }
-  free(buf);
-  free(linebuf);
   return rv;
 }
 
@@ -706,7 +1045,7 @@ _pstdout_print_wrapper(pstdout_state_t pstate,
   assert(format);
 
   va_start(ap, format);
-  _pstdout_print(pstate, internal_to_pstdout, stderr, format, ap);
+  _pstdout_print(pstate, internal_to_pstdout, stream, format, ap);
   va_end(ap);
 }
 
@@ -867,34 +1206,20 @@ pstdout_perror(pstdout_state_t pstate, const char *s)
 }
 
 static int
-_pstdout_state_init(pstdout_state_t pstate, const char *hostname)
+_pstdout_state_init(pstdout_state_t pstate, 
+                    const char *hostname,
+                    struct pstdout_worker *worker)
 {
   int rc;
 
   assert(pstate);
+  assert(worker);
 
   memset(pstate, '\0', sizeof(struct pstdout_state));
   pstate->magic = PSTDOUT_STATE_MAGIC;
   pstate->hostname = (char *)hostname;
+  pstate->worker = worker;
 
-  if (!(pstate->p_stdout = cbuf_create(PSTDOUT_STATE_CBUF_MIN, PSTDOUT_STATE_CBUF_MAX)))
-    {
-      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-        fprintf(stderr, "cbuf_create: %s\n", strerror(errno));
-      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-      return -1;
-    }
-  if (!(pstate->p_stderr = cbuf_create(PSTDOUT_STATE_CBUF_MIN, PSTDOUT_STATE_CBUF_MAX)))
-    {
-      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-        fprintf(stderr, "cbuf_create: %s\n", strerror(errno));
-      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-      return -1;
-    }
-  pstate->buffer_stdout = NULL;
-  pstate->buffer_stdout_len = 0;
-  pstate->buffer_stderr = NULL;
-  pstate->buffer_stderr_len = 0;
   pstate->no_more_external_output = 0;
 
   if ((rc = pthread_mutex_init(&(pstate->mutex), NULL)))
@@ -910,22 +1235,19 @@ _pstdout_state_init(pstdout_state_t pstate, const char *hostname)
 static int
 _pstdout_output_buffer_data(pstdout_state_t pstate, 
                             FILE *stream,
-                            char **whichbuffer,
-                            unsigned int *whichbufferlen,
+                            struct pstdout_stream *pstream,
                             uint32_t whichprependmask, 
                             uint32_t whichbuffermask,
                             uint32_t whichconsolidatemask,
                             List whichconsolidatedlist,
+                            hash_t whichconsolidatedhash,
 			    pthread_mutex_t *whichconsolidatedmutex)
 {
   assert(pstate);
   assert(pstate->magic == PSTDOUT_STATE_MAGIC);
-  assert(pstate->p_stdout);
-  assert(pstate->p_stderr);
   assert(stream);
   assert(stream == stdout || stream == stderr);
-  assert(whichbuffer);
-  assert(whichbufferlen);
+  assert(pstream);
   assert(whichprependmask == PSTDOUT_OUTPUT_STDOUT_PREPEND_HOSTNAME 
          || whichprependmask == PSTDOUT_OUTPUT_STDERR_PREPEND_HOSTNAME);
   assert(whichbuffermask == PSTDOUT_OUTPUT_BUFFER_STDOUT 
@@ -933,21 +1255,20 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
   assert(whichconsolidatemask == PSTDOUT_OUTPUT_STDOUT_CONSOLIDATE
          || whichconsolidatemask == PSTDOUT_OUTPUT_STDERR_CONSOLIDATE);
   assert(whichconsolidatedlist);
+  assert(whichconsolidatedhash);
   assert(whichconsolidatedmutex);
 
-  if ((*whichbuffer && *whichbufferlen)
+  if (pstream->buffer_len
       && (pstdout_output_flags & whichbuffermask
           || pstdout_output_flags & whichconsolidatemask))
     {
-      /* Need to write a '\0' */
-      if (!(*whichbuffer = (char *)realloc(*whichbuffer, *whichbufferlen + 1)))
-        {
-          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-          goto cleanup;
-        }
+      /* Need to write a '\0', not counted in the length */
+      if (_pstdout_grow(&(pstream->buffer), 
+                        &(pstream->buffer_size),
+                        pstream->buffer_len + 1) < 0)
+        goto cleanup;
 
-      (*whichbuffer)[*whichbufferlen] = '\0';
-      *whichbufferlen += 1;
+      pstream->buffer[pstream->buffer_len] = '\0';
 
       if (pstdout_output_flags & whichbuffermask)
         {
@@ -957,14 +1278,19 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
               fprintf(stream, "%s\n", pstate->hostname);
               fprintf(stream, "----------------\n");
             }
-          fprintf(stream, "%s", *whichbuffer);
+          fwrite(pstream->buffer, 1, pstream->buffer_len, stream);
           fflush(stream);
         }
       else
         {
 	  struct pstdout_consolidated_data *cdata;
+          struct pstdout_consolidated_key key;
 	  int rc;
 
+          /* Digest outside of the lock, output may be large */
+          key.digest = _pstdout_consolidated_digest(pstream->buffer, pstream->buffer_len);
+          key.output = pstream->buffer;
+
 	  if ((rc = pthread_mutex_lock(whichconsolidatedmutex)))
 	    {
 	      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
@@ -973,10 +1299,12 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
 	      goto cleanup;
 	    }
 
-          if (!(cdata = list_find_first(whichconsolidatedlist, _pstdout_consolidated_data_find, *whichbuffer)))
+          if (!(cdata = hash_find(whichconsolidatedhash, &key)))
             {
-              if (!(cdata = _pstdout_consolidated_data_create(pstate->hostname, *whichbuffer)))
-                goto cleanup;
+              if (!(cdata = _pstdout_consolidated_data_create(pstate->hostname, 
+                                                              pstream->buffer,
+                                                              key.digest)))
+                goto cleanup_unlock;
 
               if (!list_append(whichconsolidatedlist, cdata))
                 {
@@ -984,7 +1312,16 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
                     fprintf(stderr, "list_append: %s\n", strerror(errno));
                   pstdout_errnum = PSTDOUT_ERR_INTERNAL;
                   _pstdout_consolidated_data_destroy(cdata);
-                  goto cleanup;
+                  goto cleanup_unlock;
+                }
+
+              /* cdata now owned by the list */
+              if (!hash_insert(whichconsolidatedhash, &(cdata->key), cdata))
+                {
+                  if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
+                    fprintf(stderr, "hash_insert: %s\n", strerror(errno));
+                  pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+                  goto cleanup_unlock;
                 }
             }
           else
@@ -994,7 +1331,7 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
                   if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
                     fprintf(stderr, "hostlist_push: %s\n", strerror(errno));
                   pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-                  goto cleanup;
+                  goto cleanup_unlock;
                 }
             }
 
@@ -1011,6 +1348,8 @@ _pstdout_output_buffer_data(pstdout_state_t pstate,
 
   return 0;
 
+ cleanup_unlock:
+  pthread_mutex_unlock(whichconsolidatedmutex);
  cleanup:
   return -1;
 }
@@ -1023,8 +1362,6 @@ _pstdout_output_finish(pstdout_state_t pstate)
 
   assert(pstate);
   assert(pstate->magic == PSTDOUT_STATE_MAGIC);
-  assert(pstate->p_stdout);
-  assert(pstate->p_stderr);
 
   if ((rc = pthread_mutex_lock(&(pstate->mutex))))
     {
@@ -1035,34 +1372,34 @@ _pstdout_output_finish(pstdout_state_t pstate)
     }
   pstate_mutex_locked++;
 
-  /* If there is remaining junk in the cbufs, write a "\n" to it so we
+  /* If there is a remaining partial line, write a "\n" so we
    * finish off the line and get it flushed out.
    */
-  if (!cbuf_is_empty(pstate->p_stdout))
-    _pstdout_print_wrapper(pstate, 1, stdout, "\n");
+  if (pstate->p_stdout.pending_len || pstate->p_stdout.buffer_midline)
+    _pstdout_write(pstate, stdout, "\n", 1);
   
-  if (!cbuf_is_empty(pstate->p_stderr))
-    _pstdout_print_wrapper(pstate, 1, stderr, "\n");
+  if (pstate->p_stderr.pending_len || pstate->p_stderr.buffer_midline)
+    _pstdout_write(pstate, stderr, "\n", 1);
   
   if (_pstdout_output_buffer_data(pstate,
                                   stdout,
-                                  &(pstate->buffer_stdout),
-                                  &(pstate->buffer_stdout_len),
+                                  &(pstate->p_stdout),
                                   PSTDOUT_OUTPUT_STDOUT_PREPEND_HOSTNAME,
                                   PSTDOUT_OUTPUT_BUFFER_STDOUT,
                                   PSTDOUT_OUTPUT_STDOUT_CONSOLIDATE,
                                   pstdout_consolidated_stdout,
+                                  pstdout_consolidated_stdout_hash,
 				  &pstdout_consolidated_stdout_mutex) < 0)
     goto cleanup;
 
   if (_pstdout_output_buffer_data(pstate,
                                   stderr,
-                                  &(pstate->buffer_stderr),
-                                  &(pstate->buffer_stderr_len),
+                                  &(pstate->p_stderr),
                                   PSTDOUT_OUTPUT_STDERR_PREPEND_HOSTNAME,
                                   PSTDOUT_OUTPUT_BUFFER_STDERR,
                                   PSTDOUT_OUTPUT_STDERR_CONSOLIDATE,
                                   pstdout_consolidated_stderr,
+                                  pstdout_consolidated_stderr_hash,
 				  &pstdout_consolidated_stderr_mutex) < 0)
     goto cleanup;
 
@@ -1089,42 +1426,73 @@ _pstdout_state_cleanup(pstdout_state_t pstate)
   assert(pstate);
   assert(pstate->magic == PSTDOUT_STATE_MAGIC);
 
-  if (pstate->p_stdout)
-    cbuf_destroy(pstate->p_stdout);
-  if (pstate->p_stderr)
-    cbuf_destroy(pstate->p_stderr);
-  free(pstate->buffer_stdout);
-  free(pstate->buffer_stderr);
+  free(pstate->p_stdout.pending);
+  free(pstate->p_stdout.buffer);
+  free(pstate->p_stderr.pending);
+  free(pstate->p_stderr.buffer);
+  free(pstate->fmtbuf);
   memset(pstate, '\0', sizeof(struct pstdout_state));
 }
 
-static void *
-_pstdout_func_entry(void *arg)
+/* Prepare a pstate already used by a worker for its next host.  The
+ * formatting and output buffers are kept so their memory is reused.
+ */
+static void
+_pstdout_state_reset(pstdout_state_t pstate, const char *hostname)
 {
-  struct pstdout_thread_data *tdata = NULL;
-  struct pstdout_state pstate;
-  int rc;
+  assert(pstate);
+  assert(pstate->magic == PSTDOUT_STATE_MAGIC);
 
-  tdata = (struct pstdout_thread_data *)arg;
+  pstate->hostname = (char *)hostname;
+  pstate->p_stdout.pending_len = 0;
+  pstate->p_stdout.buffer_len = 0;
+  pstate->p_stdout.buffer_midline = 0;
+  pstate->p_stderr.pending_len = 0;
+  pstate->p_stderr.buffer_len = 0;
+  pstate->p_stderr.buffer_midline = 0;
+  pstate->no_more_external_output = 0;
+}
 
-  if (_pstdout_state_init(&pstate, tdata->hostname) < 0)
-    goto cleanup;
+static void
+_pstdout_worker_cleanup(struct pstdout_worker *worker)
+{
+  assert(worker);
+
+  if (worker->data && worker->data_destroy)
+    worker->data_destroy(worker->data);
+  worker->data = NULL;
+  worker->data_destroy = NULL;
+}
+
+static int
+_pstdout_run_host(pstdout_state_t pstate,
+                  const char *hostname, 
+                  Pstdout_Thread pstdout_func,
+                  void *arg,
+                  int *exit_code)
+{
+  int rc, rv = -1;
+
+  assert(pstate);
+  assert(hostname);
+  assert(pstdout_func);
+  assert(exit_code);
 
   if ((rc = pthread_mutex_lock(&pstdout_states_mutex)))
     {
       if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
         fprintf(stderr, "pthread_mutex_lock: %s\n", strerror(rc));
       pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-      goto cleanup;
+      return -1;
     }
   
-  if (!list_append(pstdout_states, &pstate))
+  if (!list_append(pstdout_states, pstate))
     {
       if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
 	fprintf(stderr, "list_append: %s\n", strerror(errno));
       pstdout_errnum = PSTDOUT_ERR_INTERNAL;
       pthread_mutex_unlock(&pstdout_states_mutex);
-      goto cleanup;
+      return -1;
     }
 
   if ((rc = pthread_mutex_unlock(&pstdout_states_mutex)))
@@ -1135,20 +1503,78 @@ _pstdout_func_entry(void *arg)
       goto cleanup;
     }
 
-  tdata->exit_code = (tdata->pstdout_func)(&pstate, tdata->hostname, tdata->arg);
+  *exit_code = pstdout_func(pstate, hostname, arg);
   
-  if (_pstdout_output_finish(&pstate) < 0)
+  if (_pstdout_output_finish(pstate) < 0)
     goto cleanup;
 
+  rv = 0;
  cleanup:
   pthread_mutex_lock(&pstdout_states_mutex);
-  list_delete_all(pstdout_states, _pstdout_states_delete_pointer, &pstate);
+  list_delete_all(pstdout_states, _pstdout_states_delete_pointer, pstate);
   pthread_mutex_unlock(&pstdout_states_mutex);
-  _pstdout_state_cleanup(&pstate);
-  pthread_mutex_lock(&pstdout_threadcount_mutex);
-  pstdout_threadcount--;
-  pthread_cond_signal(&pstdout_threadcount_cond);
-  pthread_mutex_unlock(&pstdout_threadcount_mutex);
+  return rv;
+}
+
+static void *
+_pstdout_worker_entry(void *arg)
+{
+  struct pstdout_worker *worker;
+  struct pstdout_workqueue *wq;
+  struct pstdout_state pstate;
+  int pstate_init = 0;
+  unsigned int index;
+  int rc;
+
+  worker = (struct pstdout_worker *)arg;
+  wq = worker->wq;
+
+  while (1)
+    {
+      if ((rc = pthread_mutex_lock(&(wq->mutex))))
+        {
+          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
+            fprintf(stderr, "pthread_mutex_lock: %s\n", strerror(rc));
+          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+          break;
+        }
+      index = wq->next;
+      if (index < wq->hostnames_count)
+        wq->next++;
+      pthread_mutex_unlock(&(wq->mutex));
+
+      if (index >= wq->hostnames_count)
+        break;
+
+      /* An internal error fails only the current host, the remaining
+       * hosts are still run.
+       */
+      if (!pstate_init)
+        {
+          if (_pstdout_state_init(&pstate, wq->hostnames[index], worker) < 0)
+            {
+              wq->exit_codes[index] = EXIT_FAILURE;
+              continue;
+            }
+          pstate_init++;
+        }
+      else
+        _pstdout_state_reset(&pstate, wq->hostnames[index]);
+
+      if (_pstdout_run_host(&pstate,
+                            wq->hostnames[index],
+                            wq->pstdout_func,
+                            wq->arg,
+                            &(wq->exit_codes[index])) < 0)
+        {
+          if (!wq->exit_codes[index])
+            wq->exit_codes[index] = EXIT_FAILURE;
+        }
+    }
+
+  if (pstate_init)
+    _pstdout_state_cleanup(&pstate);
+  _pstdout_worker_cleanup(worker);
   return NULL;
 }
 
@@ -1281,8 +1707,7 @@ _pstdout_sigint_finish_output(void *x, void *arg)
       && (pstdout_output_flags & PSTDOUT_OUTPUT_STDOUT_PREPEND_HOSTNAME)
       && (pstdout_output_flags & PSTDOUT_OUTPUT_BUFFER_STDOUT))
     {
-      if ((pstate->buffer_stdout && pstate->buffer_stdout_len)
-          || (pstate->buffer_stderr && pstate->buffer_stderr_len))
+      if (pstate->p_stdout.buffer_len || pstate->p_stderr.buffer_len)
         fprintf(stdout, "%s: exiting session: current output flushed\n", pstate->hostname);
       else
         fprintf(stdout, "%s: exiting session\n", pstate->hostname);
@@ -1291,8 +1716,7 @@ _pstdout_sigint_finish_output(void *x, void *arg)
 
   if (pstdout_output_flags & PSTDOUT_OUTPUT_STDOUT_CONSOLIDATE)
     {
-      if ((pstate->buffer_stdout && pstate->buffer_stdout_len)
-          || (pstate->buffer_stderr && pstate->buffer_stderr_len))
+      if (pstate->p_stdout.buffer_len || pstate->p_stderr.buffer_len)
         fprintf(stdout, "%s: exiting session: current output consolidated\n", pstate->hostname);
       else
         fprintf(stdout, "%s: exiting session\n", pstate->hostname);
@@ -1328,7 +1752,12 @@ _pstdout_sigint(int s)
 int
 pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
 {
-  struct pstdout_thread_data **tdata = NULL;
+  struct pstdout_workqueue wq;
+  struct pstdout_worker *workers = NULL;
+  unsigned int workers_count = 0;
+  unsigned int workers_launched = 0;
+  int wq_mutex_init = 0;
+  struct pstdout_worker worker;
   struct pstdout_state pstate;
   unsigned int pstate_init = 0;
   hostlist_iterator_t hitr = NULL;
@@ -1353,6 +1782,9 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
       return -1;
     }
   
+  memset(&wq, '\0', sizeof(struct pstdout_workqueue));
+  memset(&worker, '\0', sizeof(struct pstdout_worker));
+
   if ((rc = pthread_mutex_lock(&pstdout_launch_mutex)))
     {
       if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
@@ -1364,9 +1796,9 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
   /* Special case */
   if (!hostnames)
     {
-      if (_pstdout_state_init(&pstate, NULL) < 0)
-        goto cleanup;
       pstate_init++;
+      if (_pstdout_state_init(&pstate, NULL, &worker) < 0)
+        goto cleanup;
 
       exit_code = pstdout_func(&pstate, NULL, arg);
       pstdout_errnum = PSTDOUT_ERR_SUCCESS;
@@ -1392,9 +1824,9 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
   /* Special case */
   if (h_count == 1)
     {
-      if (_pstdout_state_init(&pstate, hostnames) < 0)
-        goto cleanup;
       pstate_init++;
+      if (_pstdout_state_init(&pstate, hostnames, &worker) < 0)
+        goto cleanup;
 
       exit_code = pstdout_func(&pstate, hostnames, arg);
       pstdout_errnum = PSTDOUT_ERR_SUCCESS;
@@ -1416,51 +1848,45 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
       goto cleanup;
     }
 
-  if (!(tdata = (struct pstdout_thread_data **)malloc(sizeof(struct pstdout_thread_data *) * h_count)))
+  if (!(wq.hostnames = (char **)malloc(sizeof(char *) * h_count)))
     {
       pstdout_errnum = PSTDOUT_ERR_OUTMEM;
       goto cleanup;
     }
-  memset(tdata, '\0', sizeof(struct pstdout_thread_data *) * h_count);
+  memset(wq.hostnames, '\0', sizeof(char *) * h_count);
+
+  if (!(wq.exit_codes = (int *)malloc(sizeof(int) * h_count)))
+    {
+      pstdout_errnum = PSTDOUT_ERR_OUTMEM;
+      goto cleanup;
+    }
+  memset(wq.exit_codes, '\0', sizeof(int) * h_count);
 
   i = 0;
   while ((host = hostlist_next(hitr)))
     {
-      if (!(tdata[i] = (struct pstdout_thread_data *)malloc(sizeof(struct pstdout_thread_data))))
-        {
-          pstdout_errnum = PSTDOUT_ERR_OUTMEM;
-          goto cleanup;
-        }
-      memset(tdata[i], '\0', sizeof(struct pstdout_thread_data));
-      
-      if (!(tdata[i]->hostname = strdup(host)))
+      if (!(wq.hostnames[i] = strdup(host)))
         {
           pstdout_errnum = PSTDOUT_ERR_OUTMEM;
           goto cleanup;
         }
-      tdata[i]->pstdout_func = pstdout_func;
-      tdata[i]->arg = arg;
-      
-      if ((rc = pthread_attr_init(&(tdata[i]->attr))))
-        {
-          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "pthread_attr_init: %s\n", strerror(rc));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
-        }
-      
-      if ((rc = pthread_attr_setdetachstate(&(tdata[i]->attr), PTHREAD_CREATE_DETACHED)))
-        {
-          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "pthread_attr_setdetachstate: %s\n", strerror(rc));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
-        }
-      
       free(host);
       i++;
     }
   host = NULL;
+  wq.hostnames_count = h_count;
+  wq.next = 0;
+  wq.pstdout_func = pstdout_func;
+  wq.arg = arg;
+
+  if ((rc = pthread_mutex_init(&(wq.mutex), NULL)))
+    {
+      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
+        fprintf(stderr, "pthread_mutex_init: %s\n", strerror(rc));
+      pstdout_errnum = PSTDOUT_ERR_INTERNAL;
+      goto cleanup;
+    }
+  wq_mutex_init++;
 
   hostlist_iterator_destroy(hitr);
   hitr = NULL;
@@ -1468,70 +1894,53 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
   hostlist_destroy(h);
   h = NULL;
 
-  /* Launch threads up to fanout */
-  for (i = 0; i < h_count; i++)
-    {
-      if ((rc = pthread_mutex_lock(&pstdout_threadcount_mutex)))
-        {
-          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "pthread_mutex_lock: %s\n", strerror(rc));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
-        }
+  /* No need for more workers than hosts */
+  workers_count = pstdout_fanout < h_count ? pstdout_fanout : h_count;
 
-      if (pstdout_threadcount == pstdout_fanout)
-        {
-          if ((rc = pthread_cond_wait(&pstdout_threadcount_cond, &pstdout_threadcount_mutex)))
-            {
-              if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-                fprintf(stderr, "pthread_cond_wait: %s\n", strerror(rc));
-              pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-              goto cleanup;
-            }
-        }
+  if (!(workers = (struct pstdout_worker *)malloc(sizeof(struct pstdout_worker) * workers_count)))
+    {
+      pstdout_errnum = PSTDOUT_ERR_OUTMEM;
+      goto cleanup;
+    }
+  memset(workers, '\0', sizeof(struct pstdout_worker) * workers_count);
 
-      if ((rc = pthread_create(&(tdata[i]->tid),
-                               &(tdata[i]->attr),
-                               _pstdout_func_entry,
-                               (void *) tdata[i])))
+  /* Launch worker pool, if we can't get all of the workers we asked
+   * for, the workers that were launched will pick up the slack.
+   */
+  for (i = 0; i < workers_count; i++)
+    {
+      workers[i].wq = &wq;
+      
+      if ((rc = pthread_create(&(workers[i].tid),
+                               NULL,
+                               _pstdout_worker_entry,
+                               (void *) &workers[i])))
         {
           if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
             fprintf(stderr, "pthread_create: %s\n", strerror(rc));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
-        }
-
-      pstdout_threadcount++;
-
-      if ((rc = pthread_mutex_unlock(&pstdout_threadcount_mutex)))
-        {
-          if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "pthread_mutex_unlock: %s\n", strerror(rc));
-          pstdout_errnum = PSTDOUT_ERR_INTERNAL;
-          goto cleanup;
+          break;
         }
+      workers_launched++;
     }
 
-  /* Wait for Threads to finish */
-
-  if ((rc = pthread_mutex_lock(&pstdout_threadcount_mutex)))
+  if (!workers_launched)
     {
-      if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-        fprintf(stderr, "pthread_mutex_lock: %s\n", strerror(rc));
       pstdout_errnum = PSTDOUT_ERR_INTERNAL;
       goto cleanup;
     }
 
-  while (pstdout_threadcount > 0)
+  /* Wait for workers to finish */
+  for (i = 0; i < workers_launched; i++)
     {
-      if ((rc = pthread_cond_wait(&pstdout_threadcount_cond, &pstdout_threadcount_mutex)))
+      if ((rc = pthread_join(workers[i].tid, NULL)))
         {
           if (pstdout_debug_flags & PSTDOUT_DEBUG_STANDARD)
-            fprintf(stderr, "pthread_cond_wait: %s\n", strerror(rc));
+            fprintf(stderr, "pthread_join: %s\n", strerror(rc));
           pstdout_errnum = PSTDOUT_ERR_INTERNAL;
           goto cleanup;
         }
     }
+  workers_launched = 0;
 
   if (_pstdout_output_consolidated_finish() < 0)
     goto cleanup;
@@ -1540,28 +1949,32 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
   exit_code = 0;
   for (i = 0; i < h_count; i++)
     {
-      if (tdata[i]->exit_code > exit_code)
-        exit_code = tdata[i]->exit_code;
+      if (wq.exit_codes[i] > exit_code)
+        exit_code = wq.exit_codes[i];
     }
 
  cleanup:
+  hash_delete_if(pstdout_consolidated_stdout_hash, _pstdout_consolidated_hash_delete_all, NULL);
+  hash_delete_if(pstdout_consolidated_stderr_hash, _pstdout_consolidated_hash_delete_all, NULL);
   /* Cannot pass NULL for key, so just pass dummy key */
   list_delete_all(pstdout_consolidated_stdout, _pstdout_consolidated_data_delete_all, "");
   list_delete_all(pstdout_consolidated_stderr, _pstdout_consolidated_data_delete_all, "");
   if (pstate_init)
     _pstdout_state_cleanup(&pstate);
-  if (tdata)
+  _pstdout_worker_cleanup(&worker);
+  /* Only on a join error, don't free data workers may still use */
+  if (!workers_launched)
     {
-      for (i = 0; i < h_count; i++)
+      free(workers);
+      if (wq.hostnames)
         {
-          if (tdata[i])
-            {
-	      free(tdata[i]->hostname);
-              pthread_attr_destroy(&(tdata[i]->attr));
-              free(tdata[i]);
-            }
+          for (i = 0; i < wq.hostnames_count; i++)
+            free(wq.hostnames[i]);
+          free(wq.hostnames);
         }
-      free(tdata);
+      free(wq.exit_codes);
+      if (wq_mutex_init)
+        pthread_mutex_destroy(&(wq.mutex));
     }
   if (hitr)
     hostlist_iterator_destroy(hitr);
@@ -1579,6 +1992,55 @@ pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg)
   return exit_code;
 }
 
+void *
+pstdout_get_worker_data(pstdout_state_t pstate)
+{
+  if (!pstdout_initialized)
+    {
+      pstdout_errnum = PSTDOUT_ERR_UNINITIALIZED;
+      return NULL;
+    }
+
+  if (!pstate || pstate->magic != PSTDOUT_STATE_MAGIC)
+    {
+      pstdout_errnum = PSTDOUT_ERR_PARAMETERS;
+      return NULL;
+    }
+
+  assert(pstate->worker);
+
+  pstdout_errnum = PSTDOUT_ERR_SUCCESS;
+  return pstate->worker->data;
+}
+
+int
+pstdout_set_worker_data(pstdout_state_t pstate,
+                        void *data,
+                        Pstdout_Worker_Data_Destroy data_destroy)
+{
+  if (!pstdout_initialized)
+    {
+      pstdout_errnum = PSTDOUT_ERR_UNINITIALIZED;
+      return -1;
+    }
+
+  if (!pstate || pstate->magic != PSTDOUT_STATE_MAGIC)
+    {
+      pstdout_errnum = PSTDOUT_ERR_PARAMETERS;
+      return -1;
+    }
+
+  assert(pstate->worker);
+
+  if (pstate->worker->data != data)
+    _pstdout_worker_cleanup(pstate->worker);
+
+  pstate->worker->data = data;
+  pstate->worker->data_destroy = data_destroy;
+  pstdout_errnum = PSTDOUT_ERR_SUCCESS;
+  return 0;
+}
+
 int 
 PSTDOUT_PRINTF(pstdout_state_t pstate, const char *format, ...)
 {
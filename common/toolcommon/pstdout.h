@@ -30,7 +30,7 @@
 
 /* 
  * Pstdout is a library/tool to launch and manage multiple threads,
- * each dealing with a different host.  It will also manage the
+ * each dealing with a different host at a time.  It will also manage the
  * "parallel" standard output from the launched threads.
  *
  * The idea for pstdout came from the pdsh and dshbak.  (See
@@ -143,6 +143,13 @@ typedef struct pstdout_state *pstdout_state_t;
  */
 typedef int (*Pstdout_Thread)(pstdout_state_t pstate, const char *hostname, void *arg);
 
+/* Pstdout_Worker_Data_Destroy
+ *
+ * Function prototype to destroy data saved with
+ * 'pstdout_set_worker_data'.  Called when the worker thread exits.
+ */
+typedef void (*Pstdout_Worker_Data_Destroy)(void *data);
+
 /* pstdout_init
  *
  * Must be called before most pstdout API functions can be called.
@@ -185,8 +192,8 @@ int pstdout_get_output_flags(void);
 
 /* pstdout_set_fanout
  *
- * Set the current fanout.  The fanout is the largest number of
- * threads that can be launched simultaneously by 'pstdout_launch'.
+ * Set the current fanout.  The fanout is the number of worker
+ * threads 'pstdout_launch' uses to work through the hosts.
  *
  * Returns 0 on success, -1 on error
  */
@@ -273,14 +280,38 @@ void pstdout_perror(pstdout_state_t pstate, const char *s);
 /* pstdout_launch
  *
  * Primary thread launching function of the library.  It will launch
- * no more than 'fanout' threads at the same time, launching new
- * threads after old ones have completed.  Will handle all standard output
- * buffering or consolidation that is required.
+ * a pool of no more than 'fanout' worker threads.  Each worker calls
+ * 'pstdout_func' for one host at a time, moving on to the next
+ * remaining host after the previous one has completed.  Will handle
+ * all standard output buffering or consolidation that is required.
  *
- * Returns: Largest exit code returned from all threads launched.
+ * Returns: Largest exit code returned from all hosts.
  */
 int pstdout_launch(const char *hostnames, Pstdout_Thread pstdout_func, void *arg);
 
+/* pstdout_get_worker_data
+ *
+ * Retrieve data saved with 'pstdout_set_worker_data' while handling
+ * an earlier host on the same worker thread.  Allows expensive
+ * per-host resources (e.g. contexts) to be reused across hosts.
+ *
+ * Returns data on success, NULL if no data is set or on error.
+ */
+void *pstdout_get_worker_data(pstdout_state_t pstate);
+
+/* pstdout_set_worker_data
+ *
+ * Save data with the worker thread handling this host, replacing
+ * (and destroying) any data previously saved.  'data_destroy' may be
+ * NULL.  Should only be called by a thread executed by
+ * 'pstdout_launch'.
+ *
+ * Returns 0 on success, -1 on error
+ */
+int pstdout_set_worker_data(pstdout_state_t pstate,
+                            void *data,
+                            Pstdout_Worker_Data_Destroy data_destroy);
+
 /* PSTDOUT_PRINTF
  *
  * Identical to 'pstdout_printf', but will call standard printf() if an invalid
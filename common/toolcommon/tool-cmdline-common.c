@@ -335,6 +335,19 @@ common_parse_opt (int key,
         }
       common_args->retransmission_timeout = tmp;
       break;
+    case ARGP_PIPELINE_WINDOW_KEY:
+      errno = 0;
+      tmp = strtol (arg, &endptr, 0);
+      if (errno
+	  || endptr[0] != '\0'
+          || tmp <= 0
+          || tmp > IPMI_PIPELINE_WINDOW_MAX)
+        {
+          fprintf (stderr, "invalid pipeline window\n");
+          exit (EXIT_FAILURE);
+        }
+      common_args->pipeline_window = tmp;
+      break;
       /* ARGP_AUTH_TYPE_KEY for backwards compatability */
     case ARGP_AUTH_TYPE_KEY:
     case ARGP_AUTHENTICATION_TYPE_KEY:
@@ -434,6 +447,9 @@ common_parse_opt (int key,
           exit (EXIT_FAILURE);
         }
       break;
+    case ARGP_SHARED_SDR_CACHE_KEY:
+      common_args->shared_sdr_cache = 1;
+      break;
     case ARGP_IGNORE_SDR_CACHE_KEY:
       common_args->ignore_sdr_cache = 1;
       break;
@@ -519,6 +535,7 @@ _init_common_cmd_args (struct common_cmd_args *common_args)
   common_args->k_g_len = 0;
   common_args->session_timeout = 0;
   common_args->retransmission_timeout = 0;
+  common_args->pipeline_window = IPMI_PIPELINE_WINDOW_DEFAULT;
   common_args->authentication_type = IPMI_AUTHENTICATION_TYPE_MD5;
   common_args->cipher_suite_id = 3;
   /* privilege_level set by parent function */
@@ -535,6 +552,7 @@ _init_common_cmd_args (struct common_cmd_args *common_args)
   common_args->sdr_cache_recreate = 0;
   common_args->sdr_cache_file = NULL;
   common_args->sdr_cache_directory = NULL;
+  common_args->shared_sdr_cache = 0;
   common_args->ignore_sdr_cache = 0;
 
   common_args->utc_to_localtime = 0;
@@ -71,6 +71,7 @@ enum argp_common_option_keys
     ARGP_SDR_CACHE_FILE_KEY = 148,
     ARGP_SDR_CACHE_DIRECTORY_KEY = 150,
     ARGP_IGNORE_SDR_CACHE_KEY = 151,
+    ARGP_SHARED_SDR_CACHE_KEY = 156,
     /* time options */
     ARGP_UTC_TO_LOCALTIME_KEY = 152,
     ARGP_LOCALTIME_TO_UTC_KEY = 153,
@@ -81,6 +82,8 @@ enum argp_common_option_keys
     ARGP_FANOUT_KEY = 'F',
     ARGP_ELIMINATE_KEY = 'E',
     ARGP_ALWAYS_PREFIX_KEY = 155,
+    /* pipeline options */
+    ARGP_PIPELINE_WINDOW_KEY = 157,
   };
 
 /*
@@ -147,6 +150,10 @@ enum argp_common_option_keys
   { "retransmission-timeout", ARGP_RETRANSMISSION_TIMEOUT_KEY, "MILLISECONDS", 0,                               \
       "Specify the packet retransmission timeout in milliseconds.", 14}
 
+#define ARGP_COMMON_OPTIONS_PIPELINE_WINDOW                                                                     \
+  { "pipeline-window", ARGP_PIPELINE_WINDOW_KEY, "COUNT", 0,                                                    \
+      "Specify the number of requests that may be outstanding to the remote host.", 14}
+
 /* auth-type is maintained for backwards compatability */
 #define ARGP_COMMON_OPTIONS_AUTHENTICATION_TYPE                                                                 \
   { "auth-type", ARGP_AUTH_TYPE_KEY, "AUTHENTICATION-TYPE", OPTION_HIDDEN,                                      \
@@ -188,7 +195,9 @@ enum argp_common_option_keys
   { "sdr-cache-file", ARGP_SDR_CACHE_FILE_KEY, "FILE", 0,                                                       \
       "Specify a specific file for the sensor data repository (SDR) cache to be stored or read from.", 23},     \
   { "sdr-cache-directory", ARGP_SDR_CACHE_DIRECTORY_KEY, "DIRECTORY", 0,                                        \
-      "Specify an alternate directory for sensor data repository (SDR) caches to be stored or read from.", 24}
+      "Specify an alternate directory for sensor data repository (SDR) caches to be stored or read from.", 24}, \
+  { "shared-sdr-cache", ARGP_SHARED_SDR_CACHE_KEY, 0, 0,                                                        \
+      "Share sensor data repository (SDR) caches between hosts with identical SDRs.", 24}
 
 #define ARGP_COMMON_SDR_CACHE_OPTIONS_IGNORE                                                                    \
   { "ignore-sdr-cache", ARGP_IGNORE_SDR_CACHE_KEY, 0, 0,                                                        \
@@ -240,6 +249,7 @@ struct common_cmd_args
   unsigned int k_g_len;
   unsigned int session_timeout;
   unsigned int retransmission_timeout;
+  unsigned int pipeline_window;
   int authentication_type;
   int cipher_suite_id;
   int privilege_level;
@@ -261,6 +271,7 @@ struct common_cmd_args
   int sdr_cache_recreate;
   char *sdr_cache_file;
   char *sdr_cache_directory;
+  int shared_sdr_cache;
   int ignore_sdr_cache;
 
   /* time options */
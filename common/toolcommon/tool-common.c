@@ -42,24 +42,32 @@
 
 #include "freeipmi-portability.h"
 
-ipmi_ctx_t
-ipmi_open (const char *progname,
-           const char *hostname,
-           struct common_cmd_args *common_args,
-	   pstdout_state_t pstate)
+/* contexts cached by a pstdout worker thread between hosts */
+struct tool_worker_data
+{
+  ipmi_ctx_t ipmi_ctx;
+  ipmi_sdr_ctx_t sdr_ctx;
+};
+
+static int
+_ipmi_open (ipmi_ctx_t ipmi_ctx,
+            const char *progname,
+            const char *hostname,
+            struct common_cmd_args *common_args,
+            pstdout_state_t pstate)
 {
-  ipmi_ctx_t ipmi_ctx = NULL;
   unsigned int workaround_flags = 0;
 
+  assert (ipmi_ctx);
   assert (progname);
   assert (common_args);
 
-  if (!(ipmi_ctx = ipmi_ctx_create ()))
+  if (ipmi_ctx_set_pipeline_window (ipmi_ctx, common_args->pipeline_window) < 0)
     {
       PSTDOUT_FPRINTF (pstate,
 		       stderr,
-		       "ipmi_ctx_create: %s",
-		       strerror (errno));
+		       "ipmi_ctx_set_pipeline_window: %s\n",
+		       ipmi_ctx_errormsg (ipmi_ctx));
       goto cleanup;
     }
 
@@ -232,10 +240,169 @@ ipmi_open (const char *progname,
 	} 
     }
   
-  return (ipmi_ctx);
+  return (0);
 
  cleanup: 
   ipmi_ctx_close (ipmi_ctx);
-  ipmi_ctx_destroy (ipmi_ctx);
-  return (NULL);
+  return (-1);
+}
+
+ipmi_ctx_t
+ipmi_open (const char *progname,
+           const char *hostname,
+           struct common_cmd_args *common_args,
+	   pstdout_state_t pstate)
+{
+  ipmi_ctx_t ipmi_ctx = NULL;
+
+  assert (progname);
+  assert (common_args);
+
+  if (!(ipmi_ctx = ipmi_ctx_create ()))
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "ipmi_ctx_create: %s",
+		       strerror (errno));
+      return (NULL);
+    }
+
+  if (_ipmi_open (ipmi_ctx,
+                  progname,
+                  hostname,
+                  common_args,
+                  pstate) < 0)
+    {
+      ipmi_ctx_destroy (ipmi_ctx);
+      return (NULL);
+    }
+
+  return (ipmi_ctx);
+}
+
+static void
+_tool_worker_data_destroy (void *data)
+{
+  struct tool_worker_data *wdata;
+
+  assert (data);
+
+  wdata = (struct tool_worker_data *)data;
+  ipmi_ctx_destroy (wdata->ipmi_ctx);
+  ipmi_sdr_ctx_destroy (wdata->sdr_ctx);
+  free (wdata);
+}
+
+static struct tool_worker_data *
+_tool_worker_data (pstdout_state_t pstate, int create)
+{
+  struct tool_worker_data *wdata;
+
+  /* not launched by pstdout, nothing to cache in */
+  if (!pstate)
+    return (NULL);
+
+  if ((wdata = pstdout_get_worker_data (pstate)) || !create)
+    return (wdata);
+
+  if (!(wdata = (struct tool_worker_data *)malloc (sizeof (struct tool_worker_data))))
+    return (NULL);
+  memset (wdata, '\0', sizeof (struct tool_worker_data));
+
+  if (pstdout_set_worker_data (pstate, wdata, _tool_worker_data_destroy) < 0)
+    {
+      free (wdata);
+      return (NULL);
+    }
+
+  return (wdata);
+}
+
+ipmi_ctx_t
+ipmi_open_cached (const char *progname,
+                  const char *hostname,
+                  struct common_cmd_args *common_args,
+                  pstdout_state_t pstate)
+{
+  struct tool_worker_data *wdata;
+  ipmi_ctx_t ipmi_ctx = NULL;
+
+  assert (progname);
+  assert (common_args);
+
+  if ((wdata = _tool_worker_data (pstate, 0)) && wdata->ipmi_ctx)
+    {
+      ipmi_ctx = wdata->ipmi_ctx;
+      wdata->ipmi_ctx = NULL;
+    }
+  else if (!(ipmi_ctx = ipmi_ctx_create ()))
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "ipmi_ctx_create: %s",
+		       strerror (errno));
+      return (NULL);
+    }
+
+  if (_ipmi_open (ipmi_ctx,
+                  progname,
+                  hostname,
+                  common_args,
+                  pstate) < 0)
+    {
+      ipmi_close_cached (ipmi_ctx, pstate);
+      return (NULL);
+    }
+
+  return (ipmi_ctx);
+}
+
+void
+ipmi_close_cached (ipmi_ctx_t ipmi_ctx, pstdout_state_t pstate)
+{
+  struct tool_worker_data *wdata;
+
+  if (!ipmi_ctx)
+    return;
+
+  /* ignore potential error, may already be closed */
+  ipmi_ctx_close (ipmi_ctx);
+
+  if ((wdata = _tool_worker_data (pstate, 1)) && !wdata->ipmi_ctx)
+    wdata->ipmi_ctx = ipmi_ctx;
+  else
+    ipmi_ctx_destroy (ipmi_ctx);
+}
+
+ipmi_sdr_ctx_t
+ipmi_sdr_ctx_create_cached (pstdout_state_t pstate)
+{
+  struct tool_worker_data *wdata;
+  ipmi_sdr_ctx_t sdr_ctx;
+
+  if ((wdata = _tool_worker_data (pstate, 0)) && wdata->sdr_ctx)
+    {
+      sdr_ctx = wdata->sdr_ctx;
+      wdata->sdr_ctx = NULL;
+      return (sdr_ctx);
+    }
+
+  return (ipmi_sdr_ctx_create ());
+}
+
+void
+ipmi_sdr_ctx_destroy_cached (ipmi_sdr_ctx_t sdr_ctx, pstdout_state_t pstate)
+{
+  struct tool_worker_data *wdata;
+
+  if (!sdr_ctx)
+    return;
+
+  /* ignore potential error, cache may not be open */
+  ipmi_sdr_cache_close (sdr_ctx);
+
+  if ((wdata = _tool_worker_data (pstate, 1)) && !wdata->sdr_ctx)
+    wdata->sdr_ctx = sdr_ctx;
+  else
+    ipmi_sdr_ctx_destroy (sdr_ctx);
 }
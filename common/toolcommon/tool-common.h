@@ -30,4 +30,27 @@ ipmi_ctx_t ipmi_open (const char *progname,
                       struct common_cmd_args *common_args,
 		      pstdout_state_t pstate);
 
+/* ipmi_open_cached, ipmi_close_cached
+ *
+ * Like ipmi_open(), but reuses a context cached by the pstdout
+ * worker thread handling the host, saving the context creation on
+ * every host.  Contexts must be released via ipmi_close_cached(),
+ * not ipmi_ctx_close()/ipmi_ctx_destroy().
+ */
+ipmi_ctx_t ipmi_open_cached (const char *progname,
+                             const char *hostname,
+                             struct common_cmd_args *common_args,
+                             pstdout_state_t pstate);
+
+void ipmi_close_cached (ipmi_ctx_t ipmi_ctx, pstdout_state_t pstate);
+
+/* ipmi_sdr_ctx_create_cached, ipmi_sdr_ctx_destroy_cached
+ *
+ * Same as above, for SDR contexts.  Any open SDR cache is closed
+ * when the context is released.
+ */
+ipmi_sdr_ctx_t ipmi_sdr_ctx_create_cached (pstdout_state_t pstate);
+
+void ipmi_sdr_ctx_destroy_cached (ipmi_sdr_ctx_t sdr_ctx, pstdout_state_t pstate);
+
 #endif /* TOOL_COMMON_H */
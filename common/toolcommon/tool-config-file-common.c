@@ -435,6 +435,35 @@ _config_file_k_g (conffile_t cf,
   return (0);
 }
 
+static int
+_config_file_pipeline_window (conffile_t cf,
+                              struct conffile_data *data,
+                              char *optionname,
+                              int option_type,
+                              void *option_ptr,
+                              int option_data,
+                              void *app_ptr,
+                              int app_data)
+{
+  unsigned int *value;
+
+  assert (data);
+  assert (optionname);
+  assert (option_ptr);
+
+  value = (unsigned int *)option_ptr;
+
+  if (data->intval <= 0
+      || data->intval > IPMI_PIPELINE_WINDOW_MAX)
+    {
+      fprintf (stderr, "Config File Error: invalid value for %s\n", optionname);
+      exit (EXIT_FAILURE);
+    }
+
+  *value = data->intval;
+  return (0);
+}
+
 static int
 _config_file_authentication_type (conffile_t cf,
                                   struct conffile_data *data,
@@ -1351,7 +1380,10 @@ config_file_parse (const char *filename,
     authentication_type_count = 0, cipher_suite_id_count = 0,
     privilege_level_count = 0;
 
-  int quiet_cache_count = 0, sdr_cache_directory_count = 0;
+  int pipeline_window_count = 0;
+
+  int quiet_cache_count = 0, sdr_cache_directory_count = 0,
+    shared_sdr_cache_count = 0;
 
   int utc_to_localtime_count = 0, localtime_to_utc_count = 0,
     utc_offset_count = 0;
@@ -1700,6 +1732,21 @@ config_file_parse (const char *filename,
       },
     };
 
+  struct conffile_option pipeline_options[] =
+    {
+      {
+        "pipeline-window",
+        CONFFILE_OPTION_INT,
+        -1,
+        _config_file_pipeline_window,
+        1,
+        0,
+        &pipeline_window_count,
+        &(common_args->pipeline_window),
+        0
+      },
+    };
+
   struct conffile_option sdr_options[] =
     {
       {
@@ -1724,6 +1771,17 @@ config_file_parse (const char *filename,
         &(common_args->sdr_cache_directory),
         0
       },
+      {
+        "shared-sdr-cache",
+        CONFFILE_OPTION_BOOL,
+        -1,
+        _config_file_bool,
+        1,
+        0,
+        &shared_sdr_cache_count,
+        &(common_args->shared_sdr_cache),
+        0
+      },
     };
 
   struct conffile_option time_options[] =
@@ -4828,6 +4886,17 @@ config_file_parse (const char *filename,
         &(ipmipower_data.ping_consec_count),
         0
       },
+      {
+        "ipmipower-shared-sockets",
+        CONFFILE_OPTION_INT,
+        -1,
+        _config_file_unsigned_int,
+        1,
+        0,
+        &(ipmipower_data.shared_sockets_count),
+        &(ipmipower_data.shared_sockets),
+        0
+      },
     };
 
   /*
@@ -5121,7 +5190,8 @@ config_file_parse (const char *filename,
                 || (support & CONFIG_FILE_OUTOFBAND)
 		|| (support & CONFIG_FILE_SDR)
 		|| (support & CONFIG_FILE_TIME)
-		|| (support & CONFIG_FILE_HOSTRANGE))
+		|| (support & CONFIG_FILE_HOSTRANGE)
+		|| (support & CONFIG_FILE_PIPELINE))
                && common_args))
           && (((tool_support & CONFIG_FILE_TOOL_BMC_DEVICE) && !tool_data)
               || ((tool_support & CONFIG_FILE_TOOL_BMC_INFO) && tool_data)
@@ -5182,6 +5252,17 @@ config_file_parse (const char *filename,
 
   config_file_options_len += options_len;
 
+  options_len = sizeof (pipeline_options)/sizeof (struct conffile_option);
+  if (!(support & CONFIG_FILE_PIPELINE))
+    _ignore_options (pipeline_options, options_len);
+
+  _copy_options (config_file_options,
+                 config_file_options_len,
+                 pipeline_options,
+                 options_len);
+
+  config_file_options_len += options_len;
+
   options_len = sizeof (sdr_options)/sizeof (struct conffile_option);
   if (!(support & CONFIG_FILE_SDR))
     _ignore_options (sdr_options, options_len);
@@ -32,6 +32,7 @@
 #define CONFIG_FILE_SDR         0x04
 #define CONFIG_FILE_TIME        0x08
 #define CONFIG_FILE_HOSTRANGE   0x10
+#define CONFIG_FILE_PIPELINE    0x20
 
 #define CONFIG_FILE_TOOL_NONE                0x00000000
 #define CONFIG_FILE_TOOL_BMC_DEVICE          0x00000001
@@ -275,6 +276,8 @@ struct config_file_data_ipmipower
   int ping_percent_count;
   unsigned int ping_consec_count;
   int ping_consec_count_count;
+  unsigned int shared_sockets;
+  int shared_sockets_count;
 };
 
 struct config_file_data_ipmiseld
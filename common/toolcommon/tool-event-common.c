@@ -37,15 +37,33 @@
 #include "freeipmi-portability.h"
 #include "pstdout.h"
 
+static int
+_event_load_sel_config (ipmi_interpret_ctx_t interpret_ctx,
+			const char *event_state_config_file,
+			const char *event_state_config_cache_file)
+{
+  assert (interpret_ctx);
+
+  if (event_state_config_cache_file)
+    return (ipmi_interpret_load_sel_config_cached (interpret_ctx,
+						   event_state_config_file,
+						   event_state_config_cache_file));
+
+  return (ipmi_interpret_load_sel_config (interpret_ctx,
+					  event_state_config_file));
+}
+
 int
 event_load_event_state_config_file (pstdout_state_t pstate,
 				    ipmi_interpret_ctx_t interpret_ctx,
-				    const char *event_state_config_file)
+				    const char *event_state_config_file,
+				    const char *event_state_config_cache_file)
 {
   if (event_state_config_file)
     {
-      if (ipmi_interpret_load_sel_config (interpret_ctx,
-					  event_state_config_file) < 0)
+      if (_event_load_sel_config (interpret_ctx,
+				  event_state_config_file,
+				  event_state_config_cache_file) < 0)
 	{
 	  if (ipmi_interpret_ctx_errnum (interpret_ctx) == IPMI_INTERPRET_ERR_SEL_CONFIG_FILE_DOES_NOT_EXIST)
 	    PSTDOUT_FPRINTF (pstate,
@@ -67,7 +85,9 @@ event_load_event_state_config_file (pstdout_state_t pstate,
     }
   else
     {
-      if (ipmi_interpret_load_sel_config (interpret_ctx, NULL) < 0)
+      if (_event_load_sel_config (interpret_ctx,
+				  NULL,
+				  event_state_config_cache_file) < 0)
 	{
 	  if (ipmi_interpret_ctx_errnum (interpret_ctx) == IPMI_INTERPRET_ERR_SEL_CONFIG_FILE_PARSE)
 	    PSTDOUT_FPRINTF (pstate,
@@ -36,7 +36,8 @@
 
 int event_load_event_state_config_file (pstdout_state_t pstate,
 					ipmi_interpret_ctx_t interpret_ctx,
-					const char *event_state_config_file);
+					const char *event_state_config_file,
+					const char *event_state_config_cache_file);
 
 /* All functions below
  * return 1 on success
@@ -30,6 +30,12 @@
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#if HAVE_FLOCK
+#include <sys/file.h>
+#endif /* HAVE_FLOCK */
+#endif /* HAVE_FCNTL_H */
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif  /* HAVE_UNISTD_H */
@@ -38,11 +44,15 @@
 #include <netdb.h>              /* MAXHOSTNAMELEN Solaris */
 #endif /* HAVE_NETDB_H */
 #include <libgen.h>
+#include <time.h>
 #include <assert.h>
 #include <errno.h>
 
 #define SDR_CACHE_DIR                     "sdr-cache"
 #define SDR_CACHE_FILENAME_PREFIX         "sdr-cache"
+#define SDR_CACHE_SHARED_DIR              "shared"
+#define SDR_CACHE_SHARED_KEY_LEN          64
+/* seconds before a shared cache lock is assumed left behind by a dead process */
 #define FREEIPMI_CONFIG_DIRECTORY_MODE    0700
 
 #ifndef MAXHOSTNAMELEN
@@ -56,6 +66,7 @@
 #include "tool-sdr-cache-common.h"
 
 #include "freeipmi-portability.h"
+#include "fd.h"
 #include "pstdout.h"
 #include "tool-cmdline-common.h"
 
@@ -304,6 +315,60 @@ _sdr_cache_get_cache_directory (pstdout_state_t pstate,
   return (0);
 }
 
+static int
+_sdr_cache_get_host_filename (pstdout_state_t pstate,
+			      const char *prefix,
+			      const char *hostname,
+			      const char *cache_dir,
+			      char *buf,
+			      unsigned int buflen)
+{
+  char sdrcachebuf[MAXPATHLEN+1];
+  char hostnamebuf[MAXHOSTNAMELEN+1];
+  char *ptr;
+  int ret;
+
+  assert (prefix);
+  assert (buf);
+  assert (buflen);
+
+  memset (hostnamebuf, '\0', MAXHOSTNAMELEN+1);
+  if (gethostname (hostnamebuf, MAXHOSTNAMELEN) < 0)
+    snprintf (hostnamebuf, MAXHOSTNAMELEN, "localhost");
+
+  /* shorten hostname if necessary */
+  if ((ptr = strchr (hostnamebuf, '.')))
+    *ptr = '\0';
+
+  if (_sdr_cache_get_cache_directory (pstate,
+				      cache_dir,
+				      sdrcachebuf,
+				      MAXPATHLEN) < 0)
+    return (-1);
+
+  if ((ret = snprintf (buf,
+		       buflen,
+		       "%s/%s-%s.%s",
+		       sdrcachebuf,
+		       prefix,
+		       hostnamebuf,
+		       hostname ? hostname : "localhost")) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      return (-1);
+    }
+
+  if (ret >= buflen)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      return (-1);
+    }
+
+  return (0);
+}
+
 static int
 _sdr_cache_get_cache_filename (pstdout_state_t pstate,
 			       const char *hostname,
@@ -312,7 +377,6 @@ _sdr_cache_get_cache_filename (pstdout_state_t pstate,
 			       unsigned int buflen)
 {
   char sdrcachebuf[MAXPATHLEN+1];
-  char *ptr;
   int ret;
 
   assert (common_args);
@@ -321,42 +385,13 @@ _sdr_cache_get_cache_filename (pstdout_state_t pstate,
 
   if (!common_args->sdr_cache_file)
     {
-      char hostnamebuf[MAXHOSTNAMELEN+1];
-
-      memset (hostnamebuf, '\0', MAXHOSTNAMELEN+1);
-      if (gethostname (hostnamebuf, MAXHOSTNAMELEN) < 0)
-	snprintf (hostnamebuf, MAXHOSTNAMELEN, "localhost");
-
-      /* shorten hostname if necessary */
-      if ((ptr = strchr (hostnamebuf, '.')))
-	*ptr = '\0';
-      
-      if (_sdr_cache_get_cache_directory (pstate,
-					  common_args->sdr_cache_directory,
-					  sdrcachebuf,
-					  MAXPATHLEN) < 0)
+      if (_sdr_cache_get_host_filename (pstate,
+					SDR_CACHE_FILENAME_PREFIX,
+					hostname,
+					common_args->sdr_cache_directory,
+					buf,
+					buflen) < 0)
 	return (-1);
-
-      if ((ret = snprintf (buf,
-			   buflen,
-			   "%s/%s-%s.%s",
-			   sdrcachebuf,
-			   SDR_CACHE_FILENAME_PREFIX,
-			   hostnamebuf,
-			   hostname ? hostname : "localhost")) < 0)
-	
-	{
-	  PSTDOUT_PERROR (pstate, "snprintf");
-	  return (-1);
-	}
-
-      if (ret >= buflen)
-	{
-	  PSTDOUT_FPRINTF (pstate,
-			   stderr,
-			   "snprintf invalid bytes written\n");
-	  return (-1);
-	}
     }
   else
     {
@@ -519,32 +554,45 @@ _sdr_cache_create_directory (pstdout_state_t pstate,
 }
 
 int
-_sdr_cache_create (ipmi_sdr_ctx_t ctx,
-		   pstdout_state_t pstate,
-		   ipmi_ctx_t ipmi_ctx,
-		   const char *hostname,
-		   const struct common_cmd_args *common_args)
+sdr_cache_get_host_cache_filename (pstdout_state_t pstate,
+				   const char *prefix,
+				   const char *hostname,
+				   const struct common_cmd_args *common_args,
+				   char *buf,
+				   unsigned int buflen)
+{
+  assert (prefix);
+  assert (common_args);
+  assert (buf);
+  assert (buflen);
+
+  if (_sdr_cache_create_directory (pstate, common_args->sdr_cache_directory) < 0)
+    return (-1);
+
+  return (_sdr_cache_get_host_filename (pstate,
+					prefix,
+					hostname,
+					common_args->sdr_cache_directory,
+					buf,
+					buflen));
+}
+
+static int
+_sdr_cache_create_file (ipmi_sdr_ctx_t ctx,
+			pstdout_state_t pstate,
+			ipmi_ctx_t ipmi_ctx,
+			const char *cachefilename,
+			unsigned int cache_create_flags,
+			const struct common_cmd_args *common_args)
 {
-  char cachefilenamebuf[MAXPATHLEN+1];
   int count = 0;
-  int cache_create_flags = 0;
   int rv = -1;
 
   assert (ctx);
   assert (ipmi_ctx);
+  assert (cachefilename);
   assert (common_args);
 
-  if (_sdr_cache_create_directory (pstate, common_args->sdr_cache_directory) < 0)
-    goto cleanup;
-
-  memset (cachefilenamebuf, '\0', MAXPATHLEN+1);
-  if (_sdr_cache_get_cache_filename (pstate,
-				     hostname,
-				     common_args,
-				     cachefilenamebuf,
-				     MAXPATHLEN) < 0)
-    goto cleanup;
-
   /* pstdout library can't handle \r, its the responsibility of
    * tool code to set quiet_cache if there are multiple
    * hosts are generating the cache at the same time.
@@ -552,19 +600,14 @@ _sdr_cache_create (ipmi_sdr_ctx_t ctx,
   if (!common_args->quiet_cache)
     fprintf (stderr,
              "Caching SDR repository information: %s\n",
-             cachefilenamebuf);
-
-  if (common_args->sdr_cache_recreate)
-    cache_create_flags = IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE;
-  else
-    cache_create_flags = IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT;
+             cachefilename);
 
   if (common_args->workaround_flags_sdr & IPMI_PARSE_WORKAROUND_FLAGS_SDR_ASSUME_MAX_SDR_RECORD_COUNT)
     cache_create_flags |= IPMI_SDR_CACHE_CREATE_FLAGS_ASSUME_MAX_SDR_RECORD_COUNT;
 
   if (ipmi_sdr_cache_create (ctx,
                              ipmi_ctx,
-                             cachefilenamebuf,
+                             cachefilename,
                              cache_create_flags,
                              common_args->quiet_cache ? NULL : _sdr_cache_create_callback,
                              common_args->quiet_cache ? NULL : (void *)&count) < 0)
@@ -586,7 +629,632 @@ _sdr_cache_create (ipmi_sdr_ctx_t ctx,
   rv = 0;
  cleanup:
   if (rv < 0)
-    ipmi_sdr_cache_delete (ctx, cachefilenamebuf);
+    ipmi_sdr_cache_delete (ctx, cachefilename);
+  return (rv);
+}
+
+int
+_sdr_cache_create (ipmi_sdr_ctx_t ctx,
+		   pstdout_state_t pstate,
+		   ipmi_ctx_t ipmi_ctx,
+		   const char *hostname,
+		   int incremental,
+		   const struct common_cmd_args *common_args)
+{
+  char cachefilenamebuf[MAXPATHLEN+1];
+  unsigned int cache_create_flags = IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT;
+  struct stat buf;
+
+  assert (ctx);
+  assert (ipmi_ctx);
+  assert (common_args);
+
+  if (_sdr_cache_create_directory (pstate, common_args->sdr_cache_directory) < 0)
+    return (-1);
+
+  memset (cachefilenamebuf, '\0', MAXPATHLEN+1);
+  if (_sdr_cache_get_cache_filename (pstate,
+				     hostname,
+				     common_args,
+				     cachefilenamebuf,
+				     MAXPATHLEN) < 0)
+    return (-1);
+
+  /* Cache may be a link into the shared cache directory from an
+   * earlier --shared-sdr-cache run (possibly dangling if the shared
+   * cache was flushed), don't overwrite the shared cache through it.
+   */
+  if (!lstat (cachefilenamebuf, &buf) && S_ISLNK (buf.st_mode))
+    {
+      /* ignore potential error, create will report it */
+      unlink (cachefilenamebuf);
+    }
+
+  /* An out of date cache is updated in place, only records that
+   * changed are read from the BMC.  An explicit recreate re-reads
+   * every record.
+   */
+  if (incremental)
+    cache_create_flags = (IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE
+			  | IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL);
+  else if (common_args->sdr_cache_recreate)
+    cache_create_flags = IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE;
+
+  return (_sdr_cache_create_file (ctx,
+				  pstate,
+				  ipmi_ctx,
+				  cachefilenamebuf,
+				  cache_create_flags,
+				  common_args));
+}
+
+/* achu: Shared SDR caches are stored by content under the shared
+ * sub-directory, keyed by everything that identifies an SDR
+ * repository.  Identical BMC models with identical firmware and SDRs
+ * end up with the same key, so the SDR only has to be downloaded
+ * once.  The normal per-host cache file becomes a symlink into the
+ * shared store.
+ */
+static int
+_sdr_cache_get_shared_key (pstdout_state_t pstate,
+			   ipmi_ctx_t ipmi_ctx,
+			   char *buf,
+			   unsigned int buflen)
+{
+  fiid_obj_t obj_cmd_rs = NULL;
+  uint32_t manufacturer_id;
+  uint16_t product_id;
+  uint8_t firmware_major_revision;
+  uint8_t firmware_minor_revision;
+  uint16_t record_count;
+  uint32_t most_recent_addition_timestamp;
+  uint32_t most_recent_erase_timestamp;
+  uint64_t val;
+  int ret;
+  int rv = -1;
+
+  assert (ipmi_ctx);
+  assert (buf);
+  assert (buflen);
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_device_id_rs)))
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_device_id (ipmi_ctx, obj_cmd_rs) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "ipmi_cmd_get_device_id: %s\n",
+                       ipmi_ctx_errormsg (ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "manufacturer_id.id", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'manufacturer_id.id': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  manufacturer_id = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "product_id", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'product_id': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  product_id = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "firmware_revision1.major_revision", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'firmware_revision1.major_revision': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  firmware_major_revision = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "firmware_revision2.minor_revision", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'firmware_revision2.minor_revision': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  firmware_minor_revision = val;
+
+  fiid_obj_destroy (obj_cmd_rs);
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sdr_repository_info_rs)))
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_sdr_repository_info (ipmi_ctx, obj_cmd_rs) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "ipmi_cmd_get_sdr_repository_info: %s\n",
+                       ipmi_ctx_errormsg (ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "record_count", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'record_count': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  record_count = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_addition_timestamp", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_addition_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  most_recent_addition_timestamp = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_erase_timestamp", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_erase_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  most_recent_erase_timestamp = val;
+
+  if ((ret = snprintf (buf,
+                       buflen,
+                       "%05X-%04X-%02X.%02X-%08X-%08X-%04X",
+                       manufacturer_id,
+                       product_id,
+                       firmware_major_revision,
+                       firmware_minor_revision,
+                       most_recent_addition_timestamp,
+                       most_recent_erase_timestamp,
+                       record_count)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      goto cleanup;
+    }
+
+  if (ret >= buflen)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "snprintf invalid bytes written\n");
+      goto cleanup;
+    }
+
+  rv = 0;
+ cleanup:
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
+static int
+_sdr_cache_get_shared_filename (pstdout_state_t pstate,
+				const char *key,
+				const struct common_cmd_args *common_args,
+				char *buf,
+				unsigned int buflen)
+{
+  char sdrcachebuf[MAXPATHLEN+1];
+  int ret;
+
+  assert (key);
+  assert (common_args);
+  assert (buf);
+  assert (buflen);
+
+  if (_sdr_cache_get_cache_directory (pstate,
+				      common_args->sdr_cache_directory,
+				      sdrcachebuf,
+				      MAXPATHLEN) < 0)
+    return (-1);
+
+  if ((ret = snprintf (buf,
+		       buflen,
+		       "%s/%s/%s-%s",
+		       sdrcachebuf,
+		       SDR_CACHE_SHARED_DIR,
+		       SDR_CACHE_FILENAME_PREFIX,
+		       key)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      return (-1);
+    }
+
+  if (ret >= buflen)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      return (-1);
+    }
+
+  return (0);
+}
+
+static int
+_sdr_cache_create_shared_directory (pstdout_state_t pstate,
+				    const char *cache_dir)
+{
+  char cachedirectorybuf[MAXPATHLEN+1];
+  char shareddirectorybuf[MAXPATHLEN+1];
+  int ret;
+
+  if (_sdr_cache_create_directory (pstate, cache_dir) < 0)
+    return (-1);
+
+  if (_sdr_cache_get_cache_directory (pstate,
+				      cache_dir,
+				      cachedirectorybuf,
+				      MAXPATHLEN) < 0)
+    return (-1);
+
+  if ((ret = snprintf (shareddirectorybuf,
+		       MAXPATHLEN,
+		       "%s/%s",
+		       cachedirectorybuf,
+		       SDR_CACHE_SHARED_DIR)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      return (-1);
+    }
+
+  if (ret >= MAXPATHLEN)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      return (-1);
+    }
+
+  errno = 0;
+  ret = mkdir (shareddirectorybuf, FREEIPMI_CONFIG_DIRECTORY_MODE);
+  if (ret < 0 && errno != EEXIST)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "Cannot make cache directory: %s: %s\n",
+                       shareddirectorybuf,
+                       strerror (errno));
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* Point the per-host cache file at the shared cache.  The symlink is
+ * relative so the cache directory can be moved around.
+ */
+static int
+_sdr_cache_link_shared (pstdout_state_t pstate,
+			const char *cachefilename,
+			const char *key)
+{
+  char linkbuf[MAXPATHLEN+1];
+  char currentlinkbuf[MAXPATHLEN+1];
+  char tmpfilenamebuf[MAXPATHLEN+1];
+  ssize_t len;
+  int ret;
+
+  assert (cachefilename);
+  assert (key);
+
+  if ((ret = snprintf (linkbuf,
+		       MAXPATHLEN,
+		       "%s/%s-%s",
+		       SDR_CACHE_SHARED_DIR,
+		       SDR_CACHE_FILENAME_PREFIX,
+		       key)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      return (-1);
+    }
+
+  if (ret >= MAXPATHLEN)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      return (-1);
+    }
+
+  memset (currentlinkbuf, '\0', MAXPATHLEN+1);
+  if ((len = readlink (cachefilename, currentlinkbuf, MAXPATHLEN)) > 0
+      && !strcmp (currentlinkbuf, linkbuf))
+    return (0);
+
+  /* symlink, then rename over the old file, so concurrent readers
+   * never see a missing cache file
+   */
+  if ((ret = snprintf (tmpfilenamebuf,
+		       MAXPATHLEN,
+		       "%s.%u.tmp",
+		       cachefilename,
+		       (unsigned int)getpid ())) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      return (-1);
+    }
+
+  if (ret >= MAXPATHLEN)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      return (-1);
+    }
+
+  /* ignore potential error, may not exist */
+  unlink (tmpfilenamebuf);
+
+  if (symlink (linkbuf, tmpfilenamebuf) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "Cannot link cache file: %s: %s\n",
+		       cachefilename,
+		       strerror (errno));
+      return (-1);
+    }
+
+  if (rename (tmpfilenamebuf, cachefilename) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "Cannot link cache file: %s: %s\n",
+		       cachefilename,
+		       strerror (errno));
+      /* ignore potential error, cleanup path */
+      unlink (tmpfilenamebuf);
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* Only one process/thread downloads a given shared cache, everyone
+ * else waits for the lock and then finds the cache.  The kernel drops
+ * the lock when the holder exits or is killed, so an interrupted
+ * download never leaves a stale lock behind.  flock() locks belong to
+ * the open file, so threads of one process exclude each other too.
+ * Returns the locked fd, closing it releases the lock.
+ */
+static int
+_sdr_cache_shared_lock (pstdout_state_t pstate,
+			const char *lockfilename)
+{
+  int fd;
+
+  assert (lockfilename);
+
+  if ((fd = open (lockfilename, O_CREAT | O_WRONLY, 0600)) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "Cannot create cache lock: %s: %s\n",
+		       lockfilename,
+		       strerror (errno));
+      return (-1);
+    }
+
+#if HAVE_FLOCK
+  while (flock (fd, LOCK_EX) < 0)
+#else /* !HAVE_FLOCK */
+  while (fd_get_writew_lock (fd) < 0)
+#endif /* !HAVE_FLOCK */
+    {
+      if (errno == EINTR)
+	continue;
+
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "Cannot lock cache: %s: %s\n",
+		       lockfilename,
+		       strerror (errno));
+      /* ignore potential error, cleanup path */
+      close (fd);
+      return (-1);
+    }
+
+  return (fd);
+}
+
+static int
+_sdr_cache_create_and_load_shared (ipmi_sdr_ctx_t sdr_ctx,
+				   pstdout_state_t pstate,
+				   ipmi_ctx_t ipmi_ctx,
+				   const char *hostname,
+				   const struct common_cmd_args *common_args)
+{
+  char key[SDR_CACHE_SHARED_KEY_LEN+1];
+  char cachefilenamebuf[MAXPATHLEN+1];
+  char sharedfilenamebuf[MAXPATHLEN+1];
+  char lockfilenamebuf[MAXPATHLEN+1];
+  char tmpfilenamebuf[MAXPATHLEN+1];
+  int lockfd = -1;
+  int created = 0;
+  int ret;
+  int rv = -1;
+
+  assert (sdr_ctx);
+  assert (ipmi_ctx);
+  assert (common_args);
+  assert (!common_args->sdr_cache_file);
+
+  memset (cachefilenamebuf, '\0', MAXPATHLEN+1);
+  if (_sdr_cache_get_cache_filename (pstate,
+				     hostname,
+				     common_args,
+				     cachefilenamebuf,
+				     MAXPATHLEN) < 0)
+    goto cleanup;
+
+  /* The open checks the SDR repository timestamps, so a host already
+   * linked to an up to date shared cache needs no more round trips.
+   * Only look up the shared key if the link is missing or stale.
+   */
+  if (!ipmi_sdr_cache_open (sdr_ctx, ipmi_ctx, cachefilenamebuf))
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  memset (key, '\0', SDR_CACHE_SHARED_KEY_LEN+1);
+  if (_sdr_cache_get_shared_key (pstate,
+				 ipmi_ctx,
+				 key,
+				 SDR_CACHE_SHARED_KEY_LEN) < 0)
+    goto cleanup;
+
+  if (_sdr_cache_create_shared_directory (pstate, common_args->sdr_cache_directory) < 0)
+    goto cleanup;
+
+  memset (sharedfilenamebuf, '\0', MAXPATHLEN+1);
+  if (_sdr_cache_get_shared_filename (pstate,
+				      key,
+				      common_args,
+				      sharedfilenamebuf,
+				      MAXPATHLEN) < 0)
+    goto cleanup;
+
+  if ((ret = snprintf (lockfilenamebuf,
+		       MAXPATHLEN,
+		       "%s.lock",
+		       sharedfilenamebuf)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      goto cleanup;
+    }
+
+  if (ret >= MAXPATHLEN)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      goto cleanup;
+    }
+
+  if ((ret = snprintf (tmpfilenamebuf,
+		       MAXPATHLEN,
+		       "%s.tmp",
+		       sharedfilenamebuf)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      goto cleanup;
+    }
+
+  if (ret >= MAXPATHLEN)
+    {
+      PSTDOUT_FPRINTF (pstate,
+		       stderr,
+		       "snprintf invalid bytes written\n");
+      goto cleanup;
+    }
+
+  while (1)
+    {
+      /* The key contains the SDR timestamps, so the open should only
+       * find the cache out of date if the SDR changed after the key
+       * was read.
+       */
+      if (!ipmi_sdr_cache_open (sdr_ctx, ipmi_ctx, sharedfilenamebuf))
+	break;
+
+      /* if we just created it, don't try again */
+      if (created
+	  || (ipmi_sdr_ctx_errnum (sdr_ctx) != IPMI_SDR_ERR_CACHE_READ_CACHE_DOES_NOT_EXIST
+	      && !((ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
+		    || ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+		   && common_args->sdr_cache_recreate)))
+	{
+	  if (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID)
+	    PSTDOUT_FPRINTF (pstate,
+			     stderr,
+			     "SDR Cache '%s' invalid: Please flush the cache and regenerate it\n",
+			     sharedfilenamebuf);
+	  else if (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+	    PSTDOUT_FPRINTF (pstate,
+			     stderr,
+			     "SDR Cache '%s' out of date: Please flush the cache and regenerate it\n",
+			     sharedfilenamebuf);
+	  else
+	    PSTDOUT_FPRINTF (pstate,
+			     stderr,
+			     "ipmi_sdr_cache_open: %s: %s\n",
+			     sharedfilenamebuf,
+			     ipmi_sdr_ctx_errormsg (sdr_ctx));
+	  goto cleanup;
+	}
+
+      if (lockfd < 0)
+	{
+	  if ((lockfd = _sdr_cache_shared_lock (pstate, lockfilenamebuf)) < 0)
+	    goto cleanup;
+
+	  /* someone else may have created it while we waited */
+	  continue;
+	}
+
+      /* cache is written under a temporary name and renamed into
+       * place, so other readers never see a partial cache
+       */
+      if (_sdr_cache_create_file (sdr_ctx,
+				  pstate,
+				  ipmi_ctx,
+				  tmpfilenamebuf,
+				  IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE,
+				  common_args) < 0)
+	goto cleanup;
+
+      if (rename (tmpfilenamebuf, sharedfilenamebuf) < 0)
+	{
+	  PSTDOUT_FPRINTF (pstate,
+			   stderr,
+			   "Cannot rename cache file: %s: %s\n",
+			   sharedfilenamebuf,
+			   strerror (errno));
+	  /* ignore potential error, cleanup path */
+	  unlink (tmpfilenamebuf);
+	  goto cleanup;
+	}
+
+      created++;
+    }
+
+  if (_sdr_cache_link_shared (pstate, cachefilenamebuf, key) < 0)
+    goto cleanup;
+
+  rv = 0;
+ cleanup:
+  /* ignore potential error, closing releases the lock */
+  if (lockfd >= 0)
+    close (lockfd);
   return (rv);
 }
 
@@ -613,13 +1281,24 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
 
   /* If user specifies cache file, don't check timestamps, just load it */
 
-  if (ipmi_sdr_cache_open (sdr_ctx,
+  if (common_args->shared_sdr_cache
+      && !common_args->sdr_cache_file
+      && ipmi_ctx)
+    {
+      if (_sdr_cache_create_and_load_shared (sdr_ctx,
+					     pstate,
+					     ipmi_ctx,
+					     hostname,
+					     common_args) < 0)
+	goto cleanup;
+    }
+  else if (ipmi_sdr_cache_open (sdr_ctx,
                            common_args->sdr_cache_file ? NULL : ipmi_ctx,
                            cachefilenamebuf) < 0)
     {
       if (ipmi_sdr_ctx_errnum (sdr_ctx) != IPMI_SDR_ERR_CACHE_READ_CACHE_DOES_NOT_EXIST
-          && !((ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
-                || ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+          && ipmi_sdr_ctx_errnum (sdr_ctx) != IPMI_SDR_ERR_CACHE_OUT_OF_DATE
+          && !(ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
                && common_args->sdr_cache_recreate))
         {
           if (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID)
@@ -630,15 +1309,6 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
                                cachefilenamebuf);
               goto cleanup;
             }
-          else if (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
-            {
-              PSTDOUT_FPRINTF (pstate,
-                               stderr,
-                               "SDR Cache '%s' out of date: Please flush the cache and regenerate it\n",
-                               cachefilenamebuf);
-              goto cleanup;
-
-            }
           else
             {
               PSTDOUT_FPRINTF (pstate,
@@ -652,14 +1322,17 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
     }
 
   if (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_READ_CACHE_DOES_NOT_EXIST
-      || ((ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
-           || ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+      || ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE
+      || (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
           && common_args->sdr_cache_recreate))
     {
+      /* out of date caches are updated without a flush */
       if (_sdr_cache_create (sdr_ctx,
 			     pstate,
 			     ipmi_ctx,
 			     hostname,
+			     (ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE
+			      && !common_args->sdr_cache_recreate),
 			     common_args) < 0)
         goto cleanup;
 
@@ -728,6 +1401,9 @@ sdr_cache_flush_cache (pstdout_state_t pstate,
       goto cleanup;
     }
 
+  /* If this host links to a shared cache, only the link is removed,
+   * other hosts may still be using the shared cache.
+   */
   if (ipmi_sdr_cache_delete (ctx, cachefilenamebuf) < 0)
     {
       PSTDOUT_FPRINTF (pstate,
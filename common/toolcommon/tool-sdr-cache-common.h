@@ -37,6 +37,17 @@ int sdr_cache_flush_cache (pstdout_state_t pstate,
                            const char *hostname,
 			   const struct common_cmd_args *common_args);
 
+/* filename of another per host cache, kept in the SDR cache
+ * directory and named like the SDR cache with prefix in place of
+ * "sdr-cache".  Creates the directory if necessary.
+ */
+int sdr_cache_get_host_cache_filename (pstdout_state_t pstate,
+				       const char *prefix,
+				       const char *hostname,
+				       const struct common_cmd_args *common_args,
+				       char *buf,
+				       unsigned int buflen);
+
 /* wrapper for ipmi_sdr_cache_search_sensor, handles some additional special workarounds */
 int ipmi_sdr_cache_search_sensor_wrapper (ipmi_sdr_ctx_t sdr_ctx,
 					  uint8_t sensor_number,
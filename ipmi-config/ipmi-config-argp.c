@@ -67,6 +67,7 @@ static struct argp_option cmdline_options[] = {
   ARGP_COMMON_OPTIONS_DRIVER,
   ARGP_COMMON_OPTIONS_INBAND,
   ARGP_COMMON_OPTIONS_OUTOFBAND_HOSTRANGED,
+  ARGP_COMMON_OPTIONS_PIPELINE_WINDOW,
   ARGP_COMMON_OPTIONS_AUTHENTICATION_TYPE,
   ARGP_COMMON_OPTIONS_CIPHER_SUITE_ID,
   ARGP_COMMON_OPTIONS_PRIVILEGE_LEVEL,
@@ -582,7 +583,7 @@ _ipmi_config_config_file_parse (struct ipmi_config_arguments *cmd_args)
   if (config_file_parse (cmd_args->common_args.config_file,
                          0,
                          &(cmd_args->common_args),
-                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_HOSTRANGE,
+                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_PIPELINE | CONFIG_FILE_HOSTRANGE,
                          CONFIG_FILE_TOOL_IPMI_CONFIG,
                          &config_file_data) < 0)
     {
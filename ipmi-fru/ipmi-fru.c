@@ -1056,10 +1056,10 @@ _ipmi_fru (pstdout_state_t pstate,
   state_data.pstate = pstate;
   state_data.hostname = (char *)hostname;
 
-  if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
-					 hostname,
-					 &(prog_data->args->common_args),
-					 state_data.pstate)))
+  if (!(state_data.ipmi_ctx = ipmi_open_cached (prog_data->progname,
+                                                hostname,
+                                                &(prog_data->args->common_args),
+                                                state_data.pstate)))
     goto cleanup;
 
   if (!(state_data.fru_ctx = ipmi_fru_ctx_create (state_data.ipmi_ctx)))
@@ -1097,7 +1097,7 @@ _ipmi_fru (pstdout_state_t pstate,
 	}
     }
 
-  if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create ()))
+  if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create_cached (pstate)))
     {
       pstdout_perror (pstate, "ipmi_sdr_ctx_create()");
       goto cleanup;
@@ -1109,9 +1109,8 @@ _ipmi_fru (pstdout_state_t pstate,
   exit_code = EXIT_SUCCESS;
  cleanup:
   ipmi_fru_ctx_destroy (state_data.fru_ctx);
-  ipmi_sdr_ctx_destroy (state_data.sdr_ctx);
-  ipmi_ctx_close (state_data.ipmi_ctx);
-  ipmi_ctx_destroy (state_data.ipmi_ctx);
+  ipmi_sdr_ctx_destroy_cached (state_data.sdr_ctx, pstate);
+  ipmi_close_cached (state_data.ipmi_ctx, pstate);
   return (exit_code);
 }
 
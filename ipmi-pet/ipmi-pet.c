@@ -2185,7 +2185,8 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
 
       if (event_load_event_state_config_file (NULL,
 					      state_data.interpret_ctx,
-					      prog_data->args->event_state_config_file) < 0)
+					      prog_data->args->event_state_config_file,
+					      NULL) < 0)
 	goto cleanup;
 
       if (prog_data->args->interpret_oem_data)
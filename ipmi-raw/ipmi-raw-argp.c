@@ -75,6 +75,8 @@ static struct argp_option cmdline_options[] =
       "Specify an alternate slave address to bridge raw commands to.", 41},
     { "file", CMD_FILE_KEY, "CMD-FILE", 0,
       "Specify a file to read command requests from.", 42},
+    { "multiplex", MULTIPLEX_KEY, 0, 0,
+      "Send the command to all hosts from a single thread.", 43},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -120,6 +122,9 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
           exit (EXIT_FAILURE);
         }
       break;
+    case MULTIPLEX_KEY:
+      cmd_args->multiplex = 1;
+      break;
     case ARGP_KEY_ARG:
       {
         unsigned int i;
@@ -198,6 +203,47 @@ _ipmi_raw_config_file_parse (struct ipmi_raw_arguments *cmd_args)
     }
 }
 
+static void
+_ipmi_raw_args_validate (struct ipmi_raw_arguments *cmd_args)
+{
+  assert (cmd_args);
+
+  if (cmd_args->multiplex)
+    {
+      if (!cmd_args->common_args.hostname)
+        {
+          fprintf (stderr, "hostname input required for multiplex\n");
+          exit (EXIT_FAILURE);
+        }
+
+      if (cmd_args->cmd_file || !cmd_args->cmd_length)
+        {
+          fprintf (stderr, "multiplex requires command hex bytes on the command line\n");
+          exit (EXIT_FAILURE);
+        }
+
+      if (cmd_args->common_args.target_channel_number_is_set
+          || cmd_args->common_args.target_slave_address_is_set)
+        {
+          fprintf (stderr, "multiplex cannot bridge commands\n");
+          exit (EXIT_FAILURE);
+        }
+
+      if (cmd_args->common_args.buffer_output
+          || cmd_args->common_args.consolidate_output)
+        {
+          fprintf (stderr, "multiplex cannot buffer or consolidate output\n");
+          exit (EXIT_FAILURE);
+        }
+
+      if (cmd_args->common_args.debug)
+        {
+          fprintf (stderr, "multiplex does not support debugging\n");
+          exit (EXIT_FAILURE);
+        }
+    }
+}
+
 void
 ipmi_raw_argp_parse (int argc, char **argv, struct ipmi_raw_arguments *cmd_args)
 {
@@ -208,6 +254,7 @@ ipmi_raw_argp_parse (int argc, char **argv, struct ipmi_raw_arguments *cmd_args)
   init_common_cmd_args_admin (&(cmd_args->common_args));
 
   cmd_args->cmd_file = NULL;
+  cmd_args->multiplex = 0;
   memset (cmd_args->cmd, '\0', sizeof (uint8_t) * IPMI_RAW_MAX_ARGS);
   cmd_args->cmd_length = 0;
 
@@ -228,4 +275,5 @@ ipmi_raw_argp_parse (int argc, char **argv, struct ipmi_raw_arguments *cmd_args)
               cmd_args);
 
   verify_common_cmd_args (&(cmd_args->common_args));
+  _ipmi_raw_args_validate (cmd_args);
 }
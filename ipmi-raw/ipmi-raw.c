@@ -37,6 +37,8 @@
 #include "ipmi-raw-argp.h"
 
 #include "freeipmi-portability.h"
+#include "hostlist.h"
+#include "parse-common.h"
 #include "pstdout.h"
 #include "tool-common.h"
 #include "tool-cmdline-common.h"
@@ -417,6 +419,350 @@ _ipmi_raw (pstdout_state_t pstate,
   return (exit_code);
 }
 
+/* --multiplex, all hosts are sent the command through one
+ * ipmi_mux_ctx_t from this thread instead of through one pstdout
+ * thread and ipmi_ctx_t per host.
+ */
+
+struct ipmi_raw_multiplex_host
+{
+  ipmi_raw_prog_data_t *prog_data;
+  char *hostname;
+  int prefix;
+  ipmi_mux_session_t session;
+  fiid_obj_t obj_cmd_rq;
+  fiid_obj_t obj_cmd_rs;
+  int exit_code;
+};
+
+static fiid_template_t tmpl_ipmi_raw_multiplex_rq =
+  {
+    { 8, "cmd", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED},
+    { 8192, "data", FIID_FIELD_OPTIONAL | FIID_FIELD_LENGTH_VARIABLE},
+    { 0, "", 0}
+  };
+
+static fiid_template_t tmpl_ipmi_raw_multiplex_rs =
+  {
+    { 8, "cmd", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED | FIID_FIELD_MAKES_PACKET_SUFFICIENT},
+    { 8, "comp_code", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED | FIID_FIELD_MAKES_PACKET_SUFFICIENT},
+    { 8192, "data", FIID_FIELD_OPTIONAL | FIID_FIELD_LENGTH_VARIABLE},
+    { 0, "", 0}
+  };
+
+static void
+_ipmi_raw_multiplex_error (struct ipmi_raw_multiplex_host *host,
+                           const char *func,
+                           int errnum)
+{
+  assert (host);
+  assert (func);
+
+  if (host->prefix)
+    fprintf (stderr, "%s: ", host->hostname);
+
+  /* same as ipmi_open() */
+  if (errnum == IPMI_ERR_USERNAME_INVALID
+      || errnum == IPMI_ERR_PASSWORD_INVALID
+      || errnum == IPMI_ERR_K_G_INVALID
+      || errnum == IPMI_ERR_PRIVILEGE_LEVEL_INSUFFICIENT
+      || errnum == IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED
+      || errnum == IPMI_ERR_AUTHENTICATION_TYPE_UNAVAILABLE
+      || errnum == IPMI_ERR_CIPHER_SUITE_ID_UNAVAILABLE
+      || errnum == IPMI_ERR_PASSWORD_VERIFICATION_TIMEOUT
+      || errnum == IPMI_ERR_HOSTNAME_INVALID
+      || errnum == IPMI_ERR_IPMI_2_0_UNAVAILABLE
+      || errnum == IPMI_ERR_CONNECTION_TIMEOUT)
+    fprintf (stderr,
+             "%s: %s\n",
+             host->prog_data->progname,
+             ipmi_mux_ctx_strerror (errnum));
+  else
+    fprintf (stderr,
+             "%s: %s\n",
+             func,
+             ipmi_mux_ctx_strerror (errnum));
+}
+
+static void
+_ipmi_raw_multiplex_done (struct ipmi_raw_multiplex_host *host)
+{
+  assert (host);
+
+  ipmi_mux_session_destroy (host->session);
+  host->session = NULL;
+}
+
+static void
+_ipmi_raw_multiplex_close_callback (ipmi_mux_session_t session,
+                                    int errnum,
+                                    void *callback_data)
+{
+  /* ignore potential error, like ipmi_ctx_close() */
+  _ipmi_raw_multiplex_done ((struct ipmi_raw_multiplex_host *)callback_data);
+}
+
+static void
+_ipmi_raw_multiplex_open_callback (ipmi_mux_session_t session,
+                                   int errnum,
+                                   void *callback_data)
+{
+  struct ipmi_raw_multiplex_host *host;
+
+  assert (callback_data);
+
+  host = (struct ipmi_raw_multiplex_host *)callback_data;
+
+  /* on success the queued command is sent next */
+  if (errnum != IPMI_ERR_SUCCESS)
+    {
+      _ipmi_raw_multiplex_error (host, "ipmi_mux_session_open", errnum);
+      /* queued command callback not called after destroy */
+      _ipmi_raw_multiplex_done (host);
+    }
+}
+
+static void
+_ipmi_raw_multiplex_cmd_callback (ipmi_mux_session_t session,
+                                  int errnum,
+                                  void *callback_data)
+{
+  struct ipmi_raw_multiplex_host *host;
+  uint8_t bytes_rs[IPMI_RAW_MAX_ARGS];
+  int rs_len;
+  int i;
+
+  assert (callback_data);
+
+  host = (struct ipmi_raw_multiplex_host *)callback_data;
+
+  if (errnum != IPMI_ERR_SUCCESS)
+    {
+      _ipmi_raw_multiplex_error (host, "ipmi_mux_cmd", errnum);
+      _ipmi_raw_multiplex_done (host);
+      return;
+    }
+
+  if ((rs_len = fiid_obj_get_all (host->obj_cmd_rs,
+                                  bytes_rs,
+                                  IPMI_RAW_MAX_ARGS)) < 0)
+    {
+      if (host->prefix)
+        fprintf (stderr, "%s: ", host->hostname);
+      fprintf (stderr,
+               "fiid_obj_get_all: %s\n",
+               fiid_obj_errormsg (host->obj_cmd_rs));
+      _ipmi_raw_multiplex_done (host);
+      return;
+    }
+
+  if (host->prefix)
+    printf ("%s: ", host->hostname);
+  printf ("rcvd: ");
+  for (i = 0; i < rs_len; i++)
+    printf ("%02X ", bytes_rs[i]);
+  printf ("\n");
+
+  host->exit_code = EXIT_SUCCESS;
+
+  if (ipmi_mux_session_close (session,
+                              _ipmi_raw_multiplex_close_callback,
+                              host) < 0)
+    _ipmi_raw_multiplex_done (host);
+}
+
+static int
+ipmi_raw_multiplex (ipmi_raw_prog_data_t *prog_data, int hosts_count)
+{
+  struct ipmi_raw_arguments *args;
+  struct ipmi_raw_multiplex_host *hosts = NULL;
+  unsigned int hosts_len = 0;
+  ipmi_mux_ctx_t mux_ctx = NULL;
+  hostlist_t hl = NULL;
+  hostlist_iterator_t itr = NULL;
+  unsigned int workaround_flags = 0;
+  uint8_t *bytes_rq;
+  unsigned int send_len;
+  char *hostname;
+  unsigned int i;
+  int exit_code = EXIT_FAILURE;
+  int ret;
+
+  assert (prog_data);
+  assert (prog_data->args->common_args.hostname);
+  assert (prog_data->args->cmd_length);
+
+  args = prog_data->args;
+
+  bytes_rq = args->cmd;
+  send_len = args->cmd_length;
+
+  if (send_len <= 2)
+    {
+      fprintf (stderr, "Invalid number of hex bytes\n");
+      goto cleanup;
+    }
+
+  if (!IPMI_NET_FN_RQ_VALID (bytes_rq[1]))
+    {
+      fprintf (stderr, "Invalid netfn value\n");
+      goto cleanup;
+    }
+
+  if (args->common_args.driver_type == IPMI_DEVICE_LAN_2_0)
+    parse_get_freeipmi_outofband_2_0_flags (args->common_args.workaround_flags_outofband_2_0,
+                                            &workaround_flags);
+  else
+    parse_get_freeipmi_outofband_flags (args->common_args.workaround_flags_outofband,
+                                        &workaround_flags);
+
+  if (!(mux_ctx = ipmi_mux_ctx_create ()))
+    {
+      perror ("ipmi_mux_ctx_create");
+      goto cleanup;
+    }
+
+  if (!(hl = hostlist_create (args->common_args.hostname)))
+    {
+      perror ("hostlist_create");
+      goto cleanup;
+    }
+
+  if (!(hosts = (struct ipmi_raw_multiplex_host *)calloc (hostlist_count (hl),
+                                                           sizeof (struct ipmi_raw_multiplex_host))))
+    {
+      perror ("calloc");
+      goto cleanup;
+    }
+
+  if (!(itr = hostlist_iterator_create (hl)))
+    {
+      perror ("hostlist_iterator_create");
+      goto cleanup;
+    }
+
+  while ((hostname = hostlist_next (itr)))
+    {
+      struct ipmi_raw_multiplex_host *host = &hosts[hosts_len++];
+
+      host->prog_data = prog_data;
+      host->hostname = hostname;
+      host->prefix = (hosts_count > 1 || args->common_args.always_prefix);
+      host->exit_code = EXIT_FAILURE;
+
+      if (!(host->obj_cmd_rq = fiid_obj_create (tmpl_ipmi_raw_multiplex_rq))
+          || !(host->obj_cmd_rs = fiid_obj_create (tmpl_ipmi_raw_multiplex_rs)))
+        {
+          perror ("fiid_obj_create");
+          goto cleanup;
+        }
+
+      if (fiid_obj_set (host->obj_cmd_rq, "cmd", bytes_rq[2]) < 0
+          || (send_len > 3
+              && fiid_obj_set_data (host->obj_cmd_rq,
+                                    "data",
+                                    &bytes_rq[3],
+                                    send_len - 3) < 0))
+        {
+          fprintf (stderr,
+                   "fiid_obj_set: %s\n",
+                   fiid_obj_errormsg (host->obj_cmd_rq));
+          goto cleanup;
+        }
+
+      /* the command is held until the session is established */
+      if (args->common_args.driver_type == IPMI_DEVICE_LAN_2_0)
+        host->session = ipmi_mux_session_open_2_0 (mux_ctx,
+                                                   hostname,
+                                                   args->common_args.username,
+                                                   args->common_args.password,
+                                                   (args->common_args.k_g_len) ? args->common_args.k_g : NULL,
+                                                   (args->common_args.k_g_len) ? args->common_args.k_g_len : 0,
+                                                   args->common_args.privilege_level,
+                                                   args->common_args.cipher_suite_id,
+                                                   args->common_args.session_timeout,
+                                                   args->common_args.retransmission_timeout,
+                                                   workaround_flags,
+                                                   IPMI_FLAGS_DEFAULT,
+                                                   _ipmi_raw_multiplex_open_callback,
+                                                   host);
+      else
+        host->session = ipmi_mux_session_open (mux_ctx,
+                                               hostname,
+                                               args->common_args.username,
+                                               args->common_args.password,
+                                               args->common_args.authentication_type,
+                                               args->common_args.privilege_level,
+                                               args->common_args.session_timeout,
+                                               args->common_args.retransmission_timeout,
+                                               workaround_flags,
+                                               IPMI_FLAGS_DEFAULT,
+                                               _ipmi_raw_multiplex_open_callback,
+                                               host);
+
+      if (!host->session)
+        {
+          _ipmi_raw_multiplex_error (host,
+                                     "ipmi_mux_session_open",
+                                     ipmi_mux_ctx_errnum (mux_ctx));
+          continue;
+        }
+
+      if (ipmi_mux_cmd (host->session,
+                        bytes_rq[0],
+                        bytes_rq[1],
+                        host->obj_cmd_rq,
+                        host->obj_cmd_rs,
+                        _ipmi_raw_multiplex_cmd_callback,
+                        host) < 0)
+        {
+          _ipmi_raw_multiplex_error (host,
+                                     "ipmi_mux_cmd",
+                                     ipmi_mux_ctx_errnum (mux_ctx));
+          _ipmi_raw_multiplex_done (host);
+          continue;
+        }
+    }
+
+  while ((ret = ipmi_mux_process (mux_ctx, -1)) > 0)
+    ;
+
+  if (ret < 0)
+    {
+      fprintf (stderr,
+               "ipmi_mux_process: %s\n",
+               ipmi_mux_ctx_errormsg (mux_ctx));
+      goto cleanup;
+    }
+
+  /* like pstdout_launch(), the highest exit code of all hosts */
+  exit_code = EXIT_SUCCESS;
+  for (i = 0; i < hosts_len; i++)
+    {
+      if (hosts[i].exit_code > exit_code)
+        exit_code = hosts[i].exit_code;
+    }
+
+ cleanup:
+  if (hosts)
+    {
+      for (i = 0; i < hosts_len; i++)
+        {
+          ipmi_mux_session_destroy (hosts[i].session);
+          fiid_obj_destroy (hosts[i].obj_cmd_rq);
+          fiid_obj_destroy (hosts[i].obj_cmd_rs);
+          free (hosts[i].hostname);
+        }
+      free (hosts);
+    }
+  if (itr)
+    hostlist_iterator_destroy (itr);
+  if (hl)
+    hostlist_destroy (hl);
+  ipmi_mux_ctx_destroy (mux_ctx);
+  return (exit_code);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -439,6 +785,9 @@ main (int argc, char **argv)
   if (!hosts_count)
     return (EXIT_SUCCESS);
 
+  if (prog_data.args->multiplex)
+    return (ipmi_raw_multiplex (&prog_data, hosts_count));
+
   if ((rv = pstdout_launch (prog_data.args->common_args.hostname,
                             _ipmi_raw,
                             &prog_data)) < 0)
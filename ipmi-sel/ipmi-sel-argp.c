@@ -72,6 +72,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_OPTIONS_DRIVER,
     ARGP_COMMON_OPTIONS_INBAND,
     ARGP_COMMON_OPTIONS_OUTOFBAND_HOSTRANGED,
+    ARGP_COMMON_OPTIONS_PIPELINE_WINDOW,
     ARGP_COMMON_OPTIONS_AUTHENTICATION_TYPE,
     ARGP_COMMON_OPTIONS_CIPHER_SUITE_ID,
     ARGP_COMMON_OPTIONS_PRIVILEGE_LEVEL,
@@ -149,6 +150,10 @@ static struct argp_option cmdline_options[] =
       "Output non-abbreviated units (e.g. 'Amps' instead of 'A').", 68},
     { "legacy-output", LEGACY_OUTPUT_KEY, 0, 0,
       "Output in legacy format.", 69},
+    { "sel-cache", SEL_CACHE_KEY, 0, 0,
+      "Cache SEL records locally and only read new records from the BMC.", 70},
+    { "event-state-config-cache", EVENT_STATE_CONFIG_CACHE_KEY, "FILE", 0,
+      "Cache the loaded event state configuration in a file and load it from there.", 71},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -633,6 +638,16 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case LEGACY_OUTPUT_KEY:
       cmd_args->legacy_output = 1;
       break;
+    case SEL_CACHE_KEY:
+      cmd_args->sel_cache = 1;
+      break;
+    case EVENT_STATE_CONFIG_CACHE_KEY:
+      if (!(cmd_args->event_state_config_cache_file = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
     case ARGP_KEY_ARG:
       /* Too many arguments. */
       argp_usage (state);
@@ -660,7 +675,7 @@ _ipmi_sel_config_file_parse (struct ipmi_sel_arguments *cmd_args)
   if (config_file_parse (cmd_args->common_args.config_file,
                          0,
                          &(cmd_args->common_args),
-                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_SDR | CONFIG_FILE_TIME | CONFIG_FILE_HOSTRANGE,
+                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_PIPELINE | CONFIG_FILE_SDR | CONFIG_FILE_TIME | CONFIG_FILE_HOSTRANGE,
                          CONFIG_FILE_TOOL_IPMI_SEL,
                          &config_file_data) < 0)
     {
@@ -825,6 +840,8 @@ ipmi_sel_argp_parse (int argc, char **argv, struct ipmi_sel_arguments *cmd_args)
   cmd_args->no_header_output = 0;
   cmd_args->non_abbreviated_units = 0;
   cmd_args->legacy_output = 0;
+  cmd_args->sel_cache = 0;
+  cmd_args->event_state_config_cache_file = NULL;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -0,0 +1,706 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif /* HAVE_FCNTL_H */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/param.h>		/* MAXPATHLEN */
+#include <assert.h>
+#include <errno.h>
+
+#include <freeipmi/freeipmi.h>
+
+#include "ipmi-sel_.h"
+#include "ipmi-sel-cache.h"
+
+#include "freeipmi-portability.h"
+#include "fd.h"
+#include "pstdout.h"
+#include "tool-sdr-cache-common.h"
+
+#ifndef MAXPATHLEN
+#define MAXPATHLEN 4096
+#endif /* MAXPATHLEN */
+
+#define IPMI_SEL_CACHE_FILENAME_PREFIX  "sel-cache"
+
+/*
+ * SEL Cache Format
+ *
+ * All numbers stored little endian
+ *
+ * uint32_t file_magic
+ * uint32_t file_version
+ * uint32_t most_recent_addition_timestamp
+ * uint32_t most_recent_erase_timestamp
+ * uint16_t entries
+ * uint8_t zerosumchecksum - of the header and all records
+ * entries SEL records of IPMI_SEL_RECORD_MAX_RECORD_LENGTH bytes, as
+ * read from the BMC, in SEL order
+ *
+ * The timestamps are those of Get SEL Info before the records were
+ * read.  If the erase timestamp changed, records were deleted and the
+ * cache is rebuilt.  If only the addition timestamp changed, records
+ * were added and only the records after the last cached one are read.
+ */
+
+#define IPMI_SEL_CACHE_FILE_MAGIC       0x5E1CAC4E
+
+#define IPMI_SEL_CACHE_FILE_VERSION     0x00000001
+
+#define IPMI_SEL_CACHE_HEADER_LENGTH    (4 + 4 + 4 + 4 + 2 + 1)
+
+#define IPMI_SEL_CACHE_RECORDS_MIN      64
+
+#define IPMI_SEL_CACHE_RECORDS_MAX      0xFFFF
+
+struct ipmi_sel_cache
+{
+  uint32_t most_recent_addition_timestamp;
+  uint32_t most_recent_erase_timestamp;
+  uint8_t *records;
+  unsigned int records_count;
+  unsigned int records_size;
+};
+
+static unsigned int
+_unmarshall_uint32 (const uint8_t *databuf, uint32_t *value)
+{
+  assert (databuf);
+  assert (value);
+
+  /* stored little endian */
+  (*value) = databuf[0];
+  (*value) |= (databuf[1] << 8);
+  (*value) |= (databuf[2] << 16);
+  (*value) |= ((uint32_t)databuf[3] << 24);
+
+  return (sizeof (uint32_t));
+}
+
+static unsigned int
+_unmarshall_uint16 (const uint8_t *databuf, uint16_t *value)
+{
+  assert (databuf);
+  assert (value);
+
+  /* stored little endian */
+  (*value) = databuf[0];
+  (*value) |= (databuf[1] << 8);
+
+  return (sizeof (uint16_t));
+}
+
+static unsigned int
+_marshall_uint32 (uint8_t *databuf, uint32_t value)
+{
+  assert (databuf);
+
+  /* store little endian */
+  databuf[0] = (value & 0x000000FF);
+  databuf[1] = (value & 0x0000FF00) >> 8;
+  databuf[2] = (value & 0x00FF0000) >> 16;
+  databuf[3] = (value & 0xFF000000) >> 24;
+
+  return (sizeof (uint32_t));
+}
+
+static unsigned int
+_marshall_uint16 (uint8_t *databuf, uint16_t value)
+{
+  assert (databuf);
+
+  /* store little endian */
+  databuf[0] = (value & 0x00FF);
+  databuf[1] = (value & 0xFF00) >> 8;
+
+  return (sizeof (uint16_t));
+}
+
+static uint8_t
+_checksum (const uint8_t *buf, unsigned int len, uint8_t checksum)
+{
+  unsigned int i;
+
+  assert (buf || !len);
+
+  for (i = 0; i < len; i++)
+    checksum += buf[i];
+
+  return (checksum);
+}
+
+static int
+_sel_cache_filename (pstdout_state_t pstate,
+                     const char *hostname,
+                     const struct common_cmd_args *common_args,
+                     char *buf,
+                     unsigned int buflen)
+{
+  return (sdr_cache_get_host_cache_filename (pstate,
+                                             IPMI_SEL_CACHE_FILENAME_PREFIX,
+                                             hostname,
+                                             common_args,
+                                             buf,
+                                             buflen));
+}
+
+static int
+_sel_cache_append (ipmi_sel_state_data_t *state_data,
+                   struct ipmi_sel_cache *cache,
+                   const uint8_t *record)
+{
+  assert (state_data);
+  assert (cache);
+  assert (record);
+
+  if (cache->records_count >= IPMI_SEL_CACHE_RECORDS_MAX)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "SEL cache overflow\n");
+      return (-1);
+    }
+
+  if (cache->records_count == cache->records_size)
+    {
+      unsigned int size;
+      uint8_t *tmp;
+
+      size = cache->records_size ? cache->records_size * 2 : IPMI_SEL_CACHE_RECORDS_MIN;
+
+      if (!(tmp = realloc (cache->records, size * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)))
+        {
+          pstdout_perror (state_data->pstate, "realloc");
+          return (-1);
+        }
+
+      cache->records = tmp;
+      cache->records_size = size;
+    }
+
+  memcpy (cache->records + cache->records_count * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+          record,
+          IPMI_SEL_RECORD_MAX_RECORD_LENGTH);
+  cache->records_count++;
+  return (0);
+}
+
+static void
+_sel_cache_clear (struct ipmi_sel_cache *cache)
+{
+  assert (cache);
+
+  free (cache->records);
+  memset (cache, '\0', sizeof (struct ipmi_sel_cache));
+}
+
+/* returns 1 on cache loaded, 0 if not found or not usable, -1 on error */
+static int
+_sel_cache_read (ipmi_sel_state_data_t *state_data,
+                 const char *filename,
+                 struct ipmi_sel_cache *cache)
+{
+  uint8_t databuf[IPMI_SEL_CACHE_HEADER_LENGTH];
+  unsigned int databuf_offset = 0;
+  uint32_t file_magic;
+  uint32_t file_version;
+  uint16_t entries;
+  struct stat st;
+  int len;
+  int fd = -1;
+  int rv = -1;
+
+  assert (state_data);
+  assert (filename);
+  assert (cache);
+
+  if ((fd = open (filename, O_RDONLY)) < 0)
+    {
+      if (errno == ENOENT)
+        return (0);
+
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "Error opening '%s': %s\n",
+                       filename,
+                       strerror (errno));
+      return (-1);
+    }
+
+  if (fstat (fd, &st) < 0)
+    {
+      pstdout_perror (state_data->pstate, "fstat");
+      goto cleanup;
+    }
+
+  if ((len = fd_read_n (fd, databuf, IPMI_SEL_CACHE_HEADER_LENGTH)) < 0)
+    {
+      pstdout_perror (state_data->pstate, "fd_read_n");
+      goto cleanup;
+    }
+
+  /* a damaged or out of date cache is simply rebuilt */
+  rv = 0;
+
+  if (len < IPMI_SEL_CACHE_HEADER_LENGTH)
+    goto cleanup;
+
+  databuf_offset += _unmarshall_uint32 (databuf + databuf_offset, &file_magic);
+  databuf_offset += _unmarshall_uint32 (databuf + databuf_offset, &file_version);
+
+  if (file_magic != IPMI_SEL_CACHE_FILE_MAGIC
+      || file_version != IPMI_SEL_CACHE_FILE_VERSION)
+    goto cleanup;
+
+  databuf_offset += _unmarshall_uint32 (databuf + databuf_offset, &cache->most_recent_addition_timestamp);
+  databuf_offset += _unmarshall_uint32 (databuf + databuf_offset, &cache->most_recent_erase_timestamp);
+  databuf_offset += _unmarshall_uint16 (databuf + databuf_offset, &entries);
+
+  if (st.st_size != IPMI_SEL_CACHE_HEADER_LENGTH + entries * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)
+    goto cleanup;
+
+  if (entries)
+    {
+      if (!(cache->records = malloc (entries * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)))
+        {
+          pstdout_perror (state_data->pstate, "malloc");
+          rv = -1;
+          goto cleanup;
+        }
+      cache->records_size = entries;
+
+      if ((len = fd_read_n (fd,
+                            cache->records,
+                            entries * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)) < 0)
+        {
+          pstdout_perror (state_data->pstate, "fd_read_n");
+          rv = -1;
+          goto cleanup;
+        }
+
+      if (len != entries * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)
+        goto cleanup;
+    }
+
+  if (_checksum (cache->records,
+                 entries * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                 _checksum (databuf, IPMI_SEL_CACHE_HEADER_LENGTH, 0)))
+    goto cleanup;
+
+  cache->records_count = entries;
+  rv = 1;
+ cleanup:
+  if (rv != 1)
+    _sel_cache_clear (cache);
+  /* ignore potential error, read only */
+  close (fd);
+  return (rv);
+}
+
+static int
+_sel_cache_write (ipmi_sel_state_data_t *state_data,
+                  const char *filename,
+                  struct ipmi_sel_cache *cache)
+{
+  char tmpfilename[MAXPATHLEN+32];
+  uint8_t databuf[IPMI_SEL_CACHE_HEADER_LENGTH];
+  unsigned int databuf_offset = 0;
+  unsigned int records_len;
+  uint8_t checksum;
+  int fd = -1;
+  int rv = -1;
+
+  assert (state_data);
+  assert (filename);
+  assert (cache);
+  assert (cache->records_count <= IPMI_SEL_CACHE_RECORDS_MAX);
+
+  records_len = cache->records_count * IPMI_SEL_RECORD_MAX_RECORD_LENGTH;
+
+  databuf_offset += _marshall_uint32 (databuf + databuf_offset, IPMI_SEL_CACHE_FILE_MAGIC);
+  databuf_offset += _marshall_uint32 (databuf + databuf_offset, IPMI_SEL_CACHE_FILE_VERSION);
+  databuf_offset += _marshall_uint32 (databuf + databuf_offset, cache->most_recent_addition_timestamp);
+  databuf_offset += _marshall_uint32 (databuf + databuf_offset, cache->most_recent_erase_timestamp);
+  databuf_offset += _marshall_uint16 (databuf + databuf_offset, cache->records_count);
+
+  checksum = _checksum (cache->records,
+                        records_len,
+                        _checksum (databuf, databuf_offset, 0));
+  databuf[databuf_offset++] = 0xFF - checksum + 1;
+
+  assert (databuf_offset == IPMI_SEL_CACHE_HEADER_LENGTH);
+
+  /* write aside and rename, a concurrent reader never sees a partial cache */
+  snprintf (tmpfilename, sizeof (tmpfilename), "%s.%u", filename, (unsigned int)getpid ());
+
+  if ((fd = open (tmpfilename, O_CREAT | O_TRUNC | O_WRONLY, 0644)) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "Error opening '%s': %s\n",
+                       tmpfilename,
+                       strerror (errno));
+      return (-1);
+    }
+
+  if (fd_write_n (fd, databuf, databuf_offset) != databuf_offset
+      || (records_len
+          && fd_write_n (fd, cache->records, records_len) != records_len))
+    {
+      pstdout_perror (state_data->pstate, "fd_write_n");
+      goto cleanup;
+    }
+
+  if (close (fd) < 0)
+    {
+      fd = -1;
+      pstdout_perror (state_data->pstate, "close");
+      goto cleanup;
+    }
+  fd = -1;
+
+  if (rename (tmpfilename, filename) < 0)
+    {
+      pstdout_perror (state_data->pstate, "rename");
+      goto cleanup;
+    }
+
+  rv = 0;
+ cleanup:
+  if (rv < 0)
+    {
+      /* ignore potential errors, error path */
+      if (fd >= 0)
+        close (fd);
+      unlink (tmpfilename);
+    }
+  return (rv);
+}
+
+static int
+_get_sel_info (ipmi_sel_state_data_t *state_data,
+               uint16_t *entries,
+               uint32_t *most_recent_addition_timestamp,
+               uint32_t *most_recent_erase_timestamp)
+{
+  fiid_obj_t obj_cmd_rs = NULL;
+  uint64_t val;
+  int rv = -1;
+
+  assert (state_data);
+  assert (entries);
+  assert (most_recent_addition_timestamp);
+  assert (most_recent_erase_timestamp);
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sel_info_rs)))
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_sel_info (state_data->ipmi_ctx, obj_cmd_rs) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_cmd_get_sel_info: %s\n",
+                       ipmi_ctx_errormsg (state_data->ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "entries", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'entries': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*entries) = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_addition_timestamp", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_addition_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*most_recent_addition_timestamp) = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_erase_timestamp", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_erase_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*most_recent_erase_timestamp) = val;
+
+  rv = 0;
+ cleanup:
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
+/* Read records from record_id_start on into the cache, if
+ * record_id_start is not IPMI_SEL_RECORD_ID_FIRST it must be the last
+ * cached record.
+ */
+static int
+_sel_cache_fetch (ipmi_sel_state_data_t *state_data,
+                  struct ipmi_sel_cache *cache,
+                  uint16_t record_id_start)
+{
+  const void *sel_records;
+  int count;
+  int i;
+
+  assert (state_data);
+  assert (cache);
+
+  if (ipmi_sel_parse (state_data->sel_ctx,
+                      record_id_start,
+                      IPMI_SEL_RECORD_ID_LAST,
+                      NULL,
+                      NULL) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_sel_parse: %s\n",
+                       ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+      return (-1);
+    }
+
+  if ((count = ipmi_sel_parse_get_records (state_data->sel_ctx, &sel_records)) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_sel_parse_get_records: %s\n",
+                       ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+      return (-1);
+    }
+
+  /* first record read is the last cached record, not appended again */
+  i = (record_id_start != IPMI_SEL_RECORD_ID_FIRST) ? 1 : 0;
+  for (; i < count; i++)
+    {
+      if (_sel_cache_append (state_data,
+                             cache,
+                             (const uint8_t *)sel_records + i * IPMI_SEL_RECORD_MAX_RECORD_LENGTH) < 0)
+        return (-1);
+    }
+
+  return (0);
+}
+
+/* returns 1 if the cache could be extended, 0 if it has to be rebuilt */
+static int
+_sel_cache_update (ipmi_sel_state_data_t *state_data,
+                   struct ipmi_sel_cache *cache,
+                   uint16_t entries)
+{
+  uint16_t record_id;
+  uint16_t entries_after;
+  uint32_t addition_timestamp, erase_timestamp;
+  int ret;
+
+  assert (state_data);
+  assert (cache);
+  assert (cache->records_count);
+
+  if (ipmi_sel_parse_read_record_id (state_data->sel_ctx,
+                                     cache->records + (cache->records_count - 1) * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                     IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                     &record_id) < 0)
+    return (0);
+
+  /* Parsing from a record id that is gone would walk every possible
+   * record id, so make sure the last cached record is still there.
+   */
+  if ((ret = ipmi_sel_parse_record_ids (state_data->sel_ctx,
+                                        &record_id,
+                                        1,
+                                        NULL,
+                                        NULL)) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_sel_parse_record_ids: %s\n",
+                       ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+      return (-1);
+    }
+
+  if (!ret)
+    return (0);
+
+  if (_sel_cache_fetch (state_data, cache, record_id) < 0)
+    return (-1);
+
+  /* A SEL that overwrites its oldest records when full may not
+   * update the erase timestamp, so make sure nothing went missing
+   * and nothing stale was kept.
+   */
+  if (cache->records_count != entries)
+    {
+      if (_get_sel_info (state_data,
+                         &entries_after,
+                         &addition_timestamp,
+                         &erase_timestamp) < 0)
+        return (-1);
+
+      if (cache->records_count != entries_after
+          || erase_timestamp != cache->most_recent_erase_timestamp)
+        return (0);
+    }
+
+  return (1);
+}
+
+int
+ipmi_sel_cache_load (ipmi_sel_state_data_t *state_data,
+                     uint8_t **sel_records,
+                     unsigned int *sel_records_count)
+{
+  struct ipmi_sel_cache cache;
+  char filename[MAXPATHLEN+1];
+  uint16_t entries;
+  uint32_t addition_timestamp, erase_timestamp;
+  int ret;
+  int rv = -1;
+
+  assert (state_data);
+  assert (sel_records);
+  assert (sel_records_count);
+
+  memset (&cache, '\0', sizeof (struct ipmi_sel_cache));
+  memset (filename, '\0', MAXPATHLEN+1);
+
+  if (_sel_cache_filename (state_data->pstate,
+                           state_data->hostname,
+                           &(state_data->prog_data->args->common_args),
+                           filename,
+                           MAXPATHLEN) < 0)
+    goto cleanup;
+
+  if (_get_sel_info (state_data,
+                     &entries,
+                     &addition_timestamp,
+                     &erase_timestamp) < 0)
+    goto cleanup;
+
+  if ((ret = _sel_cache_read (state_data, filename, &cache)) < 0)
+    goto cleanup;
+
+  if (ret
+      && cache.most_recent_erase_timestamp == erase_timestamp
+      && cache.records_count <= entries)
+    {
+      if (cache.most_recent_addition_timestamp == addition_timestamp
+          && cache.records_count == entries)
+        goto out;
+
+      /* nothing to update from in an empty cache, read everything */
+      if (cache.records_count)
+        {
+          if ((ret = _sel_cache_update (state_data, &cache, entries)) < 0)
+            goto cleanup;
+        }
+      else
+        ret = 0;
+    }
+  else
+    ret = 0;
+
+  if (!ret)
+    {
+      _sel_cache_clear (&cache);
+
+      if (_sel_cache_fetch (state_data, &cache, IPMI_SEL_RECORD_ID_FIRST) < 0)
+        goto cleanup;
+    }
+
+  cache.most_recent_addition_timestamp = addition_timestamp;
+  cache.most_recent_erase_timestamp = erase_timestamp;
+
+  /* the records were read fine, a cache that can't be written is
+   * only a missed optimization
+   */
+  _sel_cache_write (state_data, filename, &cache);
+
+ out:
+  (*sel_records) = cache.records;
+  (*sel_records_count) = cache.records_count;
+  cache.records = NULL;
+  rv = 0;
+ cleanup:
+  _sel_cache_clear (&cache);
+  return (rv);
+}
+
+int
+ipmi_sel_cache_flush (pstdout_state_t pstate,
+                      const char *hostname,
+                      const struct common_cmd_args *common_args)
+{
+  char filename[MAXPATHLEN+1];
+
+  assert (common_args);
+
+  memset (filename, '\0', MAXPATHLEN+1);
+
+  if (_sel_cache_filename (pstate,
+                           hostname,
+                           common_args,
+                           filename,
+                           MAXPATHLEN) < 0)
+    return (-1);
+
+  if (!common_args->quiet_cache)
+    PSTDOUT_PRINTF (pstate, "Flushing cache: %s\n", filename);
+
+  if (unlink (filename) < 0 && errno != ENOENT)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "Cannot remove cache file: %s: %s\n",
+                       filename,
+                       strerror (errno));
+      return (-1);
+    }
+
+  return (0);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IPMI_SEL_CACHE_H
+#define IPMI_SEL_CACHE_H
+
+#include "ipmi-sel_.h"
+
+/* Bring the local copy of the host's SEL up to date, reading only
+ * records added since the last run from the BMC, and return all
+ * records in SEL order.  sel_records holds sel_records_count records
+ * of IPMI_SEL_RECORD_MAX_RECORD_LENGTH bytes and must be freed by the
+ * caller.
+ *
+ * Returns 0 on success, -1 on error
+ */
+int ipmi_sel_cache_load (ipmi_sel_state_data_t *state_data,
+                         uint8_t **sel_records,
+                         unsigned int *sel_records_count);
+
+int ipmi_sel_cache_flush (pstdout_state_t pstate,
+                          const char *hostname,
+                          const struct common_cmd_args *common_args);
+
+#endif /* IPMI_SEL_CACHE_H */
@@ -41,6 +41,7 @@
 
 #include "ipmi-sel_.h"
 #include "ipmi-sel-argp.h"
+#include "ipmi-sel-cache.h"
 
 #include "freeipmi-portability.h"
 #include "pstdout.h"
@@ -1732,11 +1733,118 @@ _sel_record_id_last_callback (ipmi_sel_ctx_t ctx, void *callback_data)
   return (rv);
 }
 
+/* Select the records to display from the cached SEL, subset either
+ * points into sel_records or is allocated and returned in subset_buf.
+ */
+static int
+_sel_cache_select_records (ipmi_sel_state_data_t *state_data,
+                           uint8_t *sel_records,
+                           unsigned int sel_records_count,
+                           uint8_t **subset,
+                           unsigned int *subset_count,
+                           uint8_t **subset_buf)
+{
+  struct ipmi_sel_arguments *args;
+  uint16_t record_id;
+  unsigned int i, j;
+
+  assert (state_data);
+  assert (sel_records || !sel_records_count);
+  assert (subset);
+  assert (subset_count);
+  assert (subset_buf);
+
+  args = state_data->prog_data->args;
+
+  (*subset) = sel_records;
+  (*subset_count) = sel_records_count;
+  (*subset_buf) = NULL;
+
+  if (args->display)
+    {
+      if (!((*subset_buf) = malloc (args->display_record_list_length * IPMI_SEL_RECORD_MAX_RECORD_LENGTH)))
+        {
+          pstdout_perror (state_data->pstate, "malloc");
+          return (-1);
+        }
+
+      (*subset) = (*subset_buf);
+      (*subset_count) = 0;
+
+      /* in the order specified by the user, like ipmi_sel_parse_record_ids() */
+      for (i = 0; i < args->display_record_list_length; i++)
+        {
+          for (j = 0; j < sel_records_count; j++)
+            {
+              if (ipmi_sel_parse_read_record_id (state_data->sel_ctx,
+                                                 sel_records + j * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                                 IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                                 &record_id) < 0)
+                continue;
+
+              if (record_id == args->display_record_list[i])
+                {
+                  memcpy ((*subset) + (*subset_count) * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                          sel_records + j * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                          IPMI_SEL_RECORD_MAX_RECORD_LENGTH);
+                  (*subset_count)++;
+                  break;
+                }
+            }
+        }
+    }
+  else if (args->display_range)
+    {
+      (*subset_count) = 0;
+
+      /* record ids are ascending in SEL order */
+      for (i = 0; i < sel_records_count; i++)
+        {
+          if (ipmi_sel_parse_read_record_id (state_data->sel_ctx,
+                                             sel_records + i * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                             IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                                             &record_id) < 0)
+            {
+              /* keep the subset contiguous */
+              if (*subset_count)
+                (*subset_count)++;
+              continue;
+            }
+
+          if (record_id < args->display_range1)
+            continue;
+
+          if (record_id > args->display_range2)
+            break;
+
+          if (!(*subset_count))
+            (*subset) = sel_records + i * IPMI_SEL_RECORD_MAX_RECORD_LENGTH;
+          (*subset_count)++;
+        }
+    }
+  else if (args->tail)
+    {
+      /* with the whole SEL at hand, the tail is exact */
+      if (sel_records_count > args->tail_count)
+        {
+          (*subset) = sel_records + (sel_records_count - args->tail_count) * IPMI_SEL_RECORD_MAX_RECORD_LENGTH;
+          (*subset_count) = args->tail_count;
+        }
+    }
+
+  return (0);
+}
+
 static int
 _display_sel_records (ipmi_sel_state_data_t *state_data)
 {
   struct ipmi_sel_arguments *args;
   fiid_obj_t obj_cmd_rs = NULL;
+  uint8_t *sel_records = NULL;
+  unsigned int sel_records_count = 0;
+  uint8_t *subset = NULL;
+  unsigned int subset_count = 0;
+  uint8_t *subset_buf = NULL;
   int rv = -1;
   uint64_t val;
 
@@ -1744,6 +1852,22 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
 
   args = state_data->prog_data->args;
 
+  if (args->sel_cache)
+    {
+      if (ipmi_sel_cache_load (state_data,
+                               &sel_records,
+                               &sel_records_count) < 0)
+        goto cleanup;
+
+      if (_sel_cache_select_records (state_data,
+                                     sel_records,
+                                     sel_records_count,
+                                     &subset,
+                                     &subset_count,
+                                     &subset_buf) < 0)
+        goto cleanup;
+    }
+
   if (!args->legacy_output)
     {
       if (ipmi_sel_ctx_set_separator (state_data->sel_ctx, EVENT_OUTPUT_SEPARATOR) < 0)
@@ -1837,7 +1961,23 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
 
       /* Record IDs for SEL entries are calculated a bit differently */
       
-      if (state_data->prog_data->args->display)
+      if (args->sel_cache)
+        {
+          /* records are local, no need to guess */
+          if (ipmi_sel_parse_records (state_data->sel_ctx,
+                                      subset,
+                                      subset_count,
+                                      _sel_record_id_callback,
+                                      state_data) < 0)
+            {
+              pstdout_fprintf (state_data->pstate,
+                               stderr,
+                               "ipmi_sel_parse_records: %s\n",
+                               ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+              goto cleanup;
+            }
+        }
+      else if (state_data->prog_data->args->display)
         {
           uint16_t max_record_id = 0;
           int i;
@@ -1957,7 +2097,22 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
         }
     }
 
-  if (state_data->prog_data->args->display)
+  if (args->sel_cache)
+    {
+      if (ipmi_sel_parse_records (state_data->sel_ctx,
+                                  subset,
+                                  subset_count,
+                                  _sel_parse_callback,
+                                  state_data) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sel_parse_records: %s\n",
+                           ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+          goto cleanup;
+        }
+    }
+  else if (state_data->prog_data->args->display)
     {
       if (ipmi_sel_parse_record_ids (state_data->sel_ctx,
                                      state_data->prog_data->args->display_record_list,
@@ -2135,6 +2290,8 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
   rv = 0;
  cleanup:
   fiid_obj_destroy (obj_cmd_rs);
+  free (subset_buf);
+  free (sel_records);
   return (rv);
 }
 
@@ -2192,6 +2349,13 @@ _ipmi_sel (pstdout_state_t pstate,
                                  hostname,
                                  &prog_data->args->common_args) < 0)
         return (EXIT_FAILURE);
+      if (prog_data->args->sel_cache)
+        {
+          if (ipmi_sel_cache_flush (pstate,
+                                    hostname,
+                                    &prog_data->args->common_args) < 0)
+            return (EXIT_FAILURE);
+        }
       return (EXIT_SUCCESS);
     }
 
@@ -2200,10 +2364,10 @@ _ipmi_sel (pstdout_state_t pstate,
   state_data.pstate = pstate;
   state_data.hostname = (char *)hostname;
 
-  if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
-					 hostname,
-					 &(prog_data->args->common_args),
-					 state_data.pstate)))
+  if (!(state_data.ipmi_ctx = ipmi_open_cached (prog_data->progname,
+                                                hostname,
+                                                &(prog_data->args->common_args),
+                                                state_data.pstate)))
     goto cleanup;
 
   /* need to create/open cache before creating sel_ctx */
@@ -2214,7 +2378,7 @@ _ipmi_sel (pstdout_state_t pstate,
       && !prog_data->args->delete_range
       && !prog_data->args->common_args.ignore_sdr_cache)
     {
-      if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create ()))
+      if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create_cached (pstate)))
 	{
 	  pstdout_perror (pstate, "ipmi_sdr_ctx_create()");
 	  goto cleanup;
@@ -2274,7 +2438,8 @@ _ipmi_sel (pstdout_state_t pstate,
 
       if (event_load_event_state_config_file (pstate,
 					      state_data.interpret_ctx,
-					      prog_data->args->event_state_config_file) < 0)
+					      prog_data->args->event_state_config_file,
+					      prog_data->args->event_state_config_cache_file) < 0)
 	goto cleanup;
 
       if (prog_data->args->assume_system_event_records)
@@ -2326,10 +2491,9 @@ _ipmi_sel (pstdout_state_t pstate,
 
   exit_code = EXIT_SUCCESS;
  cleanup:
-  ipmi_sdr_ctx_destroy (state_data.sdr_ctx);
+  ipmi_sdr_ctx_destroy_cached (state_data.sdr_ctx, pstate);
   ipmi_sel_ctx_destroy (state_data.sel_ctx);
-  ipmi_ctx_close (state_data.ipmi_ctx);
-  ipmi_ctx_destroy (state_data.ipmi_ctx);
+  ipmi_close_cached (state_data.ipmi_ctx, pstate);
   return (exit_code);
 }
 
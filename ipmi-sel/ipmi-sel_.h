@@ -71,6 +71,8 @@ enum ipmi_sel_argp_option_keys
     NO_HEADER_OUTPUT_KEY = 184,
     NON_ABBREVIATED_UNITS_KEY = 185,
     LEGACY_OUTPUT_KEY = 186,
+    SEL_CACHE_KEY = 187,
+    EVENT_STATE_CONFIG_CACHE_KEY = 188,
   };
 
 struct ipmi_sel_arguments
@@ -126,6 +128,8 @@ struct ipmi_sel_arguments
   int no_header_output;
   int non_abbreviated_units;
   int legacy_output;
+  int sel_cache;
+  char *event_state_config_cache_file;
 };
 
 typedef struct ipmi_sel_prog_data
@@ -63,6 +63,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_OPTIONS_DRIVER,
     ARGP_COMMON_OPTIONS_INBAND,
     ARGP_COMMON_OPTIONS_OUTOFBAND_HOSTRANGED,
+    ARGP_COMMON_OPTIONS_PIPELINE_WINDOW,
     ARGP_COMMON_OPTIONS_AUTHENTICATION_TYPE,
     ARGP_COMMON_OPTIONS_CIPHER_SUITE_ID,
     ARGP_COMMON_OPTIONS_PRIVILEGE_LEVEL,
@@ -143,6 +144,8 @@ static struct argp_option cmdline_options[] =
     /* ipmimonitoring legacy support */
     { "ipmimonitoring-legacy-output", IPMIMONITORING_LEGACY_OUTPUT_KEY, 0, 0,
       "Output in ipmimonitoring legacy format.", 70},
+    { "sensor-state-config-cache", SENSOR_STATE_CONFIG_CACHE_KEY, "FILE", 0,
+      "Cache the loaded sensor state configuration in a file and load it from there.", 71},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -318,6 +321,13 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case IPMIMONITORING_LEGACY_OUTPUT_KEY:
       cmd_args->ipmimonitoring_legacy_output = 1;
       break;
+    case SENSOR_STATE_CONFIG_CACHE_KEY:
+      if (!(cmd_args->sensor_state_config_cache_file = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
     case ARGP_KEY_ARG:
       /* Too many arguments. */
       argp_usage (state);
@@ -345,7 +355,7 @@ _ipmi_sensors_config_file_parse (struct ipmi_sensors_arguments *cmd_args)
   if (config_file_parse (cmd_args->common_args.config_file,
                          0,
                          &(cmd_args->common_args),
-                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_SDR | CONFIG_FILE_TIME | CONFIG_FILE_HOSTRANGE,
+                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND | CONFIG_FILE_PIPELINE | CONFIG_FILE_SDR | CONFIG_FILE_TIME | CONFIG_FILE_HOSTRANGE,
                          CONFIG_FILE_TOOL_IPMI_SENSORS,
                          &config_file_data) < 0)
     {
@@ -512,6 +522,7 @@ ipmi_sensors_argp_parse (int argc, char **argv, struct ipmi_sensors_arguments *c
   cmd_args->non_abbreviated_units = 0;
   cmd_args->legacy_output = 0;
   cmd_args->ipmimonitoring_legacy_output = 0;
+  cmd_args->sensor_state_config_cache_file = NULL;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -60,6 +60,8 @@
 
 #define IPMI_SENSORS_TIME_BUFLEN    512
 
+#define IPMI_SENSORS_SENSOR_NUMBER_MAX 256
+
 static int
 _sdr_repository_info (ipmi_sensors_state_data_t *state_data)
 {
@@ -1073,6 +1075,156 @@ _output_sensor (ipmi_sensors_state_data_t *state_data,
   return (rv);
 }
 
+/* Get the readings of all BMC owned sensors through the pipeline
+ * before output, so up to pipeline window requests are outstanding
+ * at once instead of one round trip per sensor.  Not fatal if it
+ * fails, sensors are then read one at a time.
+ */
+static int
+_prefetch_sensor_readings (ipmi_sensors_state_data_t *state_data,
+                           unsigned int *output_record_ids,
+                           unsigned int output_record_ids_length)
+{
+  struct ipmi_sensors_arguments *args = NULL;
+  uint8_t sensor_numbers[IPMI_SENSORS_SENSOR_NUMBER_MAX];
+  uint8_t sensor_number_found[IPMI_SENSORS_SENSOR_NUMBER_MAX];
+  unsigned int sensor_numbers_length = 0;
+  unsigned int i;
+
+  assert (state_data);
+  assert (output_record_ids);
+
+  args = state_data->prog_data->args;
+
+  /* pipelining is only possible outofband */
+  if (!state_data->hostname
+      || !strcasecmp (state_data->hostname, "localhost")
+      || !strcmp (state_data->hostname, "127.0.0.1"))
+    return (0);
+
+  memset (sensor_number_found, '\0', IPMI_SENSORS_SENSOR_NUMBER_MAX);
+
+  for (i = 0; i < output_record_ids_length; i++)
+    {
+      uint8_t record_type;
+      uint8_t sensor_owner_id_type;
+      uint8_t sensor_owner_id;
+      uint8_t sensor_number_base;
+      uint8_t share_count = 1;
+      unsigned int j;
+
+      if (ipmi_sdr_cache_search_record_id (state_data->sdr_ctx,
+                                           output_record_ids[i]) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sdr_cache_search_record_id: 0x%02X %s\n",
+                           output_record_ids[i],
+                           ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+          return (-1);
+        }
+
+      if (ipmi_sdr_parse_record_id_and_type (state_data->sdr_ctx,
+                                             NULL,
+                                             0,
+                                             NULL,
+                                             &record_type) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sdr_parse_record_id_and_type: %s\n",
+                           ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+          return (-1);
+        }
+
+      if (record_type != IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+          && record_type != IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+        continue;
+
+      if (ipmi_sdr_parse_sensor_owner_id (state_data->sdr_ctx,
+                                          NULL,
+                                          0,
+                                          &sensor_owner_id_type,
+                                          &sensor_owner_id) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sdr_parse_sensor_owner_id: %s\n",
+                           ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+          return (-1);
+        }
+
+      if (sensor_owner_id_type == IPMI_SDR_SENSOR_OWNER_ID_TYPE_SYSTEM_SOFTWARE_ID)
+        continue;
+
+      /* sensors owned elsewhere are bridged, see ipmi_sensor_read() */
+      if (((sensor_owner_id << 1) | sensor_owner_id_type) != IPMI_SLAVE_ADDRESS_BMC
+          && !(args->common_args.section_specific_workaround_flags & IPMI_PARSE_SECTION_SPECIFIC_WORKAROUND_FLAGS_ASSUME_BMC_OWNER))
+        continue;
+
+      if (ipmi_sdr_parse_sensor_number (state_data->sdr_ctx,
+                                        NULL,
+                                        0,
+                                        &sensor_number_base) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sdr_parse_sensor_number: %s\n",
+                           ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+          return (-1);
+        }
+
+      if (args->shared_sensors
+          && record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+        {
+          if (ipmi_sdr_parse_sensor_record_sharing (state_data->sdr_ctx,
+                                                    NULL,
+                                                    0,
+                                                    &share_count,
+                                                    NULL,
+                                                    NULL,
+                                                    NULL) < 0)
+            {
+              pstdout_fprintf (state_data->pstate,
+                               stderr,
+                               "ipmi_sdr_parse_sensor_record_sharing: %s\n",
+                               ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+              return (-1);
+            }
+
+          if (!share_count)
+            share_count = 1;
+        }
+
+      for (j = 0; j < share_count; j++)
+        {
+          uint8_t sensor_number = sensor_number_base + j;
+
+          if (sensor_number_found[sensor_number])
+            continue;
+
+          sensor_number_found[sensor_number]++;
+          sensor_numbers[sensor_numbers_length++] = sensor_number;
+        }
+    }
+
+  if (sensor_numbers_length <= 1)
+    return (0);
+
+  if (ipmi_sensor_read_prefetch (state_data->sensor_read_ctx,
+                                 sensor_numbers,
+                                 sensor_numbers_length) < 0)
+    {
+      if (args->common_args.debug)
+        pstdout_fprintf (state_data->pstate,
+                         stderr,
+                         "ipmi_sensor_read_prefetch: %s\n",
+                         ipmi_sensor_read_ctx_errormsg (state_data->sensor_read_ctx));
+    }
+
+  return (0);
+}
+
 static int
 _display_sensors (ipmi_sensors_state_data_t *state_data)
 {
@@ -1234,6 +1386,14 @@ _display_sensors (ipmi_sensors_state_data_t *state_data)
         }
     }
 
+  if (args->common_args.pipeline_window > 1)
+    {
+      if (_prefetch_sensor_readings (state_data,
+                                     output_record_ids,
+                                     output_record_ids_length) < 0)
+        goto cleanup;
+    }
+
   for (i = 0; i < output_record_ids_length; i++)
     {
       uint8_t record_type;
@@ -1375,6 +1535,22 @@ run_cmd_args (ipmi_sensors_state_data_t *state_data)
   return (0);
 }
 
+static int
+_load_sensor_config (ipmi_interpret_ctx_t interpret_ctx,
+                     const char *sensor_state_config_file,
+                     const char *sensor_state_config_cache_file)
+{
+  assert (interpret_ctx);
+
+  if (sensor_state_config_cache_file)
+    return (ipmi_interpret_load_sensor_config_cached (interpret_ctx,
+                                                     sensor_state_config_file,
+                                                     sensor_state_config_cache_file));
+
+  return (ipmi_interpret_load_sensor_config (interpret_ctx,
+                                             sensor_state_config_file));
+}
+
 static int
 _ipmi_sensors (pstdout_state_t pstate,
                const char *hostname,
@@ -1406,13 +1582,13 @@ _ipmi_sensors (pstdout_state_t pstate,
   state_data.pstate = pstate;
   state_data.hostname = (char *)hostname;
   
-  if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
-					 hostname,
-					 &(prog_data->args->common_args),
-					 state_data.pstate)))
+  if (!(state_data.ipmi_ctx = ipmi_open_cached (prog_data->progname,
+                                                hostname,
+                                                &(prog_data->args->common_args),
+                                                state_data.pstate)))
     goto cleanup;
 
-  if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create ()))
+  if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create_cached (pstate)))
     {
       pstdout_perror (pstate, "ipmi_sdr_ctx_create()");
       goto cleanup;
@@ -1456,8 +1632,9 @@ _ipmi_sensors (pstdout_state_t pstate,
 
       if (prog_data->args->sensor_state_config_file)
         {
-          if (ipmi_interpret_load_sensor_config (state_data.interpret_ctx,
-                                                 prog_data->args->sensor_state_config_file) < 0)
+          if (_load_sensor_config (state_data.interpret_ctx,
+                                   prog_data->args->sensor_state_config_file,
+                                   prog_data->args->sensor_state_config_cache_file) < 0)
             {
               if (ipmi_interpret_ctx_errnum (state_data.interpret_ctx) == IPMI_INTERPRET_ERR_SENSOR_CONFIG_FILE_DOES_NOT_EXIST)
                 pstdout_fprintf (pstate,
@@ -1479,7 +1656,9 @@ _ipmi_sensors (pstdout_state_t pstate,
         }
       else
         {
-          if (ipmi_interpret_load_sensor_config (state_data.interpret_ctx, NULL) < 0)
+          if (_load_sensor_config (state_data.interpret_ctx,
+                                   NULL,
+                                   prog_data->args->sensor_state_config_cache_file) < 0)
             {
               if (ipmi_interpret_ctx_errnum (state_data.interpret_ctx) == IPMI_INTERPRET_ERR_SENSOR_CONFIG_FILE_PARSE)
                 pstdout_fprintf (pstate,
@@ -1521,11 +1700,10 @@ _ipmi_sensors (pstdout_state_t pstate,
 
   exit_code = EXIT_SUCCESS;
  cleanup:
-  ipmi_sdr_ctx_destroy (state_data.sdr_ctx);
+  ipmi_sdr_ctx_destroy_cached (state_data.sdr_ctx, pstate);
   ipmi_sensor_read_ctx_destroy (state_data.sensor_read_ctx);
   ipmi_interpret_ctx_destroy (state_data.interpret_ctx);
-  ipmi_ctx_close (state_data.ipmi_ctx);
-  ipmi_ctx_destroy (state_data.ipmi_ctx);
+  ipmi_close_cached (state_data.ipmi_ctx, pstate);
   return (exit_code);
 }
 
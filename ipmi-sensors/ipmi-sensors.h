@@ -58,6 +58,7 @@ enum ipmi_sensors_argp_option_keys
     NON_ABBREVIATED_UNITS_KEY = 176,
     LEGACY_OUTPUT_KEY = 177,
     IPMIMONITORING_LEGACY_OUTPUT_KEY = 178,
+    SENSOR_STATE_CONFIG_CACHE_KEY = 179,
   };
 
 struct ipmi_sensors_arguments
@@ -91,6 +92,7 @@ struct ipmi_sensors_arguments
   int non_abbreviated_units;
   int legacy_output;
   int ipmimonitoring_legacy_output;
+  char *sensor_state_config_cache_file;
 };
 
 typedef struct ipmi_sensors_prog_data
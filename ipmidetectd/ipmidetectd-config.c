@@ -47,6 +47,7 @@
 
 #include "ipmidetectd.h"
 #include "ipmidetectd-config.h"
+#include "ipmidetect-protocol.h"
 
 #include "freeipmi-portability.h"
 #include "conffile.h"
@@ -66,6 +67,7 @@ _config_default (void)
 
   conf.ipmiping_period = IPMIDETECTD_IPMIPING_PERIOD;
   conf.ipmidetectd_server_port = IPMIDETECTD_SERVER_PORT_DEFAULT;
+  strcpy (conf.ipmidetectd_server_socket, IPMIDETECT_PROTOCOL_SOCKET_DEFAULT);
 
   if (!(conf.hosts = hostlist_create (NULL)))
     err_exit ("hostlist_create: %s", strerror (errno));
@@ -91,6 +93,8 @@ _config_file_parse (void)
 {
   int ipmiping_period_flag,
     ipmidetectd_server_port_flag,
+    ipmidetectd_server_socket_flag,
+    ipmidetectd_shared_table_flag,
     host_flag;
 
   struct conffile_option options[] =
@@ -117,6 +121,28 @@ _config_file_parse (void)
 	&(conf.ipmidetectd_server_port),
 	0,
       },
+      {
+	"ipmidetectd_server_socket",
+	CONFFILE_OPTION_STRING,
+	-1,
+	conffile_string,
+	1,
+	0,
+	&(ipmidetectd_server_socket_flag),
+	conf.ipmidetectd_server_socket,
+	IPMIDETECTD_MAXPATHLEN+1,
+      },
+      {
+	"ipmidetectd_shared_table",
+	CONFFILE_OPTION_STRING,
+	-1,
+	conffile_string,
+	1,
+	0,
+	&(ipmidetectd_shared_table_flag),
+	conf.ipmidetectd_shared_table,
+	IPMIDETECTD_MAXPATHLEN+1,
+      },
       {
 	"host",
 	CONFFILE_OPTION_STRING,
@@ -46,10 +46,14 @@
 #endif /* !TIME_WITH_SYS_TIME */
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <sys/poll.h>
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif /* HAVE_SYS_EPOLL_H */
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif /* HAVE_UNISTD_H */
@@ -57,6 +61,7 @@
 #include <fcntl.h>
 #endif /* HAVE_FCNTL_H */
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <syslog.h>
 #include <limits.h>
 #include <signal.h>
@@ -68,13 +73,14 @@
 #include "ipmidetectd.h"
 #include "ipmidetectd-argp.h"
 #include "ipmidetectd-config.h"
+#include "ipmidetect-protocol.h"
 
 #include "freeipmi-portability.h"
+#include "dgram.h"
 #include "error.h"
 #include "fd.h"
 #include "hash.h"
 #include "hostlist.h"
-#include "list.h"
 #include "timeval.h"
 
 #include "tool-daemon-common.h"
@@ -85,6 +91,17 @@
 #define IPMIDETECTD_NODES_PER_SOCKET 8
 #define IPMIDETECTD_SERVER_BACKLOG   5
 
+/* Pings due within this many ms of each other are sent together */
+#define IPMIDETECTD_PING_BATCH_MS    10
+
+#define IPMIDETECTD_EVENTS_MAX       64
+
+/* Binary query clients must be served within this many seconds */
+#define IPMIDETECTD_CLIENT_TIMEOUT   5
+
+/* Binary query clients served at once, more are refused */
+#define IPMIDETECTD_CLIENTS_MAX      16
+
 /* IPMI has a 6 bit sequence number */
 #define IPMI_RQ_SEQ_MAX  0x3F
 
@@ -92,7 +109,13 @@ struct ipmidetectd_arguments cmd_args;
 
 struct ipmidetectd_config conf;
 
-static struct timeval ipmidetectd_next_send;
+/* Pings are spread evenly over the ipmiping period.  Node i is
+ * pinged at ping_round_start + i * ipmiping_period / nodes_count, so
+ * nodes come due in array order and only the next node due needs to
+ * be tracked.
+ */
+static struct timeval ping_round_start;
+static unsigned int ping_next_node = 0;
 
 struct ipmidetectd_info
 {
@@ -101,14 +124,63 @@ struct ipmidetectd_info
   struct sockaddr_in destaddr;
   unsigned int sequence_number;
   struct timeval last_received;
+  uint64_t generation;
 };
 
 int *fds = NULL;
 unsigned int fds_count = 0;
-List nodes = NULL;
+struct ipmidetectd_info *nodes = NULL;
 unsigned int nodes_count = 0;
 hash_t nodes_index = NULL;
 int server_fd = 0;
+int unix_server_fd = -1;
+
+/* Identifies this daemon's node table, see ipmidetect-protocol.h.
+ * The generation is advanced every time a node's last_received
+ * second changes.
+ */
+static uint64_t nodes_epoch = 0;
+static uint64_t nodes_generation = 0;
+
+/* Query responses are built in one buffer and written at once.  Both
+ * are sized for all nodes at setup.
+ */
+static char *text_buf = NULL;
+static unsigned int text_buflen = 0;
+static uint8_t *binary_buf = NULL;
+static unsigned int binary_buflen = 0;
+static unsigned int names_len = 0;
+
+/* Shared detection table, see ipmidetect-protocol.h */
+static struct ipmidetect_table_header *table = NULL;
+static uint64_t *table_timestamps = NULL;
+static unsigned int table_len = 0;
+
+/* Binary query clients are non-blocking and served from the event
+ * loop, so a slow or stuck client cannot stall pings.  The request is
+ * read, then the response written, as the socket becomes ready.
+ */
+struct ipmidetectd_client
+{
+  int fd;
+  time_t accepted;
+  uint8_t req[IPMIDETECT_PROTOCOL_REQUEST_LEN];
+  unsigned int req_len;
+  uint8_t *rsp;
+  unsigned int rsp_len;
+  unsigned int rsp_written;
+  int done;
+};
+
+static struct ipmidetectd_client clients[IPMIDETECTD_CLIENTS_MAX];
+static unsigned int clients_count = 0;
+
+static unsigned int events_count = 0;
+#if HAVE_SYS_EPOLL_H
+static int epfd = -1;
+#else /* !HAVE_SYS_EPOLL_H */
+static struct pollfd *pfds = NULL;
+#endif /* !HAVE_SYS_EPOLL_H */
 
 extern int h_errno;
 
@@ -173,6 +245,94 @@ _fds_setup (void)
 
   if (listen (server_fd, IPMIDETECTD_SERVER_BACKLOG) < 0)
     err_exit ("listen: %s", strerror (errno));
+
+  if (strlen (conf.ipmidetectd_server_socket))
+    {
+      struct sockaddr_un uaddr;
+
+      if (strlen (conf.ipmidetectd_server_socket) >= sizeof (uaddr.sun_path))
+        err_exit ("server socket path too long: %s", conf.ipmidetectd_server_socket);
+
+      if ((unix_server_fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0)
+        err_exit ("socket: %s", strerror (errno));
+
+      memset (&uaddr, '\0', sizeof (struct sockaddr_un));
+      uaddr.sun_family = AF_UNIX;
+      strcpy (uaddr.sun_path, conf.ipmidetectd_server_socket);
+
+      /* remove socket left behind by a previous daemon */
+      if (unlink (conf.ipmidetectd_server_socket) < 0
+          && errno != ENOENT)
+        err_exit ("unlink: %s", strerror (errno));
+
+      if (bind (unix_server_fd, (struct sockaddr *)&uaddr, sizeof (struct sockaddr_un)) < 0)
+        err_exit ("bind: %s: %s", conf.ipmidetectd_server_socket, strerror (errno));
+
+      /* same data is available to anyone through the tcp port */
+      if (chmod (conf.ipmidetectd_server_socket, 0666) < 0)
+        err_exit ("chmod: %s", strerror (errno));
+
+      if (listen (unix_server_fd, IPMIDETECTD_SERVER_BACKLOG) < 0)
+        err_exit ("listen: %s", strerror (errno));
+    }
+}
+
+/* ping fds, then the server fds */
+static int
+_events_fd (unsigned int i)
+{
+  if (i < fds_count)
+    return (fds[i]);
+  if (i == fds_count)
+    return (server_fd);
+  return (unix_server_fd);
+}
+
+/* fds do not change after setup, so they are registered once */
+static void
+_events_setup (void)
+{
+  unsigned int i;
+
+  assert (fds);
+  assert (fds_count);
+  assert (server_fd);
+
+  events_count = fds_count + 1;
+  if (unix_server_fd >= 0)
+    events_count++;
+
+#if HAVE_SYS_EPOLL_H
+  assert (epfd < 0);
+
+  if ((epfd = epoll_create (events_count)) < 0)
+    err_exit ("epoll_create: %s", strerror (errno));
+
+  for (i = 0; i < events_count; i++)
+    {
+      struct epoll_event ev;
+
+      memset (&ev, '\0', sizeof (struct epoll_event));
+      ev.events = EPOLLIN;
+      ev.data.fd = _events_fd (i);
+
+      if (epoll_ctl (epfd, EPOLL_CTL_ADD, ev.data.fd, &ev) < 0)
+        err_exit ("epoll_ctl: %s", strerror (errno));
+    }
+#else /* !HAVE_SYS_EPOLL_H */
+  assert (!pfds);
+
+  /* client fds are filled in before every poll */
+  if (!(pfds = (struct pollfd *)malloc ((events_count + IPMIDETECTD_CLIENTS_MAX) * sizeof (struct pollfd))))
+    err_exit ("malloc: %s", strerror (errno));
+
+  for (i = 0; i < events_count; i++)
+    {
+      pfds[i].fd = _events_fd (i);
+      pfds[i].events = POLLIN;
+      pfds[i].revents = 0;
+    }
+#endif /* !HAVE_SYS_EPOLL_H */
 }
 
 static void
@@ -188,8 +348,8 @@ _nodes_setup (void)
   assert (nodes_count);
   assert (!nodes_index);
 
-  if (!(nodes = list_create ((ListDelF)free)))
-    err_exit ("list_create: %s", strerror (errno));
+  if (!(nodes = (struct ipmidetectd_info *)calloc (nodes_count, sizeof (struct ipmidetectd_info))))
+    err_exit ("calloc: %s", strerror (errno));
 
   if (!(nodes_index = hash_create (nodes_count,
                                    (hash_key_f)hash_key_string,
@@ -202,7 +362,7 @@ _nodes_setup (void)
 
   while ((host = hostlist_next (itr)))
     {
-      struct ipmidetectd_info *info = NULL;
+      struct ipmidetectd_info *info = &nodes[i];
       struct hostent *h;
       char *tmpstr;
       char *ip;
@@ -211,9 +371,7 @@ _nodes_setup (void)
       char *host_ptr;
       uint16_t port = RMCP_PRIMARY_RMCP_PORT;
 
-      if (!(info = (struct ipmidetectd_info *)malloc (sizeof (struct ipmidetectd_info))))
-        err_exit ("malloc: %s", strerror (errno));
-      memset (info, '\0', sizeof (struct ipmidetectd_info));
+      assert (i < nodes_count);
 
       if (strchr (host, ':'))
 	{
@@ -275,9 +433,6 @@ _nodes_setup (void)
       free (host_copy);
       free (host);
 
-      if (!list_append (nodes, info))
-        err_exit ("list_append: %s", strerror (errno));
-
       if (!(tmpstr = inet_ntoa (info->destaddr.sin_addr)))
         err_exit ("inet_ntoa: %s", strerror (errno)); /* strerror? */
 
@@ -296,14 +451,192 @@ _nodes_setup (void)
   hostlist_iterator_destroy (itr);
 }
 
+static void
+_buffers_setup (void)
+{
+  unsigned int i;
+
+  assert (nodes);
+  assert (nodes_count);
+  assert (!text_buf);
+  assert (!binary_buf);
+
+  for (i = 0; i < nodes_count; i++)
+    names_len += strlen (nodes[i].hostname) + 1;
+
+  /* "hostname timestamp\n", timestamp at most 20 digits */
+  text_buflen = names_len + nodes_count * 21 + 1;
+  if (!(text_buf = (char *)malloc (text_buflen)))
+    err_exit ("malloc: %s", strerror (errno));
+
+  binary_buflen = IPMIDETECT_PROTOCOL_RESPONSE_HDR_LEN
+    + names_len
+    + nodes_count * IPMIDETECT_PROTOCOL_RECORD_LEN;
+  if (!(binary_buf = (uint8_t *)malloc (binary_buflen)))
+    err_exit ("malloc: %s", strerror (errno));
+}
+
+/* Mark a table left behind by a previous daemon as closed, so its
+ * readers move to ours.
+ */
+static void
+_table_close_previous (void)
+{
+  struct ipmidetect_table_header *old;
+  struct stat st;
+  int fd;
+
+  if ((fd = open (conf.ipmidetectd_shared_table, O_RDWR)) < 0)
+    return;
+
+  if (!fstat (fd, &st)
+      && st.st_size >= sizeof (struct ipmidetect_table_header))
+    {
+      if ((old = mmap (NULL,
+                       sizeof (struct ipmidetect_table_header),
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED,
+                       fd,
+                       0)) != MAP_FAILED)
+        {
+          if (old->magic == IPMIDETECT_TABLE_MAGIC)
+            old->closed = 1;
+          munmap (old, sizeof (struct ipmidetect_table_header));
+        }
+    }
+
+  /* ignore potential error, best effort */
+  close (fd);
+}
+
+static void
+_table_setup (void)
+{
+  char tmppath[IPMIDETECTD_MAXPATHLEN + 5];
+  unsigned int index_size = 8;
+  uint32_t *index, *name_offsets;
+  char *names;
+  unsigned int i, offset = 0;
+  int fd;
+
+  assert (nodes);
+  assert (nodes_count);
+  assert (!table);
+
+  if (!strlen (conf.ipmidetectd_shared_table))
+    return;
+
+  while (index_size < nodes_count * 2)
+    index_size *= 2;
+
+  table_len = sizeof (struct ipmidetect_table_header)
+    + nodes_count * sizeof (uint64_t)
+    + index_size * sizeof (uint32_t)
+    + nodes_count * sizeof (uint32_t)
+    + names_len;
+
+  /* build it aside, readers only ever see a complete table */
+  snprintf (tmppath, sizeof (tmppath), "%s.tmp", conf.ipmidetectd_shared_table);
+
+  if ((fd = open (tmppath, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+    err_exit ("open: %s: %s", tmppath, strerror (errno));
+
+  if (ftruncate (fd, table_len) < 0)
+    err_exit ("ftruncate: %s", strerror (errno));
+
+  if ((table = mmap (NULL,
+                     table_len,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED,
+                     fd,
+                     0)) == MAP_FAILED)
+    err_exit ("mmap: %s", strerror (errno));
+
+  /* ignore potential error, mapping stays valid */
+  close (fd);
+
+  table->magic = IPMIDETECT_TABLE_MAGIC;
+  table->version = IPMIDETECT_TABLE_VERSION;
+  table->epoch = nodes_epoch;
+  table->seq = 0;
+  table->closed = 0;
+  table->nodes_count = nodes_count;
+  table->timestamps_offset = sizeof (struct ipmidetect_table_header);
+  table->index_offset = table->timestamps_offset + nodes_count * sizeof (uint64_t);
+  table->index_size = index_size;
+  table->name_offsets_offset = table->index_offset + index_size * sizeof (uint32_t);
+  table->names_offset = table->name_offsets_offset + nodes_count * sizeof (uint32_t);
+  table->names_len = names_len;
+  table->table_len = table_len;
+
+  /* ftruncate zeroed timestamps and index */
+  table_timestamps = (uint64_t *)((uint8_t *)table + table->timestamps_offset);
+  index = (uint32_t *)((uint8_t *)table + table->index_offset);
+  name_offsets = (uint32_t *)((uint8_t *)table + table->name_offsets_offset);
+  names = (char *)table + table->names_offset;
+
+  for (i = 0; i < nodes_count; i++)
+    {
+      unsigned int slot;
+
+      strcpy (names + offset, nodes[i].hostname);
+      name_offsets[i] = offset;
+      offset += strlen (nodes[i].hostname) + 1;
+
+      slot = ipmidetect_table_hash (nodes[i].hostname) & (index_size - 1);
+      while (index[slot])
+        slot = (slot + 1) & (index_size - 1);
+      index[slot] = i + 1;
+    }
+
+  _table_close_previous ();
+
+  if (rename (tmppath, conf.ipmidetectd_shared_table) < 0)
+    err_exit ("rename: %s", strerror (errno));
+}
+
+static void
+_table_update (unsigned int node_id, uint64_t last_received)
+{
+  assert (table);
+  assert (node_id < nodes_count);
+
+  table->seq++;
+  IPMIDETECT_TABLE_BARRIER ();
+  table_timestamps[node_id] = last_received;
+  IPMIDETECT_TABLE_BARRIER ();
+  table->seq++;
+}
+
+static void
+_table_cleanup (void)
+{
+  if (!table)
+    return;
+
+  /* ignore potential errors, exiting */
+  unlink (conf.ipmidetectd_shared_table);
+  table->closed = 1;
+  IPMIDETECT_TABLE_BARRIER ();
+  munmap (table, table_len);
+  table = NULL;
+}
+
 static void
 _ipmidetectd_setup (void)
 {
-  /* Initialize ipmidetectd_next_send to 0 so there is a sweep of pings in the beginning */
-  memset (&ipmidetectd_next_send, '\0', sizeof (struct timeval));
+  /* First round of pings starts now */
+  if (gettimeofday (&ping_round_start, NULL) < 0)
+    err_exit ("gettimeofday: %s", strerror (errno));
+  ping_next_node = 0;
+
+  nodes_epoch = (uint64_t)ping_round_start.tv_sec * 1000000 + ping_round_start.tv_usec;
 
   _fds_setup ();
+  _events_setup ();
   _nodes_setup ();
+  _buffers_setup ();
+  _table_setup ();
 
   /* Avoid sigpipe exiting during server writes */
   if (signal (SIGPIPE, SIG_IGN) == SIG_ERR)
@@ -389,80 +722,150 @@ _ipmi_ping_build (struct ipmidetectd_info *info, uint8_t *buf, unsigned int bufl
 }
 
 static void
-_ipmidetectd_send_pings (void)
+_send_ping_batch (int fd, struct dgram *dgrams, unsigned int count)
 {
-  uint8_t buf[IPMIDETECTD_BUFLEN];
-  int len;
-  struct ipmidetectd_info *info;
-  ListIterator itr;
+  unsigned int sent = 0;
+
+  /* ipmi_lan_sendto() is sendto(), so pings can be batched */
+  while (sent < count)
+    {
+      int rv;
+
+      if ((rv = dgram_send_batch (fd, dgrams + sent, count - sent)) < 0)
+        err_exit ("dgram_send_batch: %s", strerror (errno));
+      sent += rv;
+    }
+}
+
+/* Time node i is due to be pinged in the current round */
+static void
+_ping_due (unsigned int i, struct timeval *due)
+{
+  uint64_t offset_us;
+  struct timeval offset;
+
+  assert (i < nodes_count);
+  assert (due);
+
+  offset_us = ((uint64_t)conf.ipmiping_period * 1000 * i) / nodes_count;
+  offset.tv_sec = offset_us / 1000000;
+  offset.tv_usec = offset_us % 1000000;
+  timeval_add (&ping_round_start, &offset, due);
+}
+
+static void
+_ipmidetectd_send_pings (struct timeval *now)
+{
+  static uint8_t bufs[DGRAM_BATCH_MAX][IPMIDETECTD_BUFLEN];
+  struct dgram dgrams[DGRAM_BATCH_MAX];
+  unsigned int count = 0;
+  unsigned int sent = 0;
+  int len, fd = -1;
 
   assert (nodes);
   assert (nodes_count);
+  assert (now);
 
-  if (!(itr = list_iterator_create (nodes)))
-    err_exit ("list_iterator_create: %s", strerror (errno));
-
-  while ((info = list_next (itr)))
+  /* Send every ping due by now.  Nodes sharing a socket are
+   * adjacent, see _nodes_setup(), so pings are batched a socket at
+   * a time.  At most one ping per node per call, in case we've
+   * fallen behind by more than a round.
+   */
+  while (sent < nodes_count)
     {
-      memset (buf, '\0', IPMIDETECTD_BUFLEN);
+      struct ipmidetectd_info *info = &nodes[ping_next_node];
+      struct timeval due;
+
+      _ping_due (ping_next_node, &due);
+      if (timeval_gt (&due, now))
+        break;
+
+      if (count && (info->fd != fd || count == DGRAM_BATCH_MAX))
+        {
+          _send_ping_batch (fd, dgrams, count);
+          count = 0;
+        }
+
+      memset (bufs[count], '\0', IPMIDETECTD_BUFLEN);
 
-      if ((len = _ipmi_ping_build (info, buf, IPMIDETECTD_BUFLEN)) < 0)
+      if ((len = _ipmi_ping_build (info, bufs[count], IPMIDETECTD_BUFLEN)) < 0)
         err_exit ("_ipmi_ping_build: %s", strerror (errno));
 
-      if (ipmi_lan_sendto (info->fd,
-                           buf,
-                           len,
-                           0,
-                           (struct sockaddr *)&(info->destaddr),
-                           sizeof (struct sockaddr_in)) < 0)
-        err_exit ("ipmi_lan_sendto: %s", strerror (errno));
+      dgrams[count].buf = bufs[count];
+      dgrams[count].len = len;
+      memcpy (&(dgrams[count].addr), &(info->destaddr), sizeof (struct sockaddr_in));
+      fd = info->fd;
+      count++;
+      sent++;
 
       if (cmd_args.debug)
         fprintf (stderr, "Ping Request to %s\n", info->hostname);
+
+      if (++ping_next_node == nodes_count)
+        {
+          struct timeval round_end;
+
+          ping_next_node = 0;
+          timeval_add_ms (&ping_round_start, conf.ipmiping_period, &ping_round_start);
+
+          /* If an entire round was missed, don't try to catch up */
+          timeval_add_ms (&ping_round_start, conf.ipmiping_period, &round_end);
+          if (timeval_lt (&round_end, now))
+            ping_round_start = *now;
+        }
     }
 
-  list_iterator_destroy (itr);
+  if (count)
+    _send_ping_batch (fd, dgrams, count);
 }
 
-static void
-_setup_pfds (struct pollfd *pfds)
+/* Milliseconds until the next ping is due */
+static unsigned int
+_ping_timeout (struct timeval *now)
 {
-  unsigned int i;
+  struct timeval due, timeout;
+  unsigned int timeout_ms;
 
-  assert (pfds);
+  assert (now);
 
-  for (i = 0; i < fds_count; i++)
-    {
-      pfds[i].fd = fds[i];
-      pfds[i].events = POLLIN;
-      pfds[i].revents = 0;
-    }
+  _ping_due (ping_next_node, &due);
+
+  if (!timeval_gt (&due, now))
+    return (0);
+
+  timeval_sub (&due, now, &timeout);
+  timeval_millisecond_calc (&timeout, &timeout_ms);
+
+  /* Don't wake up for every node in large clusters */
+  if (timeout_ms < IPMIDETECTD_PING_BATCH_MS)
+    timeout_ms = IPMIDETECTD_PING_BATCH_MS;
 
-  pfds[fds_count].fd = server_fd;
-  pfds[fds_count].events = POLLIN;
-  pfds[fds_count].revents = 0;
+  return (timeout_ms);
 }
 
 static void
 _receive_ping (int fd)
 {
-  struct sockaddr_in from;
   struct ipmidetectd_info *info;
-  uint8_t buf[IPMIDETECTD_BUFLEN];
-  int len;
-  socklen_t fromlen = sizeof (struct sockaddr_in);
+  static uint8_t bufs[DGRAM_BATCH_MAX][IPMIDETECTD_BUFLEN];
+  struct dgram dgrams[DGRAM_BATCH_MAX];
+  int i, len;
   char *tmpstr;
 
   /* We're happy as long as we receive something.  We don't bother
    * checking sequence numbers or anything like that.
+   *
+   * Everything queued on the socket is read at once.
    */
 
-  len = ipmi_lan_recvfrom (fd,
-                           buf,
-                           IPMIDETECTD_BUFLEN,
-                           0,
-                           (struct sockaddr *)&from,
-                           &fromlen);
+ again:
+  for (i = 0; i < DGRAM_BATCH_MAX; i++)
+    {
+      dgrams[i].buf = bufs[i];
+      dgrams[i].len = IPMIDETECTD_BUFLEN;
+    }
+
+  len = dgram_recv_batch (fd, dgrams, DGRAM_BATCH_MAX);
   
   /* achu & hliebig:
    *
@@ -499,32 +902,49 @@ _receive_ping (int fd)
     return;
     
   if (len < 0)
-    err_exit ("ipmi_lan_recvfrom: %s", strerror (errno));
+    err_exit ("dgram_recv_batch: %s", strerror (errno));
 
-  if (!(tmpstr = inet_ntoa (from.sin_addr)))
-    err_exit ("inet_ntoa: %s", strerror (errno)); /* strerror? */
-
-  if ((info = hash_find (nodes_index, tmpstr)))
+  for (i = 0; i < len; i++)
     {
-      if (gettimeofday (&(info->last_received), NULL) < 0)
-        err_exit ("gettimeofday: %s", strerror (errno));
+      if (!(tmpstr = inet_ntoa (dgrams[i].addr.sin_addr)))
+        err_exit ("inet_ntoa: %s", strerror (errno)); /* strerror? */
 
-      if (cmd_args.debug)
-        fprintf (stderr, "Ping Reply from %s\n", info->hostname);
+      if ((info = hash_find (nodes_index, tmpstr)))
+        {
+          struct timeval now;
+
+          if (gettimeofday (&now, NULL) < 0)
+            err_exit ("gettimeofday: %s", strerror (errno));
+
+          if (now.tv_sec != info->last_received.tv_sec)
+            {
+              info->generation = ++nodes_generation;
+              if (table)
+                _table_update (info - nodes, now.tv_sec);
+            }
+          info->last_received = now;
+
+          if (cmd_args.debug)
+            fprintf (stderr, "Ping Reply from %s\n", info->hostname);
+        }
     }
+
+  if (len == DGRAM_BATCH_MAX)
+    goto again;
 }
 
 static void
 _send_ping_data (void)
 {
-  ListIterator itr;
   struct sockaddr_in rhost;
-  struct ipmidetectd_info *info;
   socklen_t rhost_len = sizeof (struct sockaddr_in);
   int rhost_fd;
+  unsigned int i, len = 0;
+  int n;
 
   assert (nodes);
   assert (nodes_count);
+  assert (text_buf);
 
   if ((rhost_fd = accept (server_fd, (struct sockaddr *)&rhost, &rhost_len)) < 0)
     err_exit ("accept: %s", strerror (errno));
@@ -532,33 +952,302 @@ _send_ping_data (void)
   if (cmd_args.debug)
     fprintf (stderr, "Received ipmidetectd server request\n");
 
-  if (!(itr = list_iterator_create (nodes)))
-    err_exit ("list_iterator_create: %s", strerror (errno));
+  for (i = 0; i < nodes_count; i++)
+    {
+      struct ipmidetectd_info *info = &nodes[i];
+      int ret;
+
+      ret = snprintf (text_buf + len,
+                      text_buflen - len,
+                      "%s %lu\n",
+                      info->hostname,
+                      info->last_received.tv_sec);
+      if (ret < 0 || ret >= text_buflen - len)
+        err_exit ("snprintf: len=%d", ret);
+      len += ret;
+    }
 
-  while ((info = list_next (itr)))
+  if ((n = fd_write_n (rhost_fd, text_buf, len)) < 0)
     {
-      char buf[IPMIDETECTD_BUFLEN];
-      int len, n;
+      if (errno != EPIPE)
+        err_exit ("fd_write_n: %s", strerror (errno));
+    }
+  else if (n != len)
+    err_exit ("fd_write_n: n=%d len=%u", n, len);
 
-      len = snprintf (buf, IPMIDETECTD_BUFLEN, "%s %lu\n", info->hostname, info->last_received.tv_sec);
-      if (len >= IPMIDETECTD_BUFLEN)
-        err_exit ("len=%d", len);
+  /* ignore potential error, done w/ pipe */
+  close (rhost_fd);
+}
 
-      if ((n = fd_write_n (rhost_fd, buf, len)) < 0)
+#if HAVE_SYS_EPOLL_H
+static void
+_client_events (struct ipmidetectd_client *client, int op)
+{
+  struct epoll_event ev;
+
+  assert (client);
+  assert (epfd >= 0);
+
+  memset (&ev, '\0', sizeof (struct epoll_event));
+  ev.events = client->rsp ? EPOLLOUT : EPOLLIN;
+  ev.data.fd = client->fd;
+
+  if (epoll_ctl (epfd, op, client->fd, &ev) < 0)
+    err_exit ("epoll_ctl: %s", strerror (errno));
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+static void
+_client_close (unsigned int i)
+{
+  assert (i < clients_count);
+
+  /* ignore potential error, done w/ pipe, closing removes it from epoll */
+  close (clients[i].fd);
+  free (clients[i].rsp);
+
+  clients_count--;
+  if (i != clients_count)
+    clients[i] = clients[clients_count];
+}
+
+static int
+_client_find (int fd)
+{
+  unsigned int i;
+
+  for (i = 0; i < clients_count; i++)
+    {
+      if (clients[i].fd == fd)
+        return (i);
+    }
+
+  return (-1);
+}
+
+/* Close clients that are done.  Called after all events of a wait
+ * are handled, so a later event cannot refer to a reused fd.
+ */
+static void
+_clients_reap (void)
+{
+  unsigned int i = 0;
+
+  while (i < clients_count)
+    {
+      if (clients[i].done)
         {
-          if (errno == EPIPE)
-            break;
-          else
-            err_exit ("fd_write_n: %s", strerror (errno));
+          _client_close (i);
+          continue;
         }
+      i++;
+    }
+}
 
-      if (n != len)
-        err_exit ("fd_write_n: n=%d len=%d", n, len);
+/* Drop clients that were not served in time */
+static void
+_clients_expire (struct timeval *now)
+{
+  unsigned int i;
+
+  assert (now);
+
+  for (i = 0; i < clients_count; i++)
+    {
+      if (now->tv_sec - clients[i].accepted >= IPMIDETECTD_CLIENT_TIMEOUT)
+        {
+          if (cmd_args.debug)
+            fprintf (stderr, "ipmidetectd binary server request timed out\n");
+          clients[i].done = 1;
+        }
     }
 
-  list_iterator_destroy (itr);
-  /* ignore potential error, done w/ pipe */
-  close (rhost_fd);
+  _clients_reap ();
+}
+
+static void
+_accept_ping_data_binary (void)
+{
+  struct ipmidetectd_client *client;
+  struct timeval now;
+  int rhost_fd;
+  int flags;
+
+  assert (unix_server_fd >= 0);
+
+  if ((rhost_fd = accept (unix_server_fd, NULL, NULL)) < 0)
+    err_exit ("accept: %s", strerror (errno));
+
+  if (cmd_args.debug)
+    fprintf (stderr, "Received ipmidetectd binary server request\n");
+
+  if (clients_count == IPMIDETECTD_CLIENTS_MAX)
+    {
+      if (cmd_args.debug)
+        fprintf (stderr, "Too many ipmidetectd binary server requests\n");
+      /* ignore potential error, done w/ pipe */
+      close (rhost_fd);
+      return;
+    }
+
+  if ((flags = fcntl (rhost_fd, F_GETFL, 0)) < 0
+      || fcntl (rhost_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    err_exit ("fcntl: %s", strerror (errno));
+
+  if (gettimeofday (&now, NULL) < 0)
+    err_exit ("gettimeofday: %s", strerror (errno));
+
+  client = &clients[clients_count++];
+  memset (client, '\0', sizeof (struct ipmidetectd_client));
+  client->fd = rhost_fd;
+  client->accepted = now.tv_sec;
+
+#if HAVE_SYS_EPOLL_H
+  _client_events (client, EPOLL_CTL_ADD);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/* Build the response to a query on the unix socket, see
+ * ipmidetect-protocol.h.  Returns length of response in binary_buf, 0
+ * if the request is malformed and should be dropped without a
+ * response.
+ */
+static unsigned int
+_ping_data_binary_response (const uint8_t *req)
+{
+  uint64_t epoch, generation;
+  uint32_t flags = 0, records_count = 0;
+  unsigned int i, len;
+
+  assert (req);
+  assert (nodes);
+  assert (nodes_count);
+  assert (binary_buf);
+
+  if (IPMIDETECT_PROTOCOL_GET_U32 (req) != IPMIDETECT_PROTOCOL_MAGIC
+      || IPMIDETECT_PROTOCOL_GET_U32 (req + 4) != IPMIDETECT_PROTOCOL_VERSION)
+    {
+      if (cmd_args.debug)
+        fprintf (stderr, "Invalid ipmidetectd binary server request\n");
+      return (0);
+    }
+
+  epoch = IPMIDETECT_PROTOCOL_GET_U64 (req + 8);
+  generation = IPMIDETECT_PROTOCOL_GET_U64 (req + 16);
+
+  if (epoch != nodes_epoch)
+    flags |= IPMIDETECT_PROTOCOL_FLAGS_FULL;
+
+  len = IPMIDETECT_PROTOCOL_RESPONSE_HDR_LEN;
+
+  if (flags & IPMIDETECT_PROTOCOL_FLAGS_FULL)
+    {
+      for (i = 0; i < nodes_count; i++)
+        {
+          unsigned int hostname_len = strlen (nodes[i].hostname) + 1;
+
+          memcpy (binary_buf + len, nodes[i].hostname, hostname_len);
+          len += hostname_len;
+        }
+    }
+
+  for (i = 0; i < nodes_count; i++)
+    {
+      if (!(flags & IPMIDETECT_PROTOCOL_FLAGS_FULL)
+          && nodes[i].generation <= generation)
+        continue;
+
+      IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + len, i);
+      IPMIDETECT_PROTOCOL_PUT_U64 (binary_buf + len + 4, nodes[i].last_received.tv_sec);
+      len += IPMIDETECT_PROTOCOL_RECORD_LEN;
+      records_count++;
+    }
+
+  assert (len <= binary_buflen);
+
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf, IPMIDETECT_PROTOCOL_MAGIC);
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + 4, IPMIDETECT_PROTOCOL_VERSION);
+  IPMIDETECT_PROTOCOL_PUT_U64 (binary_buf + 8, nodes_epoch);
+  IPMIDETECT_PROTOCOL_PUT_U64 (binary_buf + 16, nodes_generation);
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + 24, flags);
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + 28, nodes_count);
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + 32, (flags & IPMIDETECT_PROTOCOL_FLAGS_FULL) ? names_len : 0);
+  IPMIDETECT_PROTOCOL_PUT_U32 (binary_buf + 36, records_count);
+
+  return (len);
+}
+
+/* Returns 1 if the client is done and should be closed, 0 if not */
+static int
+_send_ping_data_binary (struct ipmidetectd_client *client)
+{
+  const uint8_t *buf;
+  unsigned int len;
+  ssize_t n;
+
+  assert (client);
+
+  if (!client->rsp)
+    {
+      if ((n = read (client->fd,
+                     client->req + client->req_len,
+                     IPMIDETECT_PROTOCOL_REQUEST_LEN - client->req_len)) < 0)
+        {
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return (0);
+          return (1);
+        }
+
+      /* client went away before sending a full request */
+      if (!n)
+        return (1);
+
+      client->req_len += n;
+      if (client->req_len < IPMIDETECT_PROTOCOL_REQUEST_LEN)
+        return (0);
+
+      if (!(len = _ping_data_binary_response (client->req)))
+        return (1);
+
+      buf = binary_buf;
+    }
+  else
+    {
+      buf = client->rsp + client->rsp_written;
+      len = client->rsp_len - client->rsp_written;
+    }
+
+  if ((n = write (client->fd, buf, len)) < 0)
+    {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+          /* client may have gone away, not our problem */
+          if (cmd_args.debug)
+            fprintf (stderr, "write: %s\n", strerror (errno));
+          return (1);
+        }
+      n = 0;
+    }
+
+  if (n == len)
+    return (1);
+
+  /* binary_buf is rebuilt for the next client, keep what is left */
+  if (!client->rsp)
+    {
+      if (!(client->rsp = (uint8_t *)malloc (len - n)))
+        err_exit ("malloc: %s", strerror (errno));
+      memcpy (client->rsp, buf + n, len - n);
+      client->rsp_len = len - n;
+      client->rsp_written = 0;
+#if HAVE_SYS_EPOLL_H
+      _client_events (client, EPOLL_CTL_MOD);
+#endif /* HAVE_SYS_EPOLL_H */
+    }
+  else
+    client->rsp_written += n;
+
+  return (0);
 }
 
 static void
@@ -568,60 +1257,117 @@ _signal_handler_callback (int sig)
 }
 
 static void
-_ipmidetectd_loop (void)
+_ipmidetectd_event (int fd)
 {
-  struct pollfd *pfds = NULL;
-  unsigned int i;
+  int i;
 
+  if (fd == server_fd)
+    _send_ping_data ();
+  else if (fd == unix_server_fd)
+    _accept_ping_data_binary ();
+  else if ((i = _client_find (fd)) >= 0)
+    {
+      if (!clients[i].done
+          && _send_ping_data_binary (&clients[i]))
+        clients[i].done = 1;
+    }
+  else
+    _receive_ping (fd);
+}
+
+#if HAVE_SYS_EPOLL_H
+static void
+_ipmidetectd_wait (unsigned int timeout_ms)
+{
+  struct epoll_event events[IPMIDETECTD_EVENTS_MAX];
+  int i, n;
+
+  assert (epfd >= 0);
+
+  if ((n = epoll_wait (epfd, events, IPMIDETECTD_EVENTS_MAX, timeout_ms)) < 0)
+    {
+      if (errno == EINTR)
+        return;
+      err_exit ("epoll_wait: %s", strerror (errno));
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      if (events[i].events & (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP))
+        _ipmidetectd_event (events[i].data.fd);
+    }
+
+  _clients_reap ();
+}
+#else /* !HAVE_SYS_EPOLL_H */
+static void
+_ipmidetectd_wait (unsigned int timeout_ms)
+{
+  unsigned int i, pfds_count;
+  int n;
+
+  assert (pfds);
+
+  for (i = 0; i < clients_count; i++)
+    {
+      pfds[events_count + i].fd = clients[i].fd;
+      pfds[events_count + i].events = clients[i].rsp ? POLLOUT : POLLIN;
+      pfds[events_count + i].revents = 0;
+    }
+  pfds_count = events_count + clients_count;
+
+  if ((n = poll (pfds, pfds_count, timeout_ms)) < 0)
+    {
+      if (errno == EINTR)
+        return;
+      err_exit ("poll: %s", strerror (errno));
+    }
+
+  for (i = 0; n && i < pfds_count; i++)
+    {
+      if (pfds[i].revents & (POLLIN | POLLOUT | POLLERR | POLLHUP))
+        _ipmidetectd_event (pfds[i].fd);
+    }
+
+  _clients_reap ();
+}
+#endif /* !HAVE_SYS_EPOLL_H */
+
+static void
+_ipmidetectd_loop (void)
+{
   _ipmidetectd_setup ();
 
   assert (nodes_count);
 
-  /* +1 fd for the server fd */
-  if (!(pfds = (struct pollfd *)malloc ((fds_count + 1)*sizeof (struct pollfd))))
-    err_exit ("malloc: %s", strerror (errno));
-
   while (exit_flag)
     {
-      struct timeval now, timeout;
-      unsigned int timeout_ms;
-      int num;
+      struct timeval now;
 
       if (gettimeofday (&now, NULL) < 0)
         err_exit ("gettimeofday: %s", strerror (errno));
 
-      if (timeval_gt (&now, &ipmidetectd_next_send))
-        {
-          _ipmidetectd_send_pings ();
-
-          if (gettimeofday (&now, NULL) < 0)
-            err_exit ("gettimeofday: %s", strerror (errno));
-
-          timeval_add_ms (&now, conf.ipmiping_period, &ipmidetectd_next_send);
-        }
+      _ipmidetectd_send_pings (&now);
 
-      _setup_pfds (pfds);
+      if (gettimeofday (&now, NULL) < 0)
+        err_exit ("gettimeofday: %s", strerror (errno));
 
-      timeval_sub (&ipmidetectd_next_send, &now, &timeout);
-      timeval_millisecond_calc (&timeout, &timeout_ms);
+      _clients_expire (&now);
 
-      if ((num = poll (pfds, fds_count + 1, timeout_ms)) < 0)
-        err_exit ("poll: %s", strerror (errno));
+      _ipmidetectd_wait (_ping_timeout (&now));
+    }
 
-      if (num)
-        {
-          for (i = 0; i < fds_count; i++)
-            {
-              if (pfds[i].revents & POLLERR)
-                _receive_ping (fds[i]);
-              else if (pfds[i].revents & POLLIN)
-                _receive_ping (fds[i]);
-            }
+  while (clients_count)
+    _client_close (0);
 
-          if (pfds[fds_count].revents & POLLIN)
-            _send_ping_data ();
-        }
+  if (unix_server_fd >= 0)
+    {
+      /* ignore potential error, exiting */
+      close (unix_server_fd);
+      unlink (conf.ipmidetectd_server_socket);
     }
+
+  _table_cleanup ();
 }
 
 int
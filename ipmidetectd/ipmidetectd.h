@@ -42,10 +42,14 @@ enum ipmidetectd_argp_option_keys
     IPMIDETECTD_DEBUG_KEY = 'd',
   };
 
+#define IPMIDETECTD_MAXPATHLEN 1024
+
 struct ipmidetectd_config
 {
   int ipmiping_period;
   int ipmidetectd_server_port;
+  char ipmidetectd_server_socket[IPMIDETECTD_MAXPATHLEN+1];
+  char ipmidetectd_shared_table[IPMIDETECTD_MAXPATHLEN+1];
   hostlist_t hosts;
 };
 
@@ -430,6 +430,12 @@ struct ipmipower_powercmd {
 
   /* for oem power control to the same node */
   struct ipmipower_powercmd *next;
+
+  /* when the command must next be processed, and its index in
+   * the timer heap (-1 if not in the heap)
+   */
+  struct timeval timer_expire;
+  int timer_index;
 };
 
 struct ipmipower_connection_extra_arg
@@ -471,6 +477,15 @@ struct ipmipower_connection
 
   /* for eliminate option */
   int skip;
+
+  /* power command currently executing on this connection */
+  struct ipmipower_powercmd *powercmd;
+
+  /* for shared sockets, next connection with the same destaddr and
+   * the session id last sent
+   */
+  struct ipmipower_connection *shared_next;
+  uint32_t ipmi_session_id;
 };
 
 typedef struct ipmipower_powercmd *ipmipower_powercmd_t;
@@ -502,6 +517,7 @@ enum ipmipower_argp_option_keys
     PING_PACKET_COUNT_KEY = 174,
     PING_PERCENT_KEY = 175,
     PING_CONSEC_COUNT_KEY = 176,
+    SHARED_SOCKETS_KEY = 177,
   };
 
 struct ipmipower_arguments
@@ -524,6 +540,7 @@ struct ipmipower_arguments
   unsigned int ping_packet_count;
   unsigned int ping_percent;
   unsigned int ping_consec_count;
+  unsigned int shared_sockets;
 };
 
 #endif /* IPMIPOWER_H */
@@ -126,9 +126,11 @@ static struct argp_option cmdline_options[] =
       "Specify the ping percent value.", 57},
     { "ping-consec-count", PING_CONSEC_COUNT_KEY, "COUNT", 0,
       "Specify the ping consecutive count.", 58},
+    { "shared-sockets", SHARED_SOCKETS_KEY, "COUNT", 0,
+      "Specify the number of sockets to share amongst all hosts.", 59},
 #ifndef NDEBUG
     { "rmcpdump", RMCPDUMP_KEY, 0, 0,
-      "Turn on RMCP packet dump output.", 59},
+      "Turn on RMCP packet dump output.", 60},
 #endif
     { NULL, 0, NULL, 0, NULL, 0}
   };
@@ -312,6 +314,18 @@ cmdline_parse (int key,
         }
       cmd_args->ping_consec_count = tmp;
       break;
+    case SHARED_SOCKETS_KEY:       /* --shared-sockets */
+      errno = 0;
+      tmp = strtol (arg, &endptr, 10);
+      if (errno
+	  || endptr[0] != '\0'
+          || tmp < 0)
+        {
+          fprintf (stderr, "shared sockets count invalid");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->shared_sockets = tmp;
+      break;
       /* removed legacy short options */
     default:
       return (common_parse_opt (key, arg, &(cmd_args->common_args)));
@@ -378,6 +392,8 @@ _ipmipower_config_file_parse (struct ipmipower_arguments *cmd_args)
     cmd_args->ping_percent = config_file_data.ping_percent;
   if (config_file_data.ping_consec_count_count)
     cmd_args->ping_consec_count = config_file_data.ping_consec_count;
+  if (config_file_data.shared_sockets_count)
+    cmd_args->shared_sockets = config_file_data.shared_sockets;
 }
 
 static void
@@ -447,6 +463,7 @@ ipmipower_argp_parse (int argc, char **argv, struct ipmipower_arguments *cmd_arg
   cmd_args->ping_packet_count = 10;
   cmd_args->ping_percent = 50;
   cmd_args->ping_consec_count = 5;
+  cmd_args->shared_sockets = 0;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -55,11 +55,15 @@
 #include "ipmipower_connection.h"
 #include "ipmipower_error.h"
 #include "ipmipower_output.h"
+#include "ipmipower_powercmd.h"
 #include "ipmipower_util.h"
 
 #include "freeipmi-portability.h"
 #include "cbuf.h"
+#include "dgram.h"
+#include "hash.h"
 #include "hostlist.h"
+#include "secure.h"
 
 extern int h_errno;
 
@@ -70,6 +74,34 @@ extern struct ipmipower_arguments cmd_args;
 #define IPMIPOWER_MIN_CONNECTION_BUF 1024*2
 #define IPMIPOWER_MAX_CONNECTION_BUF 1024*4
 
+/* best effort, many hosts may respond to a shared socket at once */
+#define IPMIPOWER_SHARED_RCVBUF      1024*1024*4
+
+/* Shared sockets and the source address hash used to demultiplex
+ * packets received on them.  Shared between all connection arrays,
+ * since a new array is created before the old one is destroyed when
+ * hostnames are changed in interactive mode.
+ */
+static int *shared_fds = NULL;
+static unsigned int shared_fds_len = 0;
+static unsigned int shared_arrays_count = 0;
+static hash_t shared_hash = NULL;
+
+#define IPMIPOWER_SEND_QUEUE_LEN     64
+
+/* Packets waiting to be sent, the packet itself stays in the cbuf
+ * until it is sent.
+ */
+struct ipmipower_connection_send
+{
+  struct ipmipower_connection *ic;
+  cbuf_t cbuf;
+};
+
+static struct ipmipower_connection_send *send_queue = NULL;
+static unsigned int send_queue_len = 0;
+static unsigned int send_queue_count = 0;
+
 /* _clean_fd
  * - Remove any extraneous packets sitting on the fd buf
  */
@@ -111,7 +143,9 @@ ipmipower_connection_clear (struct ipmipower_connection *ic)
 {
   assert (ic);
 
-  _clean_fd (ic->ipmi_fd);
+  /* Can't clean a shared socket, packets may belong to other hosts */
+  if (!ipmipower_connection_shared_fd (ic->ipmi_fd))
+    _clean_fd (ic->ipmi_fd);
   if (cbuf_drop (ic->ipmi_in, -1) < 0)
     {
       IPMIPOWER_ERROR (("cbuf_drop: %s", strerror (errno)));
@@ -125,6 +159,631 @@ ipmipower_connection_clear (struct ipmipower_connection *ic)
   return;
 }
 
+/* _packet_session_id
+ * - get session id from the session header of an IPMI packet
+ * - Returns 0 if not found, which is also the session id of
+ *   packets outside of a session
+ */
+static uint32_t
+_packet_session_id (const uint8_t *buf, unsigned int len)
+{
+  unsigned int offset;
+
+  /* IPMI 1.5 - 4 byte RMCP header, authentication type, 4 byte
+   * session sequence number, then session id
+   *
+   * IPMI 2.0 - 4 byte RMCP header, authentication type, payload
+   * type, then session id
+   */
+  if (ipmi_is_ipmi_2_0_packet (buf, len) > 0)
+    offset = 6;
+  else
+    offset = 9;
+
+  if (len < offset + 4)
+    return (0);
+
+  return ((uint32_t)buf[offset]
+          | ((uint32_t)buf[offset + 1] << 8)
+          | ((uint32_t)buf[offset + 2] << 16)
+          | ((uint32_t)buf[offset + 3] << 24));
+}
+
+/* _send_queue_add
+ * - queue the packet stored in cbuf, it is sent on the next
+ *   ipmipower_connection_flush()
+ */
+static void
+_send_queue_add (struct ipmipower_connection *ic, cbuf_t cbuf)
+{
+  if (send_queue_count == send_queue_len)
+    {
+      struct ipmipower_connection_send *tmp;
+      unsigned int len = send_queue_len ? send_queue_len * 2 : IPMIPOWER_SEND_QUEUE_LEN;
+
+      if (!(tmp = (struct ipmipower_connection_send *)realloc (send_queue, sizeof (struct ipmipower_connection_send) * len)))
+        {
+          IPMIPOWER_ERROR (("realloc: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+      send_queue = tmp;
+      send_queue_len = len;
+    }
+
+  send_queue[send_queue_count].ic = ic;
+  send_queue[send_queue_count].cbuf = cbuf;
+  send_queue_count++;
+}
+
+static int
+_send_queue_cmp (const void *a, const void *b)
+{
+  const struct ipmipower_connection_send *sa = a;
+  const struct ipmipower_connection_send *sb = b;
+  int fda = (sa->cbuf == sa->ic->ipmi_out) ? sa->ic->ipmi_fd : sa->ic->ping_fd;
+  int fdb = (sb->cbuf == sb->ic->ipmi_out) ? sb->ic->ipmi_fd : sb->ic->ping_fd;
+
+  if (fda < fdb)
+    return (-1);
+  if (fda > fdb)
+    return (1);
+  return (0);
+}
+
+/* _send_batch
+ * - send datagrams queued up for fd
+ */
+static void
+_send_batch (int fd, struct dgram *dgrams, unsigned int count)
+{
+  unsigned int sent = 0;
+
+  /* ipmi_lan_sendto and ipmi_rmcpplus_sendto are identical to
+   * sendto(), so 1.5 and 2.0 packets can be batched together.
+   */
+  while (sent < count)
+    {
+      int rv;
+
+      if ((rv = dgram_send_batch (fd, dgrams + sent, count - sent)) < 0)
+        {
+          IPMIPOWER_ERROR (("dgram_send_batch: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+      sent += rv;
+    }
+}
+
+void
+ipmipower_connection_flush (void)
+{
+  static uint8_t bufs[DGRAM_BATCH_MAX][IPMIPOWER_PACKET_BUFLEN];
+  struct dgram dgrams[DGRAM_BATCH_MAX];
+  unsigned int i, count = 0;
+  int batch_fd = -1;
+
+  if (!send_queue_count)
+    return;
+
+  /* group packets going out the same socket, only matters if sockets
+   * are shared
+   */
+  if (cmd_args.shared_sockets)
+    qsort (send_queue,
+           send_queue_count,
+           sizeof (struct ipmipower_connection_send),
+           _send_queue_cmp);
+
+  for (i = 0; i < send_queue_count; i++)
+    {
+      struct ipmipower_connection *ic = send_queue[i].ic;
+      cbuf_t cbuf = send_queue[i].cbuf;
+      int fd = (cbuf == ic->ipmi_out) ? ic->ipmi_fd : ic->ping_fd;
+      int n;
+
+      if (count && (fd != batch_fd || count == DGRAM_BATCH_MAX))
+        {
+          _send_batch (batch_fd, dgrams, count);
+          count = 0;
+        }
+
+      if ((n = cbuf_read (cbuf, bufs[count], IPMIPOWER_PACKET_BUFLEN)) < 0)
+        {
+          IPMIPOWER_ERROR (("cbuf_read: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      if (n == IPMIPOWER_PACKET_BUFLEN)
+        {
+          IPMIPOWER_ERROR (("cbuf_read: buffer full"));
+          exit (EXIT_FAILURE);
+        }
+
+      /* cbuf should be empty now */
+      if (!cbuf_is_empty (cbuf))
+        {
+          IPMIPOWER_ERROR (("cbuf not empty"));
+          exit (EXIT_FAILURE);
+        }
+
+      /* dropped by ipmipower_connection_clear() since it was queued */
+      if (!n)
+        continue;
+
+      /* Responses carry the same session id in IPMI 1.5 */
+      if (cmd_args.shared_sockets && cbuf == ic->ipmi_out)
+        ic->ipmi_session_id = _packet_session_id (bufs[count], n);
+
+      dgrams[count].buf = bufs[count];
+      dgrams[count].len = n;
+      memcpy (&(dgrams[count].addr), &(ic->destaddr), sizeof (struct sockaddr_in));
+      batch_fd = fd;
+      count++;
+    }
+
+  if (count)
+    _send_batch (batch_fd, dgrams, count);
+
+  send_queue_count = 0;
+
+  secure_memset (bufs, '\0', sizeof (bufs));
+}
+
+void
+ipmipower_connection_send_ipmi (ipmipower_connection_t ic)
+{
+  assert (ic);
+
+  _send_queue_add (ic, ic->ipmi_out);
+}
+
+void
+ipmipower_connection_send_ping (ipmipower_connection_t ic)
+{
+  assert (ic);
+
+  _send_queue_add (ic, ic->ping_out);
+}
+
+/* _cbuf_store
+ * - store a received packet in cbuf, dropping anything not yet read
+ */
+static void
+_cbuf_store (cbuf_t cbuf, const void *buf, int len)
+{
+  int n, dropped = 0;
+
+  /* cbuf should be empty, but if it isn't, empty it */
+  if (!cbuf_is_empty (cbuf))
+    {
+      IPMIPOWER_DEBUG (("cbuf not empty, draining"));
+      do
+        {
+          uint8_t tempbuf[IPMIPOWER_PACKET_BUFLEN];
+          
+          if (cbuf_read (cbuf, tempbuf, IPMIPOWER_PACKET_BUFLEN) < 0)
+            {
+              IPMIPOWER_ERROR (("cbuf_read: %s", strerror (errno)));
+              exit (EXIT_FAILURE);
+            }
+        } while(!cbuf_is_empty (cbuf));
+    }
+
+  if ((n = cbuf_write (cbuf, (void *)buf, len, &dropped)) < 0)
+    {
+      IPMIPOWER_ERROR (("cbuf_write: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  if (n != len)
+    {
+      IPMIPOWER_ERROR (("cbuf_write: rv=%d n=%d", len, n));
+      exit (EXIT_FAILURE);
+    }
+
+  if (dropped)
+    IPMIPOWER_DEBUG (("cbuf_write: read dropped %d bytes", dropped));
+}
+
+/* _recvfrom
+ * - receive a packet on fd into buf
+ * - Returns length of packet, 0 if no packet should be stored
+ */
+static int
+_recvfrom (int fd, uint8_t *buf, struct sockaddr_in *from)
+{
+  unsigned int fromlen = sizeof (struct sockaddr_in);
+  int rv;
+
+  do
+    {
+      /* For receive side, ipmi_lan_recvfrom and
+       * ipmi_rmcpplus_recvfrom are identical.  So we just use
+       * ipmi_lan_recvfrom for both.
+       *
+       * In event of future change, should use util functions
+       * ipmi_is_ipmi_1_5_packet or ipmi_is_ipmi_2_0_packet
+       * appropriately.
+       */
+      rv = ipmi_lan_recvfrom (fd,
+                              buf,
+                              IPMIPOWER_PACKET_BUFLEN,
+                              0,
+                              (struct sockaddr *)from,
+                              &fromlen);
+    } while (rv < 0 && errno == EINTR);
+
+  /* achu & hliebig:
+   *
+   * Premise from ipmitool (http://ipmitool.sourceforge.net/)
+   *
+   * On some OSes (it seems Unixes), the behavior is to not return
+   * port denied errors up to the client for UDP responses (i.e. you
+   * need to timeout).  But on some OSes (it seems Windows), the
+   * behavior is to return port denied errors up to the user for UDP
+   * responses via ECONNRESET or ECONNREFUSED.
+   *
+   * If this were just the case, we could return or handle errors
+   * properly and move on.  However, it's not the case.
+   *
+   * According to Ipmitool, on some motherboards, both the OS and the
+   * BMC are capable of responding to an IPMI request.  That means you
+   * can get an ECONNRESET or ECONNREFUSED, then later on, get your
+   * real IPMI response.
+   *
+   * Our solution is copied from Ipmitool, we'll ignore some specific
+   * errors and try to read again.
+   *
+   * If the ECONNREFUSED or ECONNRESET is from the OS, but we will get
+   * an IPMI response later, the recvfrom later on gets the packet we
+   * want.
+   *
+   * If the ECONNREFUSED or ECONNRESET is from the OS but there is no
+   * BMC (or IPMI disabled, etc.), just do the recvfrom again to
+   * eventually get a timeout, which is the behavior we'd like.
+   */
+  if (rv < 0
+      && (errno == ECONNRESET
+          || errno == ECONNREFUSED))
+    {
+      IPMIPOWER_DEBUG (("ipmi_lan_recvfrom: connection refused: %s", strerror (errno)));
+      return (0);
+    }
+
+  if (rv < 0)
+    {
+      IPMIPOWER_ERROR (("ipmi_lan_recvfrom: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  if (!rv)
+    {
+      IPMIPOWER_ERROR (("ipmi_lan_recvfrom: EOF"));
+      exit (EXIT_FAILURE);
+    }
+
+  /* Don't store if this packet is strange for some reason */
+  if (from->sin_family != AF_INET)
+    return (0);
+
+  return (rv);
+}
+
+void
+ipmipower_connection_recvfrom (cbuf_t cbuf, int fd, struct sockaddr_in *srcaddr)
+{
+  uint8_t buf[IPMIPOWER_PACKET_BUFLEN];
+  struct sockaddr_in from;
+  int rv;
+
+  if (!(rv = _recvfrom (fd, buf, &from)))
+    return;
+
+  if (from.sin_addr.s_addr != srcaddr->sin_addr.s_addr)
+    return;
+
+  _cbuf_store (cbuf, buf, rv);
+}
+
+/* _shared_demux
+ * - store a packet received on a shared socket with the
+ *   connection(s) it belongs to
+ */
+static void
+_shared_demux (const uint8_t *buf, int rv, struct sockaddr_in *from)
+{
+  struct ipmipower_connection *ic;
+  uint32_t session_id;
+
+  assert (shared_hash);
+
+  if (from->sin_family != AF_INET || !rv)
+    return;
+
+  if (!(ic = hash_find (shared_hash, from)))
+    {
+      IPMIPOWER_DEBUG (("packet from unknown address %s:%u",
+                        inet_ntoa (from->sin_addr),
+                        ntohs (from->sin_port)));
+      return;
+    }
+
+  /* RMCP pongs are matched to pings by message tag, so every host
+   * behind this address can be given a copy.
+   */
+  if (rv > 3 && buf[3] == RMCP_HDR_MESSAGE_CLASS_ASF)
+    {
+      for (; ic; ic = ic->shared_next)
+        _cbuf_store (ic->ping_in, buf, rv);
+      return;
+    }
+
+  /* Common case, only one host at this address */
+  if (!ic->shared_next)
+    {
+      _cbuf_store (ic->ipmi_in, buf, rv);
+      ipmipower_powercmd_wakeup (ic);
+      return;
+    }
+
+  /* Multiple hostnames resolved to the same address and port.  Pass
+   * the packet to each power command in the matching session.
+   * Session ids of 0 are outside of a session, the power commands
+   * sort those out by sequence numbers like any stale packet.
+   */
+  session_id = _packet_session_id (buf, rv);
+  for (; ic; ic = ic->shared_next)
+    {
+      if (!ic->powercmd)
+        continue;
+
+      if (session_id)
+        {
+          if (cmd_args.common_args.driver_type == IPMI_DEVICE_LAN_2_0)
+            {
+              if (session_id != ic->powercmd->remote_console_session_id)
+                continue;
+            }
+          else
+            {
+              if (session_id != ic->ipmi_session_id)
+                continue;
+            }
+        }
+
+      _cbuf_store (ic->ipmi_in, buf, rv);
+      ipmipower_powercmd_wakeup (ic);
+    }
+}
+
+void
+ipmipower_connection_shared_recvfrom (int fd)
+{
+  static uint8_t bufs[DGRAM_BATCH_MAX][IPMIPOWER_PACKET_BUFLEN];
+  struct dgram dgrams[DGRAM_BATCH_MAX];
+  int i, rv;
+
+  /* Drain everything queued on the socket.  A host that has two
+   * packets queued only keeps the later one, same as with a private
+   * socket read before the power command is processed.
+   */
+  do
+    {
+      for (i = 0; i < DGRAM_BATCH_MAX; i++)
+        {
+          dgrams[i].buf = bufs[i];
+          dgrams[i].len = IPMIPOWER_PACKET_BUFLEN;
+        }
+
+      if ((rv = dgram_recv_batch (fd, dgrams, DGRAM_BATCH_MAX)) < 0)
+        {
+          /* See comments in _recvfrom() */
+          if (errno == ECONNRESET
+              || errno == ECONNREFUSED)
+            {
+              IPMIPOWER_DEBUG (("dgram_recv_batch: connection refused: %s", strerror (errno)));
+              return;
+            }
+
+          IPMIPOWER_ERROR (("dgram_recv_batch: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      for (i = 0; i < rv; i++)
+        _shared_demux (dgrams[i].buf, dgrams[i].len, &(dgrams[i].addr));
+    } while (rv == DGRAM_BATCH_MAX);
+}
+
+int
+ipmipower_connection_shared_fd (int fd)
+{
+  unsigned int i;
+
+  for (i = 0; i < shared_fds_len; i++)
+    {
+      if (shared_fds[i] == fd)
+        return (1);
+    }
+  return (0);
+}
+
+static unsigned int
+_shared_hash_key (const void *key)
+{
+  const struct sockaddr_in *addr = key;
+
+  return ((unsigned int)addr->sin_addr.s_addr ^ ((unsigned int)addr->sin_port << 16));
+}
+
+static int
+_shared_hash_cmp (const void *key1, const void *key2)
+{
+  const struct sockaddr_in *addr1 = key1;
+  const struct sockaddr_in *addr2 = key2;
+
+  return (addr1->sin_addr.s_addr != addr2->sin_addr.s_addr
+          || addr1->sin_port != addr2->sin_port);
+}
+
+/* _shared_sockets_setup
+ * - open the shared sockets if not already open
+ * - Returns 0 on success, -1 on EMFILE
+ */
+static int
+_shared_sockets_setup (unsigned int host_count)
+{
+  struct sockaddr_in srcaddr;
+  int rcvbuf = IPMIPOWER_SHARED_RCVBUF;
+  unsigned int i;
+
+  assert (cmd_args.shared_sockets);
+
+  if (shared_fds)
+    return (0);
+
+  if (!(shared_fds = (int *)malloc (sizeof (int) * cmd_args.shared_sockets)))
+    {
+      IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  bzero (&srcaddr, sizeof (struct sockaddr_in));
+  srcaddr.sin_family = AF_INET;
+  srcaddr.sin_port = htons (0);
+  srcaddr.sin_addr.s_addr = htonl (INADDR_ANY);
+
+  for (i = 0; i < cmd_args.shared_sockets; i++)
+    {
+      if ((shared_fds[i] = socket (AF_INET, SOCK_DGRAM, 0)) < 0)
+        {
+          if (errno == EMFILE)
+            {
+              IPMIPOWER_DEBUG (("file descriptor limit reached"));
+              goto cleanup;
+            }
+
+          IPMIPOWER_ERROR (("socket: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      shared_fds_len++;
+
+      if (bind (shared_fds[i], &srcaddr, sizeof (struct sockaddr_in)) < 0)
+        {
+          IPMIPOWER_ERROR (("bind: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      /* ignore potential error, not fatal */
+      setsockopt (shared_fds[i], SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf));
+
+      ipmipower_event_register (shared_fds[i], IPMIPOWER_EVENT_IN, NULL);
+    }
+
+  if (!(shared_hash = hash_create (host_count,
+                                   _shared_hash_key,
+                                   _shared_hash_cmp,
+                                   NULL)))
+    {
+      IPMIPOWER_ERROR (("hash_create: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  return (0);
+
+ cleanup:
+  for (i = 0; i < shared_fds_len; i++)
+    {
+      ipmipower_event_unregister (shared_fds[i]);
+      /* ignore potential error, error path */
+      close (shared_fds[i]);
+    }
+  free (shared_fds);
+  shared_fds = NULL;
+  shared_fds_len = 0;
+  errno = EMFILE;
+  return (-1);
+}
+
+static void
+_shared_sockets_cleanup (void)
+{
+  unsigned int i;
+
+  if (shared_arrays_count || !shared_fds)
+    return;
+
+  for (i = 0; i < shared_fds_len; i++)
+    {
+      ipmipower_event_unregister (shared_fds[i]);
+      /* ignore potential error, cleanup path */
+      close (shared_fds[i]);
+    }
+  free (shared_fds);
+  shared_fds = NULL;
+  shared_fds_len = 0;
+
+  hash_destroy (shared_hash);
+  shared_hash = NULL;
+}
+
+static void
+_shared_hash_insert (struct ipmipower_connection *ic)
+{
+  struct ipmipower_connection *ictmp;
+
+  assert (ic);
+  assert (shared_hash);
+
+  ic->shared_next = NULL;
+
+  if ((ictmp = hash_find (shared_hash, &(ic->destaddr))))
+    {
+      while (ictmp->shared_next)
+        ictmp = ictmp->shared_next;
+      ictmp->shared_next = ic;
+      return;
+    }
+
+  if (!hash_insert (shared_hash, &(ic->destaddr), ic))
+    {
+      IPMIPOWER_ERROR (("hash_insert: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+}
+
+static void
+_shared_hash_remove (struct ipmipower_connection *ic)
+{
+  struct ipmipower_connection *ictmp;
+
+  assert (ic);
+  assert (shared_hash);
+
+  if (!(ictmp = hash_find (shared_hash, &(ic->destaddr))))
+    return;
+
+  if (ictmp == ic)
+    {
+      /* key is stored in the head of the chain, so re-insert */
+      hash_remove (shared_hash, &(ic->destaddr));
+      if (ic->shared_next)
+        {
+          if (!hash_insert (shared_hash, &(ic->shared_next->destaddr), ic->shared_next))
+            {
+              IPMIPOWER_ERROR (("hash_insert: %s", strerror (errno)));
+              exit (EXIT_FAILURE);
+            }
+        }
+      return;
+    }
+
+  while (ictmp->shared_next && ictmp->shared_next != ic)
+    ictmp = ictmp->shared_next;
+  if (ictmp->shared_next)
+    ictmp->shared_next = ic->shared_next;
+}
+
 static int
 _connection_setup (struct ipmipower_connection *ic, const char *hostname)
 {
@@ -140,6 +799,10 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
   assert (ic);
   assert (hostname);
 
+  /* Shared sockets are assigned by the caller */
+  if (cmd_args.shared_sockets)
+    goto buffers;
+
   /* Don't use wrapper function, need to exit cleanly on EMFILE errno */
 
   errno = 0;
@@ -185,6 +848,7 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
       exit (EXIT_FAILURE);
     }
 
+ buffers:
   if (!(ic->ipmi_in  = cbuf_create (IPMIPOWER_MIN_CONNECTION_BUF,
                                     IPMIPOWER_MAX_CONNECTION_BUF)))
     {
@@ -561,6 +1225,12 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
   if ((host_count = _hostname_count (hostname)) < 0)
     return (NULL);
 
+  if (cmd_args.shared_sockets)
+    {
+      if (_shared_sockets_setup (host_count) < 0)
+        return (NULL);
+    }
+
   if (!(ics = (struct ipmipower_connection *)malloc (sizeof (struct ipmipower_connection) * host_count)))
     {
       IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
@@ -755,9 +1425,30 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
 	    }
         }
       free (ics);
+      if (cmd_args.shared_sockets)
+        _shared_sockets_cleanup ();
       return (NULL);
     }
 
+  if (cmd_args.shared_sockets)
+    {
+      for (i = 0; i < index; i++)
+        {
+          ics[i].ipmi_fd = shared_fds[i % shared_fds_len];
+          ics[i].ping_fd = ics[i].ipmi_fd;
+          _shared_hash_insert (&ics[i]);
+        }
+      shared_arrays_count++;
+    }
+  else
+    {
+      for (i = 0; i < index; i++)
+        {
+          ipmipower_event_register (ics[i].ipmi_fd, IPMIPOWER_EVENT_IN, &ics[i]);
+          ipmipower_event_register (ics[i].ping_fd, IPMIPOWER_EVENT_IN, &ics[i]);
+        }
+    }
+
   *len = index;
   return (ics);
 }
@@ -771,12 +1462,32 @@ ipmipower_connection_array_destroy (struct ipmipower_connection *ics,
   if (!ics)
     return;
 
+  /* queued packets may reference these connections */
+  ipmipower_connection_flush ();
+  free (send_queue);
+  send_queue = NULL;
+  send_queue_len = 0;
+
   for (i = 0; i < ics_len; i++)
     {
-      /* ignore potential error, cleanup path */
-      close (ics[i].ipmi_fd);
-      /* ignore potential error, cleanup path */
-      close (ics[i].ping_fd);
+      if (cmd_args.shared_sockets)
+        _shared_hash_remove (&ics[i]);
+
+      /* ipmi_fd may have been replaced by a private socket, see
+       * _retry_packets() in ipmipower_powercmd.c
+       */
+      if (!ipmipower_connection_shared_fd (ics[i].ipmi_fd))
+        {
+          ipmipower_event_unregister (ics[i].ipmi_fd);
+          /* ignore potential error, cleanup path */
+          close (ics[i].ipmi_fd);
+        }
+      if (!ipmipower_connection_shared_fd (ics[i].ping_fd))
+        {
+          ipmipower_event_unregister (ics[i].ping_fd);
+          /* ignore potential error, cleanup path */
+          close (ics[i].ping_fd);
+        }
       cbuf_destroy (ics[i].ipmi_in);
       cbuf_destroy (ics[i].ipmi_out);
       cbuf_destroy (ics[i].ping_in);
@@ -800,6 +1511,12 @@ ipmipower_connection_array_destroy (struct ipmipower_connection *ics,
 	}
     }
   free (ics);
+
+  if (cmd_args.shared_sockets)
+    {
+      shared_arrays_count--;
+      _shared_sockets_cleanup ();
+    }
 }
 
 int
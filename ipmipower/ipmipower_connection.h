@@ -34,8 +34,45 @@
  */
 void ipmipower_connection_clear (ipmipower_connection_t ic);
 
+/* ipmipower_connection_send_ipmi
+ * - queue the packet stored in ipmi_out to be sent
+ */
+void ipmipower_connection_send_ipmi (ipmipower_connection_t ic);
+
+/* ipmipower_connection_send_ping
+ * - queue the packet stored in ping_out to be sent
+ */
+void ipmipower_connection_send_ping (ipmipower_connection_t ic);
+
+/* ipmipower_connection_flush
+ * - send all queued packets, batching packets going out the same
+ *   socket
+ */
+void ipmipower_connection_flush (void);
+
+/* ipmipower_connection_recvfrom
+ * - receive a packet on fd and store it in cbuf
+ * - packets not from srcaddr are dropped
+ */
+void ipmipower_connection_recvfrom (cbuf_t cbuf,
+                                    int fd,
+                                    struct sockaddr_in *srcaddr);
+
+/* ipmipower_connection_shared_recvfrom
+ * - receive a packet on a shared socket and store it with the
+ *   connection(s) it belongs to
+ * - power commands receiving a packet are woken up
+ */
+void ipmipower_connection_shared_recvfrom (int fd);
+
+/* ipmipower_connection_shared_fd
+ * - Returns 1 if fd is a shared socket, 0 if not
+ */
+int ipmipower_connection_shared_fd (int fd);
+
 /* ipmipower_connection_array_create
  * - Create ipmipower_connection array
+ * - Connection fds are registered with the event set
  * - Returns pointer on success, NULL on error.
  */
 struct ipmipower_connection *ipmipower_connection_array_create (const char *hostname,
@@ -71,30 +71,130 @@
 
 extern struct ipmipower_arguments cmd_args;
 
-/* Queue of all pending power commands */
-static List pending = NULL;
-
-/* Queue of power commands to be added to the pending, for serializing
- * OEM power control to the same host
+/* Min-heap of executing power commands, ordered by the time each
+ * must next be processed (i.e. retransmission or session timeout).
+ * Commands that receive a packet are moved to the top of the heap,
+ * so each pass only processes commands with something to do.
  */
-static List add_to_pending = NULL;
+static ipmipower_powercmd_t *timer_heap = NULL;
+static unsigned int timer_heap_count = 0;
+static unsigned int timer_heap_len = 0;
+
+/* Commands pulled off the timer heap during a single pass */
+static ipmipower_powercmd_t *timer_expired = NULL;
+
+/* Queue of power commands waiting for a fanout slot */
+static List waiting = NULL;
+
+/* Count of all pending power commands, executing and waiting */
+static unsigned int pending_count = 0;
 
 /* Count of currently executing power commands for fanout */
 static unsigned int executing_count = 0;
 
-static int
-_find_ipmipower_powercmd (void *x, void *key)
+static void
+_timer_heap_swap (unsigned int a, unsigned int b)
 {
-  ipmipower_powercmd_t ip;
-  char *hostname;
+  ipmipower_powercmd_t tmp;
 
-  assert (x);
-  assert (key);
-  
-  ip = (ipmipower_powercmd_t)x;
-  hostname = (char *)key;
+  tmp = timer_heap[a];
+  timer_heap[a] = timer_heap[b];
+  timer_heap[b] = tmp;
+  timer_heap[a]->timer_index = a;
+  timer_heap[b]->timer_index = b;
+}
+
+static void
+_timer_heap_up (unsigned int index)
+{
+  while (index)
+    {
+      unsigned int parent = (index - 1) / 2;
+
+      if (!timeval_lt (&(timer_heap[index]->timer_expire),
+                       &(timer_heap[parent]->timer_expire)))
+        break;
+
+      _timer_heap_swap (index, parent);
+      index = parent;
+    }
+}
+
+static void
+_timer_heap_down (unsigned int index)
+{
+  while (1)
+    {
+      unsigned int left = index * 2 + 1;
+      unsigned int right = index * 2 + 2;
+      unsigned int smallest = index;
+
+      if (left < timer_heap_count
+          && timeval_lt (&(timer_heap[left]->timer_expire),
+                         &(timer_heap[smallest]->timer_expire)))
+        smallest = left;
+      if (right < timer_heap_count
+          && timeval_lt (&(timer_heap[right]->timer_expire),
+                         &(timer_heap[smallest]->timer_expire)))
+        smallest = right;
+
+      if (smallest == index)
+        break;
+
+      _timer_heap_swap (index, smallest);
+      index = smallest;
+    }
+}
+
+static void
+_timer_heap_insert (ipmipower_powercmd_t ip)
+{
+  assert (ip);
+  assert (ip->timer_index < 0);
+
+  if (timer_heap_count == timer_heap_len)
+    {
+      unsigned int len = timer_heap_len ? timer_heap_len * 2 : 64;
+
+      if (!(timer_heap = (ipmipower_powercmd_t *)realloc (timer_heap,
+                                                           len * sizeof (ipmipower_powercmd_t))))
+        {
+          IPMIPOWER_ERROR (("realloc: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      if (!(timer_expired = (ipmipower_powercmd_t *)realloc (timer_expired,
+                                                              len * sizeof (ipmipower_powercmd_t))))
+        {
+          IPMIPOWER_ERROR (("realloc: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+
+      timer_heap_len = len;
+    }
 
-  return (!strcasecmp (ip->ic->hostname, hostname));
+  ip->timer_index = timer_heap_count;
+  timer_heap[timer_heap_count++] = ip;
+  _timer_heap_up (ip->timer_index);
+}
+
+static void
+_timer_heap_remove (ipmipower_powercmd_t ip)
+{
+  unsigned int index;
+
+  assert (ip);
+  assert (ip->timer_index >= 0 && ip->timer_index < timer_heap_count);
+
+  index = ip->timer_index;
+  timer_heap_count--;
+  if (index != timer_heap_count)
+    {
+      _timer_heap_swap (index, timer_heap_count);
+      _timer_heap_down (index);
+      _timer_heap_up (index);
+    }
+  ip->timer_index = -1;
 }
 
 static void
@@ -171,10 +271,11 @@ _destroy_ipmipower_powercmd (void *x)
 
   free (ip->extra_arg);
 
-  /* Any additional queued commands should be moved to add_to_pending
-   * before destroy
+  /* Any additional queued commands are started before their
+   * predecessor is destroyed, so they only remain on cleanup.
    */
-  assert (!ip->next);
+  if (ip->next)
+    _destroy_ipmipower_powercmd (ip->next);
 
   free (ip);
 }
@@ -182,31 +283,65 @@ _destroy_ipmipower_powercmd (void *x)
 void
 ipmipower_powercmd_setup ()
 {
-  assert (!pending);  /* need to cleanup first! */
+  assert (!waiting);  /* need to cleanup first! */
 
-  pending = list_create ((ListDelF)_destroy_ipmipower_powercmd);
-  if (!pending)
+  waiting = list_create ((ListDelF)_destroy_ipmipower_powercmd);
+  if (!waiting)
     {
       IPMIPOWER_ERROR (("list_create: %s", strerror (errno)));
       exit (EXIT_FAILURE);
     }
+}
 
-  add_to_pending = list_create (NULL);
-  if (!add_to_pending)
+void
+ipmipower_powercmd_cleanup ()
+{
+  assert (waiting);  /* did not run ipmipower_powercmd_setup() */
+
+  while (timer_heap_count)
     {
-      IPMIPOWER_ERROR (("list_create: %s", strerror (errno)));
-      exit (EXIT_FAILURE);
+      ipmipower_powercmd_t ip = timer_heap[0];
+
+      _timer_heap_remove (ip);
+      _destroy_ipmipower_powercmd (ip);
     }
+  free (timer_heap);
+  free (timer_expired);
+  timer_heap = NULL;
+  timer_expired = NULL;
+  timer_heap_len = 0;
+
+  list_destroy (waiting);
+  waiting = NULL;
+  pending_count = 0;
+  executing_count = 0;
 }
 
-void
-ipmipower_powercmd_cleanup ()
+/* _powercmd_start
+ * - start a queued power command, or wait for a fanout slot
+ */
+static void
+_powercmd_start (ipmipower_powercmd_t ip)
 {
-  assert (pending);  /* did not run ipmipower_powercmd_setup() */
-  list_destroy (pending);
-  list_destroy (add_to_pending); 
-  pending = NULL;
-  add_to_pending = NULL;
+  assert (ip);
+
+  ip->ic->powercmd = ip;
+
+  if (cmd_args.common_args.fanout
+      && executing_count >= cmd_args.common_args.fanout)
+    {
+      if (!list_append (waiting, ip))
+        {
+          IPMIPOWER_ERROR (("list_append: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+      return;
+    }
+
+  /* process as soon as possible */
+  timeval_clear (&(ip->timer_expire));
+  _timer_heap_insert (ip);
+  executing_count++;
 }
 
 void
@@ -216,7 +351,7 @@ ipmipower_powercmd_queue (ipmipower_power_cmd_t cmd,
 {
   ipmipower_powercmd_t ip;
 
-  assert (pending);  /* did not run ipmipower_powercmd_setup() */
+  assert (waiting);  /* did not run ipmipower_powercmd_setup() */
   assert (ic);
   assert (IPMIPOWER_POWER_CMD_VALID (cmd));
 
@@ -632,21 +767,14 @@ ipmipower_powercmd_queue (ipmipower_power_cmd_t cmd,
    * So we will serialize power control operations to the same host.
    */
 
-  /* XXX: The constant strcmp and searching of this list can be slow
-   * (O(n^2)), but for the time being it is assumed this will not
-   * be an overall performance issue for ipmipower.  If it does become
-   * an issue, a bigger rearchitecture will be required.
-   */
-  
   ip->next = NULL;
+  ip->timer_index = -1;
 
   if (cmd_args.oem_power_type == IPMIPOWER_OEM_POWER_TYPE_C410X)
     {
       ipmipower_powercmd_t iptmp;
 
-      if ((iptmp = list_find_first (pending,
-				    _find_ipmipower_powercmd,
-				    ip->ic->hostname)))
+      if ((iptmp = ip->ic->powercmd))
 	{
 	  /* find the last one in the list */
 	  while (iptmp->next)
@@ -656,19 +784,31 @@ ipmipower_powercmd_queue (ipmipower_power_cmd_t cmd,
 	}
     }
 
-  if (!list_append (pending, ip))
-    {
-      IPMIPOWER_ERROR (("list_append: %s", strerror (errno)));
-      exit (EXIT_FAILURE);
-    }
+  pending_count++;
+  _powercmd_start (ip);
 }
 
 int
 ipmipower_powercmd_pending ()
 {
-  assert (pending);  /* did not run ipmipower_powercmd_setup() */
+  assert (waiting);  /* did not run ipmipower_powercmd_setup() */
+
+  return (pending_count ? 1 : 0);
+}
+
+void
+ipmipower_powercmd_wakeup (struct ipmipower_connection *ic)
+{
+  ipmipower_powercmd_t ip;
 
-  return (!list_is_empty (pending));
+  assert (ic);
+
+  /* Not executing or still waiting on fanout */
+  if (!(ip = ic->powercmd) || ip->timer_index < 0)
+    return;
+
+  timeval_clear (&(ip->timer_expire));
+  _timer_heap_up (ip->timer_index);
 }
 
 /* _send_packet
@@ -725,6 +865,8 @@ _send_packet (ipmipower_powercmd_t ip, ipmipower_packet_type_t pkt)
 
   secure_memset (buf, '\0', IPMIPOWER_PACKET_BUFLEN);
 
+  ipmipower_connection_send_ipmi (ip->ic);
+
   switch (pkt)
     {
     case IPMIPOWER_PACKET_TYPE_AUTHENTICATION_CAPABILITIES_RQ:
@@ -1395,6 +1537,9 @@ _retry_packets (ipmipower_powercmd_t ip)
 	 * store the old file descriptrs (which are bound to the old
 	 * ports) on a list, and close all of them after we have gotten
 	 * past the Get Session Challenge phase of the protocol.
+	 *
+	 * A shared socket is left alone, the connection moves to the
+	 * new private socket.
 	 */
 	int new_fd, *old_fd;
 	struct sockaddr_in srcaddr;
@@ -1422,16 +1567,22 @@ _retry_packets (ipmipower_powercmd_t ip)
 	    exit (EXIT_FAILURE);
 	  }
 	
-	if (!(old_fd = (int *)malloc (sizeof (int))))
+	if (!ipmipower_connection_shared_fd (ip->ic->ipmi_fd))
 	  {
-	    IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
-	    exit (EXIT_FAILURE);
+	    if (!(old_fd = (int *)malloc (sizeof (int))))
+	      {
+		IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
+		exit (EXIT_FAILURE);
+	      }
+	    
+	    *old_fd = ip->ic->ipmi_fd;
+	    list_push (ip->sockets_to_close, old_fd);
+	    
+	    /* Responses to the old port are ignored from here on */
+	    ipmipower_event_unregister (ip->ic->ipmi_fd);
 	  }
-	
-	*old_fd = ip->ic->ipmi_fd;
-	list_push (ip->sockets_to_close, old_fd);
-	
 	ip->ic->ipmi_fd = new_fd;
+	ipmipower_event_register (ip->ic->ipmi_fd, IPMIPOWER_EVENT_IN, ip->ic);
 	
 	_send_packet (ip, IPMIPOWER_PACKET_TYPE_GET_SESSION_CHALLENGE_RQ);
       }
@@ -1858,6 +2009,7 @@ _calculate_cipher_keys (ipmipower_powercmd_t ip)
  *   the power control protocol
  * - Returns timeout length, or < 0 if command completed and should
  *   be removed from pending.
+ * - Sets timer_expire to when the command must next be processed
  */
 static int
 _process_ipmi_packets (ipmipower_powercmd_t ip)
@@ -1885,13 +2037,9 @@ _process_ipmi_packets (ipmipower_powercmd_t ip)
 
   if (ip->protocol_state == IPMIPOWER_PROTOCOL_STATE_START)
     {
-      /* Don't execute if fanout turned on and we're in the middle of too
-       * many power commands.
+      /* Fanout is handled before commands are placed on the timer
+       * heap, see _powercmd_start().
        */
-      if (cmd_args.common_args.fanout
-          && (executing_count >= cmd_args.common_args.fanout))
-        return (cmd_args.common_args.session_timeout);
-
       _send_packet (ip, IPMIPOWER_PACKET_TYPE_AUTHENTICATION_CAPABILITIES_RQ);
 
       if (gettimeofday (&(ip->time_begin), NULL) < 0)
@@ -1899,7 +2047,6 @@ _process_ipmi_packets (ipmipower_powercmd_t ip)
           IPMIPOWER_ERROR (("gettimeofday: %s", strerror (errno)));
           exit (EXIT_FAILURE);
         }
-      executing_count++;
     }
   else if (ip->protocol_state == IPMIPOWER_PROTOCOL_STATE_AUTHENTICATION_CAPABILITIES_SENT)
     {
@@ -2390,116 +2537,127 @@ _process_ipmi_packets (ipmipower_powercmd_t ip)
         timeout = retransmission_timeout;
     }
 
+  timeval_add_ms (&cur_time, timeout, &(ip->timer_expire));
   return (timeout);
 }
 
-int
-ipmipower_powercmd_process_pending (int *timeout)
+/* _powercmd_finish
+ * - remove a completed power command, start the next command to the
+ *   same host and any commands waiting on fanout
+ */
+static void
+_powercmd_finish (ipmipower_powercmd_t ip)
 {
-  ListIterator itr;
-  ipmipower_powercmd_t ip;
-  int min_timeout = cmd_args.common_args.session_timeout;
-  int num_pending;
+  ipmipower_powercmd_t ipnext = NULL;
 
-  assert (pending);  /* did not run ipmipower_powercmd_setup() */
-  assert (timeout);
+  assert (ip);
+  assert (ip->timer_index < 0);
 
-  /* if there are no pending jobs, don't edit the timeout */
-  if (list_is_empty (pending))
-    return (0);
+  executing_count--;
 
-  /* If we have a fanout, powercmds should be executed "in order" on
-   * this list.  So no need to iterate through this list twice.
-   */
+  if (ip->ic->powercmd == ip)
+    ip->ic->powercmd = NULL;
 
-  if (!(itr = list_iterator_create (pending)))
+  if (cmd_args.oem_power_type == IPMIPOWER_OEM_POWER_TYPE_C410X)
     {
-      IPMIPOWER_ERROR (("list_iterator_create: %s", strerror (errno)));
-      exit (EXIT_FAILURE);
+      ipnext = ip->next;
+      ip->next = NULL;
     }
 
-  while ((ip = (ipmipower_powercmd_t)list_next (itr)))
-    {
-      int tmp_timeout = -1;
+  _destroy_ipmipower_powercmd (ip);
 
-      if ((tmp_timeout = _process_ipmi_packets (ip)) < 0)
-        {
-	  if (cmd_args.oem_power_type == IPMIPOWER_OEM_POWER_TYPE_C410X)
-	    {
-	      if (ip->next)
-		{
-		  if (!list_append (add_to_pending, ip->next))
-		    {
-		      IPMIPOWER_ERROR (("list_append: %s", strerror (errno)));
-		      exit (EXIT_FAILURE);
-		    }
-
-		  ip->next = NULL;
-		}
-	    }
+  if (ipnext)
+    {
+      ipmipower_connection_clear (ipnext->ic);
+      _powercmd_start (ipnext);
+    }
+  else
+    pending_count--;
 
-          if (!list_delete (itr))
-            {
-              IPMIPOWER_ERROR (("list_delete"));
-              exit (EXIT_FAILURE);
-            }
+  while (!list_is_empty (waiting)
+         && (!cmd_args.common_args.fanout
+             || executing_count < cmd_args.common_args.fanout))
+    {
+      ipmipower_powercmd_t ipwait;
 
-          executing_count--;
-          continue;
+      if (!(ipwait = list_dequeue (waiting)))
+        {
+          IPMIPOWER_ERROR (("list_dequeue: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
         }
 
-      if (tmp_timeout < min_timeout)
-        min_timeout = tmp_timeout;
+      _powercmd_start (ipwait);
     }
-  list_iterator_destroy (itr);
+}
 
-  if (list_count (add_to_pending) > 0)
-    {
-      ListIterator addtoitr;
+int
+ipmipower_powercmd_process_pending (int *timeout)
+{
+  struct timeval cur_time, result;
+  unsigned int expired_count = 0;
+  unsigned int ms_time;
+  unsigned int i;
 
-      if (!(addtoitr = list_iterator_create (add_to_pending)))
-	{
-	  IPMIPOWER_ERROR (("list_iterator_create: %s", strerror (errno)));
-	  exit (EXIT_FAILURE);
-	}
-      while ((ip = list_next (addtoitr)))
-	{
-	  ipmipower_connection_clear (ip->ic);
-	  if (!list_append (pending, ip))
-	    {
-	      IPMIPOWER_ERROR (("list_append: %s", strerror (errno)));
-	      exit (EXIT_FAILURE);
-	    }
+  assert (waiting);  /* did not run ipmipower_powercmd_setup() */
+  assert (timeout);
 
-	  if (!list_delete (addtoitr))
-	    {
-	      IPMIPOWER_ERROR (("list_delete"));
-	      exit (EXIT_FAILURE);
-	    }
-	}
+  /* if there are no pending jobs, don't edit the timeout */
+  if (!pending_count)
+    return (0);
 
-      list_iterator_destroy (addtoitr);
+  if (gettimeofday (&cur_time, NULL) < 0)
+    {
+      IPMIPOWER_ERROR (("gettimeofday: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
 
-      /* If by chance all commands are going to the same host, then
-       * the next powercmd will start after a default timeout.  We
-       * don't want that.  We'll shorten the timeout to a
-       * retransmission timeout so it appears more normal.
-       */
+  /* Pull off all expired commands first, so that commands put back
+   * on the heap below are not processed twice in the same pass.
+   */
+  while (timer_heap_count
+         && !timeval_gt (&(timer_heap[0]->timer_expire), &cur_time))
+    {
+      ipmipower_powercmd_t ip = timer_heap[0];
 
-      if (cmd_args.common_args.retransmission_timeout < min_timeout)
-	min_timeout = cmd_args.common_args.retransmission_timeout;
-    } 
+      _timer_heap_remove (ip);
+      timer_expired[expired_count++] = ip;
+    }
 
-  if (!(num_pending = list_count (pending)))
-    ipmipower_output_finish ();
+  for (i = 0; i < expired_count; i++)
+    {
+      ipmipower_powercmd_t ip = timer_expired[i];
+
+      if (_process_ipmi_packets (ip) < 0)
+        {
+          _powercmd_finish (ip);
+          continue;
+        }
+
+      _timer_heap_insert (ip);
+    }
 
   /* If the last pending power control command finished, the timeout
    * is 0 to get the primary poll loop to "re-init" at the start of
    * the loop.
    */
-  if (num_pending)
-    *timeout = min_timeout;
-  else
-    *timeout = 0;
-  return (num_pending);
+  if (!pending_count)
+    {
+      ipmipower_output_finish ();
+      *timeout = 0;
+      return (0);
+    }
+
+  /* waiting commands imply executing commands on the heap */
+  assert (timer_heap_count);
+
+  if (gettimeofday (&cur_time, NULL) < 0)
+    {
+      IPMIPOWER_ERROR (("gettimeofday: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  timeval_sub (&(timer_heap[0]->timer_expire), &cur_time, &result);
+  timeval_millisecond_calc (&result, &ms_time);
+  *timeout = ms_time;
+  return (pending_count);
 }
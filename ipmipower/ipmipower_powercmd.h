@@ -43,8 +43,16 @@ void ipmipower_powercmd_queue (ipmipower_power_cmd_t cmd,
  */
 int ipmipower_powercmd_pending ();
 
+/* ipmipower_powercmd_wakeup
+ * - Mark the command executing on ic to be processed on the next
+ *   call to ipmipower_powercmd_process_pending, e.g. after a packet
+ *   was received for it
+ */
+void ipmipower_powercmd_wakeup (ipmipower_connection_t ic);
+
 /* ipmipower_powercmd_process_pending
- * - Process remaining commands still in the queue
+ * - Process commands that have been woken up or whose retransmission
+ *   or session timeout has expired
  * - Sets timeout to min timeout of all pending requests
  * - Does not set timeout if no pending requests exist
  * Returns number of pending requests, 0 if none
@@ -1054,6 +1054,9 @@ _cmd_config (void)
   ipmipower_cbuf_printf (ttyout,
                          "Ping Consec Count:            %u\n",
                          cmd_args.ping_consec_count);
+  ipmipower_cbuf_printf (ttyout,
+                         "Shared Sockets:               %u\n",
+                         cmd_args.shared_sockets);
 
   ipmipower_cbuf_printf (ttyout,
                          "Buffer-Output:                %s\n",
@@ -49,6 +49,9 @@
 #endif  /* !HAVE_SYS_TIME_H */
 #endif /* !TIME_WITH_SYS_TIME */
 #include <sys/poll.h>
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif /* HAVE_SYS_EPOLL_H */
 #include <assert.h>
 #include <errno.h>
 
@@ -60,6 +63,30 @@
 
 extern struct ipmipower_arguments cmd_args;
 
+/* Per fd event registration, indexed by fd */
+struct ipmipower_event_fd
+{
+  int registered;
+  int unpollable;
+  unsigned int events;
+  void *arg;
+};
+
+static struct ipmipower_event_fd *event_fds = NULL;
+static unsigned int event_fds_len = 0;
+
+#if HAVE_SYS_EPOLL_H
+static int event_epfd = -1;
+
+/* epoll refuses regular files, which may be passed as stdin/stdout.
+ * Like poll, we treat them as always ready.
+ */
+#define IPMIPOWER_EVENT_UNPOLLABLE_MAX 4
+
+static int event_unpollable_fds[IPMIPOWER_EVENT_UNPOLLABLE_MAX];
+static unsigned int event_unpollable_count = 0;
+#endif /* HAVE_SYS_EPOLL_H */
+
 char *
 ipmipower_power_cmd_to_string (ipmipower_power_cmd_t cmd)
 {
@@ -183,6 +210,284 @@ ipmipower_poll (struct pollfd *ufds, unsigned int nfds, int timeout)
   return n;
 }
 
+void
+ipmipower_event_setup (void)
+{
+#if HAVE_SYS_EPOLL_H
+  assert (event_epfd < 0);
+
+  if ((event_epfd = epoll_create (IPMIPOWER_EVENT_MAX)) < 0)
+    {
+      IPMIPOWER_ERROR (("epoll_create: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+void
+ipmipower_event_cleanup (void)
+{
+#if HAVE_SYS_EPOLL_H
+  /* ignore potential error, cleanup path */
+  close (event_epfd);
+  event_epfd = -1;
+  event_unpollable_count = 0;
+#endif /* HAVE_SYS_EPOLL_H */
+  free (event_fds);
+  event_fds = NULL;
+  event_fds_len = 0;
+}
+
+#if HAVE_SYS_EPOLL_H
+static uint32_t
+_event_to_epoll (unsigned int events)
+{
+  uint32_t epoll_events = 0;
+
+  if (events & IPMIPOWER_EVENT_IN)
+    epoll_events |= EPOLLIN;
+  if (events & IPMIPOWER_EVENT_OUT)
+    epoll_events |= EPOLLOUT;
+  return (epoll_events);
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+void
+ipmipower_event_register (int fd, unsigned int events, void *arg)
+{
+  struct ipmipower_event_fd *efd;
+
+  assert (fd >= 0);
+
+  if (fd >= event_fds_len)
+    {
+      unsigned int len = event_fds_len ? event_fds_len : 64;
+
+      while (len <= fd)
+        len *= 2;
+
+      if (!(event_fds = (struct ipmipower_event_fd *)realloc (event_fds,
+                                                               len * sizeof (struct ipmipower_event_fd))))
+        {
+          IPMIPOWER_ERROR (("realloc: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+      memset (&event_fds[event_fds_len],
+              '\0',
+              (len - event_fds_len) * sizeof (struct ipmipower_event_fd));
+      event_fds_len = len;
+    }
+
+  efd = &event_fds[fd];
+
+#if HAVE_SYS_EPOLL_H
+  if (!efd->unpollable)
+    {
+      struct epoll_event ev;
+
+      memset (&ev, '\0', sizeof (struct epoll_event));
+      ev.events = _event_to_epoll (events);
+      ev.data.fd = fd;
+
+      if (epoll_ctl (event_epfd,
+                     efd->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                     fd,
+                     &ev) < 0)
+        {
+          if (errno != EPERM
+              || efd->registered
+              || event_unpollable_count >= IPMIPOWER_EVENT_UNPOLLABLE_MAX)
+            {
+              IPMIPOWER_ERROR (("epoll_ctl: %s", strerror (errno)));
+              exit (EXIT_FAILURE);
+            }
+
+          efd->unpollable = 1;
+          event_unpollable_fds[event_unpollable_count++] = fd;
+        }
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  efd->registered = 1;
+  efd->events = events;
+  efd->arg = arg;
+}
+
+void
+ipmipower_event_unregister (int fd)
+{
+  struct ipmipower_event_fd *efd;
+
+  if (fd < 0 || fd >= event_fds_len || !event_fds[fd].registered)
+    return;
+
+  efd = &event_fds[fd];
+
+#if HAVE_SYS_EPOLL_H
+  if (efd->unpollable)
+    {
+      unsigned int i;
+
+      for (i = 0; i < event_unpollable_count; i++)
+        {
+          if (event_unpollable_fds[i] == fd)
+            {
+              event_unpollable_fds[i] = event_unpollable_fds[--event_unpollable_count];
+              break;
+            }
+        }
+    }
+  else
+    {
+      struct epoll_event ev;
+
+      /* ev ignored, but must be non-NULL on older kernels */
+      if (epoll_ctl (event_epfd, EPOLL_CTL_DEL, fd, &ev) < 0)
+        {
+          IPMIPOWER_ERROR (("epoll_ctl: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  memset (efd, '\0', sizeof (struct ipmipower_event_fd));
+}
+
+#if HAVE_SYS_EPOLL_H
+int
+ipmipower_event_wait (struct ipmipower_event *events,
+                      unsigned int maxevents,
+                      int timeout)
+{
+  struct epoll_event epevents[IPMIPOWER_EVENT_MAX];
+  unsigned int count = 0;
+  int epmaxevents;
+  int i, n;
+
+  assert (events);
+  assert (maxevents);
+
+  for (i = 0; i < event_unpollable_count && count < maxevents; i++)
+    {
+      struct ipmipower_event_fd *efd = &event_fds[event_unpollable_fds[i]];
+
+      if (!efd->events)
+        continue;
+
+      events[count].fd = event_unpollable_fds[i];
+      events[count].events = efd->events;
+      events[count].arg = efd->arg;
+      count++;
+    }
+
+  if (count == maxevents)
+    return (count);
+
+  if (count)
+    timeout = 0;
+
+  if ((maxevents - count) < IPMIPOWER_EVENT_MAX)
+    epmaxevents = maxevents - count;
+  else
+    epmaxevents = IPMIPOWER_EVENT_MAX;
+
+  /* If interrupted, return no additional events, the caller will
+   * recalculate its timeout and come back.
+   */
+  if ((n = epoll_wait (event_epfd, epevents, epmaxevents, timeout)) < 0)
+    {
+      if (errno == EINTR)
+        return (count);
+
+      IPMIPOWER_ERROR (("epoll_wait: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      int fd = epevents[i].data.fd;
+
+      events[count].fd = fd;
+      events[count].events = 0;
+      events[count].arg = event_fds[fd].arg;
+
+      /* a hangup on stdin is an EOF, which must be read like data */
+      if (epevents[i].events & (EPOLLIN | EPOLLHUP))
+        events[count].events |= IPMIPOWER_EVENT_IN;
+      if (epevents[i].events & EPOLLOUT)
+        events[count].events |= IPMIPOWER_EVENT_OUT;
+      if (epevents[i].events & EPOLLERR)
+        events[count].events |= IPMIPOWER_EVENT_ERR;
+      count++;
+    }
+
+  return (count);
+}
+#else /* !HAVE_SYS_EPOLL_H */
+int
+ipmipower_event_wait (struct ipmipower_event *events,
+                      unsigned int maxevents,
+                      int timeout)
+{
+  static struct pollfd *pfds = NULL;
+  static unsigned int pfds_len = 0;
+  unsigned int nfds = 0;
+  unsigned int count = 0;
+  unsigned int i;
+
+  assert (events);
+  assert (maxevents);
+
+  if (pfds_len < event_fds_len)
+    {
+      free (pfds);
+      if (!(pfds = (struct pollfd *)malloc (event_fds_len * sizeof (struct pollfd))))
+        {
+          IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+      pfds_len = event_fds_len;
+    }
+
+  for (i = 0; i < event_fds_len; i++)
+    {
+      if (!event_fds[i].registered)
+        continue;
+
+      pfds[nfds].fd = i;
+      pfds[nfds].events = 0;
+      pfds[nfds].revents = 0;
+      if (event_fds[i].events & IPMIPOWER_EVENT_IN)
+        pfds[nfds].events |= POLLIN;
+      if (event_fds[i].events & IPMIPOWER_EVENT_OUT)
+        pfds[nfds].events |= POLLOUT;
+      nfds++;
+    }
+
+  ipmipower_poll (pfds, nfds, timeout);
+
+  for (i = 0; i < nfds && count < maxevents; i++)
+    {
+      if (!pfds[i].revents)
+        continue;
+
+      events[count].fd = pfds[i].fd;
+      events[count].events = 0;
+      events[count].arg = event_fds[pfds[i].fd].arg;
+
+      if (pfds[i].revents & (POLLIN | POLLHUP))
+        events[count].events |= IPMIPOWER_EVENT_IN;
+      if (pfds[i].revents & POLLOUT)
+        events[count].events |= IPMIPOWER_EVENT_OUT;
+      if (pfds[i].revents & POLLERR)
+        events[count].events |= IPMIPOWER_EVENT_ERR;
+      count++;
+    }
+
+  return (count);
+}
+#endif /* !HAVE_SYS_EPOLL_H */
+
 void
 ipmipower_cbuf_printf(cbuf_t cbuf, const char *fmt, ...)
 {
@@ -50,6 +50,50 @@ int ipmipower_power_cmd_check_privilege (ipmipower_power_cmd_t cmd,
  */
 int ipmipower_poll (struct pollfd *ufds, unsigned int nfds, int timeout);
 
+#define IPMIPOWER_EVENT_IN  0x01
+#define IPMIPOWER_EVENT_OUT 0x02
+#define IPMIPOWER_EVENT_ERR 0x04
+
+/* max events returned from a single ipmipower_event_wait() */
+#define IPMIPOWER_EVENT_MAX 1024
+
+struct ipmipower_event
+{
+  int fd;
+  unsigned int events;
+  void *arg;
+};
+
+/* ipmipower_event_setup
+ * - create the event set all descriptors are registered with
+ * - uses epoll when available, poll otherwise
+ */
+void ipmipower_event_setup (void);
+
+void ipmipower_event_cleanup (void);
+
+/* ipmipower_event_register
+ * - add fd to the event set, or change the events/arg of an fd
+ *   already in the event set
+ * - arg is returned with every event on fd
+ */
+void ipmipower_event_register (int fd, unsigned int events, void *arg);
+
+/* ipmipower_event_unregister
+ * - remove fd from the event set, must be called before fd is closed
+ * - no-op if fd is not in the event set
+ */
+void ipmipower_event_unregister (int fd);
+
+/* ipmipower_event_wait
+ * - wait up to timeout milliseconds for events on registered fds
+ * - only fds with events are returned, at most maxevents
+ * - Returns number of events, 0 on timeout or signal
+ */
+int ipmipower_event_wait (struct ipmipower_event *events,
+                          unsigned int maxevents,
+                          int timeout);
+
 /* ipmipower_cbuf_printf
  * - wrapper for vsnprintf and cbuf_write
  */
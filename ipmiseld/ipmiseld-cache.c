@@ -90,7 +90,8 @@
 
 static int
 _ipmiseld_sdr_cache_create (ipmiseld_host_data_t *host_data,
-			    char *filename)
+			    char *filename,
+			    int cache_create_flags)
 {
   assert (host_data);
   assert (host_data->host_poll);
@@ -101,7 +102,7 @@ _ipmiseld_sdr_cache_create (ipmiseld_host_data_t *host_data,
   if (ipmi_sdr_cache_create (host_data->host_poll->sdr_ctx,
                              host_data->host_poll->ipmi_ctx,
                              filename,
-                             IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT,
+                             cache_create_flags,
                              NULL,
                              NULL) < 0)
     {
@@ -200,11 +201,24 @@ ipmiseld_sdr_cache_create_and_load (ipmiseld_host_data_t *host_data)
 	  if (host_data->prog_data->args->common_args.debug)
 	    IPMISELD_HOST_DEBUG (("SDR cache not available - creating"));
 
-          if (_ipmiseld_sdr_cache_create (host_data, filename) < 0)
+          if (_ipmiseld_sdr_cache_create (host_data,
+					  filename,
+					  IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT) < 0)
             goto cleanup;
         }
-      else if (ipmi_sdr_ctx_errnum (host_data->host_poll->sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
-               || ipmi_sdr_ctx_errnum (host_data->host_poll->sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+      else if (ipmi_sdr_ctx_errnum (host_data->host_poll->sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+        {
+	  if (host_data->prog_data->args->common_args.debug)
+	    IPMISELD_HOST_DEBUG (("SDR cache out of date - updating cache"));
+
+          /* only download records that changed */
+          if (_ipmiseld_sdr_cache_create (host_data,
+					  filename,
+					  IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE
+					  | IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL) < 0)
+            goto cleanup;
+        }
+      else if (ipmi_sdr_ctx_errnum (host_data->host_poll->sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID)
         {
 	  if (host_data->prog_data->args->common_args.debug)
 	    IPMISELD_HOST_DEBUG (("SDR cache invalid - delete and recreate cache"));
@@ -217,7 +231,9 @@ ipmiseld_sdr_cache_create_and_load (ipmiseld_host_data_t *host_data)
 	      goto cleanup;
 	    }
 	  
-          if (_ipmiseld_sdr_cache_create (host_data, filename) < 0)
+          if (_ipmiseld_sdr_cache_create (host_data,
+					  filename,
+					  IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT) < 0)
             goto cleanup;
         }
       else
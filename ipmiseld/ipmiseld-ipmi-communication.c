@@ -86,6 +86,15 @@ ipmiseld_ipmi_setup (ipmiseld_host_data_t *host_data)
       goto cleanup;
     }
 
+  if (ipmi_ctx_set_pipeline_window (host_data->host_poll->ipmi_ctx,
+                                    common_args->pipeline_window) < 0)
+    {
+      ipmiseld_err_output (host_data,
+                           "ipmi_ctx_set_pipeline_window: %s",
+                           ipmi_ctx_errormsg (host_data->host_poll->ipmi_ctx));
+      goto cleanup;
+    }
+
   if (host_data->hostname
       && strcasecmp (host_data->hostname, "localhost") != 0
       && strcmp (host_data->hostname, "127.0.0.1") != 0)
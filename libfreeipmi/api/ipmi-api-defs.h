@@ -84,6 +84,7 @@ struct ipmi_ctx
   unsigned int workaround_flags_outofband_2_0;
   unsigned int workaround_flags_inband;
   unsigned int flags;
+  unsigned int pipeline_window;
   
   struct ipmi_ctx_target target;
   
@@ -119,6 +120,9 @@ struct ipmi_ctx
     {
       int sockfd;
 
+      /* set if crypt_cache_session_start() succeeded */
+      int crypt_cache_session;
+
       char hostname[MAXHOSTNAMELEN+1];
 
       struct sockaddr_in remote_host;
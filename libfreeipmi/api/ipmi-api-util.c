@@ -25,10 +25,15 @@
 #ifdef STDC_HEADERS
 #include <string.h>
 #endif /* STDC_HEADERS */
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <limits.h>
 #include <assert.h>
 #include <errno.h>
 
 #include "freeipmi/api/ipmi-api.h"
+#include "freeipmi/interface/rmcp-interface.h"
 #include "freeipmi/locate/ipmi-locate.h"
 #include "freeipmi/spec/ipmi-comp-code-spec.h"
 #include "freeipmi/driver/ipmi-inteldcmi-driver.h"
@@ -44,93 +49,103 @@
 
 #include "freeipmi-portability.h"
 
-void
-api_set_api_errnum_by_errno (ipmi_ctx_t ctx, int __errno)
-{
-  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+#define GETHOSTBYNAME_AUX_BUFLEN             1024
+extern int h_errno;
 
+int
+api_errnum_by_errno (int __errno)
+{
   switch (__errno)
     {
     case 0:
-      ctx->errnum = IPMI_ERR_SUCCESS;
-      break;
+      return (IPMI_ERR_SUCCESS);
     case ENOMEM:
-      ctx->errnum = IPMI_ERR_OUT_OF_MEMORY;
-      break;
+      return (IPMI_ERR_OUT_OF_MEMORY);
     case ENODEV:
-      ctx->errnum = IPMI_ERR_DEVICE_NOT_SUPPORTED;
-      break;
+      return (IPMI_ERR_DEVICE_NOT_SUPPORTED);
     case ECONNRESET:
-      ctx->errnum = IPMI_ERR_IPMI_ERROR;
-      break;
+      return (IPMI_ERR_IPMI_ERROR);
     case ECONNREFUSED:
-      ctx->errnum = IPMI_ERR_IPMI_ERROR;
-      break;
+      return (IPMI_ERR_IPMI_ERROR);
     case EINVAL:
-      ctx->errnum = IPMI_ERR_PARAMETERS;
-      break;
+      return (IPMI_ERR_PARAMETERS);
     default:
-      ctx->errnum = IPMI_ERR_INTERNAL_ERROR;
+      return (IPMI_ERR_INTERNAL_ERROR);
     }
 }
 
-void
-api_set_api_errnum_by_fiid_object (ipmi_ctx_t ctx, fiid_obj_t obj)
+int
+api_errnum_by_fiid_object (fiid_obj_t obj)
 {
-  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
-
   switch (fiid_obj_errnum (obj))
     {
     case FIID_ERR_SUCCESS:
-      ctx->errnum = IPMI_ERR_SUCCESS;
-      break;
+      return (IPMI_ERR_SUCCESS);
     case FIID_ERR_OUT_OF_MEMORY:
-      ctx->errnum = IPMI_ERR_OUT_OF_MEMORY;
-      break;
+      return (IPMI_ERR_OUT_OF_MEMORY);
     case FIID_ERR_DATA_NOT_AVAILABLE:
-      ctx->errnum = IPMI_ERR_IPMI_ERROR;
-      break;
+      return (IPMI_ERR_IPMI_ERROR);
     case FIID_ERR_FIELD_NOT_FOUND:
     case FIID_ERR_DATA_NOT_BYTE_ALIGNED:
     case FIID_ERR_REQUIRED_FIELD_MISSING:
     case FIID_ERR_FIXED_LENGTH_FIELD_INVALID:
     case FIID_ERR_NOT_IDENTICAL:
-      ctx->errnum = IPMI_ERR_PARAMETERS;
-      break;
+      return (IPMI_ERR_PARAMETERS);
     default:
-      ctx->errnum = IPMI_ERR_INTERNAL_ERROR;
+      return (IPMI_ERR_INTERNAL_ERROR);
     }
 }
 
-void
-api_set_api_errnum_by_bad_response (ipmi_ctx_t ctx, fiid_obj_t obj_cmd_rs)
+int
+api_errnum_by_bad_response (fiid_obj_t obj_cmd_rs)
 {
-  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
-
   /* IPMI_COMP_CODE_COMMAND_TIMEOUT, assumes it's a IPMB or command
    * specific timeout, so set to "MESSAGE_TIMEOUT" so user can
    * continue on if they wish.  At minimum, returned by openipmi
    * driver for (what seems to be) collection of potential errors.
    */
   if (ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_COMMAND_TIMEOUT) == 1)
-    ctx->errnum = IPMI_ERR_MESSAGE_TIMEOUT;
+    return (IPMI_ERR_MESSAGE_TIMEOUT);
   else if (ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_NODE_BUSY) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_OUT_OF_SPACE) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_SDR_REPOSITORY_IN_UPDATE_MODE) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_DEVICE_IN_FIRMWARE_UPDATE_MODE) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_BMC_INITIALIZATION_IN_PROGRESS) == 1)
-    ctx->errnum = IPMI_ERR_BMC_BUSY;
+    return (IPMI_ERR_BMC_BUSY);
   else if (ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_INSUFFICIENT_PRIVILEGE_LEVEL) == 1)
-    ctx->errnum = IPMI_ERR_PRIVILEGE_LEVEL_INSUFFICIENT;
+    return (IPMI_ERR_PRIVILEGE_LEVEL_INSUFFICIENT);
   else if (ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_INVALID_COMMAND) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_COMMAND_INVALID_FOR_LUN) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_REQUEST_DATA_LENGTH_INVALID) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_REQUEST_DATA_LENGTH_LIMIT_EXCEEDED) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_PARAMETER_OUT_OF_RANGE) == 1
 	   || ipmi_check_completion_code (obj_cmd_rs, IPMI_COMP_CODE_INVALID_DATA_FIELD_IN_REQUEST) == 1)
-    ctx->errnum = IPMI_ERR_COMMAND_INVALID_OR_UNSUPPORTED;
-  else
-    ctx->errnum = IPMI_ERR_BAD_COMPLETION_CODE;
+    return (IPMI_ERR_COMMAND_INVALID_OR_UNSUPPORTED);
+  return (IPMI_ERR_BAD_COMPLETION_CODE);
+}
+
+void
+api_set_api_errnum_by_errno (ipmi_ctx_t ctx, int __errno)
+{
+  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+
+  ctx->errnum = api_errnum_by_errno (__errno);
+}
+
+void
+api_set_api_errnum_by_fiid_object (ipmi_ctx_t ctx, fiid_obj_t obj)
+{
+  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+
+  ctx->errnum = api_errnum_by_fiid_object (obj);
+}
+
+void
+api_set_api_errnum_by_bad_response (ipmi_ctx_t ctx, fiid_obj_t obj_cmd_rs)
+{
+  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+
+  ctx->errnum = api_errnum_by_bad_response (obj_cmd_rs);
 }
 
 void
@@ -419,3 +434,133 @@ api_ipmi_cmd_ipmb (ipmi_ctx_t ctx,
 
   return (_api_ipmi_cmd_post (ctx, obj_cmd_rs));
 }
+
+int
+api_resolve_hostname (const char *hostname,
+                      char *hostname_buf,
+                      struct sockaddr_in *remote_host)
+{
+  struct hostent hent;
+  int h_errnop;
+  char buf[GETHOSTBYNAME_AUX_BUFLEN];
+#if defined(HAVE_FUNC_GETHOSTBYNAME_R_6)
+  struct hostent *hptr;
+#elif defined(HAVE_FUNC_GETHOSTBYNAME_R_5)
+#else /* !HAVE_FUNC_GETHOSTBYNAME_R */
+  struct hostent *hptr;
+#endif /* !HAVE_FUNC_GETHOSTBYNAME_R */
+  char *hostname_copy = NULL;
+  char *hostname_ptr;
+  uint16_t port = RMCP_AUX_BUS_SHUNT;
+  int rv = IPMI_ERR_INTERNAL_ERROR;
+
+  assert (hostname);
+  assert (hostname_buf);
+  assert (remote_host);
+
+  if (strchr (hostname, ':'))
+    {
+      char *ptr;
+
+      if (!(hostname_copy = strdup ((char *)hostname)))
+	{
+	  rv = IPMI_ERR_OUT_OF_MEMORY;
+	  goto cleanup;
+	}
+
+      if ((ptr = strchr (hostname_copy, ':')))
+	{
+	  char *endptr;
+	  int tmp;
+
+	  *ptr = '\0';
+	  ptr++;
+
+	  if (strlen (hostname_copy) > MAXHOSTNAMELEN)
+	    {
+	      rv = IPMI_ERR_PARAMETERS;
+	      goto cleanup;
+	    }
+	  
+	  errno = 0;
+	  tmp = strtol (ptr, &endptr, 0);
+	  if (errno
+	      || endptr[0] != '\0'
+	      || tmp <= 0
+	      || tmp > USHRT_MAX)
+	    {
+	      rv = IPMI_ERR_PARAMETERS;
+	      goto cleanup;
+	    }
+	  
+	  port = tmp;
+	}
+      hostname_ptr = hostname_copy;
+    }
+  else
+    {
+      if (strlen (hostname) > MAXHOSTNAMELEN)
+	return (IPMI_ERR_PARAMETERS);
+
+      hostname_ptr = (char *)hostname;
+    }
+  
+  memset (&hent, '\0', sizeof (struct hostent));
+#if defined(HAVE_FUNC_GETHOSTBYNAME_R_6)
+  if (gethostbyname_r (hostname_ptr,
+                       &hent,
+                       buf,
+                       GETHOSTBYNAME_AUX_BUFLEN,
+                       &hptr,
+                       &h_errnop))
+    {
+      rv = IPMI_ERR_HOSTNAME_INVALID;
+      goto cleanup;
+    }
+  if (!hptr)
+    {
+      rv = IPMI_ERR_HOSTNAME_INVALID;
+      goto cleanup;
+    }
+#elif defined(HAVE_FUNC_GETHOSTBYNAME_R_5)
+  /* Jan Forch - Solaris gethostbyname_r returns ptr, not integer */
+  if (!gethostbyname_r (hostname_ptr,
+                        &hent,
+                        buf,
+                        GETHOSTBYNAME_AUX_BUFLEN,
+                        &h_errnop))
+    {
+      rv = IPMI_ERR_HOSTNAME_INVALID;
+      goto cleanup;
+    }
+#else  /* !HAVE_FUNC_GETHOSTBYNAME_R */
+  if (freeipmi_gethostbyname_r (hostname_ptr,
+                                &hent,
+                                buf,
+                                GETHOSTBYNAME_AUX_BUFLEN,
+                                &hptr,
+                                &h_errnop))
+    {
+      rv = IPMI_ERR_HOSTNAME_INVALID;
+      goto cleanup;
+    }
+  if (!hptr)
+    {
+      rv = IPMI_ERR_HOSTNAME_INVALID;
+      goto cleanup;
+    }
+#endif /* !HAVE_FUNC_GETHOSTBYNAME_R */
+
+  strncpy (hostname_buf,
+           hostname_ptr,
+           MAXHOSTNAMELEN);
+
+  remote_host->sin_family = AF_INET;
+  remote_host->sin_port = htons (port);
+  remote_host->sin_addr = *(struct in_addr *) hent.h_addr;
+
+  rv = IPMI_ERR_SUCCESS;
+ cleanup:
+  free (hostname_copy);
+  return (rv);
+}
@@ -29,6 +29,7 @@
 #include <string.h>
 #endif /* STDC_HEADERS */
 #include <errno.h>
+#include <netinet/in.h>
 
 #include "freeipmi/api/ipmi-api.h"
 #include "freeipmi/fiid/fiid.h"
@@ -37,6 +38,13 @@
 
 #include "ipmi-api-defs.h"
 
+/* api_errnum_by_* - map an error to an ipmi_errnum without a ctx */
+int api_errnum_by_errno (int __errno);
+
+int api_errnum_by_fiid_object (fiid_obj_t obj);
+
+int api_errnum_by_bad_response (fiid_obj_t obj_cmd_rs);
+
 void api_set_api_errnum_by_errno (ipmi_ctx_t ctx, int __errno);
 
 void api_set_api_errnum_by_fiid_object (ipmi_ctx_t ctx, fiid_obj_t obj);
@@ -55,6 +63,15 @@ void api_set_api_errnum_by_sunbmc_errnum (ipmi_ctx_t ctx, int sunbmc_errnum);
 
 void api_set_api_errnum_by_inteldcmi_errnum (ipmi_ctx_t ctx, int inteldcmi_errnum);
 
+/* api_resolve_hostname
+ * - resolve "hostname[:port]" for an out-of-band connection
+ * - hostname_buf must be at least MAXHOSTNAMELEN + 1 bytes
+ * - Returns IPMI_ERR_SUCCESS or the ipmi_errnum of the failure
+ */
+int api_resolve_hostname (const char *hostname,
+                          char *hostname_buf,
+                          struct sockaddr_in *remote_host);
+
 int api_ipmi_cmd (ipmi_ctx_t ctx,
                   uint8_t lun,
                   uint8_t net_fn,
@@ -93,9 +93,6 @@
 
 #define IPMI_POLL_INTERVAL_USECS             10
 
-#define GETHOSTBYNAME_AUX_BUFLEN             1024
-extern int h_errno;
-
 static char *ipmi_errmsg[] =
   {
     "success",                                                          /* 0 */
@@ -144,6 +141,7 @@ _ipmi_ctx_init (struct ipmi_ctx *ctx)
   memset (ctx, '\0', sizeof (struct ipmi_ctx));
   ctx->magic = IPMI_CTX_MAGIC;
   ctx->type = IPMI_DEVICE_UNKNOWN;
+  ctx->pipeline_window = IPMI_PIPELINE_WINDOW_DEFAULT;
 }
 
 ipmi_ctx_t
@@ -250,6 +248,47 @@ ipmi_ctx_set_flags (ipmi_ctx_t ctx, unsigned int flags)
   return (0);
 }
 
+int
+ipmi_ctx_get_pipeline_window (ipmi_ctx_t ctx, unsigned int *window)
+{
+  if (!ctx || ctx->magic != IPMI_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_ctx_errormsg (ctx), ipmi_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!window)
+    {
+      API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  (*window) = ctx->pipeline_window;
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
+int
+ipmi_ctx_set_pipeline_window (ipmi_ctx_t ctx, unsigned int window)
+{
+  if (!ctx || ctx->magic != IPMI_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_ctx_errormsg (ctx), ipmi_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!window
+      || window > IPMI_PIPELINE_WINDOW_MAX)
+    {
+      API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  ctx->pipeline_window = window;
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
 static void
 _ipmi_outofband_free (ipmi_ctx_t ctx)
 {
@@ -282,6 +321,12 @@ _ipmi_outofband_free (ipmi_ctx_t ctx)
   ctx->io.outofband.rs.obj_lan_msg_trlr = NULL;
   fiid_obj_destroy (ctx->io.outofband.rs.obj_rmcpplus_session_trlr);
   ctx->io.outofband.rs.obj_rmcpplus_session_trlr = NULL;
+
+  if (ctx->io.outofband.crypt_cache_session)
+    {
+      crypt_cache_session_end ();
+      ctx->io.outofband.crypt_cache_session = 0;
+    }
 }
 
 static void
@@ -326,132 +371,21 @@ _ipmi_inband_free (ipmi_ctx_t ctx)
 static int
 _setup_hostname (ipmi_ctx_t ctx, const char *hostname)
 {
-  struct hostent hent;
-  int h_errnop;
-  char buf[GETHOSTBYNAME_AUX_BUFLEN];
-#if defined(HAVE_FUNC_GETHOSTBYNAME_R_6)
-  struct hostent *hptr;
-#elif defined(HAVE_FUNC_GETHOSTBYNAME_R_5)
-#else /* !HAVE_FUNC_GETHOSTBYNAME_R */
-  struct hostent *hptr;
-#endif /* !HAVE_FUNC_GETHOSTBYNAME_R */
-  char *hostname_copy = NULL;
-  char *hostname_ptr;
-  uint16_t port = RMCP_AUX_BUS_SHUNT;
-  int rv = -1;
+  int errnum;
 
   assert (ctx);
   assert (ctx->magic == IPMI_CTX_MAGIC);
   assert (hostname);
 
-  if (strchr (hostname, ':'))
+  if ((errnum = api_resolve_hostname (hostname,
+                                      ctx->io.outofband.hostname,
+                                      &(ctx->io.outofband.remote_host))) != IPMI_ERR_SUCCESS)
     {
-      char *ptr;
-
-      if (!(hostname_copy = strdup ((char *)hostname)))
-	{
-	  API_SET_ERRNUM (ctx, IPMI_ERR_OUT_OF_MEMORY);
-	  goto cleanup;
-	}
-
-      if ((ptr = strchr (hostname_copy, ':')))
-	{
-	  char *endptr;
-	  int tmp;
-
-	  *ptr = '\0';
-	  ptr++;
-
-	  if (strlen (hostname_copy) > MAXHOSTNAMELEN)
-	    {
-	      API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
-	      return (-1);
-	    }
-	  
-	  errno = 0;
-	  tmp = strtol (ptr, &endptr, 0);
-	  if (errno
-	      || endptr[0] != '\0'
-	      || tmp <= 0
-	      || tmp > USHRT_MAX)
-	    {
-	      API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
-	      goto cleanup;
-	    }
-	  
-	  port = tmp;
-	}
-      hostname_ptr = hostname_copy;
-    }
-  else
-    {
-      if (strlen (hostname) > MAXHOSTNAMELEN)
-	{
-	  API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
-	  return (-1);
-	}
-
-      hostname_ptr = (char *)hostname;
-    }
-  
-  memset (&hent, '\0', sizeof (struct hostent));
-#if defined(HAVE_FUNC_GETHOSTBYNAME_R_6)
-  if (gethostbyname_r (hostname_ptr,
-                       &hent,
-                       buf,
-                       GETHOSTBYNAME_AUX_BUFLEN,
-                       &hptr,
-                       &h_errnop))
-    {
-      API_SET_ERRNUM (ctx, IPMI_ERR_HOSTNAME_INVALID);
-      goto cleanup;
-    }
-  if (!hptr)
-    {
-      API_SET_ERRNUM (ctx, IPMI_ERR_HOSTNAME_INVALID);
-      goto cleanup;
-    }
-#elif defined(HAVE_FUNC_GETHOSTBYNAME_R_5)
-  /* Jan Forch - Solaris gethostbyname_r returns ptr, not integer */
-  if (!gethostbyname_r (hostname_ptr,
-                        &hent,
-                        buf,
-                        GETHOSTBYNAME_AUX_BUFLEN,
-                        &h_errnop))
-    {
-      API_SET_ERRNUM (ctx, IPMI_ERR_HOSTNAME_INVALID);
-      goto cleanup;
-    }
-#else  /* !HAVE_FUNC_GETHOSTBYNAME_R */
-  if (freeipmi_gethostbyname_r (hostname_ptr,
-                                &hent,
-                                buf,
-                                GETHOSTBYNAME_AUX_BUFLEN,
-                                &hptr,
-                                &h_errnop))
-    {
-      API_SET_ERRNUM (ctx, IPMI_ERR_HOSTNAME_INVALID);
-      goto cleanup;
-    }
-  if (!hptr)
-    {
-      API_SET_ERRNUM (ctx, IPMI_ERR_HOSTNAME_INVALID);
-      goto cleanup;
+      API_SET_ERRNUM (ctx, errnum);
+      return (-1);
     }
-#endif /* !HAVE_FUNC_GETHOSTBYNAME_R */
-
-  strncpy (ctx->io.outofband.hostname,
-           hostname_ptr,
-           MAXHOSTNAMELEN);
 
-  ctx->io.outofband.remote_host.sin_family = AF_INET;
-  ctx->io.outofband.remote_host.sin_port = htons (port);
-  ctx->io.outofband.remote_host.sin_addr = *(struct in_addr *) hent.h_addr;
-
-  rv = 0;
- cleanup:
-  free (hostname_copy);
-  return (rv);
+  return (0);
 }
 
 static int
@@ -540,6 +474,7 @@ ipmi_ctx_open_outofband (ipmi_ctx_t ctx,
     }
 
   ctx->type = IPMI_DEVICE_LAN;
+  ctx->io.outofband.crypt_cache_session = 0;
   ctx->workaround_flags_outofband = workaround_flags;
   ctx->flags = flags;
 
@@ -614,6 +549,10 @@ ipmi_ctx_open_outofband (ipmi_ctx_t ctx,
       goto cleanup;
     }
 
+  /* keyed crypt handles are only cached while the session is open */
+  if (!crypt_cache_session_start ())
+    ctx->io.outofband.crypt_cache_session = 1;
+
   if (_setup_socket (ctx) < 0)
     goto cleanup;
 
@@ -694,6 +633,7 @@ ipmi_ctx_open_outofband_2_0 (ipmi_ctx_t ctx,
     }
 
   ctx->type = IPMI_DEVICE_LAN_2_0;
+  ctx->io.outofband.crypt_cache_session = 0;
   ctx->workaround_flags_outofband_2_0 = workaround_flags;
   ctx->flags = flags;
 
@@ -834,6 +774,10 @@ ipmi_ctx_open_outofband_2_0 (ipmi_ctx_t ctx,
       goto cleanup;
     }
 
+  /* keyed crypt handles are only cached while the session is open */
+  if (!crypt_cache_session_start ())
+    ctx->io.outofband.crypt_cache_session = 1;
+
   if (_setup_socket (ctx) < 0)
     goto cleanup;
 
@@ -1911,6 +1855,77 @@ ipmi_cmd_ipmb (ipmi_ctx_t ctx,
   return (rv);
 }
 
+int
+ipmi_cmd_pipeline (ipmi_ctx_t ctx,
+                   uint8_t lun,
+                   uint8_t net_fn,
+                   fiid_obj_t *obj_cmd_rq,
+                   fiid_obj_t *obj_cmd_rs,
+                   unsigned int count)
+{
+  unsigned int i;
+
+  if (!ctx || ctx->magic != IPMI_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_ctx_errormsg (ctx), ipmi_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!obj_cmd_rq
+      || !obj_cmd_rs
+      || !count)
+    {
+      API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  /* pipelining is only possible within an outofband session, when
+   * talking to the BMC directly.
+   */
+  if ((ctx->type == IPMI_DEVICE_LAN
+       || ctx->type == IPMI_DEVICE_LAN_2_0)
+      && !(ctx->flags & IPMI_FLAGS_NOSESSION)
+      && !(ctx->target.channel_number_is_set
+           && ctx->target.rs_addr_is_set)
+      && ctx->pipeline_window > 1
+      && count > 1)
+    {
+      for (i = 0; i < count; i++)
+        {
+          if (!fiid_obj_valid (obj_cmd_rq[i])
+              || !fiid_obj_valid (obj_cmd_rs[i]))
+            {
+              API_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+              return (-1);
+            }
+
+          if (FIID_OBJ_PACKET_VALID (obj_cmd_rq[i]) < 0)
+            {
+              API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, obj_cmd_rq[i]);
+              return (-1);
+            }
+        }
+
+      ctx->target.lun = lun;
+      ctx->target.net_fn = net_fn;
+
+      if (api_lan_cmd_pipeline (ctx, obj_cmd_rq, obj_cmd_rs, count) < 0)
+        return (-1);
+
+      ctx->errnum = IPMI_ERR_SUCCESS;
+      return (0);
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      /* errnum set in ipmi_cmd() */
+      if (ipmi_cmd (ctx, lun, net_fn, obj_cmd_rq[i], obj_cmd_rs[i]) < 0)
+        return (-1);
+    }
+
+  return (0);
+}
+
 int
 ipmi_cmd_raw (ipmi_ctx_t ctx,
               uint8_t lun,
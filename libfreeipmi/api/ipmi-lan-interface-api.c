@@ -247,6 +247,31 @@ api_lan_cmd_raw_ipmb (ipmi_ctx_t ctx,
   return (rv);
 }
 
+/* for IPMI 1.5 and IPMI 2.0 */
+int
+api_lan_cmd_pipeline (ipmi_ctx_t ctx,
+		      fiid_obj_t *obj_cmd_rq,
+		      fiid_obj_t *obj_cmd_rs,
+		      unsigned int count)
+{
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+          && !(ctx->flags & IPMI_FLAGS_NOSESSION)
+	  && ctx->io.outofband.sockfd
+          && obj_cmd_rq
+          && obj_cmd_rs
+          && count);
+
+  return (api_lan_cmd_wrapper_pipeline (ctx,
+					ctx->target.lun,
+					ctx->target.net_fn,
+					obj_cmd_rq,
+					obj_cmd_rs,
+					count));
+}
+
 int
 api_lan_2_0_cmd (ipmi_ctx_t ctx,
 		 fiid_obj_t obj_cmd_rq,
@@ -43,6 +43,11 @@ int api_lan_cmd_raw_ipmb (ipmi_ctx_t ctx,
 			  void *buf_rs,
 			  unsigned int buf_rs_len);
 
+int api_lan_cmd_pipeline (ipmi_ctx_t ctx,
+			  fiid_obj_t *obj_cmd_rq,
+			  fiid_obj_t *obj_cmd_rs,
+			  unsigned int count);
+
 int api_lan_2_0_cmd (ipmi_ctx_t ctx,
 		     fiid_obj_t obj_cmd_rq,
 		     fiid_obj_t obj_cmd_rs);
@@ -4319,3 +4319,670 @@ api_lan_2_0_close_session (ipmi_ctx_t ctx)
   fiid_obj_destroy (obj_cmd_rs);
   return (rv);
 }
+
+/* Pipelined commands
+ *
+ * Up to ctx->pipeline_window requests are in flight at once.  Every
+ * transmission of a request, including retransmissions, uses its own
+ * requester and session sequence numbers.  Responses are matched to
+ * requests by requester sequence number, so they may arrive in any
+ * order.  Entries are kept oldest first.
+ */
+struct api_lan_pipeline_entry
+{
+  unsigned int index;           /* into obj_cmd_rq/obj_cmd_rs */
+  uint8_t rq_seq;
+  unsigned int retransmission_count;
+  struct timeval last_send;
+  uint8_t cmd;                  /* used for debugging */
+  uint8_t group_extension;      /* used for debugging */
+};
+
+struct api_lan_pipeline
+{
+  uint8_t lun;
+  uint8_t net_fn;
+  unsigned int internal_workaround_flags;
+  uint8_t authentication_type;  /* IPMI 1.5 */
+  uint8_t payload_authenticated; /* IPMI 2.0 */
+  uint8_t payload_encrypted;    /* IPMI 2.0 */
+  const char *password;
+  unsigned int password_len;
+  unsigned int intf_flags;
+};
+
+static int
+_api_lan_pipeline_send (ipmi_ctx_t ctx,
+			struct api_lan_pipeline *p,
+			struct api_lan_pipeline_entry *e,
+			fiid_obj_t obj_cmd_rq)
+{
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+          && p
+          && e
+          && fiid_obj_valid (obj_cmd_rq));
+
+  if (ctx->type == IPMI_DEVICE_LAN)
+    {
+      if (_api_lan_cmd_send (ctx,
+			     p->lun,
+			     p->net_fn,
+			     p->authentication_type,
+			     ctx->io.outofband.session_sequence_number,
+			     ctx->io.outofband.session_id,
+			     ctx->io.outofband.rq_seq,
+			     p->password,
+			     p->password_len,
+			     e->cmd,  /* for debug dumping */
+			     e->group_extension,  /* for debug dumping */
+			     obj_cmd_rq) < 0)
+	return (-1);
+    }
+  else
+    {
+      if (_api_lan_2_0_cmd_send (ctx,
+				 p->lun,
+				 p->net_fn,
+				 IPMI_PAYLOAD_TYPE_IPMI,
+				 p->payload_authenticated,
+				 p->payload_encrypted,
+				 ctx->io.outofband.session_sequence_number,
+				 ctx->io.outofband.managed_system_session_id,
+				 ctx->io.outofband.rq_seq,
+				 ctx->io.outofband.authentication_algorithm,
+				 ctx->io.outofband.integrity_algorithm,
+				 ctx->io.outofband.confidentiality_algorithm,
+				 ctx->io.outofband.integrity_key_ptr,
+				 ctx->io.outofband.integrity_key_len,
+				 ctx->io.outofband.confidentiality_key_ptr,
+				 ctx->io.outofband.confidentiality_key_len,
+				 p->password,
+				 p->password_len,
+				 e->cmd, /* for debug dumping */
+				 e->group_extension, /* for debug dumping */
+				 obj_cmd_rq) < 0)
+	return (-1);
+    }
+
+  e->rq_seq = ctx->io.outofband.rq_seq;
+  e->last_send = ctx->io.outofband.last_send;
+
+  ctx->io.outofband.session_sequence_number++;
+  /* In IPMI 2.0, session sequence numbers of 0 are special */
+  if (ctx->type == IPMI_DEVICE_LAN_2_0
+      && !ctx->io.outofband.session_sequence_number)
+    ctx->io.outofband.session_sequence_number++;
+  ctx->io.outofband.rq_seq = (ctx->io.outofband.rq_seq + 1) % (IPMI_LAN_REQUESTER_SEQUENCE_NUMBER_MAX + 1);
+  return (0);
+}
+
+static void
+_api_lan_pipeline_retransmission_timeout (ipmi_ctx_t ctx,
+					  struct api_lan_pipeline_entry *e,
+					  struct timeval *timeout)
+{
+  struct timeval retransmission_timeout_len;
+  unsigned int retransmission_timeout_multiplier;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+	  && e
+	  && timeout);
+
+  retransmission_timeout_multiplier = (e->retransmission_count / IPMI_LAN_BACKOFF_COUNT) + 1;
+
+  retransmission_timeout_len.tv_sec = (retransmission_timeout_multiplier * ctx->io.outofband.retransmission_timeout) / 1000;
+  retransmission_timeout_len.tv_usec = ((retransmission_timeout_multiplier * ctx->io.outofband.retransmission_timeout) - (retransmission_timeout_len.tv_sec * 1000)) * 1000;
+
+  timeradd (&(e->last_send), &retransmission_timeout_len, timeout);
+}
+
+/* return 1 if packet available, 0 on timeout, -1 on error */
+static int
+_api_lan_pipeline_wait (ipmi_ctx_t ctx,
+			struct api_lan_pipeline_entry *entries,
+			unsigned int entries_count)
+{
+  struct timeval current;
+  struct timeval timeout;
+  struct timeval session_timeout;
+  struct timeval session_timeout_len;
+  fd_set read_set;
+  unsigned int i;
+  int status;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+	  && entries
+	  && entries_count);
+
+  session_timeout_len.tv_sec = ctx->io.outofband.session_timeout / 1000;
+  session_timeout_len.tv_usec = (ctx->io.outofband.session_timeout - (session_timeout_len.tv_sec * 1000)) * 1000;
+  timeradd (&(ctx->io.outofband.last_received), &session_timeout_len, &session_timeout);
+
+  if (ctx->io.outofband.retransmission_timeout)
+    {
+      for (i = 0; i < entries_count; i++)
+	{
+	  struct timeval retransmission_timeout;
+
+	  _api_lan_pipeline_retransmission_timeout (ctx,
+						    &entries[i],
+						    &retransmission_timeout);
+	  if (timercmp (&retransmission_timeout, &session_timeout, <))
+	    session_timeout = retransmission_timeout;
+	}
+    }
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      API_ERRNO_TO_API_ERRNUM (ctx, errno);
+      return (-1);
+    }
+
+  if (timercmp (&current, &session_timeout, <))
+    timersub (&session_timeout, &current, &timeout);
+  else
+    timerclear (&timeout);
+
+  FD_ZERO (&read_set);
+  FD_SET (ctx->io.outofband.sockfd, &read_set);
+
+  if ((status = select ((ctx->io.outofband.sockfd + 1),
+			&read_set,
+			NULL,
+			NULL,
+			&timeout)) < 0)
+    {
+      if (errno == EINTR)
+	return (0);
+      API_ERRNO_TO_API_ERRNUM (ctx, errno);
+      return (-1);
+    }
+
+  return (status ? 1 : 0);
+}
+
+/* retransmit requests whose retransmission timeout has passed */
+static int
+_api_lan_pipeline_retransmit (ipmi_ctx_t ctx,
+			      struct api_lan_pipeline *p,
+			      struct api_lan_pipeline_entry *entries,
+			      unsigned int entries_count,
+			      fiid_obj_t *obj_cmd_rq)
+{
+  struct timeval current;
+  unsigned int i;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+	  && p
+	  && entries
+	  && obj_cmd_rq);
+
+  if (!ctx->io.outofband.retransmission_timeout)
+    return (0);
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      API_ERRNO_TO_API_ERRNUM (ctx, errno);
+      return (-1);
+    }
+
+  for (i = 0; i < entries_count; i++)
+    {
+      struct timeval retransmission_timeout;
+
+      _api_lan_pipeline_retransmission_timeout (ctx,
+						&entries[i],
+						&retransmission_timeout);
+      if (timercmp (&current, &retransmission_timeout, <))
+	continue;
+
+      entries[i].retransmission_count++;
+
+      if (_api_lan_pipeline_send (ctx,
+				  p,
+				  &entries[i],
+				  obj_cmd_rq[entries[i].index]) < 0)
+	return (-1);
+    }
+
+  return (0);
+}
+
+static int
+_api_lan_pipeline_unassemble (ipmi_ctx_t ctx,
+			      struct api_lan_pipeline *p,
+			      const void *pkt,
+			      unsigned int pkt_len,
+			      fiid_obj_t obj_cmd_rs)
+{
+  int ret;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+	  && p
+	  && pkt
+	  && pkt_len
+	  && fiid_obj_valid (obj_cmd_rs));
+
+  if (ctx->type == IPMI_DEVICE_LAN)
+    ret = unassemble_ipmi_lan_pkt (pkt,
+				   pkt_len,
+				   ctx->io.outofband.rs.obj_rmcp_hdr,
+				   ctx->io.outofband.rs.obj_lan_session_hdr,
+				   ctx->io.outofband.rs.obj_lan_msg_hdr,
+				   obj_cmd_rs,
+				   ctx->io.outofband.rs.obj_lan_msg_trlr,
+				   p->intf_flags);
+  else
+    ret = unassemble_ipmi_rmcpplus_pkt (ctx->io.outofband.authentication_algorithm,
+					ctx->io.outofband.integrity_algorithm,
+					ctx->io.outofband.confidentiality_algorithm,
+					ctx->io.outofband.integrity_key_ptr,
+					ctx->io.outofband.integrity_key_len,
+					ctx->io.outofband.confidentiality_key_ptr,
+					ctx->io.outofband.confidentiality_key_len,
+					pkt,
+					pkt_len,
+					ctx->io.outofband.rs.obj_rmcp_hdr,
+					ctx->io.outofband.rs.obj_rmcpplus_session_hdr,
+					ctx->io.outofband.rs.obj_rmcpplus_payload,
+					ctx->io.outofband.rs.obj_lan_msg_hdr,
+					obj_cmd_rs,
+					ctx->io.outofband.rs.obj_lan_msg_trlr,
+					ctx->io.outofband.rs.obj_rmcpplus_session_trlr,
+					p->intf_flags);
+
+  if (ret < 0)
+    {
+      API_ERRNO_TO_API_ERRNUM (ctx, errno);
+      return (-1);
+    }
+
+  return (ret);
+}
+
+/* return index of matching entry, -1 if no match, -2 on error */
+static int
+_api_lan_pipeline_match (ipmi_ctx_t ctx,
+			 struct api_lan_pipeline *p,
+			 struct api_lan_pipeline_entry *entries,
+			 unsigned int entries_count,
+			 const void *pkt,
+			 unsigned int pkt_len,
+			 fiid_obj_t *obj_cmd_rs)
+{
+  fiid_obj_t obj_rs;
+  unsigned int i;
+  uint64_t val;
+  int ret;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+	  && p
+	  && entries
+	  && entries_count
+	  && pkt
+	  && pkt_len
+	  && obj_cmd_rs);
+
+  /* The lan message header, and with it the requester sequence
+   * number, is parsed before the command.  So unassemble with the
+   * oldest request's response object, which normally is the match,
+   * and unassemble again if the response is for another request.
+   */
+  if ((ret = _api_lan_pipeline_unassemble (ctx,
+					   p,
+					   pkt,
+					   pkt_len,
+					   obj_cmd_rs[entries[0].index])) < 0)
+    return (-2);
+
+  if ((ret = fiid_obj_get (ctx->io.outofband.rs.obj_lan_msg_hdr,
+			   "rq_seq",
+			   &val)) < 0)
+    {
+      API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_lan_msg_hdr);
+      return (-2);
+    }
+
+  /* cannot parse packet */
+  if (!ret)
+    return (-1);
+
+  for (i = 0; i < entries_count; i++)
+    {
+      if (entries[i].rq_seq == val)
+	break;
+    }
+
+  if (i == entries_count)
+    return (-1);
+
+  obj_rs = obj_cmd_rs[entries[i].index];
+
+  if (i)
+    {
+      if ((ret = _api_lan_pipeline_unassemble (ctx,
+					       p,
+					       pkt,
+					       pkt_len,
+					       obj_rs)) < 0)
+	return (-2);
+    }
+
+  /* its ok to use the "request" net_fn, dump code doesn't care */
+  if (ctx->flags & IPMI_FLAGS_DEBUG_DUMP)
+    {
+      if (ctx->type == IPMI_DEVICE_LAN)
+	_api_lan_dump_rs (ctx,
+			  pkt,
+			  pkt_len,
+			  entries[i].cmd,
+			  p->net_fn,
+			  entries[i].group_extension,
+			  obj_rs);
+      else
+	_api_lan_2_0_dump_rs (ctx,
+			      ctx->io.outofband.authentication_algorithm,
+			      ctx->io.outofband.integrity_algorithm,
+			      ctx->io.outofband.confidentiality_algorithm,
+			      ctx->io.outofband.integrity_key_ptr,
+			      ctx->io.outofband.integrity_key_len,
+			      ctx->io.outofband.confidentiality_key_ptr,
+			      ctx->io.outofband.confidentiality_key_len,
+			      pkt,
+			      pkt_len,
+			      entries[i].cmd,
+			      p->net_fn,
+			      entries[i].group_extension,
+			      obj_rs);
+    }
+
+  if (!ret)
+    return (-1);
+
+  if (ctx->type == IPMI_DEVICE_LAN)
+    ret = _api_lan_cmd_wrapper_verify_packet (ctx,
+					      p->internal_workaround_flags,
+					      p->authentication_type,
+					      1,
+					      &(ctx->io.outofband.session_sequence_number),
+					      ctx->io.outofband.session_id,
+					      &(entries[i].rq_seq),
+					      p->password,
+					      p->password_len,
+					      obj_rs);
+  else
+    ret = _api_lan_2_0_cmd_wrapper_verify_packet (ctx,
+						  IPMI_PAYLOAD_TYPE_IPMI,
+						  NULL,
+						  &(ctx->io.outofband.session_sequence_number),
+						  ctx->io.outofband.managed_system_session_id,
+						  &(entries[i].rq_seq),
+						  ctx->io.outofband.integrity_algorithm,
+						  ctx->io.outofband.integrity_key_ptr,
+						  ctx->io.outofband.integrity_key_len,
+						  p->password,
+						  p->password_len,
+						  obj_rs,
+						  pkt,
+						  pkt_len);
+
+  if (ret < 0)
+    return (-2);
+
+  if (!ret)
+    return (-1);
+
+  return (i);
+}
+
+int
+api_lan_cmd_wrapper_pipeline (ipmi_ctx_t ctx,
+			      uint8_t lun,
+			      uint8_t net_fn,
+			      fiid_obj_t *obj_cmd_rq,
+			      fiid_obj_t *obj_cmd_rs,
+			      unsigned int count)
+{
+  struct api_lan_pipeline_entry entries[IPMI_PIPELINE_WINDOW_MAX];
+  struct api_lan_pipeline p;
+  unsigned int entries_count = 0;
+  unsigned int window;
+  unsigned int next = 0;
+  unsigned int done = 0;
+  uint8_t pkt[IPMI_MAX_PKT_LEN];
+  int recv_len, ret, rv = -1;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && (ctx->type == IPMI_DEVICE_LAN
+              || ctx->type == IPMI_DEVICE_LAN_2_0)
+          && !(ctx->flags & IPMI_FLAGS_NOSESSION)
+          && ctx->io.outofband.sockfd
+          && IPMI_BMC_LUN_VALID (lun)
+          && IPMI_NET_FN_VALID (net_fn)
+          && obj_cmd_rq
+          && obj_cmd_rs
+          && count);
+
+  memset (&p, '\0', sizeof (struct api_lan_pipeline));
+  p.lun = lun;
+  p.net_fn = net_fn;
+  p.intf_flags = IPMI_INTERFACE_FLAGS_DEFAULT;
+  if (ctx->flags & IPMI_FLAGS_NO_LEGAL_CHECK)
+    p.intf_flags |= IPMI_INTERFACE_FLAGS_NO_LEGAL_CHECK;
+
+  if (ctx->type == IPMI_DEVICE_LAN)
+    {
+      api_lan_cmd_get_session_parameters (ctx,
+					  &p.authentication_type,
+					  &p.internal_workaround_flags);
+      /* if auth type NONE, still pass password.  Needed for
+       * check_unexpected_authcode workaround
+       */
+      p.password = ctx->io.outofband.password;
+      p.password_len = IPMI_1_5_MAX_PASSWORD_LENGTH;
+    }
+  else
+    {
+      api_lan_2_0_cmd_get_session_parameters (ctx,
+					      &p.payload_authenticated,
+					      &p.payload_encrypted);
+      p.password = strlen (ctx->io.outofband.password) ? ctx->io.outofband.password : NULL;
+      p.password_len = strlen (ctx->io.outofband.password);
+    }
+
+  window = ctx->pipeline_window;
+  if (window > IPMI_PIPELINE_WINDOW_MAX)
+    window = IPMI_PIPELINE_WINDOW_MAX;
+  if (window > count)
+    window = count;
+
+  if (!ctx->io.outofband.last_received.tv_sec
+      && !ctx->io.outofband.last_received.tv_usec)
+    {
+      if (gettimeofday (&ctx->io.outofband.last_received, NULL) < 0)
+        {
+          API_ERRNO_TO_API_ERRNUM (ctx, errno);
+          return (-1);
+        }
+    }
+
+  while (done < count)
+    {
+      while (entries_count < window && next < count)
+	{
+	  struct api_lan_pipeline_entry *e = &entries[entries_count];
+
+	  assert (fiid_obj_valid (obj_cmd_rq[next])
+		  && fiid_obj_packet_valid (obj_cmd_rq[next]) == 1
+		  && fiid_obj_valid (obj_cmd_rs[next]));
+
+	  memset (e, '\0', sizeof (struct api_lan_pipeline_entry));
+	  e->index = next;
+
+	  if (ctx->flags & IPMI_FLAGS_DEBUG_DUMP)
+	    {
+	      uint64_t val;
+
+	      /* ignore error, continue on */
+	      if (FIID_OBJ_GET (obj_cmd_rq[next],
+				"cmd",
+				&val) < 0)
+		API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, obj_cmd_rq[next]);
+	      else
+		e->cmd = val;
+
+	      if (IPMI_NET_FN_GROUP_EXTENSION (net_fn))
+		{
+		  /* ignore error, continue on */
+		  if (FIID_OBJ_GET (obj_cmd_rq[next],
+				    "group_extension_identification",
+				    &val) < 0)
+		    API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, obj_cmd_rq[next]);
+		  else
+		    e->group_extension = val;
+		}
+	    }
+
+	  if (_api_lan_pipeline_send (ctx, &p, e, obj_cmd_rq[next]) < 0)
+	    goto cleanup;
+
+	  entries_count++;
+	  next++;
+	}
+
+      if ((ret = _session_timed_out (ctx)) < 0)
+        goto cleanup;
+
+      if (ret)
+        {
+          API_SET_ERRNUM (ctx, IPMI_ERR_SESSION_TIMEOUT);
+          goto cleanup;
+        }
+
+      if ((ret = _api_lan_pipeline_wait (ctx, entries, entries_count)) < 0)
+	goto cleanup;
+
+      if (_api_lan_pipeline_retransmit (ctx,
+					&p,
+					entries,
+					entries_count,
+					obj_cmd_rq) < 0)
+	goto cleanup;
+
+      if (!ret)
+	continue;
+
+      if (fiid_obj_clear (ctx->io.outofband.rs.obj_rmcp_hdr) < 0)
+	{
+	  API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_rmcp_hdr);
+	  goto cleanup;
+	}
+      if (fiid_obj_clear (ctx->io.outofband.rs.obj_lan_msg_hdr) < 0)
+	{
+	  API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_lan_msg_hdr);
+	  goto cleanup;
+	}
+      if (fiid_obj_clear (ctx->io.outofband.rs.obj_lan_msg_trlr) < 0)
+	{
+	  API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_lan_msg_trlr);
+	  goto cleanup;
+	}
+      if (ctx->type == IPMI_DEVICE_LAN)
+	{
+	  if (fiid_obj_clear (ctx->io.outofband.rs.obj_lan_session_hdr) < 0)
+	    {
+	      API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_lan_session_hdr);
+	      goto cleanup;
+	    }
+	}
+      else
+	{
+	  if (fiid_obj_clear (ctx->io.outofband.rs.obj_rmcpplus_session_hdr) < 0)
+	    {
+	      API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_rmcpplus_session_hdr);
+	      goto cleanup;
+	    }
+	  if (fiid_obj_clear (ctx->io.outofband.rs.obj_rmcpplus_payload) < 0)
+	    {
+	      API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_rmcpplus_payload);
+	      goto cleanup;
+	    }
+	  if (fiid_obj_clear (ctx->io.outofband.rs.obj_rmcpplus_session_trlr) < 0)
+	    {
+	      API_FIID_OBJECT_ERROR_TO_API_ERRNUM (ctx, ctx->io.outofband.rs.obj_rmcpplus_session_trlr);
+	      goto cleanup;
+	    }
+	}
+
+      memset (pkt, '\0', IPMI_MAX_PKT_LEN);
+      do
+	{
+	  /* see _api_lan_recvfrom(), identical for IPMI 1.5 and 2.0 */
+	  recv_len = ipmi_lan_recvfrom (ctx->io.outofband.sockfd,
+					pkt,
+					IPMI_MAX_PKT_LEN,
+					0,
+					NULL,
+					NULL);
+	} while (recv_len < 0 && errno == EINTR);
+
+      if (recv_len < 0)
+	{
+	  /* see _api_lan_cmd_recv() on ECONNRESET and ECONNREFUSED */
+	  if (errno == ECONNRESET
+	      || errno == ECONNREFUSED)
+	    continue;
+
+	  API_ERRNO_TO_API_ERRNUM (ctx, errno);
+	  goto cleanup;
+	}
+
+      if (!recv_len)
+	continue;
+
+      if ((ret = _api_lan_pipeline_match (ctx,
+					  &p,
+					  entries,
+					  entries_count,
+					  pkt,
+					  recv_len,
+					  obj_cmd_rs)) < -1)
+	goto cleanup;
+
+      if (ret < 0)
+	continue;
+
+      if (gettimeofday (&(ctx->io.outofband.last_received), NULL) < 0)
+	{
+	  API_ERRNO_TO_API_ERRNUM (ctx, errno);
+	  goto cleanup;
+	}
+
+      entries_count--;
+      memmove (&entries[ret],
+	       &entries[ret + 1],
+	       (entries_count - ret) * sizeof (struct api_lan_pipeline_entry));
+      done++;
+    }
+
+  rv = 0;
+ cleanup:
+  return (rv);
+}
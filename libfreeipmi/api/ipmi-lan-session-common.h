@@ -88,4 +88,14 @@ int api_lan_2_0_open_session (ipmi_ctx_t ctx);
 
 int api_lan_2_0_close_session (ipmi_ctx_t ctx);
 
+/* Pipelined in-session commands for IPMI 1.5 and IPMI 2.0, up to
+ * ctx->pipeline_window requests in flight at once.
+ */
+int api_lan_cmd_wrapper_pipeline (ipmi_ctx_t ctx,
+				  uint8_t lun,
+				  uint8_t net_fn,
+				  fiid_obj_t *obj_cmd_rq,
+				  fiid_obj_t *obj_cmd_rs,
+				  unsigned int count);
+
 #endif /* IPMI_LAN_SESSION_COMMON_H */
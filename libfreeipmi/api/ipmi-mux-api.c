@@ -0,0 +1,3299 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/poll.h>
+#include <netinet/in.h>
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif  /* !TIME_WITH_SYS_TIME */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "freeipmi/api/ipmi-mux-api.h"
+#include "freeipmi/cmds/ipmi-messaging-support-cmds.h"
+#include "freeipmi/fiid/fiid.h"
+#include "freeipmi/interface/ipmi-interface.h"
+#include "freeipmi/interface/ipmi-lan-interface.h"
+#include "freeipmi/interface/ipmi-rmcpplus-interface.h"
+#include "freeipmi/interface/rmcp-interface.h"
+#include "freeipmi/spec/ipmi-authentication-type-spec.h"
+#include "freeipmi/spec/ipmi-channel-spec.h"
+#include "freeipmi/spec/ipmi-comp-code-spec.h"
+#include "freeipmi/spec/ipmi-ipmb-lun-spec.h"
+#include "freeipmi/spec/ipmi-netfn-spec.h"
+#include "freeipmi/spec/ipmi-privilege-level-spec.h"
+#include "freeipmi/spec/ipmi-rmcpplus-status-spec.h"
+#include "freeipmi/spec/ipmi-slave-address-spec.h"
+#include "freeipmi/util/ipmi-cipher-suite-util.h"
+#include "freeipmi/util/ipmi-lan-util.h"
+#include "freeipmi/util/ipmi-outofband-util.h"
+#include "freeipmi/util/ipmi-rmcpplus-util.h"
+#include "freeipmi/util/ipmi-util.h"
+
+#include "ipmi-api-defs.h"
+#include "ipmi-api-trace.h"
+#include "ipmi-api-util.h"
+
+#include "freeipmi-portability.h"
+#include "dgram.h"
+#include "hash.h"
+#include "timeval.h"
+
+#define IPMI_MUX_CTX_MAGIC       0xd1e5c0a7
+#define IPMI_MUX_SESSION_MAGIC   0xd1e5c0a8
+
+#define IPMI_MUX_ADDRS_HASH_SIZE 1024
+
+#define IPMI_MUX_BACKOFF_COUNT   2
+
+#define MUX_SET_ERRNUM(__ctx, __errnum)                                     \
+  do {                                                                      \
+    (__ctx)->errnum = (__errnum);                                           \
+    TRACE_MSG_OUT (ipmi_mux_ctx_errormsg ((__ctx)), (__errnum));            \
+  } while (0)
+
+typedef enum
+  {
+    IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES,
+    IPMI_MUX_STATE_GET_SESSION_CHALLENGE,
+    IPMI_MUX_STATE_ACTIVATE_SESSION,
+    IPMI_MUX_STATE_OPEN_SESSION,
+    IPMI_MUX_STATE_RAKP_MESSAGE_1,
+    IPMI_MUX_STATE_RAKP_MESSAGE_3,
+    IPMI_MUX_STATE_SET_SESSION_PRIVILEGE_LEVEL,
+    IPMI_MUX_STATE_ESTABLISHED,
+    IPMI_MUX_STATE_CLOSE_SESSION,
+    IPMI_MUX_STATE_CLOSED,
+  } ipmi_mux_state_t;
+
+struct ipmi_mux_request
+{
+  uint8_t lun;
+  uint8_t net_fn;
+  fiid_obj_t obj_cmd_rq;
+  fiid_obj_t obj_cmd_rs;
+  Ipmi_Mux_Callback callback;
+  void *callback_data;
+  struct ipmi_mux_request *next;
+};
+
+/* All sessions to the same remote address and port */
+struct ipmi_mux_addr
+{
+  struct sockaddr_in addr;
+  struct ipmi_mux_session *sessions;
+};
+
+struct ipmi_mux_session
+{
+  uint32_t magic;
+  struct ipmi_mux_ctx *ctx;
+  struct ipmi_mux_addr *maddr;
+  struct ipmi_mux_session *addr_next;
+  struct ipmi_mux_session *next;
+  struct ipmi_mux_session *prev;
+  int destroyed;
+
+  ipmi_mux_state_t state;
+  ipmi_driver_type_t type;      /* IPMI_DEVICE_LAN or IPMI_DEVICE_LAN_2_0 */
+  char hostname[MAXHOSTNAMELEN+1];
+  char username[IPMI_MAX_USER_NAME_LENGTH+1];
+  char password[IPMI_2_0_MAX_PASSWORD_LENGTH+1];
+  uint8_t authentication_type;
+  uint8_t privilege_level;
+  unsigned int session_timeout;
+  unsigned int retransmission_timeout;
+  unsigned int workaround_flags;
+  unsigned int workaround_flags_2_0;
+  unsigned int flags;
+
+  int per_msg_auth_disabled;
+  uint32_t session_id;          /* temp session id until activated */
+  uint32_t session_sequence_number;
+  uint32_t highest_received_sequence_number;
+  uint32_t previously_received_list;
+  uint8_t rq_seq;
+
+  /* IPMI 2.0 */
+  uint8_t k_g[IPMI_MAX_K_G_LENGTH];
+  int k_g_configured;
+  uint8_t cipher_suite_id;
+  uint8_t authentication_algorithm;
+  uint8_t integrity_algorithm;
+  uint8_t confidentiality_algorithm;
+  uint8_t requested_maximum_privilege;
+  uint8_t message_tag;
+  uint32_t remote_console_session_id;
+  uint32_t managed_system_session_id;
+  uint8_t remote_console_random_number[IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH];
+  uint8_t managed_system_random_number[IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH];
+  uint8_t managed_system_guid[IPMI_MANAGED_SYSTEM_GUID_LENGTH];
+  uint8_t sik_key[IPMI_MAX_SIK_KEY_LENGTH];
+  void *sik_key_ptr;
+  unsigned int sik_key_len;
+  uint8_t integrity_key[IPMI_MAX_INTEGRITY_KEY_LENGTH];
+  void *integrity_key_ptr;
+  unsigned int integrity_key_len;
+  uint8_t confidentiality_key[IPMI_MAX_CONFIDENTIALITY_KEY_LENGTH];
+  void *confidentiality_key_ptr;
+  unsigned int confidentiality_key_len;
+
+  /* session setup and close commands */
+  fiid_obj_t obj_session_rq;
+  fiid_obj_t obj_session_rs;
+
+  /* called when session established/failed, then when closed */
+  Ipmi_Mux_Callback callback;
+  void *callback_data;
+  int close_pending;
+
+  /* user commands, the head is in flight when established */
+  struct ipmi_mux_request *rq_head;
+  struct ipmi_mux_request *rq_tail;
+
+  int in_flight;
+  unsigned int retransmission_count;
+  struct timeval send_start;
+  struct timeval last_send;
+  struct timeval last_received;
+  struct timeval timer_expire;
+  int timer_index;
+};
+
+struct ipmi_mux_ctx
+{
+  uint32_t magic;
+  int errnum;
+  int sockfd;
+  hash_t addrs;
+  struct ipmi_mux_session *sessions;
+
+  /* sessions destroyed while processing, freed when it is done */
+  int processing;
+  struct ipmi_mux_session *destroyed;
+
+  /* sessions with a packet in flight, ordered by next timeout */
+  struct ipmi_mux_session **timer_heap;
+  unsigned int timer_heap_count;
+  unsigned int timer_heap_len;
+
+  fiid_obj_t obj_rmcp_hdr_rq;
+  fiid_obj_t obj_lan_session_hdr_rq;
+  fiid_obj_t obj_rmcpplus_session_hdr_rq;
+  fiid_obj_t obj_lan_msg_hdr_rq;
+  fiid_obj_t obj_rmcpplus_session_trlr_rq;
+  fiid_obj_t obj_rmcp_hdr_rs;
+  fiid_obj_t obj_lan_session_hdr_rs;
+  fiid_obj_t obj_rmcpplus_session_hdr_rs;
+  fiid_obj_t obj_lan_msg_hdr_rs;
+  fiid_obj_t obj_rmcpplus_payload_rs;
+  fiid_obj_t obj_lan_msg_trlr_rs;
+  fiid_obj_t obj_rmcpplus_session_trlr_rs;
+
+  struct dgram send_dgrams[DGRAM_BATCH_MAX];
+  uint8_t send_bufs[DGRAM_BATCH_MAX][IPMI_MAX_PKT_LEN];
+  unsigned int send_count;
+
+  struct dgram recv_dgrams[DGRAM_BATCH_MAX];
+  uint8_t recv_bufs[DGRAM_BATCH_MAX][IPMI_MAX_PKT_LEN];
+};
+
+static unsigned int
+_mux_addr_hash (const void *key)
+{
+  const struct sockaddr_in *addr = key;
+
+  return ((unsigned int)addr->sin_addr.s_addr * 2654435761U
+          ^ (unsigned int)addr->sin_port);
+}
+
+static int
+_mux_addr_cmp (const void *key1, const void *key2)
+{
+  const struct sockaddr_in *addr1 = key1;
+  const struct sockaddr_in *addr2 = key2;
+
+  return (!(addr1->sin_addr.s_addr == addr2->sin_addr.s_addr
+            && addr1->sin_port == addr2->sin_port));
+}
+
+static void
+_mux_timer_heap_swap (ipmi_mux_ctx_t ctx, unsigned int a, unsigned int b)
+{
+  ipmi_mux_session_t tmp;
+
+  tmp = ctx->timer_heap[a];
+  ctx->timer_heap[a] = ctx->timer_heap[b];
+  ctx->timer_heap[b] = tmp;
+  ctx->timer_heap[a]->timer_index = a;
+  ctx->timer_heap[b]->timer_index = b;
+}
+
+static void
+_mux_timer_heap_up (ipmi_mux_ctx_t ctx, unsigned int index)
+{
+  while (index)
+    {
+      unsigned int parent = (index - 1) / 2;
+
+      if (!timeval_lt (&(ctx->timer_heap[index]->timer_expire),
+                       &(ctx->timer_heap[parent]->timer_expire)))
+        break;
+
+      _mux_timer_heap_swap (ctx, index, parent);
+      index = parent;
+    }
+}
+
+static void
+_mux_timer_heap_down (ipmi_mux_ctx_t ctx, unsigned int index)
+{
+  while (1)
+    {
+      unsigned int left = index * 2 + 1;
+      unsigned int right = index * 2 + 2;
+      unsigned int smallest = index;
+
+      if (left < ctx->timer_heap_count
+          && timeval_lt (&(ctx->timer_heap[left]->timer_expire),
+                         &(ctx->timer_heap[smallest]->timer_expire)))
+        smallest = left;
+      if (right < ctx->timer_heap_count
+          && timeval_lt (&(ctx->timer_heap[right]->timer_expire),
+                         &(ctx->timer_heap[smallest]->timer_expire)))
+        smallest = right;
+
+      if (smallest == index)
+        break;
+
+      _mux_timer_heap_swap (ctx, index, smallest);
+      index = smallest;
+    }
+}
+
+static void
+_mux_timer_remove (ipmi_mux_session_t session)
+{
+  ipmi_mux_ctx_t ctx;
+  unsigned int index;
+
+  assert (session);
+
+  if (session->timer_index < 0)
+    return;
+
+  ctx = session->ctx;
+  index = session->timer_index;
+  ctx->timer_heap_count--;
+  if (index != ctx->timer_heap_count)
+    {
+      _mux_timer_heap_swap (ctx, index, ctx->timer_heap_count);
+      _mux_timer_heap_down (ctx, index);
+      _mux_timer_heap_up (ctx, index);
+    }
+  session->timer_index = -1;
+}
+
+/* insert session in the timer heap, or move it if already there */
+static int
+_mux_timer_set (ipmi_mux_session_t session, struct timeval *expire)
+{
+  ipmi_mux_ctx_t ctx;
+
+  assert (session);
+  assert (expire);
+
+  ctx = session->ctx;
+  session->timer_expire = *expire;
+
+  if (session->timer_index >= 0)
+    {
+      _mux_timer_heap_down (ctx, session->timer_index);
+      _mux_timer_heap_up (ctx, session->timer_index);
+      return (0);
+    }
+
+  if (ctx->timer_heap_count == ctx->timer_heap_len)
+    {
+      unsigned int len = ctx->timer_heap_len ? ctx->timer_heap_len * 2 : 64;
+      ipmi_mux_session_t *tmp;
+
+      if (!(tmp = (ipmi_mux_session_t *)realloc (ctx->timer_heap,
+                                                 len * sizeof (ipmi_mux_session_t))))
+        return (-1);
+
+      ctx->timer_heap = tmp;
+      ctx->timer_heap_len = len;
+    }
+
+  session->timer_index = ctx->timer_heap_count;
+  ctx->timer_heap[ctx->timer_heap_count++] = session;
+  _mux_timer_heap_up (ctx, session->timer_index);
+  return (0);
+}
+
+static void
+_mux_flush (ipmi_mux_ctx_t ctx)
+{
+  unsigned int i = 0;
+
+  assert (ctx);
+
+  /* Datagrams that cannot be sent are treated as lost on the
+   * network, they are retransmitted when their session's timer
+   * expires.
+   */
+  while (i < ctx->send_count)
+    {
+      int n;
+
+      if ((n = dgram_send_batch (ctx->sockfd,
+                                 ctx->send_dgrams + i,
+                                 ctx->send_count - i)) < 0)
+        n = 0;
+
+      /* skip over the datagram that failed */
+      i += n;
+      if (i < ctx->send_count)
+        i++;
+    }
+
+  ctx->send_count = 0;
+}
+
+static uint8_t
+_mux_authentication_type (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  if (session->per_msg_auth_disabled)
+    return (IPMI_AUTHENTICATION_TYPE_NONE);
+  return (session->authentication_type);
+}
+
+/* session has a session id and sequence numbers */
+static int
+_mux_in_session (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  return (session->state == IPMI_MUX_STATE_SET_SESSION_PRIVILEGE_LEVEL
+          || session->state == IPMI_MUX_STATE_ESTABLISHED
+          || session->state == IPMI_MUX_STATE_CLOSE_SESSION);
+}
+
+/* IPMI 2.0 sessions use RMCP+ packets after the authentication
+ * capabilities, which is sent via IPMI 1.5 like in
+ * api_lan_2_0_open_session().
+ */
+static int
+_mux_rmcpplus (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  return (session->type == IPMI_DEVICE_LAN_2_0
+          && session->state != IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES);
+}
+
+static uint8_t
+_mux_payload_type (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  if (session->state == IPMI_MUX_STATE_OPEN_SESSION)
+    return (IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_REQUEST);
+  if (session->state == IPMI_MUX_STATE_RAKP_MESSAGE_1)
+    return (IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_1);
+  if (session->state == IPMI_MUX_STATE_RAKP_MESSAGE_3)
+    return (IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_3);
+  return (IPMI_PAYLOAD_TYPE_IPMI);
+}
+
+static void
+_mux_current_cmd (ipmi_mux_session_t session,
+                  uint8_t *lun,
+                  uint8_t *net_fn,
+                  fiid_obj_t *obj_cmd_rq,
+                  fiid_obj_t *obj_cmd_rs)
+{
+  assert (session);
+  assert (session->in_flight);
+
+  if (session->state == IPMI_MUX_STATE_ESTABLISHED)
+    {
+      assert (session->rq_head);
+      if (lun)
+        *lun = session->rq_head->lun;
+      if (net_fn)
+        *net_fn = session->rq_head->net_fn;
+      if (obj_cmd_rq)
+        *obj_cmd_rq = session->rq_head->obj_cmd_rq;
+      if (obj_cmd_rs)
+        *obj_cmd_rs = session->rq_head->obj_cmd_rs;
+    }
+  else
+    {
+      if (lun)
+        *lun = IPMI_BMC_IPMB_LUN_BMC;
+      if (net_fn)
+        *net_fn = IPMI_NET_FN_APP_RQ;
+      if (obj_cmd_rq)
+        *obj_cmd_rq = session->obj_session_rq;
+      if (obj_cmd_rs)
+        *obj_cmd_rs = session->obj_session_rs;
+    }
+}
+
+static int
+_mux_assemble_lan (ipmi_mux_session_t session,
+                   uint8_t lun,
+                   uint8_t net_fn,
+                   fiid_obj_t obj_cmd_rq,
+                   void *pkt,
+                   unsigned int pkt_len)
+{
+  ipmi_mux_ctx_t ctx;
+  uint8_t authentication_type;
+  uint32_t session_sequence_number = 0;
+  uint32_t session_id = 0;
+  const char *password = NULL;
+  unsigned int password_len = 0;
+  int len;
+
+  assert (session);
+
+  ctx = session->ctx;
+
+  if (session->state == IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES
+      || session->state == IPMI_MUX_STATE_GET_SESSION_CHALLENGE)
+    authentication_type = IPMI_AUTHENTICATION_TYPE_NONE;
+  else if (session->state == IPMI_MUX_STATE_ACTIVATE_SESSION)
+    {
+      authentication_type = session->authentication_type;
+      session_id = session->session_id;
+      password = session->password;
+      password_len = IPMI_1_5_MAX_PASSWORD_LENGTH;
+    }
+  else
+    {
+      authentication_type = _mux_authentication_type (session);
+      session_sequence_number = session->session_sequence_number;
+      session_id = session->session_id;
+      password = session->password;
+      password_len = IPMI_1_5_MAX_PASSWORD_LENGTH;
+    }
+
+  if (fiid_obj_clear (ctx->obj_rmcp_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcp_hdr_rq);
+      return (-1);
+    }
+  if (fiid_obj_clear (ctx->obj_lan_session_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_lan_session_hdr_rq);
+      return (-1);
+    }
+  if (fiid_obj_clear (ctx->obj_lan_msg_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_lan_msg_hdr_rq);
+      return (-1);
+    }
+
+  if (fill_rmcp_hdr_ipmi (ctx->obj_rmcp_hdr_rq) < 0
+      || fill_lan_msg_hdr (IPMI_SLAVE_ADDRESS_BMC,
+                           net_fn,
+                           lun,
+                           session->rq_seq,
+                           ctx->obj_lan_msg_hdr_rq) < 0
+      || fill_lan_session_hdr (authentication_type,
+                               session_sequence_number,
+                               session_id,
+                               ctx->obj_lan_session_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  if ((len = assemble_ipmi_lan_pkt (ctx->obj_rmcp_hdr_rq,
+                                    ctx->obj_lan_session_hdr_rq,
+                                    ctx->obj_lan_msg_hdr_rq,
+                                    obj_cmd_rq,
+                                    password,
+                                    password_len,
+                                    pkt,
+                                    pkt_len,
+                                    IPMI_INTERFACE_FLAGS_DEFAULT)) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  return (len);
+}
+
+/* see _api_lan_2_0_cmd_send() */
+static int
+_mux_assemble_rmcpplus (ipmi_mux_session_t session,
+                        uint8_t lun,
+                        uint8_t net_fn,
+                        fiid_obj_t obj_cmd_rq,
+                        void *pkt,
+                        unsigned int pkt_len)
+{
+  ipmi_mux_ctx_t ctx;
+  uint8_t payload_type;
+  uint8_t payload_authenticated = IPMI_PAYLOAD_FLAG_UNAUTHENTICATED;
+  uint8_t payload_encrypted = IPMI_PAYLOAD_FLAG_UNENCRYPTED;
+  uint8_t authentication_algorithm = IPMI_AUTHENTICATION_ALGORITHM_RAKP_NONE;
+  uint8_t integrity_algorithm = IPMI_INTEGRITY_ALGORITHM_NONE;
+  uint8_t confidentiality_algorithm = IPMI_CONFIDENTIALITY_ALGORITHM_NONE;
+  const void *integrity_key = NULL;
+  unsigned int integrity_key_len = 0;
+  const void *confidentiality_key = NULL;
+  unsigned int confidentiality_key_len = 0;
+  uint32_t session_sequence_number = 0;
+  uint32_t session_id = 0;
+  const char *password = NULL;
+  unsigned int password_len = 0;
+  int len;
+
+  assert (session);
+
+  ctx = session->ctx;
+  payload_type = _mux_payload_type (session);
+
+  if (payload_type == IPMI_PAYLOAD_TYPE_IPMI)
+    {
+      if (session->integrity_algorithm != IPMI_INTEGRITY_ALGORITHM_NONE)
+        payload_authenticated = IPMI_PAYLOAD_FLAG_AUTHENTICATED;
+      if (session->confidentiality_algorithm != IPMI_CONFIDENTIALITY_ALGORITHM_NONE)
+        payload_encrypted = IPMI_PAYLOAD_FLAG_ENCRYPTED;
+      authentication_algorithm = session->authentication_algorithm;
+      integrity_algorithm = session->integrity_algorithm;
+      confidentiality_algorithm = session->confidentiality_algorithm;
+      integrity_key = session->integrity_key_ptr;
+      integrity_key_len = session->integrity_key_len;
+      confidentiality_key = session->confidentiality_key_ptr;
+      confidentiality_key_len = session->confidentiality_key_len;
+      session_sequence_number = session->session_sequence_number;
+      session_id = session->managed_system_session_id;
+      if (strlen (session->password))
+        password = session->password;
+      password_len = strlen (session->password);
+    }
+  else
+    {
+      /* Unlike most packets, the open session request, rakp 1 and
+       * rakp 3 messages have the message tags in a non-header field,
+       * so it is set on every (re)transmission.
+       */
+      if (fiid_obj_set (obj_cmd_rq, "message_tag", session->message_tag) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (obj_cmd_rq);
+          return (-1);
+        }
+    }
+
+  if (fiid_obj_clear (ctx->obj_rmcp_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcp_hdr_rq);
+      return (-1);
+    }
+  if (fiid_obj_clear (ctx->obj_rmcpplus_session_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcpplus_session_hdr_rq);
+      return (-1);
+    }
+  if (fiid_obj_clear (ctx->obj_lan_msg_hdr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_lan_msg_hdr_rq);
+      return (-1);
+    }
+  if (fiid_obj_clear (ctx->obj_rmcpplus_session_trlr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcpplus_session_trlr_rq);
+      return (-1);
+    }
+
+  if (fill_rmcp_hdr_ipmi (ctx->obj_rmcp_hdr_rq) < 0
+      || fill_rmcpplus_session_hdr (payload_type,
+                                    payload_authenticated,
+                                    payload_encrypted,
+                                    0, /* oem_iana */
+                                    0, /* oem_payload_id */
+                                    session_id,
+                                    session_sequence_number,
+                                    ctx->obj_rmcpplus_session_hdr_rq) < 0
+      || fill_lan_msg_hdr (IPMI_SLAVE_ADDRESS_BMC,
+                           net_fn,
+                           lun,
+                           session->rq_seq,
+                           ctx->obj_lan_msg_hdr_rq) < 0
+      || fill_rmcpplus_session_trlr (ctx->obj_rmcpplus_session_trlr_rq) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  if ((len = assemble_ipmi_rmcpplus_pkt (authentication_algorithm,
+                                         integrity_algorithm,
+                                         confidentiality_algorithm,
+                                         integrity_key,
+                                         integrity_key_len,
+                                         confidentiality_key,
+                                         confidentiality_key_len,
+                                         password,
+                                         password_len,
+                                         ctx->obj_rmcp_hdr_rq,
+                                         ctx->obj_rmcpplus_session_hdr_rq,
+                                         ctx->obj_lan_msg_hdr_rq,
+                                         obj_cmd_rq,
+                                         ctx->obj_rmcpplus_session_trlr_rq,
+                                         pkt,
+                                         pkt_len,
+                                         IPMI_INTERFACE_FLAGS_DEFAULT)) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  return (len);
+}
+
+/* assemble the in flight command into the send batch and (re)arm
+ * the session's timer
+ */
+static int
+_mux_send (ipmi_mux_session_t session)
+{
+  ipmi_mux_ctx_t ctx;
+  struct timeval now, expire, session_expire, *start;
+  fiid_obj_t obj_cmd_rq;
+  uint8_t lun, net_fn;
+  unsigned int multiplier;
+  int len;
+
+  assert (session);
+  assert (session->in_flight);
+
+  ctx = session->ctx;
+
+  _mux_current_cmd (session, &lun, &net_fn, &obj_cmd_rq, NULL);
+
+  if (ctx->send_count == DGRAM_BATCH_MAX)
+    _mux_flush (ctx);
+
+  if (_mux_rmcpplus (session))
+    len = _mux_assemble_rmcpplus (session,
+                                  lun,
+                                  net_fn,
+                                  obj_cmd_rq,
+                                  ctx->send_bufs[ctx->send_count],
+                                  IPMI_MAX_PKT_LEN);
+  else
+    len = _mux_assemble_lan (session,
+                             lun,
+                             net_fn,
+                             obj_cmd_rq,
+                             ctx->send_bufs[ctx->send_count],
+                             IPMI_MAX_PKT_LEN);
+  if (len < 0)
+    return (-1);
+
+  ctx->send_dgrams[ctx->send_count].buf = ctx->send_bufs[ctx->send_count];
+  ctx->send_dgrams[ctx->send_count].len = len;
+  ctx->send_dgrams[ctx->send_count].addr = session->maddr->addr;
+  ctx->send_count++;
+
+  if (gettimeofday (&now, NULL) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  if (!session->retransmission_count)
+    session->send_start = now;
+  session->last_send = now;
+
+  multiplier = (session->retransmission_count / IPMI_MUX_BACKOFF_COUNT) + 1;
+  timeval_add_ms (&now, multiplier * session->retransmission_timeout, &expire);
+
+  /* A session idle for longer than the session timeout is not timed
+   * out the moment a command is submitted, the command gets a full
+   * session timeout.
+   */
+  if (timeval_gt (&(session->send_start), &(session->last_received)))
+    start = &(session->send_start);
+  else
+    start = &(session->last_received);
+  timeval_add_ms (start, session->session_timeout, &session_expire);
+
+  if (timeval_lt (&session_expire, &expire))
+    expire = session_expire;
+
+  if (_mux_timer_set (session, &expire) < 0)
+    {
+      ctx->errnum = IPMI_ERR_OUT_OF_MEMORY;
+      return (-1);
+    }
+
+  if (!ctx->processing)
+    _mux_flush (ctx);
+
+  return (0);
+}
+
+static void
+_mux_next_seq (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  if (_mux_in_session (session))
+    {
+      session->session_sequence_number++;
+      /* In IPMI 2.0, session sequence numbers of 0 are special */
+      if (session->type == IPMI_DEVICE_LAN_2_0
+          && !session->session_sequence_number)
+        session->session_sequence_number++;
+    }
+  else if (session->state == IPMI_MUX_STATE_OPEN_SESSION
+           || session->state == IPMI_MUX_STATE_RAKP_MESSAGE_1
+           || session->state == IPMI_MUX_STATE_RAKP_MESSAGE_3)
+    session->message_tag++;
+  session->rq_seq = (session->rq_seq + 1) % (IPMI_LAN_REQUESTER_SEQUENCE_NUMBER_MAX + 1);
+}
+
+static void
+_mux_session_objs_destroy (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  fiid_obj_destroy (session->obj_session_rq);
+  session->obj_session_rq = NULL;
+  fiid_obj_destroy (session->obj_session_rs);
+  session->obj_session_rs = NULL;
+}
+
+static int
+_mux_session_objs_create (ipmi_mux_session_t session,
+                          fiid_template_t tmpl_cmd_rq,
+                          fiid_template_t tmpl_cmd_rs)
+{
+  assert (session);
+
+  _mux_session_objs_destroy (session);
+
+  if (!(session->obj_session_rq = fiid_obj_create (tmpl_cmd_rq)))
+    return (api_errnum_by_errno (errno));
+  if (!(session->obj_session_rs = fiid_obj_create (tmpl_cmd_rs)))
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static void
+_mux_request_free_all (struct ipmi_mux_request *rq)
+{
+  while (rq)
+    {
+      struct ipmi_mux_request *next = rq->next;
+      free (rq);
+      rq = next;
+    }
+}
+
+/* Terminate a session, calling the open callback if the session was
+ * being established and the callbacks of all queued commands.
+ */
+static void
+_mux_session_fail (ipmi_mux_session_t session, int errnum)
+{
+  struct ipmi_mux_request *rq;
+
+  assert (session);
+  assert (errnum != IPMI_ERR_SUCCESS);
+
+  session->state = IPMI_MUX_STATE_CLOSED;
+  session->in_flight = 0;
+  _mux_timer_remove (session);
+  _mux_session_objs_destroy (session);
+
+  rq = session->rq_head;
+  session->rq_head = session->rq_tail = NULL;
+
+  if (session->callback)
+    {
+      Ipmi_Mux_Callback callback = session->callback;
+      void *callback_data = session->callback_data;
+
+      session->callback = NULL;
+      session->callback_data = NULL;
+
+      /* open callback if still opening, close callback if closing */
+      callback (session, errnum, callback_data);
+    }
+
+  while (rq)
+    {
+      struct ipmi_mux_request *next = rq->next;
+
+      if (!session->destroyed && rq->callback)
+        rq->callback (session, errnum, rq->callback_data);
+      free (rq);
+      rq = next;
+    }
+}
+
+static int
+_mux_start_cmd (ipmi_mux_session_t session,
+                ipmi_mux_state_t state,
+                fiid_template_t tmpl_cmd_rq,
+                fiid_template_t tmpl_cmd_rs)
+{
+  int errnum;
+
+  assert (session);
+
+  if ((errnum = _mux_session_objs_create (session,
+                                          tmpl_cmd_rq,
+                                          tmpl_cmd_rs)) != IPMI_ERR_SUCCESS)
+    return (errnum);
+
+  session->state = state;
+  session->in_flight = 1;
+  session->retransmission_count = 0;
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_start_close (ipmi_mux_session_t session)
+{
+  uint32_t session_id;
+  int errnum;
+
+  assert (session);
+  assert (session->state == IPMI_MUX_STATE_ESTABLISHED);
+  assert (!session->in_flight);
+
+  if ((errnum = _mux_start_cmd (session,
+                                IPMI_MUX_STATE_CLOSE_SESSION,
+                                tmpl_cmd_close_session_rq,
+                                tmpl_cmd_close_session_rs)) != IPMI_ERR_SUCCESS)
+    return (errnum);
+
+  if (session->type == IPMI_DEVICE_LAN_2_0)
+    session_id = session->managed_system_session_id;
+  else
+    session_id = session->session_id;
+
+  if (fill_cmd_close_session (session_id,
+                              NULL,
+                              session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (_mux_send (session) < 0)
+    return (session->ctx->errnum);
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+/* send the next queued command or close the session if it is idle */
+static void
+_mux_session_next (ipmi_mux_session_t session)
+{
+  int errnum;
+
+  assert (session);
+
+  if (session->destroyed
+      || session->state != IPMI_MUX_STATE_ESTABLISHED
+      || session->in_flight)
+    return;
+
+  if (session->rq_head)
+    {
+      session->in_flight = 1;
+      session->retransmission_count = 0;
+      if (_mux_send (session) < 0)
+        _mux_session_fail (session, session->ctx->errnum);
+    }
+  else if (session->close_pending)
+    {
+      if ((errnum = _mux_start_close (session)) != IPMI_ERR_SUCCESS)
+        _mux_session_fail (session, errnum);
+    }
+}
+
+static int
+_mux_get_authentication_capabilities_rs (ipmi_mux_session_t session)
+{
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    return (api_errnum_by_bad_response (session->obj_session_rs));
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_open_session(), authentication capabilities flags
+   * may be reported incorrectly.
+   */
+  if (!(session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_AUTHENTICATION_CAPABILITIES))
+    {
+      if ((ret = ipmi_check_authentication_capabilities_username (strlen (session->username) ? session->username : NULL,
+                                                                  strlen (session->password) ? session->password : NULL,
+                                                                  session->obj_session_rs)) < 0)
+        return (api_errnum_by_errno (errno));
+
+      if (!ret)
+        return (IPMI_ERR_USERNAME_INVALID);
+    }
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_open_session(), the remote BMC may ignore if per
+   * message authentication is enabled or disabled.
+   */
+  if (!(session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_FORCE_PERMSG_AUTHENTICATION))
+    {
+      if (FIID_OBJ_GET (session->obj_session_rs,
+                        "authentication_status.per_message_authentication",
+                        &val) < 0)
+        return (api_errnum_by_fiid_object (session->obj_session_rs));
+      session->per_msg_auth_disabled = val;
+    }
+  else
+    session->per_msg_auth_disabled = 0;
+
+  if (!(session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_AUTHENTICATION_CAPABILITIES))
+    {
+      if ((ret = ipmi_check_authentication_capabilities_authentication_type (session->authentication_type,
+                                                                             session->obj_session_rs)) < 0)
+        return (api_errnum_by_errno (errno));
+
+      if (!ret)
+        return (IPMI_ERR_AUTHENTICATION_TYPE_UNAVAILABLE);
+    }
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_GET_SESSION_CHALLENGE,
+                             tmpl_cmd_get_session_challenge_rq,
+                             tmpl_cmd_get_session_challenge_rs)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  if (fill_cmd_get_session_challenge (session->authentication_type,
+                                      session->username,
+                                      IPMI_MAX_USER_NAME_LENGTH,
+                                      session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_get_session_challenge_rs (ipmi_mux_session_t session)
+{
+  uint8_t challenge_string[IPMI_CHALLENGE_STRING_LENGTH];
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    {
+      if (ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_GET_SESSION_CHALLENGE_INVALID_USERNAME) == 1
+          || ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_GET_SESSION_CHALLENGE_NULL_USERNAME_NOT_ENABLED) == 1)
+        return (IPMI_ERR_USERNAME_INVALID);
+      return (api_errnum_by_bad_response (session->obj_session_rs));
+    }
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "temp_session_id",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  session->session_id = val;
+
+  if (fiid_obj_get_data (session->obj_session_rs,
+                         "challenge_string",
+                         challenge_string,
+                         IPMI_CHALLENGE_STRING_LENGTH) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_ACTIVATE_SESSION,
+                             tmpl_cmd_activate_session_rq,
+                             tmpl_cmd_activate_session_rs)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  if (fill_cmd_activate_session (session->authentication_type,
+                                 session->privilege_level,
+                                 challenge_string,
+                                 IPMI_CHALLENGE_STRING_LENGTH,
+                                 rand (),
+                                 session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_activate_session_rs (ipmi_mux_session_t session)
+{
+  ipmi_mux_ctx_t ctx;
+  uint8_t authentication_type;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  ctx = session->ctx;
+
+  if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    {
+      if (ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_ACTIVATE_SESSION_NO_SESSION_SLOT_AVAILABLE) == 1
+          || ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_ACTIVATE_SESSION_NO_SLOT_AVAILABLE_FOR_GIVEN_USER) == 1
+          || ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_ACTIVATE_SESSION_NO_SLOT_AVAILABLE_TO_SUPPORT_USER) == 1)
+        return (IPMI_ERR_BMC_BUSY);
+      /* see api_lan_open_session() for the insufficient privilege workaround */
+      if (ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_ACTIVATE_SESSION_EXCEEDS_PRIVILEGE_LEVEL) == 1
+          || ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_INSUFFICIENT_PRIVILEGE_LEVEL) == 1)
+        return (IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED);
+      return (api_errnum_by_bad_response (session->obj_session_rs));
+    }
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "session_id",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  session->session_id = val;
+
+  /* achu: On some buggy BMCs the initial outbound sequence number on
+   * the activate session response is off by one.  So we just accept
+   * whatever sequence number they give us even if it isn't the
+   * initial outbound sequence number.
+   */
+  if (FIID_OBJ_GET (ctx->obj_lan_session_hdr_rs,
+                    "session_sequence_number",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (ctx->obj_lan_session_hdr_rs));
+  session->highest_received_sequence_number = val;
+
+  /* IPMI Workaround (achu)
+   *
+   * Discovered on Sun Fire 4100.
+   *
+   * The session sequence numbers for IPMI 1.5 are the wrong endian.
+   * So we have to flip the bits to workaround it.
+   */
+  if (session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_BIG_ENDIAN_SEQUENCE_NUMBER)
+    {
+      uint32_t tmp_session_sequence_number = session->highest_received_sequence_number;
+
+      session->highest_received_sequence_number =
+        ((tmp_session_sequence_number & 0xFF000000) >> 24)
+        | ((tmp_session_sequence_number & 0x00FF0000) >> 8)
+        | ((tmp_session_sequence_number & 0x0000FF00) << 8)
+        | ((tmp_session_sequence_number & 0x000000FF) << 24);
+    }
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "initial_inbound_sequence_number",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  session->session_sequence_number = val;
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "authentication_type",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  authentication_type = val;
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_open_session(), the remote BMC may ignore that per
+   * message authentication is disabled.
+   */
+  if (session->per_msg_auth_disabled
+      && authentication_type != IPMI_AUTHENTICATION_TYPE_NONE)
+    session->per_msg_auth_disabled = 0;
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_SET_SESSION_PRIVILEGE_LEVEL,
+                             tmpl_cmd_set_session_privilege_level_rq,
+                             tmpl_cmd_set_session_privilege_level_rs)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  if (fill_cmd_set_session_privilege_level (session->privilege_level,
+                                            session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_get_authentication_capabilities_2_0_rs (ipmi_mux_session_t session)
+{
+  int ret;
+
+  assert (session);
+  assert (session->type == IPMI_DEVICE_LAN_2_0);
+
+  if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    return (api_errnum_by_bad_response (session->obj_session_rs));
+
+  if ((ret = ipmi_check_authentication_capabilities_ipmi_2_0 (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    return (IPMI_ERR_IPMI_2_0_UNAVAILABLE);
+
+  /* IPMI Workaround
+   *
+   * See api_lan_2_0_open_session(), username and K_g capabilities
+   * may be reported incorrectly.
+   */
+  if (!(session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_AUTHENTICATION_CAPABILITIES))
+    {
+      if ((ret = ipmi_check_authentication_capabilities_username (strlen (session->username) ? session->username : NULL,
+                                                                  strlen (session->password) ? session->password : NULL,
+                                                                  session->obj_session_rs)) < 0)
+        return (api_errnum_by_errno (errno));
+
+      if (!ret)
+        return (IPMI_ERR_USERNAME_INVALID);
+
+      if ((ret = ipmi_check_authentication_capabilities_k_g (session->k_g_configured ? session->k_g : NULL,
+                                                             session->obj_session_rs)) < 0)
+        return (api_errnum_by_errno (errno));
+
+      if (!ret)
+        return (IPMI_ERR_K_G_INVALID);
+    }
+
+  /* In IPMI 2.0, session_ids of 0 are special */
+  do
+    {
+      if (ipmi_get_random (&(session->remote_console_session_id),
+                           sizeof (session->remote_console_session_id)) < 0)
+        return (api_errnum_by_errno (errno));
+    } while (!session->remote_console_session_id);
+
+  if (ipmi_cipher_suite_id_to_algorithms (session->cipher_suite_id,
+                                          &(session->authentication_algorithm),
+                                          &(session->integrity_algorithm),
+                                          &(session->confidentiality_algorithm)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_2_0_open_session(), some BMCs need the actual
+   * privilege rather than the "request highest privilege" flag.
+   */
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION
+      || session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_SUN_2_0_SESSION
+      || session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_OPEN_SESSION_PRIVILEGE)
+    session->requested_maximum_privilege = session->privilege_level;
+  else
+    session->requested_maximum_privilege = IPMI_PRIVILEGE_LEVEL_HIGHEST_LEVEL;
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_OPEN_SESSION,
+                             tmpl_rmcpplus_open_session_request,
+                             tmpl_rmcpplus_open_session_response)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  session->message_tag = (uint8_t)rand ();
+
+  if (fill_rmcpplus_open_session (session->message_tag,
+                                  session->requested_maximum_privilege,
+                                  session->remote_console_session_id,
+                                  session->authentication_algorithm,
+                                  session->integrity_algorithm,
+                                  session->confidentiality_algorithm,
+                                  session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+/* IPMI Workaround (achu)
+ *
+ * See api_lan_2_0_open_session(), with the Intel workaround the
+ * username must be padded for the RAKP 1 message, RAKP 2 check and
+ * session key creation.  The session username is zero padded.
+ */
+static void
+_mux_rakp_username (ipmi_mux_session_t session,
+                    int padded,
+                    const char **username,
+                    unsigned int *username_len)
+{
+  assert (session);
+  assert (username);
+  assert (username_len);
+
+  if (padded
+      && (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION))
+    {
+      *username = session->username;
+      *username_len = IPMI_MAX_USER_NAME_LENGTH;
+    }
+  else if (strlen (session->username))
+    {
+      *username = session->username;
+      *username_len = strlen (session->username);
+    }
+  else
+    {
+      *username = NULL;
+      *username_len = 0;
+    }
+}
+
+/* IPMI Workaround (achu)
+ *
+ * See api_lan_2_0_open_session(), with the Intel workaround and
+ * HMAC-MD5-128 the password is truncated to 16 bytes.
+ */
+static void
+_mux_rakp_password (ipmi_mux_session_t session,
+                    const char **password,
+                    unsigned int *password_len)
+{
+  assert (session);
+  assert (password);
+  assert (password_len);
+
+  if (strlen (session->password))
+    *password = session->password;
+  else
+    *password = NULL;
+  *password_len = strlen (session->password);
+
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION
+      && session->authentication_algorithm == IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_MD5
+      && *password_len > IPMI_1_5_MAX_PASSWORD_LENGTH)
+    *password_len = IPMI_1_5_MAX_PASSWORD_LENGTH;
+}
+
+static int
+_mux_open_session_rs (ipmi_mux_session_t session)
+{
+  uint8_t rmcpplus_status_code;
+  const char *username;
+  unsigned int username_len;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "rmcpplus_status_code",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  rmcpplus_status_code = val;
+
+  if (rmcpplus_status_code != RMCPPLUS_STATUS_NO_ERRORS)
+    {
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_NO_CIPHER_SUITE_MATCH_WITH_PROPOSED_SECURITY_ALGORITHMS)
+        return (IPMI_ERR_CIPHER_SUITE_ID_UNAVAILABLE);
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_INVALID_ROLE)
+        return (IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED);
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION
+          || rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION_AT_THE_REQUESTED_TIME)
+        return (IPMI_ERR_BMC_BUSY);
+      return (IPMI_ERR_BAD_RMCPPLUS_STATUS_CODE);
+    }
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_2_0_open_session(), Intel BMCs return
+   * IPMI_PRIVILEGE_LEVEL_HIGHEST_LEVEL instead of an actual
+   * privilege.
+   */
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION)
+    {
+      if (FIID_OBJ_GET (session->obj_session_rs,
+                        "maximum_privilege_level",
+                        &val) < 0)
+        return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+      ret = (val == session->requested_maximum_privilege) ? 1 : 0;
+    }
+  else
+    {
+      if ((ret = ipmi_check_open_session_maximum_privilege (session->privilege_level,
+                                                            session->obj_session_rs)) < 0)
+        return (api_errnum_by_errno (errno));
+    }
+
+  if (!ret)
+    return (IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED);
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "managed_system_session_id",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  session->managed_system_session_id = val;
+
+  if (ipmi_get_random (session->remote_console_random_number,
+                       IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_RAKP_MESSAGE_1,
+                             tmpl_rmcpplus_rakp_message_1,
+                             tmpl_rmcpplus_rakp_message_2)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  _mux_rakp_username (session, 1, &username, &username_len);
+
+  /* achu: Unlike IPMI 1.5, the length of the username must be actual
+   * length, it can't be the maximum length.
+   */
+  if (fill_rmcpplus_rakp_message_1 (session->message_tag,
+                                    session->managed_system_session_id,
+                                    session->remote_console_random_number,
+                                    IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH,
+                                    session->privilege_level,
+                                    IPMI_NAME_ONLY_LOOKUP,
+                                    username,
+                                    username_len,
+                                    session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+/* IPMI Workaround (achu)
+ *
+ * See api_lan_2_0_open_session(), Supermicro and Sun BMCs return key
+ * exchange authentication codes one byte too long.
+ */
+static int
+_mux_rakp_message_2_fix_key_exchange_authentication_code (ipmi_mux_session_t session)
+{
+  uint8_t buf[IPMI_MAX_PKT_LEN];
+  unsigned int digest_len = 0;
+  int buf_len;
+
+  assert (session);
+
+  if (!(session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_SUPERMICRO_2_0_SESSION)
+      && !((session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_SUN_2_0_SESSION)
+           && session->authentication_algorithm == IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_SHA1))
+    return (IPMI_ERR_SUCCESS);
+
+  if ((buf_len = fiid_obj_get_data (session->obj_session_rs,
+                                    "key_exchange_authentication_code",
+                                    buf,
+                                    IPMI_MAX_PKT_LEN)) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  if (session->authentication_algorithm == IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_SHA1)
+    digest_len = IPMI_HMAC_SHA1_DIGEST_LENGTH;
+  else if (session->authentication_algorithm == IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_MD5)
+    digest_len = IPMI_HMAC_MD5_DIGEST_LENGTH;
+  else if (session->authentication_algorithm == IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_SHA256)
+    digest_len = IPMI_HMAC_SHA256_DIGEST_LENGTH;
+
+  if (buf_len != (digest_len + 1))
+    return (IPMI_ERR_SUCCESS);
+
+  if (fiid_obj_clear_field (session->obj_session_rs,
+                            "key_exchange_authentication_code") < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  if (digest_len
+      && fiid_obj_set_data (session->obj_session_rs,
+                            "key_exchange_authentication_code",
+                            buf,
+                            digest_len) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_rakp_message_2 (ipmi_mux_session_t session)
+{
+  uint8_t key_exchange_authentication_code[IPMI_MAX_KEY_EXCHANGE_AUTHENTICATION_CODE_LENGTH];
+  int key_exchange_authentication_code_len;
+  uint8_t rmcpplus_status_code;
+  uint8_t name_only_lookup;
+  const char *username;
+  unsigned int username_len;
+  const char *password;
+  unsigned int password_len;
+  int managed_system_random_number_len;
+  int managed_system_guid_len;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "rmcpplus_status_code",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  rmcpplus_status_code = val;
+
+  if (rmcpplus_status_code != RMCPPLUS_STATUS_NO_ERRORS)
+    {
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_UNAUTHORIZED_NAME)
+        return (IPMI_ERR_USERNAME_INVALID);
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_UNAUTHORIZED_ROLE_OR_PRIVILEGE_LEVEL_REQUESTED)
+        return (IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED);
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION
+          || rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION_AT_THE_REQUESTED_TIME)
+        return (IPMI_ERR_BMC_BUSY);
+      return (IPMI_ERR_BAD_RMCPPLUS_STATUS_CODE);
+    }
+
+  if ((managed_system_random_number_len = fiid_obj_get_data (session->obj_session_rs,
+                                                             "managed_system_random_number",
+                                                             session->managed_system_random_number,
+                                                             IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH)) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  if ((managed_system_guid_len = fiid_obj_get_data (session->obj_session_rs,
+                                                    "managed_system_guid",
+                                                    session->managed_system_guid,
+                                                    IPMI_MANAGED_SYSTEM_GUID_LENGTH)) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+
+  if (managed_system_random_number_len != IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH
+      || managed_system_guid_len != IPMI_MANAGED_SYSTEM_GUID_LENGTH)
+    return (IPMI_ERR_IPMI_ERROR);
+
+  if ((ret = _mux_rakp_message_2_fix_key_exchange_authentication_code (session)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  _mux_rakp_username (session, 1, &username, &username_len);
+  _mux_rakp_password (session, &password, &password_len);
+
+  if ((ret = ipmi_rmcpplus_check_rakp_2_key_exchange_authentication_code (session->authentication_algorithm,
+                                                                          password,
+                                                                          password_len,
+                                                                          session->remote_console_session_id,
+                                                                          session->managed_system_session_id,
+                                                                          session->remote_console_random_number,
+                                                                          IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH,
+                                                                          session->managed_system_random_number,
+                                                                          IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH,
+                                                                          session->managed_system_guid,
+                                                                          IPMI_MANAGED_SYSTEM_GUID_LENGTH,
+                                                                          IPMI_NAME_ONLY_LOOKUP,
+                                                                          session->privilege_level,
+                                                                          username,
+                                                                          username_len,
+                                                                          session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  /* see api_lan_2_0_open_session(), the privilege may be the real problem */
+  if (!ret)
+    return (IPMI_ERR_PASSWORD_INVALID);
+
+  if (ipmi_calculate_rmcpplus_session_keys (session->authentication_algorithm,
+                                            session->integrity_algorithm,
+                                            session->confidentiality_algorithm,
+                                            password,
+                                            password_len,
+                                            session->k_g_configured ? session->k_g : NULL,
+                                            session->k_g_configured ? IPMI_MAX_K_G_LENGTH : 0,
+                                            session->remote_console_random_number,
+                                            IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH,
+                                            session->managed_system_random_number,
+                                            IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH,
+                                            IPMI_NAME_ONLY_LOOKUP,
+                                            session->privilege_level,
+                                            username,
+                                            username_len,
+                                            &(session->sik_key_ptr),
+                                            &(session->sik_key_len),
+                                            &(session->integrity_key_ptr),
+                                            &(session->integrity_key_len),
+                                            &(session->confidentiality_key_ptr),
+                                            &(session->confidentiality_key_len)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_2_0_open_session(), with the Intel workaround the
+   * unpadded username is used and the key is created with the name
+   * only lookup turned off.
+   */
+  _mux_rakp_username (session, 0, &username, &username_len);
+
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION)
+    name_only_lookup = IPMI_USER_NAME_PRIVILEGE_LOOKUP;
+  else
+    name_only_lookup = IPMI_NAME_ONLY_LOOKUP;
+
+  if ((key_exchange_authentication_code_len = ipmi_calculate_rakp_3_key_exchange_authentication_code (session->authentication_algorithm,
+                                                                                                      password,
+                                                                                                      password_len,
+                                                                                                      session->managed_system_random_number,
+                                                                                                      IPMI_MANAGED_SYSTEM_RANDOM_NUMBER_LENGTH,
+                                                                                                      session->remote_console_session_id,
+                                                                                                      name_only_lookup,
+                                                                                                      session->privilege_level,
+                                                                                                      username,
+                                                                                                      username_len,
+                                                                                                      key_exchange_authentication_code,
+                                                                                                      IPMI_MAX_KEY_EXCHANGE_AUTHENTICATION_CODE_LENGTH)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_RAKP_MESSAGE_3,
+                             tmpl_rmcpplus_rakp_message_3,
+                             tmpl_rmcpplus_rakp_message_4)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  if (fill_rmcpplus_rakp_message_3 (session->message_tag,
+                                    RMCPPLUS_STATUS_NO_ERRORS,
+                                    session->managed_system_session_id,
+                                    key_exchange_authentication_code,
+                                    key_exchange_authentication_code_len,
+                                    session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_rakp_message_4 (ipmi_mux_session_t session)
+{
+  uint8_t rmcpplus_status_code;
+  uint8_t authentication_algorithm;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  if (FIID_OBJ_GET (session->obj_session_rs,
+                    "rmcpplus_status_code",
+                    &val) < 0)
+    return (api_errnum_by_fiid_object (session->obj_session_rs));
+  rmcpplus_status_code = val;
+
+  if (rmcpplus_status_code != RMCPPLUS_STATUS_NO_ERRORS)
+    {
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION
+          || rmcpplus_status_code == RMCPPLUS_STATUS_INSUFFICIENT_RESOURCES_TO_CREATE_A_SESSION_AT_THE_REQUESTED_TIME)
+        return (IPMI_ERR_BMC_BUSY);
+      /* see api_lan_2_0_open_session(), the privilege may be the real problem */
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_INVALID_INTEGRITY_CHECK_VALUE)
+        return (IPMI_ERR_PASSWORD_INVALID);
+      return (IPMI_ERR_BAD_RMCPPLUS_STATUS_CODE);
+    }
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_2_0_open_session(), Intel BMCs respond with the
+   * integrity check value based on the integrity algorithm.
+   */
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION)
+    {
+      if (session->integrity_algorithm == IPMI_INTEGRITY_ALGORITHM_NONE)
+        authentication_algorithm = IPMI_AUTHENTICATION_ALGORITHM_RAKP_NONE;
+      else if (session->integrity_algorithm == IPMI_INTEGRITY_ALGORITHM_HMAC_SHA1_96)
+        authentication_algorithm = IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_SHA1;
+      else if (session->integrity_algorithm == IPMI_INTEGRITY_ALGORITHM_HMAC_MD5_128)
+        authentication_algorithm = IPMI_AUTHENTICATION_ALGORITHM_RAKP_HMAC_MD5;
+      else
+        return (IPMI_ERR_IPMI_ERROR);
+    }
+  else
+    authentication_algorithm = session->authentication_algorithm;
+
+  /* IPMI Workaround (achu)
+   *
+   * See api_lan_2_0_open_session(), with cipher suite 0 some BMCs
+   * return an integrity check value when it should be empty.
+   */
+  if (session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_NON_EMPTY_INTEGRITY_CHECK_VALUE
+      && !session->cipher_suite_id)
+    {
+      if (fiid_obj_clear_field (session->obj_session_rs,
+                                "integrity_check_value") < 0)
+        return (api_errnum_by_fiid_object (session->obj_session_rs));
+    }
+
+  if ((ret = ipmi_rmcpplus_check_rakp_4_integrity_check_value (authentication_algorithm,
+                                                               session->sik_key_ptr,
+                                                               session->sik_key_len,
+                                                               session->remote_console_random_number,
+                                                               IPMI_REMOTE_CONSOLE_RANDOM_NUMBER_LENGTH,
+                                                               session->managed_system_session_id,
+                                                               session->managed_system_guid,
+                                                               IPMI_MANAGED_SYSTEM_GUID_LENGTH,
+                                                               session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    return (IPMI_ERR_K_G_INVALID);
+
+  if ((ret = _mux_start_cmd (session,
+                             IPMI_MUX_STATE_SET_SESSION_PRIVILEGE_LEVEL,
+                             tmpl_cmd_set_session_privilege_level_rq,
+                             tmpl_cmd_set_session_privilege_level_rs)) != IPMI_ERR_SUCCESS)
+    return (ret);
+
+  if (fill_cmd_set_session_privilege_level (session->privilege_level,
+                                            session->obj_session_rq) < 0)
+    return (api_errnum_by_errno (errno));
+
+  return (IPMI_ERR_SUCCESS);
+}
+
+static int
+_mux_set_session_privilege_level_rs (ipmi_mux_session_t session)
+{
+  int ret;
+
+  assert (session);
+
+  if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+    return (api_errnum_by_errno (errno));
+
+  if (!ret)
+    {
+      if (ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_SET_SESSION_PRIVILEGE_LEVEL_REQUESTED_LEVEL_NOT_AVAILABLE_FOR_USER) == 1
+          || ipmi_check_completion_code (session->obj_session_rs, IPMI_COMP_CODE_SET_SESSION_PRIVILEGE_LEVEL_REQUESTED_LEVEL_EXCEEDS_USER_PRIVILEGE_LIMIT) == 1)
+        return (IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED);
+      return (api_errnum_by_bad_response (session->obj_session_rs));
+    }
+
+  _mux_session_objs_destroy (session);
+  session->state = IPMI_MUX_STATE_ESTABLISHED;
+  return (IPMI_ERR_SUCCESS);
+}
+
+/* < 0 - error
+ * == 1 good packet
+ * == 0 bad packet
+ */
+static int
+_mux_verify_packet (ipmi_mux_session_t session, fiid_obj_t obj_cmd_rs)
+{
+  ipmi_mux_ctx_t ctx;
+  uint8_t authentication_type;
+  uint32_t session_id = 0;
+  uint32_t rs_session_id;
+  int check_authentication_code = 0;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  ctx = session->ctx;
+
+  if (session->state == IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES
+      || session->state == IPMI_MUX_STATE_GET_SESSION_CHALLENGE)
+    authentication_type = IPMI_AUTHENTICATION_TYPE_NONE;
+  else if (session->state == IPMI_MUX_STATE_ACTIVATE_SESSION)
+    {
+      authentication_type = session->authentication_type;
+      session_id = session->session_id;
+      check_authentication_code++;
+    }
+  else
+    {
+      authentication_type = _mux_authentication_type (session);
+      session_id = session->session_id;
+      check_authentication_code++;
+    }
+
+  if (FIID_OBJ_GET (ctx->obj_lan_session_hdr_rs,
+                    "session_id",
+                    &val) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_lan_session_hdr_rs);
+      return (-1);
+    }
+  rs_session_id = val;
+
+  /* IPMI Workaround (achu)
+   *
+   * See _api_lan_cmd_wrapper_verify_packet(), some BMCs return a
+   * session id of zero instead of the actual session id, some return
+   * a session id of zero with a bad completion code.
+   */
+  if (session_id != rs_session_id
+      && !((session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_ACCEPT_SESSION_ID_ZERO)
+           && !rs_session_id))
+    {
+      if (ipmi_check_completion_code_success (obj_cmd_rs))
+        return (0);
+    }
+
+  if (!(session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_NO_CHECKSUM_CHECK))
+    {
+      if ((ret = ipmi_lan_check_checksum (ctx->obj_lan_msg_hdr_rs,
+                                          obj_cmd_rs,
+                                          ctx->obj_lan_msg_trlr_rs)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      if (!ret)
+        return (0);
+    }
+
+  if (check_authentication_code
+      && !(session->flags & IPMI_FLAGS_IGNORE_AUTHENTICATION_CODE)
+      && !(session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_NO_AUTH_CODE_CHECK))
+    {
+      if ((ret = ipmi_lan_check_session_authentication_code (ctx->obj_lan_session_hdr_rs,
+                                                             ctx->obj_lan_msg_hdr_rs,
+                                                             obj_cmd_rs,
+                                                             ctx->obj_lan_msg_trlr_rs,
+                                                             authentication_type,
+                                                             session->password,
+                                                             IPMI_1_5_MAX_PASSWORD_LENGTH)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      /* IPMI Workaround (achu)
+       *
+       * Discovered on Dell PowerEdge 2850
+       *
+       * When per-message authentication is disabled, the BMC may
+       * respond with the authentication type used in the activate
+       * session stage and the appropriate authcode.
+       */
+      if (!ret
+          && _mux_in_session (session)
+          && session->per_msg_auth_disabled
+          && (session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_CHECK_UNEXPECTED_AUTHCODE))
+        {
+          if ((ret = ipmi_lan_check_session_authentication_code (ctx->obj_lan_session_hdr_rs,
+                                                                 ctx->obj_lan_msg_hdr_rs,
+                                                                 obj_cmd_rs,
+                                                                 ctx->obj_lan_msg_trlr_rs,
+                                                                 session->authentication_type,
+                                                                 session->password,
+                                                                 IPMI_1_5_MAX_PASSWORD_LENGTH)) < 0)
+            {
+              ctx->errnum = api_errnum_by_errno (errno);
+              return (-1);
+            }
+        }
+
+      if (!ret)
+        return (0);
+    }
+
+  if (_mux_in_session (session))
+    {
+      uint32_t rs_session_sequence_number;
+
+      if (FIID_OBJ_GET (ctx->obj_lan_session_hdr_rs,
+                        "session_sequence_number",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (ctx->obj_lan_session_hdr_rs);
+          return (-1);
+        }
+      rs_session_sequence_number = val;
+
+      /* IPMI Workaround (achu)
+       *
+       * Discovered on Sun Fire 4100.
+       *
+       * The session sequence numbers for IPMI 1.5 are the wrong endian.
+       */
+      if (session->workaround_flags & IPMI_WORKAROUND_FLAGS_OUTOFBAND_BIG_ENDIAN_SEQUENCE_NUMBER)
+        rs_session_sequence_number =
+          ((rs_session_sequence_number & 0xFF000000) >> 24)
+          | ((rs_session_sequence_number & 0x00FF0000) >> 8)
+          | ((rs_session_sequence_number & 0x0000FF00) << 8)
+          | ((rs_session_sequence_number & 0x000000FF) << 24);
+
+      if ((ret = ipmi_check_session_sequence_number_1_5 (rs_session_sequence_number,
+                                                         &(session->highest_received_sequence_number),
+                                                         &(session->previously_received_list),
+                                                         0)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      if (!ret)
+        return (0);
+    }
+
+  if ((ret = ipmi_lan_check_rq_seq (ctx->obj_lan_msg_hdr_rs,
+                                    session->rq_seq)) < 0)
+    {
+      ctx->errnum = api_errnum_by_errno (errno);
+      return (-1);
+    }
+
+  return (ret);
+}
+
+/* see _api_lan_2_0_cmd_wrapper_verify_packet()
+ *
+ * < 0 - error
+ * == 1 good packet
+ * == 0 bad packet
+ */
+static int
+_mux_verify_packet_rmcpplus (ipmi_mux_session_t session,
+                             fiid_obj_t obj_cmd_rs,
+                             const void *pkt,
+                             unsigned int pkt_len)
+{
+  ipmi_mux_ctx_t ctx;
+  uint8_t payload_type;
+  uint8_t rs_payload_type;
+  uint64_t val;
+  int ret;
+
+  assert (session);
+
+  ctx = session->ctx;
+  payload_type = _mux_payload_type (session);
+
+  if (FIID_OBJ_GET (ctx->obj_rmcpplus_session_hdr_rs,
+                    "payload_type",
+                    &val) < 0)
+    {
+      ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcpplus_session_hdr_rs);
+      return (-1);
+    }
+  rs_payload_type = val;
+
+  if (payload_type == IPMI_PAYLOAD_TYPE_IPMI)
+    {
+      const char *password = NULL;
+      uint32_t rs_session_sequence_number;
+
+      if (rs_payload_type != IPMI_PAYLOAD_TYPE_IPMI)
+        return (0);
+
+      if (FIID_OBJ_GET (ctx->obj_rmcpplus_session_hdr_rs,
+                        "session_id",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcpplus_session_hdr_rs);
+          return (-1);
+        }
+
+      if (val != session->remote_console_session_id)
+        return (0);
+
+      /* IPMI Workaround (achu)
+       *
+       * See _api_lan_2_0_cmd_wrapper_verify_packet(), checksums may be
+       * computed incorrectly.
+       */
+      if (!(session->workaround_flags_2_0 & IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_NO_CHECKSUM_CHECK))
+        {
+          if ((ret = ipmi_lan_check_checksum (ctx->obj_lan_msg_hdr_rs,
+                                              obj_cmd_rs,
+                                              ctx->obj_lan_msg_trlr_rs)) < 0)
+            {
+              ctx->errnum = api_errnum_by_errno (errno);
+              return (-1);
+            }
+
+          if (!ret)
+            return (0);
+        }
+
+      if (strlen (session->password))
+        password = session->password;
+
+      if ((ret = ipmi_rmcpplus_check_packet_session_authentication_code (session->integrity_algorithm,
+                                                                         pkt,
+                                                                         pkt_len,
+                                                                         session->integrity_key_ptr,
+                                                                         session->integrity_key_len,
+                                                                         password,
+                                                                         strlen (session->password),
+                                                                         ctx->obj_rmcpplus_session_trlr_rs)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      if (!ret)
+        return (0);
+
+      if (FIID_OBJ_GET (ctx->obj_rmcpplus_session_hdr_rs,
+                        "session_sequence_number",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (ctx->obj_rmcpplus_session_hdr_rs);
+          return (-1);
+        }
+      rs_session_sequence_number = val;
+
+      if ((ret = ipmi_check_session_sequence_number_2_0 (rs_session_sequence_number,
+                                                         &(session->highest_received_sequence_number),
+                                                         &(session->previously_received_list),
+                                                         0)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      if (!ret)
+        return (0);
+
+      if ((ret = ipmi_lan_check_rq_seq (ctx->obj_lan_msg_hdr_rs,
+                                        session->rq_seq)) < 0)
+        {
+          ctx->errnum = api_errnum_by_errno (errno);
+          return (-1);
+        }
+
+      return (ret);
+    }
+  else
+    {
+      uint8_t rmcpplus_status_code;
+
+      if ((payload_type == IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_REQUEST
+           && rs_payload_type != IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_RESPONSE)
+          || (payload_type == IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_1
+              && rs_payload_type != IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_2)
+          || (payload_type == IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_3
+              && rs_payload_type != IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_4))
+        return (0);
+
+      if (FIID_OBJ_GET (obj_cmd_rs,
+                        "message_tag",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (obj_cmd_rs);
+          return (-1);
+        }
+
+      if (val != session->message_tag)
+        return (0);
+
+      /* There is no guarantee that other data (authentication keys,
+       * session id's, etc.) in the response will be valid if there
+       * is a status code error.
+       */
+      if (FIID_OBJ_GET (obj_cmd_rs,
+                        "rmcpplus_status_code",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (obj_cmd_rs);
+          return (-1);
+        }
+      rmcpplus_status_code = val;
+
+      if (FIID_OBJ_GET (obj_cmd_rs,
+                        "remote_console_session_id",
+                        &val) < 0)
+        {
+          ctx->errnum = api_errnum_by_fiid_object (obj_cmd_rs);
+          return (-1);
+        }
+
+      if (rmcpplus_status_code == RMCPPLUS_STATUS_NO_ERRORS
+          && val != session->remote_console_session_id)
+        return (0);
+
+      return (1);
+    }
+}
+
+/* Process a response received for session.
+ * Returns 1 if the packet was for session, 0 if not.
+ */
+static int
+_mux_session_recv (ipmi_mux_session_t session,
+                   const void *pkt,
+                   unsigned int pkt_len)
+{
+  ipmi_mux_ctx_t ctx;
+  unsigned int intf_flags = IPMI_INTERFACE_FLAGS_DEFAULT;
+  fiid_obj_t obj_cmd_rs;
+  ipmi_mux_state_t state;
+  int errnum;
+  int ret;
+
+  assert (session);
+  assert (session->in_flight);
+
+  ctx = session->ctx;
+  state = session->state;
+
+  _mux_current_cmd (session, NULL, NULL, NULL, &obj_cmd_rs);
+
+  if (session->flags & IPMI_FLAGS_NO_LEGAL_CHECK)
+    intf_flags |= IPMI_INTERFACE_FLAGS_NO_LEGAL_CHECK;
+
+  /* packets that cannot be parsed are ignored, like any other packet
+   * not meant for us
+   */
+  if (fiid_obj_clear (ctx->obj_rmcp_hdr_rs) < 0
+      || fiid_obj_clear (ctx->obj_lan_session_hdr_rs) < 0
+      || fiid_obj_clear (ctx->obj_rmcpplus_session_hdr_rs) < 0
+      || fiid_obj_clear (ctx->obj_lan_msg_hdr_rs) < 0
+      || fiid_obj_clear (ctx->obj_rmcpplus_payload_rs) < 0
+      || fiid_obj_clear (ctx->obj_lan_msg_trlr_rs) < 0
+      || fiid_obj_clear (ctx->obj_rmcpplus_session_trlr_rs) < 0)
+    return (0);
+
+  if (_mux_rmcpplus (session))
+    {
+      uint8_t authentication_algorithm = IPMI_AUTHENTICATION_ALGORITHM_RAKP_NONE;
+      uint8_t integrity_algorithm = IPMI_INTEGRITY_ALGORITHM_NONE;
+      uint8_t confidentiality_algorithm = IPMI_CONFIDENTIALITY_ALGORITHM_NONE;
+      const void *integrity_key = NULL;
+      unsigned int integrity_key_len = 0;
+      const void *confidentiality_key = NULL;
+      unsigned int confidentiality_key_len = 0;
+
+      if (_mux_in_session (session))
+        {
+          authentication_algorithm = session->authentication_algorithm;
+          integrity_algorithm = session->integrity_algorithm;
+          confidentiality_algorithm = session->confidentiality_algorithm;
+          integrity_key = session->integrity_key_ptr;
+          integrity_key_len = session->integrity_key_len;
+          confidentiality_key = session->confidentiality_key_ptr;
+          confidentiality_key_len = session->confidentiality_key_len;
+        }
+
+      if ((ret = unassemble_ipmi_rmcpplus_pkt (authentication_algorithm,
+                                               integrity_algorithm,
+                                               confidentiality_algorithm,
+                                               integrity_key,
+                                               integrity_key_len,
+                                               confidentiality_key,
+                                               confidentiality_key_len,
+                                               pkt,
+                                               pkt_len,
+                                               ctx->obj_rmcp_hdr_rs,
+                                               ctx->obj_rmcpplus_session_hdr_rs,
+                                               ctx->obj_rmcpplus_payload_rs,
+                                               ctx->obj_lan_msg_hdr_rs,
+                                               obj_cmd_rs,
+                                               ctx->obj_lan_msg_trlr_rs,
+                                               ctx->obj_rmcpplus_session_trlr_rs,
+                                               intf_flags)) <= 0)
+        return (0);
+
+      ret = _mux_verify_packet_rmcpplus (session, obj_cmd_rs, pkt, pkt_len);
+    }
+  else
+    {
+      if ((ret = unassemble_ipmi_lan_pkt (pkt,
+                                          pkt_len,
+                                          ctx->obj_rmcp_hdr_rs,
+                                          ctx->obj_lan_session_hdr_rs,
+                                          ctx->obj_lan_msg_hdr_rs,
+                                          obj_cmd_rs,
+                                          ctx->obj_lan_msg_trlr_rs,
+                                          intf_flags)) <= 0)
+        return (0);
+
+      ret = _mux_verify_packet (session, obj_cmd_rs);
+    }
+
+  if (ret < 0)
+    {
+      _mux_session_fail (session, ctx->errnum);
+      return (1);
+    }
+
+  if (!ret)
+    return (0);
+
+  if (gettimeofday (&(session->last_received), NULL) < 0)
+    {
+      _mux_session_fail (session, api_errnum_by_errno (errno));
+      return (1);
+    }
+
+  _mux_timer_remove (session);
+  session->in_flight = 0;
+  _mux_next_seq (session);
+
+  switch (state)
+    {
+    case IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES:
+      if (session->type == IPMI_DEVICE_LAN_2_0)
+        errnum = _mux_get_authentication_capabilities_2_0_rs (session);
+      else
+        errnum = _mux_get_authentication_capabilities_rs (session);
+      break;
+    case IPMI_MUX_STATE_GET_SESSION_CHALLENGE:
+      errnum = _mux_get_session_challenge_rs (session);
+      break;
+    case IPMI_MUX_STATE_ACTIVATE_SESSION:
+      errnum = _mux_activate_session_rs (session);
+      break;
+    case IPMI_MUX_STATE_OPEN_SESSION:
+      errnum = _mux_open_session_rs (session);
+      break;
+    case IPMI_MUX_STATE_RAKP_MESSAGE_1:
+      errnum = _mux_rakp_message_2 (session);
+      break;
+    case IPMI_MUX_STATE_RAKP_MESSAGE_3:
+      errnum = _mux_rakp_message_4 (session);
+      break;
+    case IPMI_MUX_STATE_SET_SESSION_PRIVILEGE_LEVEL:
+      if ((errnum = _mux_set_session_privilege_level_rs (session)) == IPMI_ERR_SUCCESS
+          && session->callback)
+        {
+          Ipmi_Mux_Callback callback = session->callback;
+          void *callback_data = session->callback_data;
+
+          session->callback = NULL;
+          session->callback_data = NULL;
+          callback (session, IPMI_ERR_SUCCESS, callback_data);
+        }
+      break;
+    case IPMI_MUX_STATE_ESTABLISHED:
+      {
+        struct ipmi_mux_request *rq = session->rq_head;
+
+        if (!(session->rq_head = rq->next))
+          session->rq_tail = NULL;
+        if (rq->callback)
+          rq->callback (session, IPMI_ERR_SUCCESS, rq->callback_data);
+        free (rq);
+        errnum = IPMI_ERR_SUCCESS;
+      }
+      break;
+    case IPMI_MUX_STATE_CLOSE_SESSION:
+      {
+        Ipmi_Mux_Callback callback = session->callback;
+        void *callback_data = session->callback_data;
+
+        if ((ret = ipmi_check_completion_code_success (session->obj_session_rs)) < 0)
+          errnum = api_errnum_by_errno (errno);
+        else if (!ret)
+          errnum = api_errnum_by_bad_response (session->obj_session_rs);
+        else
+          errnum = IPMI_ERR_SUCCESS;
+
+        session->state = IPMI_MUX_STATE_CLOSED;
+        session->callback = NULL;
+        session->callback_data = NULL;
+        _mux_session_objs_destroy (session);
+        if (callback)
+          callback (session, errnum, callback_data);
+        return (1);
+      }
+    default:
+      assert (0);
+      return (1);
+    }
+
+  if (session->destroyed)
+    return (1);
+
+  if (errnum != IPMI_ERR_SUCCESS)
+    {
+      _mux_session_fail (session, errnum);
+      return (1);
+    }
+
+  if (state == IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES
+      || state == IPMI_MUX_STATE_GET_SESSION_CHALLENGE
+      || state == IPMI_MUX_STATE_ACTIVATE_SESSION
+      || state == IPMI_MUX_STATE_OPEN_SESSION
+      || state == IPMI_MUX_STATE_RAKP_MESSAGE_1
+      || state == IPMI_MUX_STATE_RAKP_MESSAGE_3)
+    {
+      /* next step of session establishment */
+      if (_mux_send (session) < 0)
+        _mux_session_fail (session, ctx->errnum);
+    }
+  else
+    _mux_session_next (session);
+
+  return (1);
+}
+
+static void
+_mux_dispatch (ipmi_mux_ctx_t ctx, struct dgram *dgram)
+{
+  struct ipmi_mux_addr *maddr;
+  ipmi_mux_session_t session;
+  const uint8_t *pkt;
+  uint32_t rs_session_id;
+  int rmcpplus;
+
+  assert (ctx);
+  assert (dgram);
+
+  if (!(maddr = hash_find (ctx->addrs, &(dgram->addr))))
+    return;
+
+  /* RMCP header (4), authentication type (1), then for IPMI 1.5 the
+   * session sequence number (4) and the session id (4) at the same
+   * offset with or without an authentication code.  For RMCP+ the
+   * payload type (1) and the session id (4).
+   */
+  if (dgram->len < 5)
+    return;
+
+  pkt = dgram->buf;
+  rmcpplus = (pkt[4] == IPMI_AUTHENTICATION_TYPE_RMCPPLUS);
+
+  if (rmcpplus)
+    {
+      if (dgram->len < 10)
+        return;
+
+      rs_session_id = (uint32_t)pkt[6]
+        | ((uint32_t)pkt[7] << 8)
+        | ((uint32_t)pkt[8] << 16)
+        | ((uint32_t)pkt[9] << 24);
+    }
+  else
+    {
+      if (dgram->len < 13)
+        return;
+
+      rs_session_id = (uint32_t)pkt[9]
+        | ((uint32_t)pkt[10] << 8)
+        | ((uint32_t)pkt[11] << 16)
+        | ((uint32_t)pkt[12] << 24);
+    }
+
+  for (session = maddr->sessions; session; session = session->addr_next)
+    {
+      uint32_t session_id;
+
+      if (!session->in_flight)
+        continue;
+
+      if (rmcpplus != _mux_rmcpplus (session))
+        continue;
+
+      if (session->state == IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES
+          || session->state == IPMI_MUX_STATE_GET_SESSION_CHALLENGE
+          || session->state == IPMI_MUX_STATE_OPEN_SESSION
+          || session->state == IPMI_MUX_STATE_RAKP_MESSAGE_1
+          || session->state == IPMI_MUX_STATE_RAKP_MESSAGE_3)
+        session_id = 0;
+      else if (session->type == IPMI_DEVICE_LAN_2_0)
+        session_id = session->remote_console_session_id;
+      else
+        session_id = session->session_id;
+
+      /* see _mux_verify_packet() for why a zero id is considered */
+      if (rs_session_id != session_id && rs_session_id)
+        continue;
+
+      if (_mux_session_recv (session, dgram->buf, dgram->len))
+        return;
+    }
+}
+
+static void
+_mux_recv (ipmi_mux_ctx_t ctx)
+{
+  unsigned int i;
+  int n;
+
+  assert (ctx);
+
+  do
+    {
+      for (i = 0; i < DGRAM_BATCH_MAX; i++)
+        {
+          ctx->recv_dgrams[i].buf = ctx->recv_bufs[i];
+          ctx->recv_dgrams[i].len = IPMI_MAX_PKT_LEN;
+        }
+
+      if ((n = dgram_recv_batch (ctx->sockfd,
+                                 ctx->recv_dgrams,
+                                 DGRAM_BATCH_MAX)) <= 0)
+        break;
+
+      for (i = 0; i < n; i++)
+        _mux_dispatch (ctx, &(ctx->recv_dgrams[i]));
+
+    } while (n == DGRAM_BATCH_MAX);
+}
+
+static int
+_mux_timeout_errnum (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  /* same errors as api_lan_open_session() */
+  if (session->state == IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES)
+    return (IPMI_ERR_CONNECTION_TIMEOUT);
+  if (session->state == IPMI_MUX_STATE_ACTIVATE_SESSION)
+    return (IPMI_ERR_PASSWORD_VERIFICATION_TIMEOUT);
+  return (IPMI_ERR_SESSION_TIMEOUT);
+}
+
+static void
+_mux_timers (ipmi_mux_ctx_t ctx)
+{
+  struct timeval now;
+
+  assert (ctx);
+
+  if (gettimeofday (&now, NULL) < 0)
+    return;
+
+  /* Every session handled is either removed from the heap or put
+   * back with a timer in the future, so this terminates.
+   */
+  while (ctx->timer_heap_count
+         && !timeval_gt (&(ctx->timer_heap[0]->timer_expire), &now))
+    {
+      ipmi_mux_session_t session = ctx->timer_heap[0];
+      struct timeval session_expire, *start;
+
+      if (timeval_gt (&(session->send_start), &(session->last_received)))
+        start = &(session->send_start);
+      else
+        start = &(session->last_received);
+      timeval_add_ms (start, session->session_timeout, &session_expire);
+
+      /* ignore timeout, just cleanly close session */
+      if (session->state == IPMI_MUX_STATE_CLOSE_SESSION)
+        {
+          Ipmi_Mux_Callback callback = session->callback;
+          void *callback_data = session->callback_data;
+
+          _mux_timer_remove (session);
+          session->in_flight = 0;
+          session->state = IPMI_MUX_STATE_CLOSED;
+          session->callback = NULL;
+          session->callback_data = NULL;
+          _mux_session_objs_destroy (session);
+          if (callback)
+            callback (session, IPMI_ERR_SUCCESS, callback_data);
+          continue;
+        }
+
+      if (!timeval_gt (&session_expire, &now))
+        {
+          _mux_session_fail (session, _mux_timeout_errnum (session));
+          continue;
+        }
+
+      _mux_next_seq (session);
+      session->retransmission_count++;
+
+      if (_mux_send (session) < 0)
+        _mux_session_fail (session, ctx->errnum);
+    }
+}
+
+static void
+_mux_session_free (ipmi_mux_session_t session)
+{
+  assert (session);
+
+  _mux_session_objs_destroy (session);
+  _mux_request_free_all (session->rq_head);
+  session->magic = ~IPMI_MUX_SESSION_MAGIC;
+  free (session);
+}
+
+static void
+_mux_destroyed_free (ipmi_mux_ctx_t ctx)
+{
+  assert (ctx);
+
+  while (ctx->destroyed)
+    {
+      ipmi_mux_session_t session = ctx->destroyed;
+
+      ctx->destroyed = session->next;
+      _mux_session_free (session);
+    }
+}
+
+/* unlink session from the ctx, the caller frees it */
+static void
+_mux_session_unlink (ipmi_mux_session_t session)
+{
+  ipmi_mux_ctx_t ctx;
+  ipmi_mux_session_t *sp;
+
+  assert (session);
+
+  ctx = session->ctx;
+
+  _mux_timer_remove (session);
+
+  if (session->maddr)
+    {
+      for (sp = &(session->maddr->sessions); *sp; sp = &((*sp)->addr_next))
+        {
+          if (*sp == session)
+            {
+              *sp = session->addr_next;
+              break;
+            }
+        }
+
+      if (!session->maddr->sessions)
+        {
+          hash_remove (ctx->addrs, &(session->maddr->addr));
+          free (session->maddr);
+        }
+      session->maddr = NULL;
+    }
+
+  if (session->prev)
+    session->prev->next = session->next;
+  else if (ctx->sessions == session)
+    ctx->sessions = session->next;
+  if (session->next)
+    session->next->prev = session->prev;
+  session->next = session->prev = NULL;
+}
+
+ipmi_mux_ctx_t
+ipmi_mux_ctx_create (void)
+{
+  struct ipmi_mux_ctx *ctx = NULL;
+  struct sockaddr_in addr;
+  int flags;
+
+  if (!(ctx = (ipmi_mux_ctx_t)malloc (sizeof (struct ipmi_mux_ctx))))
+    {
+      ERRNO_TRACE (errno);
+      return (NULL);
+    }
+  memset (ctx, '\0', sizeof (struct ipmi_mux_ctx));
+  ctx->magic = IPMI_MUX_CTX_MAGIC;
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  ctx->sockfd = -1;
+
+  if (!(ctx->addrs = hash_create (IPMI_MUX_ADDRS_HASH_SIZE,
+                                  _mux_addr_hash,
+                                  _mux_addr_cmp,
+                                  NULL)))
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
+  if (!(ctx->obj_rmcp_hdr_rq = fiid_obj_create (tmpl_rmcp_hdr))
+      || !(ctx->obj_lan_session_hdr_rq = fiid_obj_create (tmpl_lan_session_hdr))
+      || !(ctx->obj_rmcpplus_session_hdr_rq = fiid_obj_create (tmpl_rmcpplus_session_hdr))
+      || !(ctx->obj_lan_msg_hdr_rq = fiid_obj_create (tmpl_lan_msg_hdr_rq))
+      || !(ctx->obj_rmcpplus_session_trlr_rq = fiid_obj_create (tmpl_rmcpplus_session_trlr))
+      || !(ctx->obj_rmcp_hdr_rs = fiid_obj_create (tmpl_rmcp_hdr))
+      || !(ctx->obj_lan_session_hdr_rs = fiid_obj_create (tmpl_lan_session_hdr))
+      || !(ctx->obj_rmcpplus_session_hdr_rs = fiid_obj_create (tmpl_rmcpplus_session_hdr))
+      || !(ctx->obj_lan_msg_hdr_rs = fiid_obj_create (tmpl_lan_msg_hdr_rs))
+      || !(ctx->obj_rmcpplus_payload_rs = fiid_obj_create (tmpl_rmcpplus_payload))
+      || !(ctx->obj_lan_msg_trlr_rs = fiid_obj_create (tmpl_lan_msg_trlr))
+      || !(ctx->obj_rmcpplus_session_trlr_rs = fiid_obj_create (tmpl_rmcpplus_session_trlr)))
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
+  /* Open client (local) UDP socket shared by all sessions */
+  /* achu: ephemeral ports are > 1023, so no way we will bind to an IPMI port */
+
+  if ((ctx->sockfd = socket (AF_INET, SOCK_DGRAM, 0)) < 0)
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
+  memset (&addr, 0, sizeof (struct sockaddr_in));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (0);
+  addr.sin_addr.s_addr = htonl (INADDR_ANY);
+
+  if (bind (ctx->sockfd,
+            (struct sockaddr *)&addr,
+            sizeof (struct sockaddr_in)) < 0)
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
+  if ((flags = fcntl (ctx->sockfd, F_GETFL, 0)) < 0
+      || fcntl (ctx->sockfd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
+  /* Random number generation */
+  srand ((unsigned int) clock () + (unsigned int) time (NULL));
+
+  return (ctx);
+
+ cleanup:
+  ipmi_mux_ctx_destroy (ctx);
+  return (NULL);
+}
+
+void
+ipmi_mux_ctx_destroy (ipmi_mux_ctx_t ctx)
+{
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    return;
+
+  assert (!ctx->processing);
+
+  while (ctx->sessions)
+    {
+      ipmi_mux_session_t session = ctx->sessions;
+
+      _mux_session_unlink (session);
+      _mux_session_free (session);
+    }
+
+  if (ctx->addrs)
+    hash_destroy (ctx->addrs);
+  free (ctx->timer_heap);
+
+  fiid_obj_destroy (ctx->obj_rmcp_hdr_rq);
+  fiid_obj_destroy (ctx->obj_lan_session_hdr_rq);
+  fiid_obj_destroy (ctx->obj_rmcpplus_session_hdr_rq);
+  fiid_obj_destroy (ctx->obj_lan_msg_hdr_rq);
+  fiid_obj_destroy (ctx->obj_rmcpplus_session_trlr_rq);
+  fiid_obj_destroy (ctx->obj_rmcp_hdr_rs);
+  fiid_obj_destroy (ctx->obj_lan_session_hdr_rs);
+  fiid_obj_destroy (ctx->obj_rmcpplus_session_hdr_rs);
+  fiid_obj_destroy (ctx->obj_lan_msg_hdr_rs);
+  fiid_obj_destroy (ctx->obj_rmcpplus_payload_rs);
+  fiid_obj_destroy (ctx->obj_lan_msg_trlr_rs);
+  fiid_obj_destroy (ctx->obj_rmcpplus_session_trlr_rs);
+
+  /* ignore potential error, cleanup path */
+  if (ctx->sockfd >= 0)
+    close (ctx->sockfd);
+
+  ctx->magic = ~IPMI_MUX_CTX_MAGIC;
+  free (ctx);
+}
+
+int
+ipmi_mux_ctx_errnum (ipmi_mux_ctx_t ctx)
+{
+  if (!ctx)
+    return (IPMI_ERR_CTX_NULL);
+  else if (ctx->magic != IPMI_MUX_CTX_MAGIC)
+    return (IPMI_ERR_CTX_INVALID);
+  else
+    return (ctx->errnum);
+}
+
+char *
+ipmi_mux_ctx_strerror (int errnum)
+{
+  return (ipmi_ctx_strerror (errnum));
+}
+
+char *
+ipmi_mux_ctx_errormsg (ipmi_mux_ctx_t ctx)
+{
+  return (ipmi_mux_ctx_strerror (ipmi_mux_ctx_errnum (ctx)));
+}
+
+/* allocate a session and setup the fields common to IPMI 1.5 and 2.0 */
+static ipmi_mux_session_t
+_mux_session_create (ipmi_mux_ctx_t ctx,
+                     const char *hostname,
+                     const char *username,
+                     const char *password,
+                     uint8_t privilege_level,
+                     unsigned int session_timeout,
+                     unsigned int retransmission_timeout,
+                     unsigned int flags,
+                     Ipmi_Mux_Callback callback,
+                     void *callback_data,
+                     struct sockaddr_in *remote_host)
+{
+  struct ipmi_mux_session *session = NULL;
+  int errnum;
+
+  assert (ctx);
+  assert (hostname);
+  assert (remote_host);
+
+  if (!session_timeout)
+    session_timeout = IPMI_SESSION_TIMEOUT_DEFAULT;
+  if (!retransmission_timeout)
+    retransmission_timeout = IPMI_RETRANSMISSION_TIMEOUT_DEFAULT;
+
+  if (retransmission_timeout >= session_timeout)
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (NULL);
+    }
+
+  if (!(session = (ipmi_mux_session_t)malloc (sizeof (struct ipmi_mux_session))))
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_OUT_OF_MEMORY);
+      return (NULL);
+    }
+  memset (session, '\0', sizeof (struct ipmi_mux_session));
+  session->magic = IPMI_MUX_SESSION_MAGIC;
+  session->ctx = ctx;
+  session->timer_index = -1;
+
+  memset (remote_host, '\0', sizeof (struct sockaddr_in));
+  if ((errnum = api_resolve_hostname (hostname,
+                                      session->hostname,
+                                      remote_host)) != IPMI_ERR_SUCCESS)
+    {
+      MUX_SET_ERRNUM (ctx, errnum);
+      _mux_session_free (session);
+      return (NULL);
+    }
+
+  if (username)
+    strcpy (session->username, username);
+  if (password)
+    strcpy (session->password, password);
+  session->privilege_level = privilege_level;
+  session->session_timeout = session_timeout;
+  session->retransmission_timeout = retransmission_timeout;
+  session->flags = flags;
+  session->callback = callback;
+  session->callback_data = callback_data;
+  session->rq_seq = (uint8_t)((double)(IPMI_LAN_REQUESTER_SEQUENCE_NUMBER_MAX) * (rand ()/(RAND_MAX + 1.0)));
+
+  return (session);
+}
+
+/* send the authentication capabilities request and add the session
+ * to the context
+ */
+static int
+_mux_session_start (ipmi_mux_session_t session,
+                    struct sockaddr_in *remote_host,
+                    uint8_t get_ipmi_data)
+{
+  ipmi_mux_ctx_t ctx;
+  struct ipmi_mux_addr *maddr;
+  int errnum;
+
+  assert (session);
+  assert (remote_host);
+
+  ctx = session->ctx;
+
+  if (gettimeofday (&(session->last_received), NULL) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      return (-1);
+    }
+
+  if ((errnum = _mux_start_cmd (session,
+                                IPMI_MUX_STATE_GET_AUTHENTICATION_CAPABILITIES,
+                                tmpl_cmd_get_channel_authentication_capabilities_rq,
+                                tmpl_cmd_get_channel_authentication_capabilities_rs)) != IPMI_ERR_SUCCESS)
+    {
+      MUX_SET_ERRNUM (ctx, errnum);
+      return (-1);
+    }
+
+  if (fill_cmd_get_channel_authentication_capabilities (IPMI_CHANNEL_NUMBER_CURRENT_CHANNEL,
+                                                        session->privilege_level,
+                                                        get_ipmi_data,
+                                                        session->obj_session_rq) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      return (-1);
+    }
+
+  if (!(maddr = hash_find (ctx->addrs, remote_host)))
+    {
+      if (!(maddr = (struct ipmi_mux_addr *)malloc (sizeof (struct ipmi_mux_addr))))
+        {
+          MUX_SET_ERRNUM (ctx, IPMI_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+      maddr->addr = *remote_host;
+      maddr->sessions = NULL;
+
+      if (!hash_insert (ctx->addrs, &(maddr->addr), maddr))
+        {
+          MUX_SET_ERRNUM (ctx, IPMI_ERR_OUT_OF_MEMORY);
+          free (maddr);
+          return (-1);
+        }
+    }
+
+  session->maddr = maddr;
+  session->addr_next = maddr->sessions;
+  maddr->sessions = session;
+
+  session->next = ctx->sessions;
+  if (ctx->sessions)
+    ctx->sessions->prev = session;
+  ctx->sessions = session;
+
+  if (_mux_send (session) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, ctx->errnum);
+      _mux_session_unlink (session);
+      return (-1);
+    }
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
+ipmi_mux_session_t
+ipmi_mux_session_open (ipmi_mux_ctx_t ctx,
+                       const char *hostname,
+                       const char *username,
+                       const char *password,
+                       uint8_t authentication_type,
+                       uint8_t privilege_level,
+                       unsigned int session_timeout,
+                       unsigned int retransmission_timeout,
+                       unsigned int workaround_flags,
+                       unsigned int flags,
+                       Ipmi_Mux_Callback callback,
+                       void *callback_data)
+{
+  unsigned int workaround_flags_mask = (IPMI_WORKAROUND_FLAGS_OUTOFBAND_AUTHENTICATION_CAPABILITIES
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_ACCEPT_SESSION_ID_ZERO
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_FORCE_PERMSG_AUTHENTICATION
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_CHECK_UNEXPECTED_AUTHCODE
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_BIG_ENDIAN_SEQUENCE_NUMBER
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_NO_AUTH_CODE_CHECK
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_NO_CHECKSUM_CHECK);
+  unsigned int flags_mask = (IPMI_FLAGS_NO_LEGAL_CHECK
+                             | IPMI_FLAGS_IGNORE_AUTHENTICATION_CODE);
+  struct ipmi_mux_session *session = NULL;
+  struct sockaddr_in remote_host;
+
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_mux_ctx_errormsg (ctx), ipmi_mux_ctx_errnum (ctx));
+      return (NULL);
+    }
+
+  /* hostname length checks in api_resolve_hostname() */
+  if (!hostname
+      || (username && strlen (username) > IPMI_MAX_USER_NAME_LENGTH)
+      || (password && strlen (password) > IPMI_1_5_MAX_PASSWORD_LENGTH)
+      || !IPMI_1_5_AUTHENTICATION_TYPE_VALID (authentication_type)
+      || !IPMI_PRIVILEGE_LEVEL_VALID (privilege_level)
+      || (workaround_flags & ~workaround_flags_mask)
+      || (flags & ~flags_mask))
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (NULL);
+    }
+
+  if (!(session = _mux_session_create (ctx,
+                                       hostname,
+                                       username,
+                                       password,
+                                       privilege_level,
+                                       session_timeout,
+                                       retransmission_timeout,
+                                       flags,
+                                       callback,
+                                       callback_data,
+                                       &remote_host)))
+    return (NULL);
+
+  session->type = IPMI_DEVICE_LAN;
+  session->authentication_type = authentication_type;
+  session->workaround_flags = workaround_flags;
+
+  if (ipmi_check_session_sequence_number_1_5_init (&(session->highest_received_sequence_number),
+                                                   &(session->previously_received_list)) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      goto cleanup;
+    }
+
+  if (_mux_session_start (session,
+                          &remote_host,
+                          IPMI_GET_IPMI_V15_DATA) < 0)
+    goto cleanup;
+
+  return (session);
+
+ cleanup:
+  _mux_session_free (session);
+  return (NULL);
+}
+
+ipmi_mux_session_t
+ipmi_mux_session_open_2_0 (ipmi_mux_ctx_t ctx,
+                           const char *hostname,
+                           const char *username,
+                           const char *password,
+                           const unsigned char *k_g,
+                           unsigned int k_g_len,
+                           uint8_t privilege_level,
+                           uint8_t cipher_suite_id,
+                           unsigned int session_timeout,
+                           unsigned int retransmission_timeout,
+                           unsigned int workaround_flags,
+                           unsigned int flags,
+                           Ipmi_Mux_Callback callback,
+                           void *callback_data)
+{
+  unsigned int workaround_flags_mask = (IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_AUTHENTICATION_CAPABILITIES
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_INTEL_2_0_SESSION
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_SUPERMICRO_2_0_SESSION
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_SUN_2_0_SESSION
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_OPEN_SESSION_PRIVILEGE
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_NON_EMPTY_INTEGRITY_CHECK_VALUE
+                                        | IPMI_WORKAROUND_FLAGS_OUTOFBAND_2_0_NO_CHECKSUM_CHECK);
+  unsigned int flags_mask = IPMI_FLAGS_NO_LEGAL_CHECK;
+  struct ipmi_mux_session *session = NULL;
+  struct sockaddr_in remote_host;
+  unsigned int i;
+
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_mux_ctx_errormsg (ctx), ipmi_mux_ctx_errnum (ctx));
+      return (NULL);
+    }
+
+  /* hostname length checks in api_resolve_hostname() */
+  if (!hostname
+      || (username && strlen (username) > IPMI_MAX_USER_NAME_LENGTH)
+      || (password && strlen (password) > IPMI_2_0_MAX_PASSWORD_LENGTH)
+      || (k_g && k_g_len > IPMI_MAX_K_G_LENGTH)
+      || !IPMI_PRIVILEGE_LEVEL_VALID (privilege_level)
+      || !IPMI_CIPHER_SUITE_ID_SUPPORTED (cipher_suite_id)
+      || (workaround_flags & ~workaround_flags_mask)
+      || (flags & ~flags_mask))
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (NULL);
+    }
+
+  if (ipmi_rmcpplus_init () < 0)
+    {
+      if (errno == EPERM)
+        MUX_SET_ERRNUM (ctx, IPMI_ERR_SYSTEM_ERROR);
+      else
+        MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      return (NULL);
+    }
+
+  if (!(session = _mux_session_create (ctx,
+                                       hostname,
+                                       username,
+                                       password,
+                                       privilege_level,
+                                       session_timeout,
+                                       retransmission_timeout,
+                                       flags,
+                                       callback,
+                                       callback_data,
+                                       &remote_host)))
+    return (NULL);
+
+  session->type = IPMI_DEVICE_LAN_2_0;
+  session->workaround_flags_2_0 = workaround_flags;
+
+  /* a k_g of all zeroes is the same as no k_g */
+  if (k_g && k_g_len)
+    {
+      memcpy (session->k_g, k_g, k_g_len);
+      for (i = 0; i < IPMI_MAX_K_G_LENGTH; i++)
+        {
+          if (session->k_g[i])
+            {
+              session->k_g_configured = 1;
+              break;
+            }
+        }
+    }
+
+  session->cipher_suite_id = cipher_suite_id;
+  session->sik_key_ptr = session->sik_key;
+  session->sik_key_len = IPMI_MAX_SIK_KEY_LENGTH;
+  session->integrity_key_ptr = session->integrity_key;
+  session->integrity_key_len = IPMI_MAX_INTEGRITY_KEY_LENGTH;
+  session->confidentiality_key_ptr = session->confidentiality_key;
+  session->confidentiality_key_len = IPMI_MAX_CONFIDENTIALITY_KEY_LENGTH;
+
+  /* Unlike IPMI 1.5, there is no initial sequence number negotiation */
+  session->session_sequence_number = 1;
+
+  if (ipmi_check_session_sequence_number_2_0_init (&(session->highest_received_sequence_number),
+                                                   &(session->previously_received_list)) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      goto cleanup;
+    }
+
+  if (_mux_session_start (session,
+                          &remote_host,
+                          IPMI_GET_IPMI_V20_EXTENDED_DATA) < 0)
+    goto cleanup;
+
+  return (session);
+
+ cleanup:
+  _mux_session_free (session);
+  return (NULL);
+}
+
+int
+ipmi_mux_session_close (ipmi_mux_session_t session,
+                        Ipmi_Mux_Callback callback,
+                        void *callback_data)
+{
+  ipmi_mux_ctx_t ctx;
+  int errnum;
+
+  if (!session
+      || session->magic != IPMI_MUX_SESSION_MAGIC
+      || session->destroyed)
+    {
+      ERR_TRACE (ipmi_ctx_strerror (IPMI_ERR_PARAMETERS), IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  ctx = session->ctx;
+
+  if (session->state != IPMI_MUX_STATE_ESTABLISHED
+      || session->close_pending)
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_DEVICE_NOT_OPEN);
+      return (-1);
+    }
+
+  session->close_pending = 1;
+  session->callback = callback;
+  session->callback_data = callback_data;
+
+  if (!session->in_flight)
+    {
+      if ((errnum = _mux_start_close (session)) != IPMI_ERR_SUCCESS)
+        {
+          session->in_flight = 0;
+          session->state = IPMI_MUX_STATE_ESTABLISHED;
+          session->close_pending = 0;
+          session->callback = NULL;
+          session->callback_data = NULL;
+          _mux_timer_remove (session);
+          _mux_session_objs_destroy (session);
+          MUX_SET_ERRNUM (ctx, errnum);
+          return (-1);
+        }
+    }
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
+void
+ipmi_mux_session_destroy (ipmi_mux_session_t session)
+{
+  ipmi_mux_ctx_t ctx;
+
+  if (!session
+      || session->magic != IPMI_MUX_SESSION_MAGIC
+      || session->destroyed)
+    return;
+
+  ctx = session->ctx;
+
+  _mux_session_unlink (session);
+
+  if (ctx->processing)
+    {
+      /* still referenced by ipmi_mux_process(), free it later */
+      _mux_request_free_all (session->rq_head);
+      session->rq_head = session->rq_tail = NULL;
+      session->in_flight = 0;
+      session->destroyed = 1;
+      session->next = ctx->destroyed;
+      ctx->destroyed = session;
+    }
+  else
+    _mux_session_free (session);
+}
+
+char *
+ipmi_mux_session_hostname (ipmi_mux_session_t session)
+{
+  if (!session
+      || session->magic != IPMI_MUX_SESSION_MAGIC
+      || session->destroyed)
+    {
+      ERR_TRACE (ipmi_ctx_strerror (IPMI_ERR_PARAMETERS), IPMI_ERR_PARAMETERS);
+      return (NULL);
+    }
+
+  return (session->hostname);
+}
+
+int
+ipmi_mux_cmd (ipmi_mux_session_t session,
+              uint8_t lun,
+              uint8_t net_fn,
+              fiid_obj_t obj_cmd_rq,
+              fiid_obj_t obj_cmd_rs,
+              Ipmi_Mux_Callback callback,
+              void *callback_data)
+{
+  struct ipmi_mux_request *rq;
+  ipmi_mux_ctx_t ctx;
+
+  if (!session
+      || session->magic != IPMI_MUX_SESSION_MAGIC
+      || session->destroyed)
+    {
+      ERR_TRACE (ipmi_ctx_strerror (IPMI_ERR_PARAMETERS), IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  ctx = session->ctx;
+
+  if (!IPMI_BMC_LUN_VALID (lun)
+      || !IPMI_NET_FN_RQ_VALID (net_fn)
+      || !fiid_obj_valid (obj_cmd_rq)
+      || !fiid_obj_valid (obj_cmd_rs))
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (FIID_OBJ_PACKET_VALID (obj_cmd_rq) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_fiid_object (obj_cmd_rq));
+      return (-1);
+    }
+
+  if (session->state == IPMI_MUX_STATE_CLOSE_SESSION
+      || session->state == IPMI_MUX_STATE_CLOSED
+      || session->close_pending)
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_DEVICE_NOT_OPEN);
+      return (-1);
+    }
+
+  if (!(rq = (struct ipmi_mux_request *)malloc (sizeof (struct ipmi_mux_request))))
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_OUT_OF_MEMORY);
+      return (-1);
+    }
+  rq->lun = lun;
+  rq->net_fn = net_fn;
+  rq->obj_cmd_rq = obj_cmd_rq;
+  rq->obj_cmd_rs = obj_cmd_rs;
+  rq->callback = callback;
+  rq->callback_data = callback_data;
+  rq->next = NULL;
+
+  if (session->rq_tail)
+    session->rq_tail->next = rq;
+  else
+    session->rq_head = rq;
+  session->rq_tail = rq;
+
+  if (session->state == IPMI_MUX_STATE_ESTABLISHED
+      && !session->in_flight)
+    {
+      assert (session->rq_head == rq);
+
+      session->in_flight = 1;
+      session->retransmission_count = 0;
+      if (_mux_send (session) < 0)
+        {
+          session->in_flight = 0;
+          _mux_timer_remove (session);
+          session->rq_head = session->rq_tail = NULL;
+          free (rq);
+          MUX_SET_ERRNUM (ctx, ctx->errnum);
+          return (-1);
+        }
+    }
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
+int
+ipmi_mux_fd (ipmi_mux_ctx_t ctx)
+{
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_mux_ctx_errormsg (ctx), ipmi_mux_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (ctx->sockfd);
+}
+
+static int
+_mux_timeout (ipmi_mux_ctx_t ctx)
+{
+  struct timeval now, result;
+  unsigned int ms;
+
+  assert (ctx);
+
+  if (!ctx->timer_heap_count)
+    return (-1);
+
+  if (gettimeofday (&now, NULL) < 0)
+    {
+      MUX_SET_ERRNUM (ctx, api_errnum_by_errno (errno));
+      return (-2);
+    }
+
+  if (!timeval_gt (&(ctx->timer_heap[0]->timer_expire), &now))
+    return (0);
+
+  timeval_sub (&(ctx->timer_heap[0]->timer_expire), &now, &result);
+  timeval_millisecond_calc (&result, &ms);
+
+  /* round up, so a wakeup is not before the timer */
+  return (ms + 1);
+}
+
+int
+ipmi_mux_timeout (ipmi_mux_ctx_t ctx)
+{
+  int rv;
+
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_mux_ctx_errormsg (ctx), ipmi_mux_ctx_errnum (ctx));
+      return (-2);
+    }
+
+  if ((rv = _mux_timeout (ctx)) < -1)
+    return (rv);
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (rv);
+}
+
+int
+ipmi_mux_process (ipmi_mux_ctx_t ctx, int timeout)
+{
+  struct pollfd pfd;
+  int timer_timeout;
+  int n;
+
+  if (!ctx || ctx->magic != IPMI_MUX_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_mux_ctx_errormsg (ctx), ipmi_mux_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (ctx->processing)
+    {
+      MUX_SET_ERRNUM (ctx, IPMI_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if ((timer_timeout = _mux_timeout (ctx)) < -1)
+    return (-1);
+
+  /* nothing outstanding, nothing to wait for */
+  if (timer_timeout < 0 && timeout < 0)
+    {
+      ctx->errnum = IPMI_ERR_SUCCESS;
+      return (0);
+    }
+
+  if (timeout < 0 || (timer_timeout >= 0 && timer_timeout < timeout))
+    timeout = timer_timeout;
+
+  pfd.fd = ctx->sockfd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  if ((n = poll (&pfd, 1, timeout)) < 0)
+    {
+      if (errno != EINTR)
+        {
+          MUX_SET_ERRNUM (ctx, IPMI_ERR_SYSTEM_ERROR);
+          return (-1);
+        }
+      n = 0;
+    }
+
+  ctx->processing = 1;
+
+  if (n > 0)
+    _mux_recv (ctx);
+
+  _mux_timers (ctx);
+
+  _mux_flush (ctx);
+
+  ctx->processing = 0;
+
+  _mux_destroyed_free (ctx);
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (ctx->timer_heap_count);
+}
@@ -39,6 +39,7 @@
 
 #define FIID_OBJ_MAGIC 0xf00fd00d
 #define FIID_ITERATOR_MAGIC 0xd00df00f
+#define FIID_OBJ_POOL_MAGIC 0xd00dd00d
 
 struct fiid_field_data
 {
@@ -46,8 +47,21 @@ struct fiid_field_data
   char key[FIID_FIELD_MAX_KEY_LEN + 1];
   unsigned int set_field_len;
   unsigned int flags;
+  unsigned int start;
 };
 
+/* achu: field_index is an open addressing hash table of field_data
+ * indexes (stored + 1, 0 indicates an empty slot) keyed on the field
+ * name.  It is built once when the object is created so field
+ * lookups do not have to strcmp() through every field in the
+ * template.  field_index_len is always a power of 2.
+ *
+ * The field_data, field_index, and data arrays are allocated in the
+ * same memory block as the object itself, see _fiid_obj_alloc().
+ *
+ * pool, tmpl, and next are only used by objects created through
+ * fiid_obj_create_in().
+ */
 struct fiid_obj
 {
   uint32_t magic;
@@ -56,7 +70,20 @@ struct fiid_obj
   unsigned int data_len;
   struct fiid_field_data *field_data;
   unsigned int field_data_len;
+  unsigned int *field_index;
+  unsigned int field_index_len;
   int makes_packet_sufficient;
+  struct fiid_obj_pool *pool;
+  fiid_field_t *tmpl;
+  struct fiid_obj *next;
+};
+
+struct fiid_obj_pool
+{
+  uint32_t magic;
+  struct fiid_obj *free_objs;
+  unsigned int objs_outstanding;
+  int destroyed;
 };
 
 struct fiid_iterator
@@ -244,6 +271,37 @@ FIID_TEMPLATE_FIELD_LOOKUP (fiid_template_t tmpl,
   return (ret);
 }
 
+int
+fiid_template_field_handle (fiid_template_t tmpl,
+                            const char *field)
+{
+  unsigned int i;
+
+  if (!(tmpl && field))
+    {
+      /* FIID_ERR_PARAMETERS */
+      errno = EINVAL;
+      return (-1);
+    }
+
+  if (_fiid_template_check_valid_keys (tmpl) < 0)
+    {
+      /* FIID_ERR_PARAMETERS */
+      errno = EINVAL;
+      return (-1);
+    }
+
+  for (i = 0; tmpl[i].max_field_len; i++)
+    {
+      if (!strcmp (tmpl[i].key, field))
+        return (i);
+    }
+
+  /* FIID_ERR_FIELD_NOT_FOUND */
+  errno = EINVAL;
+  return (-1);
+}
+
 int
 fiid_template_len (fiid_template_t tmpl)
 {
@@ -707,39 +765,76 @@ fiid_template_free (fiid_field_t *tmpl_dynamic)
   free (tmpl_dynamic);
 }
 
+static uint32_t
+_fiid_key_hash (const char *key)
+{
+  uint32_t hash = 2166136261U;
+
+  assert (key);
+
+  /* FNV-1a */
+  while (*key)
+    {
+      hash ^= (uint8_t)(*key++);
+      hash *= 16777619U;
+    }
+
+  return (hash);
+}
+
 static int
-_fiid_obj_field_start_end (fiid_obj_t obj,
-                           const char *field,
-                           unsigned int *start,
-                           unsigned int *end)
+_fiid_obj_lookup_field_index (fiid_obj_t obj, const char *field, unsigned int *index)
 {
-  unsigned int i = 0;
-  unsigned int _start = 0;
-  unsigned int _end = 0;
+  unsigned int mask;
+  unsigned int i;
 
   assert (obj);
   assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (obj->field_index);
   assert (field);
-  assert (start);
-  assert (end);
+  assert (index);
 
-  /* integer overflow conditions checked during object creation */
-  for (i = 0; obj->field_data[i].max_field_len; i++)
+  mask = obj->field_index_len - 1;
+  i = _fiid_key_hash (field) & mask;
+  while (obj->field_index[i])
     {
-      if (!strcmp (obj->field_data[i].key, field))
+      unsigned int field_index = obj->field_index[i] - 1;
+
+      if (!strcmp (obj->field_data[field_index].key, field))
         {
-          _end = _start + obj->field_data[i].max_field_len;
-          *start = _start;
-          *end = _end;
-          return (obj->field_data[i].max_field_len);
+          (*index) = field_index;
+          return (0);
         }
-      _start += obj->field_data[i].max_field_len;
+      i = (i + 1) & mask;
     }
 
   obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
   return (-1);
 }
 
+static int
+_fiid_obj_field_start_end (fiid_obj_t obj,
+                           const char *field,
+                           unsigned int *start,
+                           unsigned int *end)
+{
+  unsigned int key_index;
+
+  assert (obj);
+  assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (field);
+  assert (start);
+  assert (end);
+
+  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+    return (-1);
+
+  /* integer overflow conditions checked during object creation */
+  *start = obj->field_data[key_index].start;
+  *end = obj->field_data[key_index].start + obj->field_data[key_index].max_field_len;
+  return (obj->field_data[key_index].max_field_len);
+}
+
 static int
 _fiid_obj_field_start (fiid_obj_t obj, const char *field)
 {
@@ -775,20 +870,16 @@ _fiid_obj_field_end (fiid_obj_t obj, const char *field)
 static int
 _fiid_obj_field_len (fiid_obj_t obj, const char *field)
 {
-  unsigned int i;
+  unsigned int key_index;
 
   assert (obj);
   assert (obj->magic == FIID_OBJ_MAGIC);
   assert (field);
 
-  for (i = 0; obj->field_data[i].max_field_len; i++)
-    {
-      if (!strcmp (obj->field_data[i].key, field))
-        return (obj->field_data[i].max_field_len);
-    }
+  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+    return (-1);
 
-  obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
-  return (-1);
+  return (obj->field_data[key_index].max_field_len);
 }
 
 char *
@@ -800,11 +891,60 @@ fiid_strerror (fiid_err_t errnum)
     return (fiid_errmsg[FIID_ERR_ERRNUMRANGE]);
 }
 
+/* achu: one allocation for the object and all of its arrays, the
+ * memory is returned zeroed.  struct fiid_obj and struct
+ * fiid_field_data are multiples of sizeof (unsigned int), so
+ * field_index is aligned.
+ */
+static fiid_obj_t
+_fiid_obj_alloc (unsigned int data_len,
+                 unsigned int field_data_len,
+                 unsigned int field_index_len)
+{
+  fiid_obj_t obj;
+  size_t len;
+
+  assert (field_data_len);
+  assert (field_index_len);
+
+  if (field_data_len > (INT_MAX / sizeof (struct fiid_field_data))
+      || field_index_len > (INT_MAX / sizeof (unsigned int)))
+    {
+      /* FIID_ERR_OVERFLOW */
+      errno = EINVAL;
+      return (NULL);
+    }
+
+  len = sizeof (struct fiid_obj);
+  len += field_data_len * sizeof (struct fiid_field_data);
+  len += field_index_len * sizeof (unsigned int);
+  len += data_len;
+
+  if (!(obj = (fiid_obj_t)malloc (len)))
+    {
+      /* FIID_ERR_OUT_OF_MEMORY */
+      errno = ENOMEM;
+      return (NULL);
+    }
+  memset (obj, '\0', len);
+
+  obj->magic = FIID_OBJ_MAGIC;
+  obj->field_data = (struct fiid_field_data *)(obj + 1);
+  obj->field_data_len = field_data_len;
+  obj->field_index = (unsigned int *)(obj->field_data + field_data_len);
+  obj->field_index_len = field_index_len;
+  obj->data = (uint8_t *)(obj->field_index + field_index_len);
+  obj->data_len = data_len;
+  return (obj);
+}
+
 fiid_obj_t
 fiid_obj_create (fiid_template_t tmpl)
 {
   fiid_obj_t obj = NULL;
   unsigned int max_pkt_len = 0;
+  unsigned int field_data_len = 0;
+  unsigned int field_index_len;
   unsigned int i;
   int data_len;
 
@@ -829,73 +969,70 @@ fiid_obj_create (fiid_template_t tmpl)
       goto cleanup;
     }
 
-  if (!(obj = (fiid_obj_t)malloc (sizeof (struct fiid_obj))))
-    {
-      /* FIID_ERR_OUT_OF_MEMORY */
-      errno = ENOMEM;
-      goto cleanup;
-    }
-  memset (obj, '\0', sizeof (struct fiid_obj));
-  obj->magic = FIID_OBJ_MAGIC;
-
   /* after call to _fiid_template_len_bytes, we know each field length
    * and total field length won't overflow an int.
    */
   if ((data_len = _fiid_template_len_bytes (tmpl,
-                                            &obj->field_data_len)) < 0)
+                                            &field_data_len)) < 0)
     goto cleanup;
-  obj->data_len = data_len;
 
-  if (!obj->field_data_len)
+  if (!field_data_len)
     {
       /* FIID_ERR_TEMPLATE_INVALID */
       errno = EINVAL;
       goto cleanup;
     }
 
-  if (!(obj->data = malloc (obj->data_len)))
-    {
-      /* FIID_ERR_OUT_OF_MEMORY */
-      errno = ENOMEM;
-      goto cleanup;
-    }
-  memset (obj->data, '\0', obj->data_len);
+  /* hash table at most half full, field_data_len includes the
+   * terminating field, so there is always at least one empty slot.
+   */
+  field_index_len = 1;
+  while (field_index_len < (field_data_len * 2))
+    field_index_len <<= 1;
 
-  if (!(obj->field_data = malloc (obj->field_data_len * sizeof (struct fiid_field_data))))
-    {
-      /* FIID_ERR_OUT_OF_MEMORY */
-      errno = ENOMEM;
-      goto cleanup;
-    }
-  memset (obj->field_data, '\0', obj->field_data_len * sizeof (struct fiid_field_data));
+  if (!(obj = _fiid_obj_alloc (data_len, field_data_len, field_index_len)))
+    goto cleanup;
 
   for (i = 0; i < obj->field_data_len; i++)
     {
-#ifndef NDEBUG
-      if (tmpl[i].max_field_len)
-        {
-          unsigned int j;
-
-          for (j = 0; j < i; j++)
-            {
-              if (!strncmp (obj->field_data[j].key, tmpl[i].key, FIID_FIELD_MAX_KEY_LEN))
-                {
-                  /* FIID_ERR_TEMPLATE_INVALID */
-                  errno = EINVAL;
-                  goto cleanup;
-                }
-            }
-        }
-#endif /* !NDEBUG */
       obj->field_data[i].max_field_len = tmpl[i].max_field_len;
-      memset (obj->field_data[i].key, '\0', FIID_FIELD_MAX_KEY_LEN + 1);
       strncpy (obj->field_data[i].key, tmpl[i].key, FIID_FIELD_MAX_KEY_LEN);
       obj->field_data[i].set_field_len = 0;
       obj->field_data[i].flags = tmpl[i].flags;
+      obj->field_data[i].start = max_pkt_len;
       max_pkt_len += tmpl[i].max_field_len;
 
       if (obj->field_data[i].flags & FIID_FIELD_MAKES_PACKET_SUFFICIENT)
         obj->makes_packet_sufficient = 1;
+
+      if (tmpl[i].max_field_len)
+        {
+          unsigned int mask = obj->field_index_len - 1;
+          unsigned int j;
+
+          j = _fiid_key_hash (obj->field_data[i].key) & mask;
+          while (obj->field_index[j])
+            {
+              if (!strcmp (obj->field_data[obj->field_index[j] - 1].key,
+                           obj->field_data[i].key))
+                break;
+              j = (j + 1) & mask;
+            }
+
+          if (obj->field_index[j])
+            {
+#ifndef NDEBUG
+              /* FIID_ERR_TEMPLATE_INVALID */
+              errno = EINVAL;
+              goto cleanup;
+#else /* NDEBUG */
+              /* first field with the key wins, as with a linear search */
+              continue;
+#endif /* NDEBUG */
+            }
+
+          obj->field_index[j] = i + 1;
+        }
     }
 
   if (max_pkt_len % 8)
@@ -909,14 +1046,48 @@ fiid_obj_create (fiid_template_t tmpl)
   return (obj);
 
  cleanup:
-  if (obj)
+  free (obj);
+  return (NULL);
+}
+
+static void
+_fiid_obj_pool_release (fiid_obj_t obj)
+{
+  struct fiid_obj_pool *pool;
+  unsigned int i;
+
+  assert (obj);
+  assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (obj->pool);
+  assert (obj->pool->magic == FIID_OBJ_POOL_MAGIC);
+  assert (obj->pool->objs_outstanding);
+
+  pool = obj->pool;
+  pool->objs_outstanding--;
+
+  if (pool->destroyed)
     {
-      free (obj->data);
-      free (obj->field_data);
+      obj->magic = ~FIID_OBJ_MAGIC;
       free (obj);
+
+      if (!pool->objs_outstanding)
+        {
+          pool->magic = ~FIID_OBJ_POOL_MAGIC;
+          free (pool);
+        }
+      return;
     }
 
-  return (NULL);
+  /* same as fiid_obj_clear() */
+  secure_memset (obj->data, '\0', obj->data_len);
+  for (i = 0; i < obj->field_data_len; i++)
+    obj->field_data[i].set_field_len = 0;
+
+  /* invalid until handed out again by fiid_obj_create_in() */
+  obj->magic = ~FIID_OBJ_MAGIC;
+  obj->errnum = FIID_ERR_SUCCESS;
+  obj->next = pool->free_objs;
+  pool->free_objs = obj;
 }
 
 void
@@ -925,60 +1096,134 @@ fiid_obj_destroy (fiid_obj_t obj)
   if (!(obj && obj->magic == FIID_OBJ_MAGIC))
     return;
 
+  if (obj->pool)
+    {
+      _fiid_obj_pool_release (obj);
+      return;
+    }
+
   obj->magic = ~FIID_OBJ_MAGIC;
   obj->errnum = FIID_ERR_SUCCESS;
-  free (obj->data);
-  free (obj->field_data);
   free (obj);
 }
 
-fiid_obj_t
-fiid_obj_dup (fiid_obj_t src_obj)
+fiid_obj_pool_t
+fiid_obj_pool_create (void)
 {
-  fiid_obj_t dest_obj = NULL;
+  fiid_obj_pool_t pool;
 
-  if (!src_obj || src_obj->magic != FIID_OBJ_MAGIC)
-    goto cleanup;
+  if (!(pool = (fiid_obj_pool_t)malloc (sizeof (struct fiid_obj_pool))))
+    {
+      /* FIID_ERR_OUT_OF_MEMORY */
+      errno = ENOMEM;
+      return (NULL);
+    }
+  memset (pool, '\0', sizeof (struct fiid_obj_pool));
+  pool->magic = FIID_OBJ_POOL_MAGIC;
+  pool->free_objs = NULL;
+  pool->objs_outstanding = 0;
+  pool->destroyed = 0;
+  return (pool);
+}
 
-  if (!(dest_obj = malloc (sizeof (struct fiid_obj))))
+void
+fiid_obj_pool_destroy (fiid_obj_pool_t pool)
+{
+  fiid_obj_t obj;
+
+  if (!(pool && pool->magic == FIID_OBJ_POOL_MAGIC))
+    return;
+
+  while (pool->free_objs)
     {
-      src_obj->errnum = FIID_ERR_OUT_OF_MEMORY;
-      goto cleanup;
+      obj = pool->free_objs;
+      pool->free_objs = obj->next;
+      free (obj);
     }
-  memset (dest_obj, '\0', sizeof (struct fiid_obj));
-  dest_obj->magic = src_obj->magic;
-  dest_obj->data_len = src_obj->data_len;
-  dest_obj->field_data_len = src_obj->field_data_len;
 
-  if (!(dest_obj->data = malloc (src_obj->data_len)))
+  /* objects still in use free the pool when the last one is destroyed */
+  if (pool->objs_outstanding)
     {
-      src_obj->errnum = FIID_ERR_OUT_OF_MEMORY;
-      goto cleanup;
+      pool->destroyed = 1;
+      return;
     }
-  memcpy (dest_obj->data, src_obj->data, src_obj->data_len);
 
-  if (!(dest_obj->field_data = malloc (dest_obj->field_data_len * sizeof (struct fiid_field_data))))
+  pool->magic = ~FIID_OBJ_POOL_MAGIC;
+  free (pool);
+}
+
+fiid_obj_t
+fiid_obj_create_in (fiid_obj_pool_t pool, fiid_template_t tmpl)
+{
+  fiid_obj_t obj, prev = NULL;
+
+  if (!(pool && pool->magic == FIID_OBJ_POOL_MAGIC && !pool->destroyed)
+      || !tmpl)
+    {
+      /* FIID_ERR_PARAMETERS */
+      errno = EINVAL;
+      return (NULL);
+    }
+
+  obj = pool->free_objs;
+  while (obj)
+    {
+      if (obj->tmpl == tmpl)
+        {
+          if (prev)
+            prev->next = obj->next;
+          else
+            pool->free_objs = obj->next;
+          obj->next = NULL;
+          obj->magic = FIID_OBJ_MAGIC;
+          obj->errnum = FIID_ERR_SUCCESS;
+          pool->objs_outstanding++;
+          return (obj);
+        }
+      prev = obj;
+      obj = obj->next;
+    }
+
+  if (!(obj = fiid_obj_create (tmpl)))
+    return (NULL);
+
+  obj->pool = pool;
+  obj->tmpl = tmpl;
+  pool->objs_outstanding++;
+  return (obj);
+}
+
+fiid_obj_t
+fiid_obj_dup (fiid_obj_t src_obj)
+{
+  fiid_obj_t dest_obj = NULL;
+
+  if (!src_obj || src_obj->magic != FIID_OBJ_MAGIC)
+    return (NULL);
+
+  if (!(dest_obj = _fiid_obj_alloc (src_obj->data_len,
+                                    src_obj->field_data_len,
+                                    src_obj->field_index_len)))
     {
       src_obj->errnum = FIID_ERR_OUT_OF_MEMORY;
-      goto cleanup;
+      return (NULL);
     }
 
+  memcpy (dest_obj->data, src_obj->data, src_obj->data_len);
+
   memcpy (dest_obj->field_data,
           src_obj->field_data,
           src_obj->field_data_len * sizeof (struct fiid_field_data));
 
+  memcpy (dest_obj->field_index,
+          src_obj->field_index,
+          src_obj->field_index_len * sizeof (unsigned int));
+
+  dest_obj->makes_packet_sufficient = src_obj->makes_packet_sufficient;
+
   src_obj->errnum = FIID_ERR_SUCCESS;
   dest_obj->errnum = FIID_ERR_SUCCESS;
   return (dest_obj);
-
- cleanup:
-  if (dest_obj)
-    {
-      free (dest_obj->data);
-      free (dest_obj->field_data);
-      free (dest_obj);
-    }
-  return (NULL);
 }
 
 fiid_obj_t
@@ -1345,29 +1590,6 @@ fiid_obj_errormsg (fiid_obj_t obj)
   return (fiid_strerror (fiid_obj_errnum (obj)));
 }
 
-static int
-_fiid_obj_lookup_field_index (fiid_obj_t obj, const char *field, unsigned int *index)
-{
-  unsigned int i;
-
-  assert (obj);
-  assert (obj->magic == FIID_OBJ_MAGIC);
-  assert (field);
-  assert (index);
-
-  for (i = 0; obj->field_data[i].max_field_len; i++)
-    {
-      if (!strcmp (obj->field_data[i].key, field))
-        {
-          (*index) = i;
-          return (0);
-        }
-    }
-
-  obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
-  return (-1);
-}
-
 int
 fiid_obj_len (fiid_obj_t obj)
 {
@@ -1642,38 +1864,47 @@ FIID_OBJ_FIELD_LOOKUP (fiid_obj_t obj, const char *field)
 }
 
 int
-fiid_obj_set (fiid_obj_t obj,
-              const char *field,
-              uint64_t val)
+fiid_obj_field_handle (fiid_obj_t obj, const char *field)
 {
-  unsigned int start_bit_pos = 0;
-  unsigned int end_bit_pos = 0; /* excluded always */
-  int byte_pos = 0;
-  int start_bit_in_byte_pos = 0;
-  int end_bit_in_byte_pos = 0;
-  int field_len = 0;
-  int bytes_used = 0;
   unsigned int key_index;
-  uint64_t merged_val = 0;
-  uint8_t *temp_data = NULL;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
-    goto cleanup;
+    return (-1);
 
   if (!field)
     {
       obj->errnum = FIID_ERR_PARAMETERS;
-      goto cleanup;
+      return (-1);
     }
 
   if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
     return (-1);
 
-  if ((field_len = _fiid_obj_field_start_end (obj,
-                                              field,
-                                              &start_bit_pos,
-                                              &end_bit_pos)) < 0)
-    return (-1);
+  obj->errnum = FIID_ERR_SUCCESS;
+  return (key_index);
+}
+
+static int
+_fiid_obj_set_by_index (fiid_obj_t obj,
+                        unsigned int key_index,
+                        uint64_t val)
+{
+  unsigned int start_bit_pos = 0;
+  int byte_pos = 0;
+  int start_bit_in_byte_pos = 0;
+  int end_bit_in_byte_pos = 0;
+  int field_len = 0;
+  int bytes_used = 0;
+  uint64_t merged_val = 0;
+  /* a field of at most 64 bits spans at most 9 bytes */
+  uint8_t temp_data[16];
+
+  assert (obj);
+  assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (key_index < obj->field_data_len);
+
+  start_bit_pos = obj->field_data[key_index].start;
+  field_len = obj->field_data[key_index].max_field_len;
 
   if (field_len > 64)
     field_len = 64;
@@ -1714,12 +1945,10 @@ fiid_obj_set (fiid_obj_t obj,
       int field_len_left = field_len;
       unsigned int i;
 
-      if (!(temp_data = malloc (obj->data_len)))
-        {
-          obj->errnum = FIID_ERR_OUT_OF_MEMORY;
-          goto cleanup;
-        }
-      memcpy (temp_data, obj->data, obj->data_len);
+      assert ((size_t)bytes_used <= sizeof (temp_data));
+
+      /* work on a copy, so the object is untouched on error */
+      memcpy (temp_data, obj->data + byte_pos, bytes_used);
 
       for (i = 0; i < bytes_used; i++)
         {
@@ -1750,7 +1979,7 @@ fiid_obj_set (fiid_obj_t obj,
               goto cleanup;
             }
 
-          if (bits_merge (temp_data[byte_pos + i],
+          if (bits_merge (temp_data[i],
                           start_bit_in_byte_pos,
                           end_bit_in_byte_pos,
                           extracted_val,
@@ -1760,12 +1989,12 @@ fiid_obj_set (fiid_obj_t obj,
               goto cleanup;
             }
 
-          temp_data[byte_pos + i] = merged_val;
+          temp_data[i] = merged_val;
           start_bit_in_byte_pos = 0;
           start_val_pos = end_val_pos;
         }
 
-      memcpy (obj->data, temp_data, obj->data_len);
+      memcpy (obj->data + byte_pos, temp_data, bytes_used);
       obj->field_data[key_index].set_field_len = field_len;
     }
   else
@@ -1783,34 +2012,24 @@ fiid_obj_set (fiid_obj_t obj,
       obj->field_data[key_index].set_field_len = field_len;
     }
 
-  free (temp_data);
   obj->errnum = FIID_ERR_SUCCESS;
   return (0);
 
  cleanup:
-  free (temp_data);
   return (-1);
 }
 
 int
-fiid_obj_get (fiid_obj_t obj,
+fiid_obj_set (fiid_obj_t obj,
               const char *field,
-              uint64_t *val)
+              uint64_t val)
 {
-  unsigned int start_bit_pos = 0;
-  unsigned int end_bit_pos = 0; /* excluded always */
-  int byte_pos = 0;
-  int start_bit_in_byte_pos = 0;
-  int end_bit_in_byte_pos = 0;
-  int field_len = 0;
-  int bytes_used = 0;
   unsigned int key_index;
-  uint64_t merged_val = 0;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
     return (-1);
 
-  if (!field || !val)
+  if (!field)
     {
       obj->errnum = FIID_ERR_PARAMETERS;
       return (-1);
@@ -1819,17 +2038,53 @@ fiid_obj_get (fiid_obj_t obj,
   if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
     return (-1);
 
+  return (_fiid_obj_set_by_index (obj, key_index, val));
+}
+
+int
+fiid_obj_set_by_handle (fiid_obj_t obj,
+                        int handle,
+                        uint64_t val)
+{
+  if (!obj || obj->magic != FIID_OBJ_MAGIC)
+    return (-1);
+
+  /* last field_data entry is the template terminator */
+  if (handle < 0 || (unsigned int)handle >= (obj->field_data_len - 1))
+    {
+      obj->errnum = FIID_ERR_PARAMETERS;
+      return (-1);
+    }
+
+  return (_fiid_obj_set_by_index (obj, handle, val));
+}
+
+static int
+_fiid_obj_get_by_index (fiid_obj_t obj,
+                        unsigned int key_index,
+                        uint64_t *val)
+{
+  unsigned int start_bit_pos = 0;
+  int byte_pos = 0;
+  int start_bit_in_byte_pos = 0;
+  int end_bit_in_byte_pos = 0;
+  int field_len = 0;
+  int bytes_used = 0;
+  uint64_t merged_val = 0;
+
+  assert (obj);
+  assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (key_index < obj->field_data_len);
+  assert (val);
+
   if (!obj->field_data[key_index].set_field_len)
     {
       obj->errnum = FIID_ERR_SUCCESS;
       return (0);
     }
 
-  if ((field_len = _fiid_obj_field_start_end (obj,
-                                              field,
-                                              &start_bit_pos,
-                                              &end_bit_pos)) < 0)
-    return (-1);
+  start_bit_pos = obj->field_data[key_index].start;
+  field_len = obj->field_data[key_index].max_field_len;
 
   if (field_len > 64)
     field_len = 64;
@@ -1940,6 +2195,52 @@ fiid_obj_get (fiid_obj_t obj,
   return (1);
 }
 
+int
+fiid_obj_get (fiid_obj_t obj,
+              const char *field,
+              uint64_t *val)
+{
+  unsigned int key_index;
+
+  if (!obj || obj->magic != FIID_OBJ_MAGIC)
+    return (-1);
+
+  if (!field || !val)
+    {
+      obj->errnum = FIID_ERR_PARAMETERS;
+      return (-1);
+    }
+
+  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+    return (-1);
+
+  return (_fiid_obj_get_by_index (obj, key_index, val));
+}
+
+int
+fiid_obj_get_by_handle (fiid_obj_t obj,
+                        int handle,
+                        uint64_t *val)
+{
+  if (!obj || obj->magic != FIID_OBJ_MAGIC)
+    return (-1);
+
+  if (!val)
+    {
+      obj->errnum = FIID_ERR_PARAMETERS;
+      return (-1);
+    }
+
+  /* last field_data entry is the template terminator */
+  if (handle < 0 || (unsigned int)handle >= (obj->field_data_len - 1))
+    {
+      obj->errnum = FIID_ERR_PARAMETERS;
+      return (-1);
+    }
+
+  return (_fiid_obj_get_by_index (obj, handle, val));
+}
+
 int
 FIID_OBJ_GET (fiid_obj_t obj,
               const char *field,
@@ -1986,8 +2287,7 @@ fiid_obj_set_data (fiid_obj_t obj,
    * on a byte boundary.
    */
 
-  if ((field_start = _fiid_obj_field_start (obj, field)) < 0)
-    return (-1);
+  field_start = obj->field_data[key_index].start;
 
   if (field_start % 8)
     {
@@ -1995,8 +2295,7 @@ fiid_obj_set_data (fiid_obj_t obj,
       return (-1);
     }
 
-  if ((bits_len = _fiid_obj_field_len (obj, field)) < 0)
-    return (-1);
+  bits_len = obj->field_data[key_index].max_field_len;
 
   if (bits_len % 8)
     {
@@ -2044,8 +2343,7 @@ fiid_obj_get_data (fiid_obj_t obj,
    * on a byte boundary.
    */
 
-  if ((field_start = _fiid_obj_field_start (obj, field)) < 0)
-    return (-1);
+  field_start = obj->field_data[key_index].start;
 
   if (field_start % 8)
     {
@@ -2053,8 +2351,7 @@ fiid_obj_get_data (fiid_obj_t obj,
       return (-1);
     }
 
-  if ((bits_len = _fiid_obj_field_len (obj, field)) < 0)
-    return (-1);
+  bits_len = obj->field_data[key_index].max_field_len;
 
   if (obj->field_data[key_index].set_field_len < bits_len)
     bits_len = obj->field_data[key_index].set_field_len;
@@ -2739,14 +3036,18 @@ fiid_iterator_key (fiid_iterator_t iter)
 int
 fiid_iterator_get (fiid_iterator_t iter, uint64_t *val)
 {
-  char *key;
   int rv;
 
   if (!(iter && iter->magic == FIID_ITERATOR_MAGIC))
     return (-1);
 
-  key = iter->obj->field_data[iter->current_index].key;
-  rv = fiid_obj_get (iter->obj, key, val);
+  if (iter->current_index == iter->last_index)
+    {
+      iter->errnum = FIID_ERR_FIELD_NOT_FOUND;
+      return (-1);
+    }
+
+  rv = fiid_obj_get_by_handle (iter->obj, iter->current_index, val);
   iter->errnum = (iter->obj->errnum);
   return (rv);
 }
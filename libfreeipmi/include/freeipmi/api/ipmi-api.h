@@ -251,6 +251,20 @@ int ipmi_ctx_get_flags (ipmi_ctx_t ctx, unsigned int *flags);
 /* for changing flags mid-operation for corner cases */
 int ipmi_ctx_set_flags (ipmi_ctx_t ctx, unsigned int flags);
 
+/* Pipeline window - for outofband only, the number of requests
+ * ipmi_cmd_pipeline() may have outstanding to the BMC at once.  The
+ * default of 1 sends one request at a time, same as ipmi_cmd().  Many
+ * BMCs handle only a single outstanding request, so only increase
+ * the window for BMCs known to handle more.  May be set before or
+ * after opening.
+ */
+#define IPMI_PIPELINE_WINDOW_DEFAULT          1
+#define IPMI_PIPELINE_WINDOW_MAX              8
+
+int ipmi_ctx_get_pipeline_window (ipmi_ctx_t ctx, unsigned int *window);
+
+int ipmi_ctx_set_pipeline_window (ipmi_ctx_t ctx, unsigned int window);
+
 /* For IPMI 1.5 sessions */
 /* For session_timeout and retransmission_timeout, specify 0 for default */
 int ipmi_ctx_open_outofband (ipmi_ctx_t ctx,
@@ -339,6 +353,20 @@ int ipmi_cmd_ipmb (ipmi_ctx_t ctx,
                    fiid_obj_t obj_cmd_rq,
                    fiid_obj_t obj_cmd_rs);
 
+/* perform count IPMI commands with the same lun and net_fn.  With
+ * an outofband session and a pipeline window greater than 1, up to
+ * window requests are outstanding at once and responses may arrive
+ * in any order.  Otherwise, effectively calls ipmi_cmd() count
+ * times.  Returns 0 if all commands completed, -1 on error, in which
+ * case the contents of all response objects are undefined.
+ */
+int ipmi_cmd_pipeline (ipmi_ctx_t ctx,
+                       uint8_t lun,
+                       uint8_t net_fn,
+                       fiid_obj_t *obj_cmd_rq,
+                       fiid_obj_t *obj_cmd_rs,
+                       unsigned int count);
+
 /* for request/response, byte #1 = cmd */
 /* for response, byte #2 (typically) = completion code */
 /* returns length written into buf_fs on success, -1 on error */
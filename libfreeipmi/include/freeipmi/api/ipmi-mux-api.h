@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IPMI_MUX_API_H
+#define IPMI_MUX_API_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <freeipmi/api/ipmi-api.h>
+#include <freeipmi/fiid/fiid.h>
+
+/* IPMI MULTIPLEXER NOTES
+ *
+ * A mux context drives many IPMI 1.5 and IPMI 2.0 (RMCP+) out-of-band
+ * sessions over a single UDP socket without blocking.  Session establishment,
+ * retransmissions, and sequence numbers are tracked per session and
+ * advanced from ipmi_mux_process(), so thousands of BMCs can be
+ * talked to from one thread without one ipmi_ctx_t per host.
+ *
+ * Error codes are the ipmi_errnum codes of ipmi-api.h.  Errors of a
+ * function call are available through ipmi_mux_ctx_errnum(), errors
+ * of an asynchronous operation are passed to its callback.
+ *
+ * Commands to the same session are sent one at a time in the order
+ * they were submitted.  Commands submitted before the session is
+ * established are held until it is.  Commands to different sessions
+ * are in flight at the same time.
+ *
+ * Like ipmi_cmd(), completion codes of commands are not checked, the
+ * caller is responsible for checking obj_cmd_rs.
+ *
+ * The session workaround flags for ipmi_ctx_open_outofband() and
+ * ipmi_ctx_open_outofband_2_0() are supported, with the exception
+ * that retransmitted Get Session Challenge requests are not sent from
+ * a new source port.  The IPMI_FLAGS_NO_LEGAL_CHECK flag is
+ * supported, and for IPMI 1.5 the IPMI_FLAGS_IGNORE_AUTHENTICATION_CODE
+ * flag, all other flags are invalid.
+ *
+ * Callbacks may submit commands, close sessions, or destroy sessions,
+ * including the session the callback is for.  Callbacks may not
+ * destroy the mux context.
+ *
+ * Callbacks are only called from within ipmi_mux_process().
+ *
+ * A mux context is not thread safe.
+ */
+
+typedef struct ipmi_mux_ctx *ipmi_mux_ctx_t;
+
+typedef struct ipmi_mux_session *ipmi_mux_session_t;
+
+/* errnum is IPMI_ERR_SUCCESS on success or the reason for failure */
+typedef void (*Ipmi_Mux_Callback)(ipmi_mux_session_t session,
+                                  int errnum,
+                                  void *callback_data);
+
+ipmi_mux_ctx_t ipmi_mux_ctx_create (void);
+
+void ipmi_mux_ctx_destroy (ipmi_mux_ctx_t ctx);
+
+int ipmi_mux_ctx_errnum (ipmi_mux_ctx_t ctx);
+
+char *ipmi_mux_ctx_strerror (int errnum);
+
+char *ipmi_mux_ctx_errormsg (ipmi_mux_ctx_t ctx);
+
+/* Start an IPMI 1.5 session to hostname
+ * - For session_timeout and retransmission_timeout, specify 0 for default
+ * - callback is called once the session is established or failed
+ * - Returns session handle on success, NULL on error
+ */
+ipmi_mux_session_t ipmi_mux_session_open (ipmi_mux_ctx_t ctx,
+                                          const char *hostname,
+                                          const char *username,
+                                          const char *password,
+                                          uint8_t authentication_type,
+                                          uint8_t privilege_level,
+                                          unsigned int session_timeout,
+                                          unsigned int retransmission_timeout,
+                                          unsigned int workaround_flags,
+                                          unsigned int flags,
+                                          Ipmi_Mux_Callback callback,
+                                          void *callback_data);
+
+/* Start an IPMI 2.0 session to hostname
+ * - Same as ipmi_mux_session_open() with the IPMI 2.0 parameters of
+ *   ipmi_ctx_open_outofband_2_0()
+ * - Returns session handle on success, NULL on error
+ */
+ipmi_mux_session_t ipmi_mux_session_open_2_0 (ipmi_mux_ctx_t ctx,
+                                              const char *hostname,
+                                              const char *username,
+                                              const char *password,
+                                              const unsigned char *k_g,
+                                              unsigned int k_g_len,
+                                              uint8_t privilege_level,
+                                              uint8_t cipher_suite_id,
+                                              unsigned int session_timeout,
+                                              unsigned int retransmission_timeout,
+                                              unsigned int workaround_flags,
+                                              unsigned int flags,
+                                              Ipmi_Mux_Callback callback,
+                                              void *callback_data);
+
+/* Close an established session
+ * - queued commands are sent before the session is closed
+ * - callback is called once the session is closed
+ * - Returns 0 on success, -1 on error
+ */
+int ipmi_mux_session_close (ipmi_mux_session_t session,
+                            Ipmi_Mux_Callback callback,
+                            void *callback_data);
+
+/* Destroy a session without closing it.  Callbacks of queued commands
+ * are not called.
+ */
+void ipmi_mux_session_destroy (ipmi_mux_session_t session);
+
+/* Returns hostname session was opened with, NULL on error */
+char *ipmi_mux_session_hostname (ipmi_mux_session_t session);
+
+/* Queue a command on a session
+ * - obj_cmd_rq and obj_cmd_rs must remain valid until callback is called
+ * - Returns 0 on success, -1 on error
+ */
+int ipmi_mux_cmd (ipmi_mux_session_t session,
+                  uint8_t lun,
+                  uint8_t net_fn,
+                  fiid_obj_t obj_cmd_rq,
+                  fiid_obj_t obj_cmd_rs,
+                  Ipmi_Mux_Callback callback,
+                  void *callback_data);
+
+/* Returns the descriptor to poll for input, -1 on error */
+int ipmi_mux_fd (ipmi_mux_ctx_t ctx);
+
+/* Returns milliseconds until ipmi_mux_process() must next be called,
+ * -1 if no timer is pending, -2 on error
+ */
+int ipmi_mux_timeout (ipmi_mux_ctx_t ctx);
+
+/* Wait up to timeout milliseconds for responses (-1 for up to the
+ * next timer), then process responses, retransmissions, timeouts,
+ * and callbacks.
+ * - Returns number of sessions with outstanding work, 0 if there is
+ *   none, -1 on error
+ */
+int ipmi_mux_process (ipmi_mux_ctx_t ctx, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IPMI_MUX_API_H */
@@ -170,6 +170,8 @@ typedef struct fiid_obj *fiid_obj_t;
 
 typedef struct fiid_iterator *fiid_iterator_t;
 
+typedef struct fiid_obj_pool *fiid_obj_pool_t;
+
 /*****************************
 * FIID Template API         *
 *****************************/
@@ -194,6 +196,17 @@ int fiid_template_field_lookup (fiid_template_t tmpl,
 int FIID_TEMPLATE_FIELD_LOOKUP (fiid_template_t tmpl,
                                 const char *field);
 
+/*
+ * fiid_template_field_handle
+ *
+ * Returns a handle for the field within the template, -1 on error.
+ * The handle may be passed to fiid_obj_get_by_handle() and
+ * fiid_obj_set_by_handle() for any object created from this
+ * template, avoiding a field name lookup on every call.
+ */
+int fiid_template_field_handle (fiid_template_t tmpl,
+                                const char *field);
+
 /*
  * fiid_template_len
  *
@@ -340,10 +353,41 @@ fiid_obj_t fiid_obj_create (fiid_template_t tmpl);
 /*
  * fiid_obj_destroy
  *
- * Destroy and free memory from a fiid object.
+ * Destroy and free memory from a fiid object.  Objects created with
+ * fiid_obj_create_in() are cleared and returned to their pool.
  */
 void fiid_obj_destroy (fiid_obj_t obj);
 
+/*
+ * fiid_obj_pool_create
+ *
+ * Return a fiid object pool.  Objects created from the pool with
+ * fiid_obj_create_in() are returned to the pool by
+ * fiid_obj_destroy() and handed out again by later calls to
+ * fiid_obj_create_in() with the same template, avoiding memory
+ * allocation for objects that are created and destroyed repeatedly.
+ * Pools are not thread safe.  Returns NULL on error.
+ */
+fiid_obj_pool_t fiid_obj_pool_create (void);
+
+/*
+ * fiid_obj_pool_destroy
+ *
+ * Destroy and free memory from a fiid object pool.  Objects from the
+ * pool that are still in use remain valid until they are destroyed.
+ */
+void fiid_obj_pool_destroy (fiid_obj_pool_t pool);
+
+/*
+ * fiid_obj_create_in
+ *
+ * Identical to fiid_obj_create() except the object is taken from the
+ * specified pool.  The template must remain valid for the lifetime of
+ * the pool, as templates are matched by address.  Returns NULL on
+ * error.
+ */
+fiid_obj_t fiid_obj_create_in (fiid_obj_pool_t pool, fiid_template_t tmpl);
+
 /*
  * fiid_obj_dup
  *
@@ -546,6 +590,16 @@ int fiid_obj_field_lookup (fiid_obj_t obj, const char *field);
  */
 int FIID_OBJ_FIELD_LOOKUP (fiid_obj_t obj, const char *field);
 
+/*
+ * fiid_obj_field_handle
+ *
+ * Returns a handle for the field within the object, -1 on error.
+ * The handle is identical to the one returned by
+ * fiid_template_field_handle() for the template the object was
+ * created from.
+ */
+int fiid_obj_field_handle (fiid_obj_t obj, const char *field);
+
 /*
  * fiid_obj_set
  *
@@ -574,6 +628,24 @@ int fiid_obj_get (fiid_obj_t obj, const char *field, uint64_t *val);
  */
 int FIID_OBJ_GET (fiid_obj_t obj, const char *field, uint64_t *val);
 
+/*
+ * fiid_obj_set_by_handle
+ *
+ * Identical to fiid_obj_set() except the field is specified by a
+ * handle returned from fiid_template_field_handle() or
+ * fiid_obj_field_handle().
+ */
+int fiid_obj_set_by_handle (fiid_obj_t obj, int handle, uint64_t val);
+
+/*
+ * fiid_obj_get_by_handle
+ *
+ * Identical to fiid_obj_get() except the field is specified by a
+ * handle returned from fiid_template_field_handle() or
+ * fiid_obj_field_handle().
+ */
+int fiid_obj_get_by_handle (fiid_obj_t obj, int handle, uint64_t *val);
+
 /*
  * fiid_obj_set_data
  *
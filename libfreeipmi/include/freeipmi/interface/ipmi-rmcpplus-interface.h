@@ -235,6 +235,24 @@ extern fiid_template_t tmpl_rmcpplus_rakp_message_4;
  */
 int ipmi_rmcpplus_init (void);
 
+/* ipmi_rmcpplus_crypt_cache_start, ipmi_rmcpplus_crypt_cache_end
+ *
+ * Between these calls, hash and cipher handles used to assemble and
+ * unassemble RMCP+ packets are kept open in the calling thread, so
+ * keys are not set up again for every packet.  Calls may be nested,
+ * one per session.  The handles are closed and their keys wiped at
+ * the last ipmi_rmcpplus_crypt_cache_end().  Both must be called from
+ * the thread that assembles and unassembles the session's packets.
+ * ipmi_ctx_t out-of-band sessions do this internally.
+ *
+ * ipmi_rmcpplus_crypt_cache_start() returns 0 on success, -1 if
+ * handles cannot be cached.  ipmi_rmcpplus_crypt_cache_end() must
+ * only be called after a successful ipmi_rmcpplus_crypt_cache_start().
+ */
+int ipmi_rmcpplus_crypt_cache_start (void);
+
+void ipmi_rmcpplus_crypt_cache_end (void);
+
 int fill_rmcpplus_session_hdr (uint8_t payload_type,
                                uint8_t payload_authenticated,
                                uint8_t payload_encrypted,
@@ -82,6 +82,21 @@ int ipmi_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
 int ipmi_interpret_load_sensor_config (ipmi_interpret_ctx_t ctx,
                                        const char *sensor_config_file);
 
+/* Same as ipmi_interpret_load_sel_config() and
+ * ipmi_interpret_load_sensor_config(), but the loaded configuration
+ * is also written to a binary cache file.  Later loads read the cache
+ * instead of parsing the config file, as long as the config file has
+ * not changed.  The cache holds the full configuration state, use on
+ * a context with no other configuration of the same type loaded.
+ */
+int ipmi_interpret_load_sel_config_cached (ipmi_interpret_ctx_t ctx,
+                                           const char *sel_config_file,
+                                           const char *sel_config_cache_file);
+
+int ipmi_interpret_load_sensor_config_cached (ipmi_interpret_ctx_t ctx,
+                                              const char *sensor_config_file,
+                                              const char *sensor_config_cache_file);
+
 /* interpret core functions */
 
 int ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
@@ -89,6 +104,16 @@ int ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
                         unsigned int sel_record_len,
                         unsigned int *sel_state);
 
+/* interpret sel_records_count records of
+ * IPMI_SEL_RECORD_MAX_RECORD_LENGTH bytes each, packed as returned by
+ * ipmi_sel_parse_get_records(), storing each state in sel_states.
+ * Stops at the first record that cannot be interpreted.
+ */
+int ipmi_interpret_sel_records (ipmi_interpret_ctx_t ctx,
+                                const void *sel_records,
+                                unsigned int sel_records_count,
+                                unsigned int *sel_states);
+
 int ipmi_interpret_sensor (ipmi_interpret_ctx_t ctx,
                            uint8_t event_reading_type_code,
                            uint8_t sensor_type,
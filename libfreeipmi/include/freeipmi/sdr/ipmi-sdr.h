@@ -91,11 +91,19 @@ extern "C" {
  * ASSUME_MAX_SDR_RECORD_COUNT - If motherboard does not implement SDR
  * record reading properly, this workaround will allow code to not
  * fail out.
+ *
+ * INCREMENTAL - If a cache already exists at the filename, only read
+ * the header of each SDR record and re-use the record from the
+ * existing cache if the record id, version, type, and length are
+ * unchanged.  Typically used with OVERWRITE to update an out of date
+ * cache.  If the existing cache cannot be read, the cache is created
+ * from scratch.
  */
 #define IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT                     0x00
 #define IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE                   0x01
 #define IPMI_SDR_CACHE_CREATE_FLAGS_DUPLICATE_RECORD_ID         0x02
 #define IPMI_SDR_CACHE_CREATE_FLAGS_ASSUME_MAX_SDR_RECORD_COUNT 0x04
+#define IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL                 0x08
 
 #define IPMI_SDR_SENSOR_NAME_FLAGS_DEFAULT                       0x00000000
 #define IPMI_SDR_SENSOR_NAME_FLAGS_IGNORE_SHARED_SENSORS         0x00000001
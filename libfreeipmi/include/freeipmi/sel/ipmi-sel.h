@@ -85,6 +85,8 @@ extern "C" {
 
 typedef struct ipmi_sel_ctx *ipmi_sel_ctx_t;
 
+typedef struct ipmi_sel_format *ipmi_sel_format_t;
+
 typedef int (*Ipmi_Sel_Parse_Callback)(ipmi_sel_ctx_t ctx, void *callback_data);
 
 /* 
@@ -200,6 +202,20 @@ int ipmi_sel_parse_record_ids (ipmi_sel_ctx_t ctx,
                                Ipmi_Sel_Parse_Callback callback,
                                void *callback_data);
 
+/* ipmi_sel_parse_records
+ * - like ipmi_sel_parse, but parses records previously read with
+ *   ipmi_sel_parse_read_record() instead of reading them from the
+ *   BMC, e.g. from a local copy of the SEL
+ * - sel_records holds sel_records_count records of
+ *   IPMI_SEL_RECORD_MAX_RECORD_LENGTH bytes each
+ * - Returns the number of entries parsed
+ */
+int ipmi_sel_parse_records (ipmi_sel_ctx_t ctx,
+                            const void *sel_records,
+                            unsigned int sel_records_count,
+                            Ipmi_Sel_Parse_Callback callback,
+                            void *callback_data);
+
 /* SEL data retrieval functions after SEL is parsed
  *
  * seek_record_id moves the iterator to the closest record_id >= record_id
@@ -211,6 +227,18 @@ int ipmi_sel_parse_sel_entry_count (ipmi_sel_ctx_t ctx);
 int ipmi_sel_parse_seek_record_id (ipmi_sel_ctx_t ctx, uint16_t record_id);
 int ipmi_sel_parse_search_record_id (ipmi_sel_ctx_t ctx, uint16_t record_id);
 
+/* ipmi_sel_parse_get_records
+ * - returns all parsed records at once, in the format taken by
+ *   ipmi_sel_parse_records(), without copying them
+ * - sel_records is set to the records, packed
+ *   IPMI_SEL_RECORD_MAX_RECORD_LENGTH bytes apart, shorter records
+ *   zero padded
+ * - sel_records belongs to the context and is valid until the next
+ *   parse or ipmi_sel_ctx_destroy()
+ * - Returns the number of records
+ */
+int ipmi_sel_parse_get_records (ipmi_sel_ctx_t ctx, const void **sel_records);
+
 /* return length of data read into buffer on success, -1 on error */
 int ipmi_sel_parse_read_record (ipmi_sel_ctx_t ctx,
                                 void *buf,
@@ -463,6 +491,28 @@ int ipmi_sel_parse_read_record_string (ipmi_sel_ctx_t ctx,
 				       unsigned int buflen,
 				       unsigned int flags);
 
+/* ipmi_sel_format_compile
+ * - compile a format string, as described for
+ *   ipmi_sel_parse_read_record_string() above, once for use with
+ *   ipmi_sel_parse_format_record_string() on many records
+ * - a format is not tied to a SEL context and may be shared
+ * - Returns NULL on error, errno set
+ */
+ipmi_sel_format_t ipmi_sel_format_compile (const char *fmt);
+void ipmi_sel_format_destroy (ipmi_sel_format_t format);
+
+/* ipmi_sel_parse_format_record_string
+ * - identical to ipmi_sel_parse_read_record_string(), but with a
+ *   compiled format
+ */
+int ipmi_sel_parse_format_record_string (ipmi_sel_ctx_t ctx,
+					 ipmi_sel_format_t format,
+					 const void *sel_record,
+					 unsigned int sel_record_len,
+					 char *buf,
+					 unsigned int buflen,
+					 unsigned int flags);
+
 /*
  * SEL Utility functions
  */
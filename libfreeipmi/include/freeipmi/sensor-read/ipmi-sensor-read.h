@@ -107,6 +107,22 @@ int ipmi_sensor_read (ipmi_sensor_read_ctx_t ctx,
                       double **sensor_reading,
                       uint16_t *sensor_event_bitmask);
 
+/* Obtain Get Sensor Reading responses for the BMC owned sensors
+ * 'sensor_numbers' through ipmi_cmd_pipeline(), so that up to the
+ * ipmi_ctx pipeline window of requests are outstanding at once.
+ * Subsequent calls to ipmi_sensor_read() for these sensors use the
+ * prefetched response instead of querying the BMC.  Each prefetched
+ * response is used once.  Responses not yet used are discarded by the
+ * next call to ipmi_sensor_read_prefetch().
+ *
+ * Only useful with an outofband session and a pipeline window greater
+ * than 1.  On error, no responses are prefetched and
+ * ipmi_sensor_read() queries the BMC as normal.
+ */
+int ipmi_sensor_read_prefetch (ipmi_sensor_read_ctx_t ctx,
+                               const uint8_t *sensor_numbers,
+                               unsigned int sensor_numbers_len);
+
 #ifdef __cplusplus
 }
 #endif
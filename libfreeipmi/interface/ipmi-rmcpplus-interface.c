@@ -220,6 +220,18 @@ ipmi_rmcpplus_init (void)
   return (0);
 }
 
+int
+ipmi_rmcpplus_crypt_cache_start (void)
+{
+  return (crypt_cache_session_start ());
+}
+
+void
+ipmi_rmcpplus_crypt_cache_end (void)
+{
+  crypt_cache_session_end ();
+}
+
 int
 fill_rmcpplus_session_hdr (uint8_t payload_type,
                            uint8_t payload_authenticated,
@@ -0,0 +1,905 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "freeipmi/interpret/ipmi-interpret.h"
+
+#include "ipmi-interpret-defs.h"
+#include "ipmi-interpret-trace.h"
+#include "ipmi-interpret-config-cache.h"
+
+#include "freeipmi-portability.h"
+#include "fd.h"
+#include "hash.h"
+
+#define IPMI_INTERPRET_CONFIG_CACHE_MAGIC         0x49504943
+#define IPMI_INTERPRET_CONFIG_CACHE_VERSION       2
+
+#define IPMI_INTERPRET_CONFIG_CACHE_TYPE_SEL      1
+#define IPMI_INTERPRET_CONFIG_CACHE_TYPE_SENSOR   2
+
+#define IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES    2
+
+#define IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT 2166136261U
+
+#define IPMI_INTERPRET_CONFIG_CACHE_PATH_MAX      4096
+
+/* the config arrays are the leading members of struct
+ * ipmi_interpret_sel and struct ipmi_interpret_sensor, ahead of the
+ * OEM hashes, so they can be walked as an array of config arrays.
+ */
+#define IPMI_INTERPRET_CONFIG_CACHE_SEL_CONFIGS                         \
+  (offsetof (struct ipmi_interpret_sel, sel_oem_sensor_config)          \
+   / sizeof (struct ipmi_interpret_sel_config **))
+
+#define IPMI_INTERPRET_CONFIG_CACHE_SENSOR_CONFIGS                      \
+  (offsetof (struct ipmi_interpret_sensor, sensor_oem_config)           \
+   / sizeof (struct ipmi_interpret_sensor_config **))
+
+struct ipmi_interpret_config_cache_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t type;
+  uint32_t layout;
+  uint64_t config_dev;
+  uint64_t config_ino;
+  uint64_t config_size;
+  int64_t config_mtime;
+  uint32_t config_mtime_nsec;
+  uint32_t states_count;
+  uint32_t oem_configs_count[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  uint32_t oem_config_len[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  uint32_t checksum;
+  uint32_t cache_len;
+};
+
+/* what a cache holds for one type of config */
+struct ipmi_interpret_config_cache_desc {
+  uint32_t type;
+  uint32_t layout;
+  uint32_t states_count;
+  hash_t oem_configs[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  uint32_t oem_config_len[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  int (*oem_config_valid[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES]) (const void *oem_config);
+};
+
+struct ipmi_interpret_config_cache_copy {
+  uint8_t *ptr;
+  uint32_t len;
+};
+
+struct ipmi_interpret_config_cache_sum {
+  uint32_t len;
+  uint32_t sum;
+};
+
+/* FNV-1a */
+static uint32_t
+_checksum (const void *buf, size_t len, uint32_t checksum)
+{
+  const uint8_t *ptr = buf;
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      checksum ^= ptr[i];
+      checksum *= 16777619;
+    }
+
+  return (checksum);
+}
+
+static int
+_oem_config_checksum (void *data, const void *key, void *arg)
+{
+  struct ipmi_interpret_config_cache_sum *sum;
+
+  assert (data);
+  assert (arg);
+
+  sum = (struct ipmi_interpret_config_cache_sum *)arg;
+
+  sum->sum += _checksum (data, sum->len, IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT);
+  return (1);
+}
+
+/* OEM configs are memset before they are filled in, so the raw
+ * structs can be checksummed.  Summed, hash order doesn't matter.
+ */
+static uint32_t
+_oem_configs_checksum (hash_t oem_configs, uint32_t oem_config_len, uint32_t checksum)
+{
+  struct ipmi_interpret_config_cache_sum sum;
+
+  sum.len = oem_config_len;
+  sum.sum = 0;
+
+  if (oem_configs)
+    hash_for_each (oem_configs, _oem_config_checksum, &sum);
+
+  return (_checksum (&sum.sum, sizeof (uint32_t), checksum));
+}
+
+static uint32_t
+_config_mtime_nsec (const struct stat *buf)
+{
+  assert (buf);
+
+#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+  return (buf->st_mtim.tv_nsec);
+#else /* !HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC */
+  return (0);
+#endif /* !HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC */
+}
+
+static int
+_sel_oem_sensor_config_valid (const void *oem_config)
+{
+  const struct ipmi_interpret_sel_oem_sensor_config *oem_conf = oem_config;
+
+  assert (oem_conf);
+
+  return (oem_conf->oem_sensor_data_count <= IPMI_SEL_OEM_SENSOR_MAX);
+}
+
+static int
+_sel_oem_record_config_valid (const void *oem_config)
+{
+  const struct ipmi_interpret_sel_oem_record_config *oem_conf = oem_config;
+  unsigned int i;
+
+  assert (oem_conf);
+
+  if (oem_conf->oem_record_count > IPMI_SEL_OEM_RECORD_MAX)
+    return (0);
+
+  for (i = 0; i < oem_conf->oem_record_count; i++)
+    {
+      if (oem_conf->oem_record[i].oem_bytes_count > IPMI_SEL_OEM_DATA_MAX)
+        return (0);
+    }
+
+  return (1);
+}
+
+static int
+_sensor_oem_config_valid (const void *oem_config)
+{
+  const struct ipmi_interpret_sensor_oem_config *oem_conf = oem_config;
+
+  assert (oem_conf);
+
+  return (oem_conf->oem_state_count <= IPMI_INTERPRET_MAX_BITMASKS);
+}
+
+static uint32_t
+_sel_layout (ipmi_interpret_ctx_t ctx)
+{
+  struct ipmi_interpret_sel_config ***configs;
+  uint32_t layout = IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
+  configs = (struct ipmi_interpret_sel_config ***)&ctx->interpret_sel;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SEL_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          layout = _checksum (configs[i][j]->option_str,
+                              strlen (configs[i][j]->option_str) + 1,
+                              layout);
+          state = configs[i][j]->assertion_state;
+          layout = _checksum (&state, sizeof (int32_t), layout);
+          state = configs[i][j]->deassertion_state;
+          layout = _checksum (&state, sizeof (int32_t), layout);
+        }
+      /* empty string marks the end of each config array */
+      layout = _checksum ("", 1, layout);
+    }
+
+  layout = _oem_configs_checksum (ctx->interpret_sel.sel_oem_sensor_config,
+                                  sizeof (struct ipmi_interpret_sel_oem_sensor_config),
+                                  layout);
+  layout = _oem_configs_checksum (ctx->interpret_sel.sel_oem_record_config,
+                                  sizeof (struct ipmi_interpret_sel_oem_record_config),
+                                  layout);
+  return (layout);
+}
+
+static void
+_sel_desc (ipmi_interpret_ctx_t ctx,
+           uint32_t layout,
+           struct ipmi_interpret_config_cache_desc *desc)
+{
+  struct ipmi_interpret_sel_config ***configs;
+  unsigned int i, j;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (desc);
+
+  configs = (struct ipmi_interpret_sel_config ***)&ctx->interpret_sel;
+
+  memset (desc, '\0', sizeof (struct ipmi_interpret_config_cache_desc));
+  desc->type = IPMI_INTERPRET_CONFIG_CACHE_TYPE_SEL;
+  desc->layout = layout;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SEL_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        desc->states_count += 2;
+    }
+
+  desc->oem_configs[0] = ctx->interpret_sel.sel_oem_sensor_config;
+  desc->oem_config_len[0] = sizeof (struct ipmi_interpret_sel_oem_sensor_config);
+  desc->oem_config_valid[0] = _sel_oem_sensor_config_valid;
+  desc->oem_configs[1] = ctx->interpret_sel.sel_oem_record_config;
+  desc->oem_config_len[1] = sizeof (struct ipmi_interpret_sel_oem_record_config);
+  desc->oem_config_valid[1] = _sel_oem_record_config_valid;
+}
+
+static void
+_sel_states_get (ipmi_interpret_ctx_t ctx, uint8_t *states)
+{
+  struct ipmi_interpret_sel_config ***configs;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (states);
+
+  configs = (struct ipmi_interpret_sel_config ***)&ctx->interpret_sel;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SEL_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          state = configs[i][j]->assertion_state;
+          memcpy (states, &state, sizeof (int32_t));
+          states += sizeof (int32_t);
+          state = configs[i][j]->deassertion_state;
+          memcpy (states, &state, sizeof (int32_t));
+          states += sizeof (int32_t);
+        }
+    }
+}
+
+static void
+_sel_states_set (ipmi_interpret_ctx_t ctx, const uint8_t *states)
+{
+  struct ipmi_interpret_sel_config ***configs;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (states);
+
+  configs = (struct ipmi_interpret_sel_config ***)&ctx->interpret_sel;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SEL_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          memcpy (&state, states, sizeof (int32_t));
+          configs[i][j]->assertion_state = state;
+          states += sizeof (int32_t);
+          memcpy (&state, states, sizeof (int32_t));
+          configs[i][j]->deassertion_state = state;
+          states += sizeof (int32_t);
+        }
+    }
+}
+
+static uint32_t
+_sensor_layout (ipmi_interpret_ctx_t ctx)
+{
+  struct ipmi_interpret_sensor_config ***configs;
+  uint32_t layout = IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
+  configs = (struct ipmi_interpret_sensor_config ***)&ctx->interpret_sensor;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SENSOR_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          layout = _checksum (configs[i][j]->option_str,
+                              strlen (configs[i][j]->option_str) + 1,
+                              layout);
+          state = configs[i][j]->state;
+          layout = _checksum (&state, sizeof (int32_t), layout);
+        }
+      /* empty string marks the end of each config array */
+      layout = _checksum ("", 1, layout);
+    }
+
+  layout = _oem_configs_checksum (ctx->interpret_sensor.sensor_oem_config,
+                                  sizeof (struct ipmi_interpret_sensor_oem_config),
+                                  layout);
+  return (layout);
+}
+
+static void
+_sensor_desc (ipmi_interpret_ctx_t ctx,
+              uint32_t layout,
+              struct ipmi_interpret_config_cache_desc *desc)
+{
+  struct ipmi_interpret_sensor_config ***configs;
+  unsigned int i, j;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (desc);
+
+  configs = (struct ipmi_interpret_sensor_config ***)&ctx->interpret_sensor;
+
+  memset (desc, '\0', sizeof (struct ipmi_interpret_config_cache_desc));
+  desc->type = IPMI_INTERPRET_CONFIG_CACHE_TYPE_SENSOR;
+  desc->layout = layout;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SENSOR_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        desc->states_count++;
+    }
+
+  desc->oem_configs[0] = ctx->interpret_sensor.sensor_oem_config;
+  desc->oem_config_len[0] = sizeof (struct ipmi_interpret_sensor_oem_config);
+  desc->oem_config_valid[0] = _sensor_oem_config_valid;
+}
+
+static void
+_sensor_states_get (ipmi_interpret_ctx_t ctx, uint8_t *states)
+{
+  struct ipmi_interpret_sensor_config ***configs;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (states);
+
+  configs = (struct ipmi_interpret_sensor_config ***)&ctx->interpret_sensor;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SENSOR_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          state = configs[i][j]->state;
+          memcpy (states, &state, sizeof (int32_t));
+          states += sizeof (int32_t);
+        }
+    }
+}
+
+static void
+_sensor_states_set (ipmi_interpret_ctx_t ctx, const uint8_t *states)
+{
+  struct ipmi_interpret_sensor_config ***configs;
+  unsigned int i, j;
+  int32_t state;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (states);
+
+  configs = (struct ipmi_interpret_sensor_config ***)&ctx->interpret_sensor;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_SENSOR_CONFIGS; i++)
+    {
+      for (j = 0; configs[i][j]; j++)
+        {
+          memcpy (&state, states, sizeof (int32_t));
+          configs[i][j]->state = state;
+          states += sizeof (int32_t);
+        }
+    }
+}
+
+static int
+_oem_config_delete_all (void *data, const void *key, void *arg)
+{
+  return (1);
+}
+
+static int
+_oem_config_copy (void *data, const void *key, void *arg)
+{
+  struct ipmi_interpret_config_cache_copy *copy;
+
+  assert (data);
+  assert (arg);
+
+  copy = (struct ipmi_interpret_config_cache_copy *)arg;
+
+  memcpy (copy->ptr, data, copy->len);
+  copy->ptr += copy->len;
+  return (1);
+}
+
+static int
+_config_cache_load (ipmi_interpret_ctx_t ctx,
+                    const char *cache_file,
+                    const struct stat *config_buf,
+                    const struct ipmi_interpret_config_cache_desc *desc,
+                    void (*states_set) (ipmi_interpret_ctx_t, const uint8_t *))
+{
+  struct ipmi_interpret_config_cache_header header;
+  struct stat buf;
+  uint8_t *cache = NULL;
+  size_t cache_len = 0;
+  void **oem_copies[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  unsigned int oem_copies_count[IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES];
+  hash_t oem_keys = NULL;
+  size_t offset;
+  int32_t state;
+  unsigned int i, j;
+  int fd = -1;
+  int rv = 0;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (cache_file);
+  assert (config_buf);
+  assert (desc);
+  assert (states_set);
+
+  memset (oem_copies, '\0', sizeof (oem_copies));
+  memset (oem_copies_count, '\0', sizeof (oem_copies_count));
+
+  /* a missing, unreadable, or stale cache is not an error, the
+   * caller parses the config file instead
+   */
+  if ((fd = open (cache_file, O_RDONLY)) < 0)
+    goto cleanup;
+
+  if (fstat (fd, &buf) < 0
+      || buf.st_size < (off_t)sizeof (struct ipmi_interpret_config_cache_header))
+    goto cleanup;
+
+  cache_len = buf.st_size;
+
+  cache = (uint8_t *)mmap (NULL,
+                           cache_len,
+                           PROT_READ,
+                           MAP_PRIVATE,
+                           fd,
+                           0);
+  if (!cache || cache == ((void *) -1))
+    {
+      cache = NULL;
+      goto cleanup;
+    }
+
+  memcpy (&header, cache, sizeof (struct ipmi_interpret_config_cache_header));
+
+  if (header.magic != IPMI_INTERPRET_CONFIG_CACHE_MAGIC
+      || header.version != IPMI_INTERPRET_CONFIG_CACHE_VERSION
+      || header.type != desc->type
+      || header.layout != desc->layout
+      || header.config_dev != (uint64_t)config_buf->st_dev
+      || header.config_ino != (uint64_t)config_buf->st_ino
+      || header.config_size != (uint64_t)config_buf->st_size
+      || header.config_mtime != (int64_t)config_buf->st_mtime
+      || header.config_mtime_nsec != _config_mtime_nsec (config_buf)
+      || header.states_count != desc->states_count
+      || header.cache_len != cache_len)
+    goto cleanup;
+
+  offset = sizeof (struct ipmi_interpret_config_cache_header)
+    + (size_t)header.states_count * sizeof (int32_t);
+  if (offset > cache_len)
+    goto cleanup;
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      if (header.oem_config_len[i] != desc->oem_config_len[i])
+        goto cleanup;
+
+      if (!header.oem_config_len[i])
+        {
+          if (header.oem_configs_count[i])
+            goto cleanup;
+          continue;
+        }
+
+      if (header.oem_configs_count[i] > (cache_len - offset) / header.oem_config_len[i])
+        goto cleanup;
+
+      offset += (size_t)header.oem_configs_count[i] * header.oem_config_len[i];
+    }
+
+  if (offset != cache_len)
+    goto cleanup;
+
+  if (_checksum (cache + sizeof (struct ipmi_interpret_config_cache_header),
+                 cache_len - sizeof (struct ipmi_interpret_config_cache_header),
+                 IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT) != header.checksum)
+    goto cleanup;
+
+  offset = sizeof (struct ipmi_interpret_config_cache_header);
+  for (i = 0; i < header.states_count; i++)
+    {
+      memcpy (&state, cache + offset, sizeof (int32_t));
+      if (state < IPMI_INTERPRET_STATE_NOMINAL
+          || state > IPMI_INTERPRET_STATE_UNKNOWN)
+        goto cleanup;
+      offset += sizeof (int32_t);
+    }
+
+  /* copy out and check all OEM configs before anything in the
+   * context is touched
+   */
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      if (!header.oem_configs_count[i])
+        continue;
+
+      if (!(oem_copies[i] = (void **)calloc (header.oem_configs_count[i], sizeof (void *))))
+        {
+          INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+          rv = -1;
+          goto cleanup;
+        }
+      oem_copies_count[i] = header.oem_configs_count[i];
+
+      /* duplicate keys could not be inserted below */
+      if (!(oem_keys = hash_create (oem_copies_count[i],
+                                    (hash_key_f)hash_key_string,
+                                    (hash_cmp_f)strcmp,
+                                    NULL)))
+        {
+          INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+          rv = -1;
+          goto cleanup;
+        }
+
+      for (j = 0; j < oem_copies_count[i]; j++)
+        {
+          if (!(oem_copies[i][j] = malloc (header.oem_config_len[i])))
+            {
+              INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+              rv = -1;
+              goto cleanup;
+            }
+          memcpy (oem_copies[i][j], cache + offset, header.oem_config_len[i]);
+          offset += header.oem_config_len[i];
+
+          /* key is the first member of every OEM config struct */
+          if (!memchr (oem_copies[i][j], '\0', IPMI_OEM_HASH_KEY_BUFLEN + 1)
+              || !desc->oem_config_valid[i] (oem_copies[i][j]))
+            goto cleanup;
+
+          if (!hash_insert (oem_keys, (char *)oem_copies[i][j], oem_copies[i][j]))
+            {
+              if (errno != EEXIST)
+                {
+                  INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+                  rv = -1;
+                }
+              goto cleanup;
+            }
+        }
+
+      hash_destroy (oem_keys);
+      oem_keys = NULL;
+    }
+
+  states_set (ctx, cache + sizeof (struct ipmi_interpret_config_cache_header));
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      if (!desc->oem_configs[i])
+        continue;
+
+      hash_delete_if (desc->oem_configs[i], _oem_config_delete_all, NULL);
+
+      for (j = 0; j < oem_copies_count[i]; j++)
+        {
+          if (!hash_insert (desc->oem_configs[i],
+                            (char *)oem_copies[i][j],
+                            oem_copies[i][j]))
+            {
+              INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+              rv = -1;
+              goto cleanup;
+            }
+          oem_copies[i][j] = NULL;
+        }
+    }
+
+  rv = 1;
+ cleanup:
+  if (oem_keys)
+    hash_destroy (oem_keys);
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      for (j = 0; j < oem_copies_count[i]; j++)
+        free (oem_copies[i][j]);
+      free (oem_copies[i]);
+    }
+  if (cache)
+    munmap ((void *)cache, cache_len);
+  /* ignore potential error, cleanup path */
+  if (fd >= 0)
+    close (fd);
+  return (rv);
+}
+
+static int
+_config_cache_store (ipmi_interpret_ctx_t ctx,
+                     const char *cache_file,
+                     const struct stat *config_buf,
+                     const struct ipmi_interpret_config_cache_desc *desc,
+                     void (*states_get) (ipmi_interpret_ctx_t, uint8_t *))
+{
+  struct ipmi_interpret_config_cache_header header;
+  struct ipmi_interpret_config_cache_copy copy;
+  char tmpfilename[IPMI_INTERPRET_CONFIG_CACHE_PATH_MAX + 1];
+  uint8_t *cache = NULL;
+  size_t cache_len;
+  int count;
+  unsigned int i;
+  int tmpfile_created = 0;
+  int ret;
+  int fd = -1;
+  int rv = -1;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (cache_file);
+  assert (config_buf);
+  assert (desc);
+  assert (states_get);
+
+  memset (&header, '\0', sizeof (struct ipmi_interpret_config_cache_header));
+  header.magic = IPMI_INTERPRET_CONFIG_CACHE_MAGIC;
+  header.version = IPMI_INTERPRET_CONFIG_CACHE_VERSION;
+  header.type = desc->type;
+  header.layout = desc->layout;
+  header.config_dev = config_buf->st_dev;
+  header.config_ino = config_buf->st_ino;
+  header.config_size = config_buf->st_size;
+  header.config_mtime = config_buf->st_mtime;
+  header.config_mtime_nsec = _config_mtime_nsec (config_buf);
+  header.states_count = desc->states_count;
+
+  cache_len = sizeof (struct ipmi_interpret_config_cache_header)
+    + (size_t)desc->states_count * sizeof (int32_t);
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      if (!desc->oem_configs[i])
+        continue;
+
+      if ((count = hash_count (desc->oem_configs[i])) < 0)
+        goto cleanup;
+
+      header.oem_configs_count[i] = count;
+      header.oem_config_len[i] = desc->oem_config_len[i];
+      cache_len += (size_t)count * desc->oem_config_len[i];
+    }
+
+  header.cache_len = cache_len;
+
+  if (!(cache = (uint8_t *)malloc (cache_len)))
+    goto cleanup;
+
+  states_get (ctx, cache + sizeof (struct ipmi_interpret_config_cache_header));
+
+  copy.ptr = cache
+    + sizeof (struct ipmi_interpret_config_cache_header)
+    + (size_t)desc->states_count * sizeof (int32_t);
+
+  for (i = 0; i < IPMI_INTERPRET_CONFIG_CACHE_OEM_HASHES; i++)
+    {
+      if (!header.oem_configs_count[i])
+        continue;
+
+      copy.len = header.oem_config_len[i];
+      if (hash_for_each (desc->oem_configs[i], _oem_config_copy, &copy) != (int)header.oem_configs_count[i])
+        goto cleanup;
+    }
+
+  assert (copy.ptr == cache + cache_len);
+
+  header.checksum = _checksum (cache + sizeof (struct ipmi_interpret_config_cache_header),
+                               cache_len - sizeof (struct ipmi_interpret_config_cache_header),
+                               IPMI_INTERPRET_CONFIG_CACHE_CHECKSUM_INIT);
+  memcpy (cache, &header, sizeof (struct ipmi_interpret_config_cache_header));
+
+  /* write aside and rename, a concurrent reader never sees a partial
+   * cache.  Threads of one process share a pid, so the temporary name
+   * must be unique per writer.
+   */
+  if ((ret = snprintf (tmpfilename,
+                       IPMI_INTERPRET_CONFIG_CACHE_PATH_MAX,
+                       "%s.XXXXXX",
+                       cache_file)) < 0
+      || ret >= IPMI_INTERPRET_CONFIG_CACHE_PATH_MAX)
+    goto cleanup;
+
+  if ((fd = mkstemp (tmpfilename)) < 0)
+    goto cleanup;
+  tmpfile_created++;
+
+  /* mkstemp creates the file 0600 */
+  if (fchmod (fd, 0644) < 0)
+    goto cleanup;
+
+  if (fd_write_n (fd, cache, cache_len) != cache_len)
+    goto cleanup;
+
+  if (close (fd) < 0)
+    {
+      fd = -1;
+      goto cleanup;
+    }
+  fd = -1;
+
+  if (rename (tmpfilename, cache_file) < 0)
+    goto cleanup;
+
+  rv = 0;
+ cleanup:
+  if (rv < 0 && tmpfile_created)
+    {
+      /* ignore potential errors, error path */
+      if (fd >= 0)
+        close (fd);
+      unlink (tmpfilename);
+    }
+  free (cache);
+  return (rv);
+}
+
+uint32_t
+interpret_config_cache_sel_layout (ipmi_interpret_ctx_t ctx)
+{
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
+  return (_sel_layout (ctx));
+}
+
+int
+interpret_config_cache_sel_load (ipmi_interpret_ctx_t ctx,
+                                 const char *sel_config_cache_file,
+                                 const struct stat *sel_config_buf,
+                                 uint32_t layout)
+{
+  struct ipmi_interpret_config_cache_desc desc;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (sel_config_cache_file);
+  assert (sel_config_buf);
+
+  _sel_desc (ctx, layout, &desc);
+
+  return (_config_cache_load (ctx,
+                              sel_config_cache_file,
+                              sel_config_buf,
+                              &desc,
+                              _sel_states_set));
+}
+
+int
+interpret_config_cache_sel_store (ipmi_interpret_ctx_t ctx,
+                                  const char *sel_config_cache_file,
+                                  const struct stat *sel_config_buf,
+                                  uint32_t layout)
+{
+  struct ipmi_interpret_config_cache_desc desc;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (sel_config_cache_file);
+  assert (sel_config_buf);
+
+  _sel_desc (ctx, layout, &desc);
+
+  return (_config_cache_store (ctx,
+                               sel_config_cache_file,
+                               sel_config_buf,
+                               &desc,
+                               _sel_states_get));
+}
+
+uint32_t
+interpret_config_cache_sensor_layout (ipmi_interpret_ctx_t ctx)
+{
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
+  return (_sensor_layout (ctx));
+}
+
+int
+interpret_config_cache_sensor_load (ipmi_interpret_ctx_t ctx,
+                                    const char *sensor_config_cache_file,
+                                    const struct stat *sensor_config_buf,
+                                    uint32_t layout)
+{
+  struct ipmi_interpret_config_cache_desc desc;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (sensor_config_cache_file);
+  assert (sensor_config_buf);
+
+  _sensor_desc (ctx, layout, &desc);
+
+  return (_config_cache_load (ctx,
+                              sensor_config_cache_file,
+                              sensor_config_buf,
+                              &desc,
+                              _sensor_states_set));
+}
+
+int
+interpret_config_cache_sensor_store (ipmi_interpret_ctx_t ctx,
+                                     const char *sensor_config_cache_file,
+                                     const struct stat *sensor_config_buf,
+                                     uint32_t layout)
+{
+  struct ipmi_interpret_config_cache_desc desc;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (sensor_config_cache_file);
+  assert (sensor_config_buf);
+
+  _sensor_desc (ctx, layout, &desc);
+
+  return (_config_cache_store (ctx,
+                               sensor_config_cache_file,
+                               sensor_config_buf,
+                               &desc,
+                               _sensor_states_get));
+}
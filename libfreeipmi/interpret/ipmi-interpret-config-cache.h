@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IPMI_INTERPRET_CONFIG_CACHE_H
+#define IPMI_INTERPRET_CONFIG_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "freeipmi/interpret/ipmi-interpret.h"
+
+#include "ipmi-interpret-defs.h"
+
+/* Binary cache of a loaded sel or sensor configuration.
+ *
+ * Integers are in host byte order, a cache is only for the host that
+ * wrote it.  Layout, offsets in bytes from the start of the file:
+ *
+ *   struct ipmi_interpret_config_cache_header
+ *   int32_t states[states_count]      - every config array entry's
+ *                                       state(s), in the order of the
+ *                                       config arrays in the context
+ *   oem config structs                - raw copies of each OEM hash
+ *                                       entry, oem_configs_count[i]
+ *                                       entries of oem_config_len[i]
+ *                                       bytes for each OEM hash
+ *
+ * A cache is only used if it was written from the same starting
+ * context (layout, a checksum of the config array names, their
+ * default states, and the built-in OEM configs), with the same OEM
+ * structs (oem_config_len), and the configuration file's device,
+ * inode, size, and mtime (with nanoseconds where available) are
+ * unchanged.
+ */
+
+/* Returns the layout of the context before a config is applied,
+ * pass it to both load and store.
+ */
+uint32_t interpret_config_cache_sel_layout (ipmi_interpret_ctx_t ctx);
+
+/* Returns 1 if the cache was loaded, 0 if it is missing or stale, -1
+ * on error
+ */
+int interpret_config_cache_sel_load (ipmi_interpret_ctx_t ctx,
+                                     const char *sel_config_cache_file,
+                                     const struct stat *sel_config_buf,
+                                     uint32_t layout);
+
+/* Returns 0 if the cache was written, -1 if not, errnum is not set */
+int interpret_config_cache_sel_store (ipmi_interpret_ctx_t ctx,
+                                      const char *sel_config_cache_file,
+                                      const struct stat *sel_config_buf,
+                                      uint32_t layout);
+
+uint32_t interpret_config_cache_sensor_layout (ipmi_interpret_ctx_t ctx);
+
+int interpret_config_cache_sensor_load (ipmi_interpret_ctx_t ctx,
+                                        const char *sensor_config_cache_file,
+                                        const struct stat *sensor_config_buf,
+                                        uint32_t layout);
+
+int interpret_config_cache_sensor_store (ipmi_interpret_ctx_t ctx,
+                                         const char *sensor_config_cache_file,
+                                         const struct stat *sensor_config_buf,
+                                         uint32_t layout);
+
+#endif /* IPMI_INTERPRET_CONFIG_CACHE_H */
@@ -206,6 +206,48 @@ struct ipmi_interpret_sel {
   hash_t sel_oem_record_config;
 };
 
+/* The sel config compiled into lookup tables on first use.  State
+ * tables are indexed by event reading type class and sensor type, the
+ * OEM tables only hold configs for the current manufacturer and
+ * product id.
+ */
+
+#define IPMI_INTERPRET_SEL_CLASS_THRESHOLD       0
+/* generic event reading type codes are classes 1 - 11 */
+#define IPMI_INTERPRET_SEL_CLASS_SENSOR_SPECIFIC 12
+#define IPMI_INTERPRET_SEL_CLASSES               13
+
+#define IPMI_INTERPRET_SEL_SENSOR_TYPES          256
+
+#define IPMI_INTERPRET_SEL_RECORD_TYPES          256
+
+#define IPMI_INTERPRET_SEL_OFFSETS               16
+
+#define IPMI_INTERPRET_SEL_STATE_TABLES_MAX      80
+
+struct ipmi_interpret_sel_state_table {
+  uint16_t offsets_valid;
+  uint8_t assertion_state[IPMI_INTERPRET_SEL_OFFSETS];
+  uint8_t deassertion_state[IPMI_INTERPRET_SEL_OFFSETS];
+};
+
+struct ipmi_interpret_sel_tables {
+  int loaded;
+  uint32_t manufacturer_id;
+  uint16_t product_id;
+
+  /* index + 1 into state_tables, 0 if there is no config */
+  uint8_t state_table_index[IPMI_INTERPRET_SEL_CLASSES][IPMI_INTERPRET_SEL_SENSOR_TYPES];
+  struct ipmi_interpret_sel_state_table state_tables[IPMI_INTERPRET_SEL_STATE_TABLES_MAX];
+  unsigned int state_tables_count;
+
+  /* sorted by event reading type code, then sensor type */
+  struct ipmi_interpret_sel_oem_sensor_config **oem_sensor_configs;
+  unsigned int oem_sensor_configs_count;
+
+  struct ipmi_interpret_sel_oem_record_config *oem_record_configs[IPMI_INTERPRET_SEL_RECORD_TYPES];
+};
+
 struct ipmi_interpret_sensor_oem_state {
   uint16_t sensor_event_bitmask;
   unsigned int sensor_state;
@@ -305,6 +347,7 @@ struct ipmi_interpret_ctx {
   ipmi_sel_ctx_t sel_ctx;
 
   struct ipmi_interpret_sel interpret_sel;
+  struct ipmi_interpret_sel_tables interpret_sel_tables;
   struct ipmi_interpret_sensor interpret_sensor;
 };
 
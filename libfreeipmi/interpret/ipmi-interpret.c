@@ -30,6 +30,7 @@
 #endif /* HAVE_UNISTD_H */
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <stddef.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -43,6 +44,7 @@
 
 #include "ipmi-interpret-defs.h"
 #include "ipmi-interpret-trace.h"
+#include "ipmi-interpret-config-cache.h"
 #include "ipmi-interpret-config-sel.h"
 #include "ipmi-interpret-config-sensor.h"
 #include "ipmi-interpret-util.h"
@@ -77,6 +79,18 @@ static char *ipmi_interpret_errmsgs[] =
 /* upper bits of threshold based sensor can be 1b, may need to ignore them */
 #define IPMI_INTERPRET_THRESHOLD_SENSOR_EVENT_BITMASK_MASK 0x3F
 
+/* System Event Record layout, see tmpl_sel_system_event_record */
+#define IPMI_INTERPRET_SEL_RECORD_TYPE_INDEX               2
+#define IPMI_INTERPRET_SEL_SENSOR_TYPE_INDEX               10
+#define IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_INDEX           12
+#define IPMI_INTERPRET_SEL_EVENT_DATA1_INDEX               13
+#define IPMI_INTERPRET_SEL_EVENT_DATA2_INDEX               14
+#define IPMI_INTERPRET_SEL_EVENT_DATA3_INDEX               15
+
+#define IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_MASK            0x7F
+#define IPMI_INTERPRET_SEL_EVENT_DIR_SHIFT                 7
+#define IPMI_INTERPRET_SEL_EVENT_DATA1_OFFSET_MASK         0x0F
+
 ipmi_interpret_ctx_t
 ipmi_interpret_ctx_create (void)
 {
@@ -125,6 +139,7 @@ ipmi_interpret_ctx_destroy (ipmi_interpret_ctx_t ctx)
   ipmi_sel_ctx_destroy (ctx->sel_ctx);
   interpret_sel_destroy (ctx);
   interpret_sensor_destroy (ctx);
+  free (ctx->interpret_sel_tables.oem_sensor_configs);
 
   ctx->magic = ~IPMI_INTERPRET_CTX_MAGIC;
   free (ctx);
@@ -276,18 +291,18 @@ ipmi_interpret_ctx_set_product_id (ipmi_interpret_ctx_t ctx, uint16_t product_id
   return (0);
 }
 
-int
-ipmi_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
-                                const char *sel_config_file)
+static int
+_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
+                            const char *sel_config_file,
+                            const char *sel_config_cache_file)
 {
   struct stat buf;
+  uint32_t layout = 0;
+  int ret;
   int rv = -1;
 
-  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
-    {
-      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
-      return (-1);
-    }
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
 
   if (sel_config_file)
     {
@@ -317,9 +332,35 @@ ipmi_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
         }
     }
 
+  ctx->interpret_sel_tables.loaded = 0;
+
+  if (sel_config_cache_file)
+    {
+      /* the cache is keyed on the state before the config is applied */
+      layout = interpret_config_cache_sel_layout (ctx);
+
+      if ((ret = interpret_config_cache_sel_load (ctx,
+                                                  sel_config_cache_file,
+                                                  &buf,
+                                                  layout)) < 0)
+        goto cleanup;
+
+      if (ret)
+        goto out;
+    }
+
   if (interpret_sel_config_parse (ctx, sel_config_file) < 0)
     goto cleanup;
 
+  /* Not an error if the cache can't be written, the config file
+   * will be parsed again next time.
+   */
+  if (sel_config_cache_file)
+    interpret_config_cache_sel_store (ctx,
+                                      sel_config_cache_file,
+                                      &buf,
+                                      layout);
+
  out:
   rv = 0;
  cleanup:
@@ -327,18 +368,51 @@ ipmi_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
 }
 
 int
-ipmi_interpret_load_sensor_config (ipmi_interpret_ctx_t ctx,
-                                   const char *sensor_config_file)
+ipmi_interpret_load_sel_config (ipmi_interpret_ctx_t ctx,
+                                const char *sel_config_file)
 {
-  struct stat buf;
-  int rv = -1;
+  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
+      return (-1);
+    }
 
+  return (_interpret_load_sel_config (ctx, sel_config_file, NULL));
+}
+
+int
+ipmi_interpret_load_sel_config_cached (ipmi_interpret_ctx_t ctx,
+                                       const char *sel_config_file,
+                                       const char *sel_config_cache_file)
+{
   if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
     {
       ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
       return (-1);
     }
 
+  if (!sel_config_cache_file)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  return (_interpret_load_sel_config (ctx, sel_config_file, sel_config_cache_file));
+}
+
+static int
+_interpret_load_sensor_config (ipmi_interpret_ctx_t ctx,
+                               const char *sensor_config_file,
+                               const char *sensor_config_cache_file)
+{
+  struct stat buf;
+  uint32_t layout = 0;
+  int ret;
+  int rv = -1;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
   if (sensor_config_file)
     {
       if (stat (sensor_config_file, &buf) < 0)
@@ -367,15 +441,556 @@ ipmi_interpret_load_sensor_config (ipmi_interpret_ctx_t ctx,
         }
     }
 
+  if (sensor_config_cache_file)
+    {
+      /* the cache is keyed on the state before the config is applied */
+      layout = interpret_config_cache_sensor_layout (ctx);
+
+      if ((ret = interpret_config_cache_sensor_load (ctx,
+                                                     sensor_config_cache_file,
+                                                     &buf,
+                                                     layout)) < 0)
+        goto cleanup;
+
+      if (ret)
+        goto out;
+    }
+
   if (interpret_sensor_config_parse (ctx, sensor_config_file) < 0)
     goto cleanup;
 
+  /* Not an error if the cache can't be written, the config file
+   * will be parsed again next time.
+   */
+  if (sensor_config_cache_file)
+    interpret_config_cache_sensor_store (ctx,
+                                         sensor_config_cache_file,
+                                         &buf,
+                                         layout);
+
  out:
   rv = 0;
  cleanup:
   return (rv);
 }
 
+int
+ipmi_interpret_load_sensor_config (ipmi_interpret_ctx_t ctx,
+                                   const char *sensor_config_file)
+{
+  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  return (_interpret_load_sensor_config (ctx, sensor_config_file, NULL));
+}
+
+int
+ipmi_interpret_load_sensor_config_cached (ipmi_interpret_ctx_t ctx,
+                                          const char *sensor_config_file,
+                                          const char *sensor_config_cache_file)
+{
+  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!sensor_config_cache_file)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  return (_interpret_load_sensor_config (ctx, sensor_config_file, sensor_config_cache_file));
+}
+
+struct ipmi_interpret_sel_config_map {
+  uint8_t event_reading_type_code;
+  uint8_t sensor_type;
+  size_t config_offset;
+};
+
+#define IPMI_INTERPRET_SEL_CONFIG_MAP(__event_reading_type_code, __sensor_type, __config) \
+  { (__event_reading_type_code), (__sensor_type), offsetof (struct ipmi_interpret_sel, __config) }
+
+/* threshold config applies to all sensor types, it is not listed */
+static struct ipmi_interpret_sel_config_map ipmi_interpret_sel_config_maps[] =
+  {
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_TEMPERATURE,
+                                   ipmi_interpret_sel_temperature_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_LIMIT,
+                                   IPMI_SENSOR_TYPE_TEMPERATURE,
+                                   ipmi_interpret_sel_temperature_limit_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_TEMPERATURE,
+                                   ipmi_interpret_sel_temperature_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_VOLTAGE,
+                                   ipmi_interpret_sel_voltage_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_LIMIT,
+                                   IPMI_SENSOR_TYPE_VOLTAGE,
+                                   ipmi_interpret_sel_voltage_limit_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_PERFORMANCE,
+                                   IPMI_SENSOR_TYPE_VOLTAGE,
+                                   ipmi_interpret_sel_voltage_performance_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_VOLTAGE,
+                                   ipmi_interpret_sel_voltage_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_CURRENT,
+                                   ipmi_interpret_sel_current_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_FAN,
+                                   ipmi_interpret_sel_fan_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_FAN,
+                                   ipmi_interpret_sel_fan_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT,
+                                   IPMI_SENSOR_TYPE_FAN,
+                                   ipmi_interpret_sel_fan_device_present_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_AVAILABILITY,
+                                   IPMI_SENSOR_TYPE_FAN,
+                                   ipmi_interpret_sel_fan_transition_availability_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY,
+                                   IPMI_SENSOR_TYPE_FAN,
+                                   ipmi_interpret_sel_fan_redundancy_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_PROCESSOR,
+                                   ipmi_interpret_sel_processor_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_POWER_SUPPLY,
+                                   ipmi_interpret_sel_power_supply_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_POWER_SUPPLY,
+                                   ipmi_interpret_sel_power_supply_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY,
+                                   IPMI_SENSOR_TYPE_POWER_SUPPLY,
+                                   ipmi_interpret_sel_power_supply_redundancy_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT,
+                                   IPMI_SENSOR_TYPE_POWER_UNIT,
+                                   ipmi_interpret_sel_power_unit_device_present_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY,
+                                   IPMI_SENSOR_TYPE_POWER_UNIT,
+                                   ipmi_interpret_sel_power_unit_redundancy_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY,
+                                   IPMI_SENSOR_TYPE_COOLING_DEVICE,
+                                   ipmi_interpret_sel_cooling_device_redundancy_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_MEMORY,
+                                   ipmi_interpret_sel_memory_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_MEMORY,
+                                   ipmi_interpret_sel_memory_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY,
+                                   IPMI_SENSOR_TYPE_MEMORY,
+                                   ipmi_interpret_sel_memory_redundancy_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_DRIVE_SLOT,
+                                   ipmi_interpret_sel_drive_slot_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_PREDICTIVE_FAILURE,
+                                   IPMI_SENSOR_TYPE_DRIVE_SLOT,
+                                   ipmi_interpret_sel_drive_slot_predictive_failure_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT,
+                                   IPMI_SENSOR_TYPE_DRIVE_SLOT,
+                                   ipmi_interpret_sel_drive_slot_device_present_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_POST_MEMORY_RESIZE,
+                                   ipmi_interpret_sel_post_memory_resize_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_SYSTEM_FIRMWARE_PROGRESS,
+                                   ipmi_interpret_sel_system_firmware_progress_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_STATE,
+                                   IPMI_SENSOR_TYPE_SYSTEM_EVENT,
+                                   ipmi_interpret_sel_system_event_transition_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_SYSTEM_EVENT,
+                                   ipmi_interpret_sel_system_event_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_BUTTON_SWITCH,
+                                   ipmi_interpret_sel_button_switch_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_BUTTON_SWITCH,
+                                   ipmi_interpret_sel_button_switch_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_MODULE_BOARD,
+                                   ipmi_interpret_sel_module_board_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT,
+                                   IPMI_SENSOR_TYPE_MODULE_BOARD,
+                                   ipmi_interpret_sel_module_board_device_present_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_CHASSIS,
+                                   ipmi_interpret_sel_chassis_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_CHIP_SET,
+                                   ipmi_interpret_sel_chip_set_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_CABLE_INTERCONNECT,
+                                   ipmi_interpret_sel_cable_interconnect_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_BOOT_ERROR,
+                                   ipmi_interpret_sel_boot_error_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_BOOT_ERROR,
+                                   ipmi_interpret_sel_boot_error_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_OS_CRITICAL_STOP,
+                                   ipmi_interpret_sel_os_critical_stop_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY,
+                                   IPMI_SENSOR_TYPE_SLOT_CONNECTOR,
+                                   ipmi_interpret_sel_slot_connector_transition_severity_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_STATE,
+                                   IPMI_SENSOR_TYPE_PLATFORM_ALERT,
+                                   ipmi_interpret_sel_platform_alert_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT,
+                                   IPMI_SENSOR_TYPE_ENTITY_PRESENCE,
+                                   ipmi_interpret_sel_entity_presence_device_present_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_PHYSICAL_SECURITY,
+                                   ipmi_interpret_sel_physical_security_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_PLATFORM_SECURITY_VIOLATION_ATTEMPT,
+                                   ipmi_interpret_sel_platform_security_violation_attempt_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_PROCESSOR,
+                                   ipmi_interpret_sel_processor_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_POWER_SUPPLY,
+                                   ipmi_interpret_sel_power_supply_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_POWER_UNIT,
+                                   ipmi_interpret_sel_power_unit_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_MEMORY,
+                                   ipmi_interpret_sel_memory_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_DRIVE_SLOT,
+                                   ipmi_interpret_sel_drive_slot_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SYSTEM_FIRMWARE_PROGRESS,
+                                   ipmi_interpret_sel_system_firmware_progress_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_EVENT_LOGGING_DISABLED,
+                                   ipmi_interpret_sel_event_logging_disabled_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SYSTEM_EVENT,
+                                   ipmi_interpret_sel_system_event_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_CRITICAL_INTERRUPT,
+                                   ipmi_interpret_sel_critical_interrupt_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_BUTTON_SWITCH,
+                                   ipmi_interpret_sel_button_switch_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_CHIP_SET,
+                                   ipmi_interpret_sel_chip_set_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_CABLE_INTERCONNECT,
+                                   ipmi_interpret_sel_cable_interconnect_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SYSTEM_BOOT_INITIATED,
+                                   ipmi_interpret_sel_system_boot_initiated_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_BOOT_ERROR,
+                                   ipmi_interpret_sel_boot_error_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_OS_BOOT,
+                                   ipmi_interpret_sel_os_boot_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_OS_CRITICAL_STOP,
+                                   ipmi_interpret_sel_os_critical_stop_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SLOT_CONNECTOR,
+                                   ipmi_interpret_sel_slot_connector_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SYSTEM_ACPI_POWER_STATE,
+                                   ipmi_interpret_sel_system_acpi_power_state_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_WATCHDOG2,
+                                   ipmi_interpret_sel_watchdog2_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_PLATFORM_ALERT,
+                                   ipmi_interpret_sel_platform_alert_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_ENTITY_PRESENCE,
+                                   ipmi_interpret_sel_entity_presence_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_LAN,
+                                   ipmi_interpret_sel_lan_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_MANAGEMENT_SUBSYSTEM_HEALTH,
+                                   ipmi_interpret_sel_management_subsystem_health_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_BATTERY,
+                                   ipmi_interpret_sel_battery_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_SESSION_AUDIT,
+                                   ipmi_interpret_sel_session_audit_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_VERSION_CHANGE,
+                                   ipmi_interpret_sel_version_change_config),
+    IPMI_INTERPRET_SEL_CONFIG_MAP (IPMI_EVENT_READING_TYPE_CODE_SENSOR_SPECIFIC,
+                                   IPMI_SENSOR_TYPE_FRU_STATE,
+                                   ipmi_interpret_sel_fru_state_config),
+  };
+
+static unsigned int ipmi_interpret_sel_config_maps_len = sizeof (ipmi_interpret_sel_config_maps) / sizeof (struct ipmi_interpret_sel_config_map);
+
+/* returns -1 if event reading type code is not interpreted through
+ * the sel config
+ */
+static int
+_get_sel_class (uint8_t event_reading_type_code)
+{
+  if (IPMI_EVENT_READING_TYPE_CODE_IS_THRESHOLD (event_reading_type_code))
+    return (IPMI_INTERPRET_SEL_CLASS_THRESHOLD);
+  if (IPMI_EVENT_READING_TYPE_CODE_IS_GENERIC (event_reading_type_code))
+    return (event_reading_type_code - IPMI_EVENT_READING_TYPE_CODE_TRANSITION_STATE + 1);
+  if (IPMI_EVENT_READING_TYPE_CODE_IS_SENSOR_SPECIFIC (event_reading_type_code))
+    return (IPMI_INTERPRET_SEL_CLASS_SENSOR_SPECIFIC);
+  return (-1);
+}
+
+static void
+_sel_state_table_load (struct ipmi_interpret_sel_state_table *table,
+                       struct ipmi_interpret_sel_config **sel_config)
+{
+  unsigned int offset;
+
+  assert (table);
+  assert (sel_config);
+
+  memset (table, '\0', sizeof (struct ipmi_interpret_sel_state_table));
+
+  /* walk the config as it always has been, stopping early at a
+   * short config
+   */
+  for (offset = 0; offset < IPMI_INTERPRET_SEL_OFFSETS; offset++)
+    {
+      unsigned int i = 0;
+
+      while (i < offset
+             && i < IPMI_INTERPRET_MAX_SENSOR_AND_EVENT_OFFSET
+             && sel_config[i])
+        i++;
+
+      if (sel_config[i])
+        {
+          table->offsets_valid |= (0x1 << offset);
+          table->assertion_state[offset] = sel_config[i]->assertion_state;
+          table->deassertion_state[offset] = sel_config[i]->deassertion_state;
+        }
+    }
+}
+
+static int
+_sel_oem_sensor_config_count (void *data, const void *key, void *arg)
+{
+  struct ipmi_interpret_sel_oem_sensor_config *oem_conf;
+  struct ipmi_interpret_sel_tables *tables;
+
+  assert (data);
+  assert (arg);
+
+  oem_conf = (struct ipmi_interpret_sel_oem_sensor_config *)data;
+  tables = (struct ipmi_interpret_sel_tables *)arg;
+
+  if (oem_conf->manufacturer_id == tables->manufacturer_id
+      && oem_conf->product_id == tables->product_id)
+    return (1);
+  return (0);
+}
+
+static int
+_sel_oem_sensor_config_add (void *data, const void *key, void *arg)
+{
+  struct ipmi_interpret_sel_oem_sensor_config *oem_conf;
+  struct ipmi_interpret_sel_tables *tables;
+
+  assert (data);
+  assert (arg);
+
+  oem_conf = (struct ipmi_interpret_sel_oem_sensor_config *)data;
+  tables = (struct ipmi_interpret_sel_tables *)arg;
+
+  if (oem_conf->manufacturer_id == tables->manufacturer_id
+      && oem_conf->product_id == tables->product_id)
+    tables->oem_sensor_configs[tables->oem_sensor_configs_count++] = oem_conf;
+  return (0);
+}
+
+static int
+_sel_oem_record_config_add (void *data, const void *key, void *arg)
+{
+  struct ipmi_interpret_sel_oem_record_config *oem_conf;
+  struct ipmi_interpret_sel_tables *tables;
+
+  assert (data);
+  assert (arg);
+
+  oem_conf = (struct ipmi_interpret_sel_oem_record_config *)data;
+  tables = (struct ipmi_interpret_sel_tables *)arg;
+
+  if (oem_conf->manufacturer_id == tables->manufacturer_id
+      && oem_conf->product_id == tables->product_id)
+    tables->oem_record_configs[oem_conf->record_type] = oem_conf;
+  return (0);
+}
+
+static int
+_sel_oem_sensor_config_cmp (const void *a, const void *b)
+{
+  const struct ipmi_interpret_sel_oem_sensor_config *oem_conf_a;
+  const struct ipmi_interpret_sel_oem_sensor_config *oem_conf_b;
+  unsigned int key_a, key_b;
+
+  oem_conf_a = *((const struct ipmi_interpret_sel_oem_sensor_config **)a);
+  oem_conf_b = *((const struct ipmi_interpret_sel_oem_sensor_config **)b);
+
+  key_a = (oem_conf_a->event_reading_type_code << 8) | oem_conf_a->sensor_type;
+  key_b = (oem_conf_b->event_reading_type_code << 8) | oem_conf_b->sensor_type;
+
+  if (key_a < key_b)
+    return (-1);
+  if (key_a > key_b)
+    return (1);
+  return (0);
+}
+
+/* Compile the sel config into lookup tables, so that interpreting a
+ * record is a few table lookups instead of walking the config and
+ * hashing a key.
+ */
+static int
+_interpret_sel_tables_load (ipmi_interpret_ctx_t ctx)
+{
+  struct ipmi_interpret_sel_tables *tables;
+  int count;
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+
+  tables = &ctx->interpret_sel_tables;
+
+  if (tables->loaded
+      && tables->manufacturer_id == ctx->manufacturer_id
+      && tables->product_id == ctx->product_id)
+    return (0);
+
+  tables->loaded = 0;
+  tables->manufacturer_id = ctx->manufacturer_id;
+  tables->product_id = ctx->product_id;
+
+  memset (tables->state_table_index, '\0', sizeof (tables->state_table_index));
+  tables->state_tables_count = 0;
+
+  _sel_state_table_load (&tables->state_tables[tables->state_tables_count],
+                         ctx->interpret_sel.ipmi_interpret_sel_threshold_config);
+  tables->state_tables_count++;
+  memset (tables->state_table_index[IPMI_INTERPRET_SEL_CLASS_THRESHOLD],
+          tables->state_tables_count,
+          IPMI_INTERPRET_SEL_SENSOR_TYPES);
+
+  assert (ipmi_interpret_sel_config_maps_len < IPMI_INTERPRET_SEL_STATE_TABLES_MAX);
+
+  for (i = 0; i < ipmi_interpret_sel_config_maps_len; i++)
+    {
+      struct ipmi_interpret_sel_config **sel_config;
+      int sel_class;
+
+      sel_class = _get_sel_class (ipmi_interpret_sel_config_maps[i].event_reading_type_code);
+      assert (sel_class >= 0);
+
+      sel_config = *((struct ipmi_interpret_sel_config ***)((uint8_t *)&ctx->interpret_sel
+                                                             + ipmi_interpret_sel_config_maps[i].config_offset));
+
+      _sel_state_table_load (&tables->state_tables[tables->state_tables_count],
+                             sel_config);
+      tables->state_tables_count++;
+      tables->state_table_index[sel_class][ipmi_interpret_sel_config_maps[i].sensor_type] = tables->state_tables_count;
+    }
+
+  free (tables->oem_sensor_configs);
+  tables->oem_sensor_configs = NULL;
+  tables->oem_sensor_configs_count = 0;
+
+  if ((count = hash_for_each (ctx->interpret_sel.sel_oem_sensor_config,
+                              _sel_oem_sensor_config_count,
+                              tables)) < 0)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (count)
+    {
+      if (!(tables->oem_sensor_configs = (struct ipmi_interpret_sel_oem_sensor_config **)malloc (count * sizeof (struct ipmi_interpret_sel_oem_sensor_config *))))
+        {
+          INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+
+      if (hash_for_each (ctx->interpret_sel.sel_oem_sensor_config,
+                         _sel_oem_sensor_config_add,
+                         tables) < 0)
+        {
+          INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_INTERNAL_ERROR);
+          return (-1);
+        }
+
+      qsort (tables->oem_sensor_configs,
+             tables->oem_sensor_configs_count,
+             sizeof (struct ipmi_interpret_sel_oem_sensor_config *),
+             _sel_oem_sensor_config_cmp);
+    }
+
+  memset (tables->oem_record_configs, '\0', sizeof (tables->oem_record_configs));
+
+  if (hash_for_each (ctx->interpret_sel.sel_oem_record_config,
+                     _sel_oem_record_config_add,
+                     tables) < 0)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  tables->loaded = 1;
+  return (0);
+}
+
+static struct ipmi_interpret_sel_oem_sensor_config *
+_find_sel_oem_sensor_config (ipmi_interpret_ctx_t ctx,
+                             uint8_t event_reading_type_code,
+                             uint8_t sensor_type)
+{
+  struct ipmi_interpret_sel_oem_sensor_config key;
+  struct ipmi_interpret_sel_oem_sensor_config *keyp = &key;
+  struct ipmi_interpret_sel_oem_sensor_config **oem_conf;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (ctx->interpret_sel_tables.loaded);
+
+  if (!ctx->interpret_sel_tables.oem_sensor_configs_count)
+    return (NULL);
+
+  key.event_reading_type_code = event_reading_type_code;
+  key.sensor_type = sensor_type;
+
+  if (!(oem_conf = bsearch (&keyp,
+                            ctx->interpret_sel_tables.oem_sensor_configs,
+                            ctx->interpret_sel_tables.oem_sensor_configs_count,
+                            sizeof (struct ipmi_interpret_sel_oem_sensor_config *),
+                            _sel_oem_sensor_config_cmp)))
+    return (NULL);
+
+  return (*oem_conf);
+}
+
 static int
 _get_sel_oem_sensor_state (ipmi_interpret_ctx_t ctx,
                            const void *sel_record,
@@ -384,27 +999,17 @@ _get_sel_oem_sensor_state (ipmi_interpret_ctx_t ctx,
                            uint8_t sensor_type,
                            unsigned int *sel_state)
 {
-  char keybuf[IPMI_OEM_HASH_KEY_BUFLEN + 1];
   struct ipmi_interpret_sel_oem_sensor_config *oem_conf;
 
   assert (ctx);
   assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
   assert (sel_record);
-  assert (sel_record_len);
+  assert (sel_record_len >= IPMI_SEL_RECORD_MAX_RECORD_LENGTH);
   assert (sel_state);
 
-  memset (keybuf, '\0', IPMI_OEM_HASH_KEY_BUFLEN + 1);
-
-  snprintf (keybuf,
-            IPMI_OEM_HASH_KEY_BUFLEN,
-            "%u:%u:%u:%u",
-            ctx->manufacturer_id,
-            ctx->product_id,
-            event_reading_type_code,
-            sensor_type);
-  
-  if ((oem_conf = hash_find (ctx->interpret_sel.sel_oem_sensor_config,
-			     keybuf)))
+  if ((oem_conf = _find_sel_oem_sensor_config (ctx,
+                                               event_reading_type_code,
+                                               sensor_type)))
     {
       unsigned int i;
       uint8_t event_direction;
@@ -414,51 +1019,11 @@ _get_sel_oem_sensor_state (ipmi_interpret_ctx_t ctx,
       int found = 0;
       
       (*sel_state) = IPMI_INTERPRET_STATE_NOMINAL;
-      
-      if (ipmi_sel_parse_read_sensor_type (ctx->sel_ctx,
-					   sel_record,
-					   sel_record_len,
-					   &sensor_type) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          return (-1);
-        }
-
-      if (ipmi_sel_parse_read_event_direction (ctx->sel_ctx,
-					       sel_record,
-					       sel_record_len,
-					       &event_direction) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          return (-1);
-        }
-
-      if (ipmi_sel_parse_read_event_data1 (ctx->sel_ctx,
-					   sel_record,
-					   sel_record_len,
-					   &event_data1) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          return (-1);
-        }
 
-      if (ipmi_sel_parse_read_event_data2 (ctx->sel_ctx,
-					   sel_record,
-					   sel_record_len,
-					   &event_data2) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          return (-1);
-        }
-      
-      if (ipmi_sel_parse_read_event_data3 (ctx->sel_ctx,
-					   sel_record,
-					   sel_record_len,
-					   &event_data3) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          return (-1);
-        }
+      event_direction = ((const uint8_t *)sel_record)[IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_INDEX] >> IPMI_INTERPRET_SEL_EVENT_DIR_SHIFT;
+      event_data1 = ((const uint8_t *)sel_record)[IPMI_INTERPRET_SEL_EVENT_DATA1_INDEX];
+      event_data2 = ((const uint8_t *)sel_record)[IPMI_INTERPRET_SEL_EVENT_DATA2_INDEX];
+      event_data3 = ((const uint8_t *)sel_record)[IPMI_INTERPRET_SEL_EVENT_DATA3_INDEX];
 
       for (i = 0; i < oem_conf->oem_sensor_data_count; i++)
 	{
@@ -490,36 +1055,48 @@ static int
 _get_sel_state (ipmi_interpret_ctx_t ctx,
                 const void *sel_record,
                 unsigned int sel_record_len,
+                int sel_class,
                 uint8_t event_reading_type_code,
                 uint8_t sensor_type,
                 uint8_t event_direction,
                 uint8_t offset_from_event_reading_type_code,
-                unsigned int *sel_state,
-                struct ipmi_interpret_sel_config **sel_config)
+                unsigned int *sel_state)
 {
-  int i = 0;
+  struct ipmi_interpret_sel_state_table *table;
+  uint8_t index;
 
   assert (ctx);
   assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (ctx->interpret_sel_tables.loaded);
   assert (sel_record);
   assert (sel_record_len);
+  assert (sel_class >= 0 && sel_class < IPMI_INTERPRET_SEL_CLASSES);
   assert (sel_state);
-  assert (sel_config);
 
   (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
 
-  i = 0;
-  while (i < offset_from_event_reading_type_code
-         && i < IPMI_INTERPRET_MAX_SENSOR_AND_EVENT_OFFSET
-	 && sel_config[i])
-    i++;
+  if (!(index = ctx->interpret_sel_tables.state_table_index[sel_class][sensor_type]))
+    {
+      if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA
+          && IPMI_SENSOR_TYPE_IS_OEM (sensor_type))
+        return (_get_sel_oem_sensor_state (ctx,
+                                           sel_record,
+                                           sel_record_len,
+                                           event_reading_type_code,
+                                           sensor_type,
+                                           sel_state));
+      return (0);
+    }
+
+  table = &ctx->interpret_sel_tables.state_tables[index - 1];
 
-  if (sel_config[i])
+  if (offset_from_event_reading_type_code < IPMI_INTERPRET_SEL_OFFSETS
+      && (table->offsets_valid & (0x1 << offset_from_event_reading_type_code)))
     {
       if (event_direction == IPMI_SEL_RECORD_ASSERTION_EVENT)
-        (*sel_state) = sel_config[i]->assertion_state;
+        (*sel_state) = table->assertion_state[offset_from_event_reading_type_code];
       else
-        (*sel_state) = sel_config[i]->deassertion_state;
+        (*sel_state) = table->deassertion_state[offset_from_event_reading_type_code];
     }
   else if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA)
     return (_get_sel_oem_sensor_state (ctx,
@@ -539,26 +1116,16 @@ _get_sel_oem_record_state (ipmi_interpret_ctx_t ctx,
                            uint8_t record_type,
                            unsigned int *sel_state)
 {
-  char keybuf[IPMI_OEM_HASH_KEY_BUFLEN + 1];
   struct ipmi_interpret_sel_oem_record_config *oem_conf;
 
   assert (ctx);
   assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (ctx->interpret_sel_tables.loaded);
   assert (sel_record);
   assert (sel_record_len);
   assert (sel_state);
 
-  memset (keybuf, '\0', IPMI_OEM_HASH_KEY_BUFLEN + 1);
-
-  snprintf (keybuf,
-            IPMI_OEM_HASH_KEY_BUFLEN,
-            "%u:%u:%u",
-            ctx->manufacturer_id,
-            ctx->product_id,
-            record_type);
-  
-  if ((oem_conf = hash_find (ctx->interpret_sel.sel_oem_record_config,
-			     keybuf)))
+  if ((oem_conf = ctx->interpret_sel_tables.oem_record_configs[record_type]))
     {
       unsigned int i, j;
       uint8_t oem_data[IPMI_SEL_OEM_DATA_MAX];
@@ -611,37 +1178,38 @@ _get_sel_oem_record_state (ipmi_interpret_ctx_t ctx,
   return (0);
 }
 
-int
-ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
-                    const void *sel_record,
-                    unsigned int sel_record_len,
-                    unsigned int *sel_state)
+static int
+_interpret_sel (ipmi_interpret_ctx_t ctx,
+                const void *sel_record,
+                unsigned int sel_record_len,
+                unsigned int *sel_state)
 {
-  struct ipmi_interpret_sel_config **sel_config = NULL;
+  const uint8_t *record;
   uint8_t record_type;
-  int rv = -1;
 
-  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
-    {
-      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
-      return (-1);
-    }
+  assert (ctx);
+  assert (ctx->magic == IPMI_INTERPRET_CTX_MAGIC);
+  assert (ctx->interpret_sel_tables.loaded);
+  assert (sel_state);
 
-  if (!sel_state)
+  /* fields are read from the record directly, decoding every record
+   * through the sel library costs more than interpreting it
+   */
+  if (!sel_record || !sel_record_len)
     {
       INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_PARAMETERS);
       return (-1);
     }
 
-  if (ipmi_sel_parse_read_record_type (ctx->sel_ctx,
-				       sel_record,
-				       sel_record_len,
-				       &record_type) < 0)
+  if (sel_record_len < IPMI_SEL_RECORD_MAX_RECORD_LENGTH)
     {
-      INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_INVALID_SEL_RECORD);
       return (-1);
     }
 
+  record = (const uint8_t *)sel_record;
+  record_type = record[IPMI_INTERPRET_SEL_RECORD_TYPE_INDEX];
+
   /* IPMI Workaround
    *
    * HP DL 380 G5
@@ -659,310 +1227,25 @@ ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
       uint8_t event_reading_type_code;
       uint8_t sensor_type;
       uint8_t offset_from_event_reading_type_code;
+      int sel_class;
 
-      if (ipmi_sel_parse_read_sensor_type (ctx->sel_ctx,
-					   sel_record,
-					   sel_record_len,
-					   &sensor_type) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          goto cleanup;
-        }
-
-      if (ipmi_sel_parse_read_event_direction (ctx->sel_ctx,
-					       sel_record,
-					       sel_record_len,
-					       &event_direction) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          goto cleanup;
-        }
-
-      if (ipmi_sel_parse_read_event_type_code (ctx->sel_ctx,
-					       sel_record,
-					       sel_record_len,
-					       &event_reading_type_code) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          goto cleanup;
-        }
-
-      if (ipmi_sel_parse_read_event_data1_offset_from_event_reading_type_code (ctx->sel_ctx,
-									       sel_record,
-									       sel_record_len,
-									       &offset_from_event_reading_type_code) < 0)
-        {
-          INTERPRET_SEL_CTX_ERROR_TO_INTERPRET_ERRNUM (ctx, ctx->sel_ctx);
-          goto cleanup;
-        }
-
-      if (IPMI_EVENT_READING_TYPE_CODE_IS_THRESHOLD (event_reading_type_code))
-        {
-          if (_get_sel_state (ctx,
-                              sel_record,
-                              sel_record_len,
-                              event_reading_type_code,
-                              sensor_type,
-                              event_direction,
-                              offset_from_event_reading_type_code,
-                              sel_state,
-                              ctx->interpret_sel.ipmi_interpret_sel_threshold_config) < 0)
-            goto cleanup;
-        }
-      else if (IPMI_EVENT_READING_TYPE_CODE_IS_GENERIC (event_reading_type_code))
-        {
-
-          if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-              && sensor_type == IPMI_SENSOR_TYPE_TEMPERATURE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_temperature_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_LIMIT
-		   && sensor_type == IPMI_SENSOR_TYPE_TEMPERATURE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_temperature_limit_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_TEMPERATURE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_temperature_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_VOLTAGE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_voltage_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_LIMIT
-                   && sensor_type == IPMI_SENSOR_TYPE_VOLTAGE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_voltage_limit_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_PERFORMANCE
-                   && sensor_type == IPMI_SENSOR_TYPE_VOLTAGE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_voltage_performance_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-                   && sensor_type == IPMI_SENSOR_TYPE_VOLTAGE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_voltage_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-                   && sensor_type == IPMI_SENSOR_TYPE_CURRENT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_current_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_FAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fan_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-                   && sensor_type == IPMI_SENSOR_TYPE_FAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fan_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT
-                   && sensor_type == IPMI_SENSOR_TYPE_FAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fan_device_present_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_AVAILABILITY
-                   && sensor_type == IPMI_SENSOR_TYPE_FAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fan_transition_availability_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY
-                   && sensor_type == IPMI_SENSOR_TYPE_FAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fan_redundancy_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_PROCESSOR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_processor_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_POWER_SUPPLY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_supply_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-                   && sensor_type == IPMI_SENSOR_TYPE_POWER_SUPPLY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_supply_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY
-                   && sensor_type == IPMI_SENSOR_TYPE_POWER_SUPPLY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_supply_redundancy_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT
-                   && sensor_type == IPMI_SENSOR_TYPE_POWER_UNIT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_unit_device_present_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY
-                   && sensor_type == IPMI_SENSOR_TYPE_POWER_UNIT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_unit_redundancy_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY
-                   && sensor_type == IPMI_SENSOR_TYPE_COOLING_DEVICE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_cooling_device_redundancy_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_MEMORY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_memory_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-                   && sensor_type == IPMI_SENSOR_TYPE_MEMORY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_memory_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_REDUNDANCY
-                   && sensor_type == IPMI_SENSOR_TYPE_MEMORY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_memory_redundancy_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_DRIVE_SLOT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_drive_slot_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_PREDICTIVE_FAILURE
-                   && sensor_type == IPMI_SENSOR_TYPE_DRIVE_SLOT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_drive_slot_predictive_failure_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT
-                   && sensor_type == IPMI_SENSOR_TYPE_DRIVE_SLOT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_drive_slot_device_present_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_POST_MEMORY_RESIZE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_post_memory_resize_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_SYSTEM_FIRMWARE_PROGRESS)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_firmware_progress_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_SYSTEM_EVENT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_event_transition_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_SYSTEM_EVENT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_event_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_BUTTON_SWITCH)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_button_switch_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_BUTTON_SWITCH)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_button_switch_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_MODULE_BOARD)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_module_board_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT
-                   && sensor_type == IPMI_SENSOR_TYPE_MODULE_BOARD)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_module_board_device_present_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_CHASSIS)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_chassis_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_CHIP_SET)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_chip_set_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_CABLE_INTERCONNECT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_cable_interconnect_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_BOOT_ERROR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_boot_error_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_BOOT_ERROR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_boot_error_transition_severity_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-		   && sensor_type == IPMI_SENSOR_TYPE_OS_CRITICAL_STOP)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_os_critical_stop_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_TRANSITION_SEVERITY
-		   && sensor_type == IPMI_SENSOR_TYPE_SLOT_CONNECTOR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_slot_connector_transition_severity_config;
-	  else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_STATE
-                   && sensor_type == IPMI_SENSOR_TYPE_PLATFORM_ALERT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_platform_alert_state_config;
-          else if (event_reading_type_code == IPMI_EVENT_READING_TYPE_CODE_DEVICE_PRESENT
-                   && sensor_type == IPMI_SENSOR_TYPE_ENTITY_PRESENCE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_entity_presence_device_present_config;
-          else if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA
-                   && IPMI_SENSOR_TYPE_IS_OEM (sensor_type))
-            {
-              if (_get_sel_oem_sensor_state (ctx,
-                                             sel_record,
-                                             sel_record_len,
-                                             event_reading_type_code,
-                                             sensor_type,
-                                             sel_state) < 0)
-                goto cleanup;
-              rv = 0;
-              goto cleanup;
-            }
-          else
-            {
-              (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
-              rv = 0;
-              goto cleanup;
-            }
-
-          if (_get_sel_state (ctx,
-                              sel_record,
-                              sel_record_len,
-                              event_reading_type_code,
-                              sensor_type,
-                              event_direction,
-                              offset_from_event_reading_type_code,
-                              sel_state,
-                              sel_config) < 0)
-            goto cleanup;
+      sensor_type = record[IPMI_INTERPRET_SEL_SENSOR_TYPE_INDEX];
+      event_reading_type_code = record[IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_INDEX] & IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_MASK;
+      event_direction = record[IPMI_INTERPRET_SEL_EVENT_TYPE_CODE_INDEX] >> IPMI_INTERPRET_SEL_EVENT_DIR_SHIFT;
+      offset_from_event_reading_type_code = record[IPMI_INTERPRET_SEL_EVENT_DATA1_INDEX] & IPMI_INTERPRET_SEL_EVENT_DATA1_OFFSET_MASK;
 
-        }
-      else if (IPMI_EVENT_READING_TYPE_CODE_IS_SENSOR_SPECIFIC (event_reading_type_code))
+      if ((sel_class = _get_sel_class (event_reading_type_code)) >= 0)
         {
-          if (sensor_type == IPMI_SENSOR_TYPE_PHYSICAL_SECURITY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_physical_security_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_PLATFORM_SECURITY_VIOLATION_ATTEMPT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_platform_security_violation_attempt_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_PROCESSOR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_processor_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_POWER_SUPPLY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_supply_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_POWER_UNIT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_power_unit_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_MEMORY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_memory_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_DRIVE_SLOT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_drive_slot_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SYSTEM_FIRMWARE_PROGRESS)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_firmware_progress_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_EVENT_LOGGING_DISABLED)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_event_logging_disabled_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SYSTEM_EVENT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_event_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_CRITICAL_INTERRUPT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_critical_interrupt_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_BUTTON_SWITCH)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_button_switch_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_CHIP_SET)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_chip_set_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_CABLE_INTERCONNECT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_cable_interconnect_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SYSTEM_BOOT_INITIATED)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_boot_initiated_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_BOOT_ERROR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_boot_error_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_OS_BOOT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_os_boot_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_OS_CRITICAL_STOP)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_os_critical_stop_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SLOT_CONNECTOR)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_slot_connector_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SYSTEM_ACPI_POWER_STATE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_system_acpi_power_state_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_WATCHDOG2)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_watchdog2_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_PLATFORM_ALERT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_platform_alert_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_ENTITY_PRESENCE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_entity_presence_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_LAN)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_lan_config;       
-          else if (sensor_type == IPMI_SENSOR_TYPE_MANAGEMENT_SUBSYSTEM_HEALTH)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_management_subsystem_health_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_BATTERY)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_battery_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_SESSION_AUDIT)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_session_audit_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_VERSION_CHANGE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_version_change_config;
-          else if (sensor_type == IPMI_SENSOR_TYPE_FRU_STATE)
-            sel_config = ctx->interpret_sel.ipmi_interpret_sel_fru_state_config;
-          else if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA
-                   && IPMI_SENSOR_TYPE_IS_OEM (sensor_type))
-            {
-              if (_get_sel_oem_sensor_state (ctx,
-                                             sel_record,
-                                             sel_record_len,
-                                             event_reading_type_code,
-                                             sensor_type,
-                                             sel_state) < 0)
-                goto cleanup;
-              rv = 0;
-              goto cleanup;
-            }
-          else
-            {
-              (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
-              rv = 0;
-              goto cleanup;
-            }
-
           if (_get_sel_state (ctx,
                               sel_record,
                               sel_record_len,
+                              sel_class,
                               event_reading_type_code,
                               sensor_type,
                               event_direction,
                               offset_from_event_reading_type_code,
-                              sel_state,
-                              sel_config) < 0)
-            goto cleanup;
+                              sel_state) < 0)
+            return (-1);
         }
       else if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA
                && IPMI_EVENT_READING_TYPE_CODE_IS_OEM (event_reading_type_code))
@@ -973,14 +1256,10 @@ ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
                                          event_reading_type_code,
                                          sensor_type,
                                          sel_state) < 0)
-            goto cleanup;
+            return (-1);
         }
       else
-        {
-          (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
-          rv = 0;
-          goto cleanup;
-        }
+        (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
     }
   else if (ctx->flags & IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA)
     {
@@ -989,18 +1268,76 @@ ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
                                      sel_record_len,
                                      record_type,
                                      sel_state) < 0)
-        goto cleanup;
+        return (-1);
     }
   else
+    (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
+
+  return (0);
+}
+
+int
+ipmi_interpret_sel (ipmi_interpret_ctx_t ctx,
+                    const void *sel_record,
+                    unsigned int sel_record_len,
+                    unsigned int *sel_state)
+{
+  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
     {
-      (*sel_state) = IPMI_INTERPRET_STATE_UNKNOWN;
-      rv = 0;
-      goto cleanup;
+      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
+      return (-1);
     }
 
-  rv = 0;
- cleanup:
-  return (rv);
+  if (!sel_state)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (_interpret_sel_tables_load (ctx) < 0)
+    return (-1);
+
+  if (_interpret_sel (ctx, sel_record, sel_record_len, sel_state) < 0)
+    return (-1);
+
+  ctx->errnum = IPMI_INTERPRET_ERR_SUCCESS;
+  return (0);
+}
+
+int
+ipmi_interpret_sel_records (ipmi_interpret_ctx_t ctx,
+                            const void *sel_records,
+                            unsigned int sel_records_count,
+                            unsigned int *sel_states)
+{
+  unsigned int i;
+
+  if (!ctx || ctx->magic != IPMI_INTERPRET_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_interpret_ctx_errormsg (ctx), ipmi_interpret_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if ((!sel_records || !sel_states) && sel_records_count)
+    {
+      INTERPRET_SET_ERRNUM (ctx, IPMI_INTERPRET_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (_interpret_sel_tables_load (ctx) < 0)
+    return (-1);
+
+  for (i = 0; i < sel_records_count; i++)
+    {
+      if (_interpret_sel (ctx,
+                          (const uint8_t *)sel_records + i * IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                          IPMI_SEL_RECORD_MAX_RECORD_LENGTH,
+                          &sel_states[i]) < 0)
+        return (-1);
+    }
+
+  ctx->errnum = IPMI_INTERPRET_ERR_SUCCESS;
+  return (0);
 }
 
 static int
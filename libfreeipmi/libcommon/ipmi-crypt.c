@@ -26,6 +26,7 @@
 #include <string.h>
 #endif /* STDC_HEADERS */
 #include <errno.h>
+#include <assert.h>
 #if HAVE_PTHREAD_H
 #include <pthread.h>
 #endif /* HAVE_PTHREAD_H */
@@ -39,6 +40,7 @@ GCRY_THREAD_OPTION_PTHREAD_IMPL;
 #include "ipmi-trace.h"
 
 #include "freeipmi-portability.h"
+#include "secure.h"
 
 static int crypt_initialized = 0;
 
@@ -59,6 +61,288 @@ _gpg_error_to_errno (gcry_error_t e)
 }
 #endif /* !WITH_ENCRYPTION */
 
+#ifdef WITH_ENCRYPTION
+/* Within a session, every packet is hashed and encrypted with the
+ * same keys (K1 and K2).  Opening a gcrypt handle and setting its key
+ * costs more than hashing or encrypting a packet, so a few open
+ * handles are kept per thread, matched on algorithm and key, and
+ * only reset between packets.  Per thread, so no locking is needed.
+ *
+ * Handles are only cached while a session opened with
+ * crypt_cache_session_start() is open in the thread.  When the last
+ * one ends, the handles are closed and their keys wiped.
+ */
+#define CRYPT_CACHE_ENTRIES      4
+#define CRYPT_CACHE_KEY_LEN_MAX  64
+
+struct crypt_hash_cache_entry
+{
+  gcry_md_hd_t h;
+  int gcry_md_algorithm;
+  int gcry_md_flags;
+  unsigned int key_len;
+  uint8_t key[CRYPT_CACHE_KEY_LEN_MAX];
+};
+
+struct crypt_cipher_cache_entry
+{
+  gcry_cipher_hd_t h;
+  int gcry_cipher_algorithm;
+  int gcry_cipher_mode;
+  unsigned int key_len;
+  uint8_t key[CRYPT_CACHE_KEY_LEN_MAX];
+};
+
+struct crypt_cache
+{
+  unsigned int sessions;
+  struct crypt_hash_cache_entry hash[CRYPT_CACHE_ENTRIES];
+  unsigned int hash_next;
+  struct crypt_cipher_cache_entry cipher[CRYPT_CACHE_ENTRIES];
+  unsigned int cipher_next;
+};
+
+static pthread_once_t crypt_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t crypt_cache_key;
+static int crypt_cache_key_initialized = 0;
+
+static void
+_crypt_cache_flush (struct crypt_cache *cache)
+{
+  unsigned int i;
+
+  assert (cache);
+
+  for (i = 0; i < CRYPT_CACHE_ENTRIES; i++)
+    {
+      if (cache->hash[i].h)
+        gcry_md_close (cache->hash[i].h);
+      if (cache->cipher[i].h)
+        gcry_cipher_close (cache->cipher[i].h);
+    }
+
+  secure_memset (cache->hash, '\0', sizeof (cache->hash));
+  secure_memset (cache->cipher, '\0', sizeof (cache->cipher));
+  cache->hash_next = 0;
+  cache->cipher_next = 0;
+}
+
+static void
+_crypt_cache_destroy (void *arg)
+{
+  struct crypt_cache *cache = arg;
+
+  if (!cache)
+    return;
+
+  _crypt_cache_flush (cache);
+  secure_memset (cache, '\0', sizeof (struct crypt_cache));
+  free (cache);
+}
+
+static void
+_crypt_cache_key_create (void)
+{
+  if (!pthread_key_create (&crypt_cache_key, _crypt_cache_destroy))
+    crypt_cache_key_initialized++;
+}
+
+/* returns NULL if no cache is available, handles are then not cached */
+static struct crypt_cache *
+_crypt_cache_get (int create)
+{
+  struct crypt_cache *cache;
+
+  if (pthread_once (&crypt_cache_once, _crypt_cache_key_create))
+    return (NULL);
+
+  if (!crypt_cache_key_initialized)
+    return (NULL);
+
+  if ((cache = pthread_getspecific (crypt_cache_key)))
+    return (cache);
+
+  if (!create)
+    return (NULL);
+
+  if (!(cache = calloc (1, sizeof (struct crypt_cache))))
+    return (NULL);
+
+  if (pthread_setspecific (crypt_cache_key, cache))
+    {
+      free (cache);
+      return (NULL);
+    }
+
+  return (cache);
+}
+
+/* returns reset handle if found, NULL if not */
+static gcry_md_hd_t
+_crypt_hash_cache_lookup (int gcry_md_algorithm,
+                          int gcry_md_flags,
+                          const void *key,
+                          unsigned int key_len)
+{
+  struct crypt_cache *cache;
+  unsigned int i;
+
+  if (!(cache = _crypt_cache_get (0))
+      || !cache->sessions)
+    return (NULL);
+
+  for (i = 0; i < CRYPT_CACHE_ENTRIES; i++)
+    {
+      struct crypt_hash_cache_entry *entry = &cache->hash[i];
+
+      if (entry->h
+          && entry->gcry_md_algorithm == gcry_md_algorithm
+          && entry->gcry_md_flags == gcry_md_flags
+          && entry->key_len == key_len
+          && (!key_len || !memcmp (entry->key, key, key_len)))
+        {
+          /* for HMAC, resetting keeps the key */
+          gcry_md_reset (entry->h);
+          return (entry->h);
+        }
+    }
+
+  return (NULL);
+}
+
+/* returns 1 if cache took ownership of handle, 0 if not */
+static int
+_crypt_hash_cache_store (gcry_md_hd_t h,
+                         int gcry_md_algorithm,
+                         int gcry_md_flags,
+                         const void *key,
+                         unsigned int key_len)
+{
+  struct crypt_cache *cache;
+  struct crypt_hash_cache_entry *entry;
+
+  if (key_len > CRYPT_CACHE_KEY_LEN_MAX)
+    return (0);
+
+  if (!(cache = _crypt_cache_get (0))
+      || !cache->sessions)
+    return (0);
+
+  entry = &cache->hash[cache->hash_next];
+  cache->hash_next = (cache->hash_next + 1) % CRYPT_CACHE_ENTRIES;
+
+  if (entry->h)
+    gcry_md_close (entry->h);
+  secure_memset (entry->key, '\0', CRYPT_CACHE_KEY_LEN_MAX);
+
+  entry->h = h;
+  entry->gcry_md_algorithm = gcry_md_algorithm;
+  entry->gcry_md_flags = gcry_md_flags;
+  entry->key_len = key_len;
+  if (key_len)
+    memcpy (entry->key, key, key_len);
+  return (1);
+}
+
+/* returns reset handle if found, NULL if not */
+static gcry_cipher_hd_t
+_crypt_cipher_cache_lookup (int gcry_cipher_algorithm,
+                            int gcry_cipher_mode,
+                            const void *key,
+                            unsigned int key_len)
+{
+  struct crypt_cache *cache;
+  unsigned int i;
+
+  if (!(cache = _crypt_cache_get (0))
+      || !cache->sessions)
+    return (NULL);
+
+  for (i = 0; i < CRYPT_CACHE_ENTRIES; i++)
+    {
+      struct crypt_cipher_cache_entry *entry = &cache->cipher[i];
+
+      if (entry->h
+          && entry->gcry_cipher_algorithm == gcry_cipher_algorithm
+          && entry->gcry_cipher_mode == gcry_cipher_mode
+          && entry->key_len == key_len
+          && (!key_len || !memcmp (entry->key, key, key_len)))
+        {
+          /* resetting keeps the key, the iv is set by the caller */
+          gcry_cipher_reset (entry->h);
+          return (entry->h);
+        }
+    }
+
+  return (NULL);
+}
+
+/* returns 1 if cache took ownership of handle, 0 if not */
+static int
+_crypt_cipher_cache_store (gcry_cipher_hd_t h,
+                           int gcry_cipher_algorithm,
+                           int gcry_cipher_mode,
+                           const void *key,
+                           unsigned int key_len)
+{
+  struct crypt_cache *cache;
+  struct crypt_cipher_cache_entry *entry;
+
+  if (key_len > CRYPT_CACHE_KEY_LEN_MAX)
+    return (0);
+
+  if (!(cache = _crypt_cache_get (0))
+      || !cache->sessions)
+    return (0);
+
+  entry = &cache->cipher[cache->cipher_next];
+  cache->cipher_next = (cache->cipher_next + 1) % CRYPT_CACHE_ENTRIES;
+
+  if (entry->h)
+    gcry_cipher_close (entry->h);
+  secure_memset (entry->key, '\0', CRYPT_CACHE_KEY_LEN_MAX);
+
+  entry->h = h;
+  entry->gcry_cipher_algorithm = gcry_cipher_algorithm;
+  entry->gcry_cipher_mode = gcry_cipher_mode;
+  entry->key_len = key_len;
+  if (key_len)
+    memcpy (entry->key, key, key_len);
+  return (1);
+}
+#endif /* !WITH_ENCRYPTION */
+
+int
+crypt_cache_session_start (void)
+{
+#ifdef WITH_ENCRYPTION
+  struct crypt_cache *cache;
+
+  if (!(cache = _crypt_cache_get (1)))
+    return (-1);
+
+  cache->sessions++;
+  return (0);
+#else /* !WITH_ENCRYPTION */
+  return (-1);
+#endif /* !WITH_ENCRYPTION */
+}
+
+void
+crypt_cache_session_end (void)
+{
+#ifdef WITH_ENCRYPTION
+  struct crypt_cache *cache;
+
+  if (!(cache = _crypt_cache_get (0))
+      || !cache->sessions)
+    return;
+
+  if (!--cache->sessions)
+    _crypt_cache_flush (cache);
+#endif /* WITH_ENCRYPTION */
+}
+
 int
 crypt_init (void)
 {
@@ -141,6 +425,7 @@ crypt_hash (unsigned int hash_algorithm,
   int gcry_md_algorithm, gcry_md_flags = 0;
   unsigned int gcry_md_digest_len;
   void *digestPtr;
+  int cached = 0;
   int rv = -1;
 
   if (!IPMI_CRYPT_HASH_ALGORITHM_VALID (hash_algorithm)
@@ -174,34 +459,51 @@ crypt_hash (unsigned int hash_algorithm,
       return (-1);
     }
 
-  if ((e = gcry_md_open (&h, gcry_md_algorithm, gcry_md_flags)) != GPG_ERR_NO_ERROR)
-    {
-      ERR_TRACE (gcry_strerror (e), e);
-      SET_ERRNO (_gpg_error_to_errno (e));
-      return (-1);
-    }
-
-  if (!h)
-    {
-      SET_ERRNO (EINVAL);
-      return (-1);
-    }
-
   /* achu: Technically any key length can be supplied.  We'll assume
    * callers have checked if the key is of a length they care about.
    */
   /* SPEC: There is no indication that if a NULL password/key is used,
    * that a zero padded password of some length should be the key.
    */
-  if ((hash_flags & IPMI_CRYPT_HASH_FLAGS_HMAC) && key && key_len)
+  if (!(hash_flags & IPMI_CRYPT_HASH_FLAGS_HMAC) || !key)
+    key_len = 0;
+
+  if (!(h = _crypt_hash_cache_lookup (gcry_md_algorithm,
+                                      gcry_md_flags,
+                                      key,
+                                      key_len)))
     {
-      if ((e = gcry_md_setkey (h, key, key_len)) != GPG_ERR_NO_ERROR)
+      if ((e = gcry_md_open (&h, gcry_md_algorithm, gcry_md_flags)) != GPG_ERR_NO_ERROR)
         {
           ERR_TRACE (gcry_strerror (e), e);
           SET_ERRNO (_gpg_error_to_errno (e));
-          goto cleanup;
+          return (-1);
+        }
+
+      if (!h)
+        {
+          SET_ERRNO (EINVAL);
+          return (-1);
         }
+
+      if (key_len)
+        {
+          if ((e = gcry_md_setkey (h, key, key_len)) != GPG_ERR_NO_ERROR)
+            {
+              ERR_TRACE (gcry_strerror (e), e);
+              SET_ERRNO (_gpg_error_to_errno (e));
+              goto cleanup;
+            }
+        }
+
+      cached = _crypt_hash_cache_store (h,
+                                        gcry_md_algorithm,
+                                        gcry_md_flags,
+                                        key,
+                                        key_len);
     }
+  else
+    cached = 1;
 
   if (hash_data && hash_data_len)
     gcry_md_write (h, (void *)hash_data, hash_data_len);
@@ -223,7 +525,7 @@ crypt_hash (unsigned int hash_algorithm,
   memcpy (digest, digestPtr, gcry_md_digest_len);
   rv = gcry_md_digest_len;
  cleanup:
-  if (h)
+  if (h && !cached)
     gcry_md_close (h);
   return (rv);
 #else /* !WITH_ENCRYPTION */
@@ -281,6 +583,7 @@ _cipher_crypt (unsigned int cipher_algorithm,
   int expected_cipher_key_len, expected_cipher_block_len;
   gcry_cipher_hd_t h = NULL;
   gcry_error_t e;
+  int cached = 0;
   int rv = -1;
 
   if (cipher_algorithm != IPMI_CRYPT_CIPHER_AES
@@ -346,27 +649,44 @@ _cipher_crypt (unsigned int cipher_algorithm,
       return (-1);
     }
 
-  if ((e = gcry_cipher_open (&h,
-                             gcry_cipher_algorithm,
-                             gcry_cipher_mode,
-                             0) != GPG_ERR_NO_ERROR))
-    {
-      ERR_TRACE (gcry_strerror (e), e);
-      SET_ERRNO (_gpg_error_to_errno (e));
-      return (-1);
-    }
+  if (!key)
+    key_len = 0;
 
-  if (key && key_len)
+  if (!(h = _crypt_cipher_cache_lookup (gcry_cipher_algorithm,
+                                        gcry_cipher_mode,
+                                        key,
+                                        key_len)))
     {
-      if ((e = gcry_cipher_setkey (h,
-                                   (void *)key,
-                                   key_len)) != GPG_ERR_NO_ERROR)
+      if ((e = gcry_cipher_open (&h,
+                                 gcry_cipher_algorithm,
+                                 gcry_cipher_mode,
+                                 0) != GPG_ERR_NO_ERROR))
         {
           ERR_TRACE (gcry_strerror (e), e);
           SET_ERRNO (_gpg_error_to_errno (e));
-          goto cleanup;
+          return (-1);
+        }
+
+      if (key_len)
+        {
+          if ((e = gcry_cipher_setkey (h,
+                                       (void *)key,
+                                       key_len)) != GPG_ERR_NO_ERROR)
+            {
+              ERR_TRACE (gcry_strerror (e), e);
+              SET_ERRNO (_gpg_error_to_errno (e));
+              goto cleanup;
+            }
         }
+
+      cached = _crypt_cipher_cache_store (h,
+                                          gcry_cipher_algorithm,
+                                          gcry_cipher_mode,
+                                          key,
+                                          key_len);
     }
+  else
+    cached = 1;
 
   if (iv && iv_len)
     {
@@ -413,7 +733,7 @@ _cipher_crypt (unsigned int cipher_algorithm,
 
   rv = data_len;
  cleanup:
-  if (h)
+  if (h && !cached)
     gcry_cipher_close (h);
   return (rv);
 }
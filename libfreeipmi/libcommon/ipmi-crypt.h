@@ -65,6 +65,22 @@
  */
 int crypt_init (void);
 
+/* crypt_cache_session_start, crypt_cache_session_end
+ *
+ * Hash and cipher handles are cached in a thread only between these
+ * calls, so keyed handles do not outlive a session.  Calls may be
+ * nested, the cached handles are closed and their keys wiped at the
+ * last crypt_cache_session_end().  Both must be called from the same
+ * thread.
+ *
+ * crypt_cache_session_start() returns 0 on success, -1 if handles
+ * cannot be cached.  crypt_cache_session_end() must only be called
+ * after a successful crypt_cache_session_start().
+ */
+int crypt_cache_session_start (void);
+
+void crypt_cache_session_end (void);
+
 /* return length of data written into buffer on success, -1 on error */
 int crypt_hash (unsigned int hash_algorithm,
                      unsigned int hash_flags,
@@ -51,6 +51,8 @@
 #include "freeipmi/debug/ipmi-debug.h"
 #include "freeipmi/record-format/ipmi-sdr-record-format.h"
 #include "freeipmi/spec/ipmi-comp-code-spec.h"
+#include "freeipmi/spec/ipmi-ipmb-lun-spec.h"
+#include "freeipmi/spec/ipmi-netfn-spec.h"
 #include "freeipmi/util/ipmi-util.h"
 
 #include "ipmi-sdr-common.h"
@@ -73,6 +75,37 @@
 #define IPMI_SDR_CACHE_BYTES_TO_READ_START      16
 #define IPMI_SDR_CACHE_BYTES_TO_READ_DECREMENT  4
 
+/* achu: After a partial read succeeds, try a slightly larger read next
+ * time, up to the largest size that has not failed.  Most records
+ * can then be read with one or two partial reads instead of several.
+ */
+#define IPMI_SDR_CACHE_BYTES_TO_READ_INCREMENT  4
+#define IPMI_SDR_CACHE_BYTES_TO_READ_MAX        (IPMI_SDR_READ_ENTIRE_RECORD_BYTES_TO_READ - 1)
+
+/* Stop trying to read entire records after this many failures in a row */
+#define IPMI_SDR_CACHE_ENTIRE_RECORD_READ_FAILURES_MAX 2
+
+/* Get SDR behavior learned while reading records, carried across all
+ * records of a cache create.
+ */
+struct ipmi_sdr_cache_read_state
+{
+  int entire_record_reads_ok;
+  unsigned int entire_record_read_failures;
+  unsigned int bytes_to_read;
+  unsigned int bytes_to_read_max;
+};
+
+/* Record from a previously created cache, used for incremental cache
+ * creation.
+ */
+struct ipmi_sdr_cache_old_record
+{
+  uint16_t record_id;
+  unsigned int record_length;
+  uint8_t record[IPMI_SDR_MAX_RECORD_LENGTH];
+};
+
 static int
 _sdr_cache_header_write (ipmi_sdr_ctx_t ctx,
                          ipmi_ctx_t ipmi_ctx,
@@ -119,10 +152,10 @@ _sdr_cache_header_write (ipmi_sdr_ctx_t ctx,
   memcpy(&header_checksum_buf[header_checksum_buf_len], sdr_cache_magic_buf, 4);
   header_checksum_buf_len += 4;
 
-  sdr_cache_version_buf[0] = IPMI_SDR_CACHE_FILE_VERSION_1_2_0;
-  sdr_cache_version_buf[1] = IPMI_SDR_CACHE_FILE_VERSION_1_2_1;
-  sdr_cache_version_buf[2] = IPMI_SDR_CACHE_FILE_VERSION_1_2_2;
-  sdr_cache_version_buf[3] = IPMI_SDR_CACHE_FILE_VERSION_1_2_3;
+  sdr_cache_version_buf[0] = IPMI_SDR_CACHE_FILE_VERSION_2_1_0;
+  sdr_cache_version_buf[1] = IPMI_SDR_CACHE_FILE_VERSION_2_1_1;
+  sdr_cache_version_buf[2] = IPMI_SDR_CACHE_FILE_VERSION_2_1_2;
+  sdr_cache_version_buf[3] = IPMI_SDR_CACHE_FILE_VERSION_2_1_3;
 
   if ((n = fd_write_n (fd, sdr_cache_version_buf, 4)) < 0)
     {
@@ -232,6 +265,210 @@ _sdr_cache_header_write (ipmi_sdr_ctx_t ctx,
   return (0);
 }
 
+static void
+_sdr_cache_set_uint16 (uint8_t *ptr, uint16_t val)
+{
+  assert (ptr);
+
+  ptr[0] = (val & 0x00FF);
+  ptr[1] = (val & 0xFF00) >> 8;
+}
+
+static void
+_sdr_cache_set_uint32 (uint8_t *ptr, uint32_t val)
+{
+  assert (ptr);
+
+  ptr[0] = (val & 0x000000FF);
+  ptr[1] = (val & 0x0000FF00) >> 8;
+  ptr[2] = (val & 0x00FF0000) >> 16;
+  ptr[3] = (val & 0xFF000000) >> 24;
+}
+
+/* Fill in a record index entry.  The pre-decoded fields are filled
+ * in through the normal parse functions, so readers get exactly what
+ * they would have gotten parsing the record.  If a record can't be
+ * parsed, the appropriate flag is simply not set and readers fall
+ * back to parsing the record.
+ */
+static void
+_sdr_cache_record_index_entry (ipmi_sdr_ctx_t ctx,
+                               uint8_t *buf,
+                               unsigned int buflen,
+                               unsigned int offset,
+                               uint8_t *entry)
+{
+  uint8_t record_type;
+  uint8_t flags = 0;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (buf);
+  assert (buflen >= IPMI_SDR_RECORD_HEADER_LENGTH);
+  assert (entry);
+
+  memset (entry, '\0', IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH);
+
+  record_type = buf[IPMI_SDR_RECORD_TYPE_INDEX];
+
+  _sdr_cache_set_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_OFFSET, offset);
+  _sdr_cache_set_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_CRC32, sdr_crc32 (buf, buflen));
+  entry[IPMI_SDR_CACHE_RECORD_INDEX_RECORD_ID] = buf[IPMI_SDR_RECORD_ID_INDEX_LS];
+  entry[IPMI_SDR_CACHE_RECORD_INDEX_RECORD_ID + 1] = buf[IPMI_SDR_RECORD_ID_INDEX_MS];
+  entry[IPMI_SDR_CACHE_RECORD_INDEX_RECORD_TYPE] = record_type;
+
+  if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+      || record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD
+      || record_type == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD)
+    {
+      fiid_field_t *tmpl_sdr_record;
+      char id_string[IPMI_SDR_MAX_ID_STRING_LENGTH + 1];
+      int id_string_offset;
+      int id_string_len;
+
+      if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD)
+        tmpl_sdr_record = tmpl_sdr_full_sensor_record;
+      else if (record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+        tmpl_sdr_record = tmpl_sdr_compact_sensor_record;
+      else
+        tmpl_sdr_record = tmpl_sdr_event_only_record;
+
+      /* search code reads these raw, so store them raw */
+      entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_OWNER_ID] = buf[IPMI_SDR_RECORD_SENSOR_OWNER_ID_INDEX];
+      entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_NUMBER] = buf[IPMI_SDR_RECORD_SENSOR_NUMBER_INDEX];
+      entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_COUNT] = sdr_cache_record_sensor_count (buf, buflen);
+
+      if (ipmi_sdr_parse_sensor_type (ctx,
+                                      buf,
+                                      buflen,
+                                      &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_TYPE]) >= 0
+          && ipmi_sdr_parse_event_reading_type_code (ctx,
+                                                     buf,
+                                                     buflen,
+                                                     &entry[IPMI_SDR_CACHE_RECORD_INDEX_EVENT_READING_TYPE_CODE]) >= 0
+          && (id_string_len = ipmi_sdr_parse_id_string (ctx,
+                                                        buf,
+                                                        buflen,
+                                                        id_string,
+                                                        IPMI_SDR_MAX_ID_STRING_LENGTH + 1)) >= 0
+          && (id_string_offset = fiid_template_field_start_bytes (tmpl_sdr_record, "id_string")) >= 0
+          && (id_string_offset + id_string_len) <= buflen)
+        {
+          entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_OFFSET] = id_string_offset;
+          entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_LENGTH] = id_string_len;
+          flags |= IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR;
+        }
+    }
+
+  if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+      || record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+    {
+      if (ipmi_sdr_parse_sensor_units (ctx,
+                                       buf,
+                                       buflen,
+                                       &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_PERCENTAGE],
+                                       &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_MODIFIER],
+                                       &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_RATE],
+                                       &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_BASE_UNIT_TYPE],
+                                       &entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_MODIFIER_UNIT_TYPE]) >= 0)
+        flags |= IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_UNITS;
+    }
+
+  if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD)
+    {
+      int8_t r_exponent, b_exponent;
+      int16_t m, b;
+
+      if (ipmi_sdr_parse_sensor_decoding_data (ctx,
+                                               buf,
+                                               buflen,
+                                               &r_exponent,
+                                               &b_exponent,
+                                               &m,
+                                               &b,
+                                               &entry[IPMI_SDR_CACHE_RECORD_INDEX_LINEARIZATION],
+                                               &entry[IPMI_SDR_CACHE_RECORD_INDEX_ANALOG_DATA_FORMAT]) >= 0)
+        {
+          entry[IPMI_SDR_CACHE_RECORD_INDEX_R_EXPONENT] = (uint8_t)r_exponent;
+          entry[IPMI_SDR_CACHE_RECORD_INDEX_B_EXPONENT] = (uint8_t)b_exponent;
+          _sdr_cache_set_uint16 (entry + IPMI_SDR_CACHE_RECORD_INDEX_M, (uint16_t)m);
+          _sdr_cache_set_uint16 (entry + IPMI_SDR_CACHE_RECORD_INDEX_B, (uint16_t)b);
+          flags |= IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_DECODING_DATA;
+        }
+
+      /* fails if not a threshold based sensor */
+      if (ipmi_sdr_parse_thresholds_raw (ctx,
+                                         buf,
+                                         buflen,
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_CRITICAL_THRESHOLD],
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_CRITICAL_THRESHOLD],
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_RECOVERABLE_THRESHOLD],
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_CRITICAL_THRESHOLD],
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_CRITICAL_THRESHOLD],
+                                         &entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_RECOVERABLE_THRESHOLD]) >= 0)
+        flags |= IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_THRESHOLDS;
+    }
+
+  entry[IPMI_SDR_CACHE_RECORD_INDEX_FLAGS] = flags;
+}
+
+static int
+_sdr_cache_record_index_write (ipmi_sdr_ctx_t ctx,
+                               int fd,
+                               unsigned int *total_bytes_written,
+                               uint8_t *record_index,
+                               unsigned int record_index_count,
+                               uint8_t sdr_read_size,
+                               uint8_t *trailer_checksum)
+{
+  uint8_t record_index_info_buf[9];
+  unsigned int record_index_len;
+  ssize_t n;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (fd);
+  assert (total_bytes_written);
+  assert (record_index);
+  assert (trailer_checksum);
+
+  _sdr_cache_set_uint32 (&record_index_info_buf[0], (*total_bytes_written));
+  _sdr_cache_set_uint32 (&record_index_info_buf[4], record_index_count);
+  record_index_info_buf[8] = sdr_read_size;
+
+  record_index_len = record_index_count * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH;
+
+  if ((n = fd_write_n (fd, record_index, record_index_len)) < 0)
+    {
+      SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+      return (-1);
+    }
+  if (n != record_index_len)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+  (*total_bytes_written) += record_index_len;
+
+  (*trailer_checksum) = ipmi_checksum_incremental (record_index, record_index_len, (*trailer_checksum));
+
+  if ((n = fd_write_n (fd, record_index_info_buf, 9)) < 0)
+    {
+      SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+      return (-1);
+    }
+  if (n != 9)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+  (*total_bytes_written) += 9;
+
+  (*trailer_checksum) = ipmi_checksum_incremental (record_index_info_buf, 9, (*trailer_checksum));
+
+  return (0);
+}
+
 static int
 _sdr_cache_trailer_write (ipmi_sdr_ctx_t ctx,
 			  ipmi_ctx_t ipmi_ctx,
@@ -325,6 +562,157 @@ _sdr_cache_reservation_id (ipmi_sdr_ctx_t ctx,
   return (rv);
 }
 
+/* Read the remaining chunks of a partially read record with all
+ * requests outstanding at once.  Chunks are consumed in order until
+ * the first one that did not come back complete, the remainder is
+ * left to the sequential partial read loop, which deals with
+ * reservation cancellations and read size failures.
+ *
+ * Returns new offset_into_record on success, -1 on error.
+ */
+static int
+_sdr_cache_get_record_pipeline (ipmi_sdr_ctx_t ctx,
+                                ipmi_ctx_t ipmi_ctx,
+                                uint16_t record_id,
+                                void *record_buf,
+                                unsigned int record_buf_len,
+                                unsigned int record_length,
+                                unsigned int offset_into_record,
+                                uint16_t reservation_id,
+                                struct ipmi_sdr_cache_read_state *read_state)
+{
+  fiid_obj_t *obj_cmd_rq = NULL;
+  fiid_obj_t *obj_cmd_rs = NULL;
+  unsigned int bytes_to_read;
+  unsigned int full_reads = 0;
+  unsigned int count = 0;
+  unsigned int i;
+  int rv = -1;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ipmi_ctx);
+  assert (record_buf);
+  assert (record_length <= record_buf_len);
+  assert (offset_into_record < record_length);
+  assert (read_state);
+
+  bytes_to_read = read_state->bytes_to_read;
+  count = (record_length - offset_into_record + bytes_to_read - 1) / bytes_to_read;
+
+  if (!(obj_cmd_rq = (fiid_obj_t *)calloc (count, sizeof (fiid_obj_t))))
+    {
+      SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+      goto cleanup;
+    }
+
+  if (!(obj_cmd_rs = (fiid_obj_t *)calloc (count, sizeof (fiid_obj_t))))
+    {
+      SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+      goto cleanup;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      unsigned int offset = offset_into_record + i * bytes_to_read;
+      unsigned int len = bytes_to_read;
+
+      if ((record_length - offset) < len)
+        len = record_length - offset;
+
+      if (!(obj_cmd_rq[i] = fiid_obj_create (tmpl_cmd_get_sdr_rq)))
+        {
+          SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (!(obj_cmd_rs[i] = fiid_obj_create (tmpl_cmd_get_sdr_rs)))
+        {
+          SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (fill_cmd_get_sdr (reservation_id,
+                            record_id,
+                            offset,
+                            len,
+                            obj_cmd_rq[i]) < 0)
+        {
+          SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+    }
+
+  if (ipmi_cmd_pipeline (ipmi_ctx,
+                         IPMI_BMC_IPMB_LUN_BMC,
+                         IPMI_NET_FN_STORAGE_RQ,
+                         obj_cmd_rq,
+                         obj_cmd_rs,
+                         count) < 0)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_IPMI_ERROR);
+      goto cleanup;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      unsigned int len = bytes_to_read;
+      int record_data_len;
+      int ret;
+
+      if ((record_length - offset_into_record) < len)
+        len = record_length - offset_into_record;
+
+      if ((ret = ipmi_check_completion_code_success (obj_cmd_rs[i])) < 0)
+        {
+          SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (!ret)
+        break;
+
+      if ((record_data_len = fiid_obj_get_data (obj_cmd_rs[i],
+                                                "record_data",
+                                                record_buf + offset_into_record,
+                                                record_buf_len - offset_into_record)) < 0)
+        {
+          SDR_FIID_OBJECT_ERROR_TO_SDR_ERRNUM (ctx, obj_cmd_rs[i]);
+          goto cleanup;
+        }
+
+      /* later chunks were requested at offsets assuming complete reads */
+      if (record_data_len != len)
+        break;
+
+      if (len == bytes_to_read)
+        full_reads++;
+
+      offset_into_record += record_data_len;
+    }
+
+  /* same as the sequential loop, try larger reads for the next record */
+  if (full_reads
+      && (read_state->bytes_to_read + IPMI_SDR_CACHE_BYTES_TO_READ_INCREMENT) <= read_state->bytes_to_read_max)
+    read_state->bytes_to_read += IPMI_SDR_CACHE_BYTES_TO_READ_INCREMENT;
+
+  rv = offset_into_record;
+ cleanup:
+  if (obj_cmd_rq)
+    {
+      for (i = 0; i < count; i++)
+        fiid_obj_destroy (obj_cmd_rq[i]);
+      free (obj_cmd_rq);
+    }
+  if (obj_cmd_rs)
+    {
+      for (i = 0; i < count; i++)
+        fiid_obj_destroy (obj_cmd_rs[i]);
+      free (obj_cmd_rs);
+    }
+  return (rv);
+}
+
 static int
 _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
                        ipmi_ctx_t ipmi_ctx,
@@ -332,7 +720,8 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
                        void *record_buf,
                        unsigned int record_buf_len,
                        uint16_t *reservation_id,
-                       uint16_t *next_record_id)
+                       uint16_t *next_record_id,
+                       struct ipmi_sdr_cache_read_state *read_state)
 {
   fiid_obj_t obj_cmd_rs = NULL;
   fiid_obj_t obj_sdr_record_header = NULL;
@@ -340,7 +729,7 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
   int sdr_record_len = 0;
   unsigned int record_length = 0;
   int rv = -1;
-  unsigned int bytes_to_read = IPMI_SDR_CACHE_BYTES_TO_READ_START;
+  unsigned int bytes_to_read;
   unsigned int offset_into_record = 0;
   unsigned int reservation_id_retry_count = 0;
   uint8_t temp_record_buf[IPMI_SDR_MAX_RECORD_LENGTH];
@@ -353,6 +742,7 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
   assert (record_buf_len);
   assert (reservation_id);
   assert (next_record_id);
+  assert (read_state);
 
   if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sdr_rs)))
     {
@@ -377,7 +767,14 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
    * Many motherboards now allow you to read the full SDR record, try
    * that first.  If it fails for any reason, bail and try to read via
    * partial reads.
+   *
+   * If entire record reads have never worked on this motherboard,
+   * don't waste a round trip on them for every record.
    */
+
+  if (!read_state->entire_record_reads_ok
+      && read_state->entire_record_read_failures >= IPMI_SDR_CACHE_ENTIRE_RECORD_READ_FAILURES_MAX)
+    goto partial_read;
  
   reservation_id_retry_count = 0;
   while (!offset_into_record)
@@ -462,11 +859,14 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
 
       memcpy (record_buf, temp_record_buf, sdr_record_len);
       offset_into_record += sdr_record_len;
+      read_state->entire_record_reads_ok = 1;
       goto out;
     }
 
  partial_read:
 
+  read_state->entire_record_read_failures++;
+
   reservation_id_retry_count = 0;
   while (!record_length)
     {
@@ -572,11 +972,44 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
     }
   *next_record_id = val;
 
+  /* if the BMC takes several requests at once, get the remaining
+   * chunks all at once first
+   */
+  if (offset_into_record < record_length
+      && (record_length - offset_into_record) > read_state->bytes_to_read)
+    {
+      unsigned int pipeline_window;
+
+      if (ipmi_ctx_get_pipeline_window (ipmi_ctx, &pipeline_window) < 0)
+        {
+          SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_IPMI_ERROR);
+          goto cleanup;
+        }
+
+      if (pipeline_window > 1)
+        {
+          int ret;
+
+          if ((ret = _sdr_cache_get_record_pipeline (ctx,
+                                                     ipmi_ctx,
+                                                     record_id,
+                                                     record_buf,
+                                                     record_buf_len,
+                                                     record_length,
+                                                     offset_into_record,
+                                                     *reservation_id,
+                                                     read_state)) < 0)
+            goto cleanup;
+          offset_into_record = ret;
+        }
+    }
+
   reservation_id_retry_count = 0;
   while (offset_into_record < record_length)
     {
       int record_data_len;
 
+      bytes_to_read = read_state->bytes_to_read;
       if ((record_length - offset_into_record) < bytes_to_read)
         bytes_to_read = record_length - offset_into_record;
 
@@ -622,6 +1055,9 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
                   bytes_to_read -= IPMI_SDR_CACHE_BYTES_TO_READ_DECREMENT;
                   if (bytes_to_read < sdr_record_header_length)
                     bytes_to_read = sdr_record_header_length;
+                  /* never grow back to a size that failed */
+                  read_state->bytes_to_read = bytes_to_read;
+                  read_state->bytes_to_read_max = bytes_to_read;
                   continue;
                 }
 
@@ -639,6 +1075,12 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
           goto cleanup;
         }
 
+      /* only a full sized read says anything about larger reads */
+      if (bytes_to_read == read_state->bytes_to_read
+          && record_data_len == bytes_to_read
+          && (read_state->bytes_to_read + IPMI_SDR_CACHE_BYTES_TO_READ_INCREMENT) <= read_state->bytes_to_read_max)
+        read_state->bytes_to_read += IPMI_SDR_CACHE_BYTES_TO_READ_INCREMENT;
+
       offset_into_record += record_data_len;
     }
 
@@ -650,6 +1092,230 @@ _sdr_cache_get_record (ipmi_sdr_ctx_t ctx,
   return (rv);
 }
 
+static int
+_sdr_cache_old_record_cmp (const void *a, const void *b)
+{
+  const struct ipmi_sdr_cache_old_record *ra = a;
+  const struct ipmi_sdr_cache_old_record *rb = b;
+
+  if (ra->record_id < rb->record_id)
+    return (-1);
+  if (ra->record_id > rb->record_id)
+    return (1);
+  return (0);
+}
+
+/* Load what can be re-used from a previously created cache: the SDR
+ * read size learned for this host and, if old_records is non-NULL,
+ * all records sorted by record id.  Records are copied, since the
+ * cache file is truncated when the new cache is written.
+ *
+ * Any problem with the old cache just means it cannot be used, in
+ * which case nothing is returned and the cache is created from
+ * scratch.
+ */
+static void
+_sdr_cache_old_cache_load (const char *filename,
+                           struct ipmi_sdr_cache_old_record **old_records,
+                           unsigned int *old_records_count,
+                           uint8_t *sdr_read_size)
+{
+  ipmi_sdr_ctx_t old_ctx = NULL;
+  struct ipmi_sdr_cache_old_record *records = NULL;
+  uint16_t record_count;
+  unsigned int count = 0;
+  int ret = 0;
+
+  assert (filename);
+  assert (old_records_count);
+  assert (sdr_read_size);
+
+  if (old_records)
+    *old_records = NULL;
+  *old_records_count = 0;
+  *sdr_read_size = 0;
+
+  if (!(old_ctx = ipmi_sdr_ctx_create ()))
+    goto cleanup;
+
+  /* no ipmi_ctx, do not check timestamps, they are expected to be out of date */
+  if (ipmi_sdr_cache_open (old_ctx, NULL, filename) < 0)
+    goto cleanup;
+
+  if (old_ctx->sdr_read_size >= IPMI_SDR_RECORD_HEADER_LENGTH)
+    *sdr_read_size = old_ctx->sdr_read_size;
+
+  if (!old_records)
+    goto cleanup;
+
+  if (ipmi_sdr_cache_record_count (old_ctx, &record_count) < 0)
+    goto cleanup;
+
+  if (!record_count)
+    goto cleanup;
+
+  if (!(records = (struct ipmi_sdr_cache_old_record *)malloc (record_count * sizeof (struct ipmi_sdr_cache_old_record))))
+    goto cleanup;
+
+  do
+    {
+      struct ipmi_sdr_cache_old_record *record;
+      int record_len;
+
+      if (count >= record_count)
+        break;
+
+      record = &records[count];
+
+      if ((record_len = ipmi_sdr_cache_record_read (old_ctx,
+                                                    record->record,
+                                                    IPMI_SDR_MAX_RECORD_LENGTH)) < 0)
+        goto cleanup;
+
+      if (record_len < IPMI_SDR_RECORD_HEADER_LENGTH)
+        continue;
+
+      /* Record ID stored little endian */
+      record->record_id = ((uint16_t)record->record[IPMI_SDR_RECORD_ID_INDEX_LS] & 0xFF);
+      record->record_id |= ((uint16_t)record->record[IPMI_SDR_RECORD_ID_INDEX_MS] & 0xFF) << 8;
+      record->record_length = record_len;
+      count++;
+    } while ((ret = ipmi_sdr_cache_next (old_ctx)) == 1);
+
+  if (ret < 0)
+    goto cleanup;
+
+  qsort (records,
+         count,
+         sizeof (struct ipmi_sdr_cache_old_record),
+         _sdr_cache_old_record_cmp);
+
+  *old_records = records;
+  *old_records_count = count;
+  records = NULL;
+ cleanup:
+  free (records);
+  ipmi_sdr_ctx_destroy (old_ctx);
+}
+
+/* Read only the header of a record.  If it matches the header of a
+ * record in the old cache, re-use the old record instead of
+ * downloading it.
+ *
+ * Returns record length if an old record was re-used, 0 if the record
+ * must be downloaded.  Errors reading the header are not fatal, the
+ * full record read will report any real problem.
+ */
+static int
+_sdr_cache_get_old_record (ipmi_sdr_ctx_t ctx,
+                           ipmi_ctx_t ipmi_ctx,
+                           uint16_t record_id,
+                           struct ipmi_sdr_cache_old_record *old_records,
+                           unsigned int old_records_count,
+                           void *record_buf,
+                           unsigned int record_buf_len,
+                           uint16_t *reservation_id,
+                           uint16_t *next_record_id)
+{
+  fiid_obj_t obj_cmd_rs = NULL;
+  struct ipmi_sdr_cache_old_record key;
+  struct ipmi_sdr_cache_old_record *old_record;
+  uint8_t record_header_buf[IPMI_SDR_MAX_RECORD_LENGTH];
+  int record_header_len;
+  unsigned int reservation_id_retry_count = 0;
+  uint64_t val;
+  int rv = 0;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ipmi_ctx);
+  assert (old_records);
+  assert (old_records_count);
+  assert (record_buf);
+  assert (record_buf_len);
+  assert (reservation_id);
+  assert (next_record_id);
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sdr_rs)))
+    goto cleanup;
+
+  while (1)
+    {
+      if (ipmi_cmd_get_sdr (ipmi_ctx,
+                            *reservation_id,
+                            record_id,
+                            0,
+                            IPMI_SDR_RECORD_HEADER_LENGTH,
+                            obj_cmd_rs) < 0)
+        {
+          uint8_t comp_code;
+
+          if (ipmi_ctx_errnum (ipmi_ctx) != IPMI_ERR_BAD_COMPLETION_CODE)
+            goto cleanup;
+
+          if (FIID_OBJ_GET (obj_cmd_rs,
+                            "comp_code",
+                            &val) < 0)
+            goto cleanup;
+          comp_code = val;
+
+          if (comp_code == IPMI_COMP_CODE_RESERVATION_CANCELLED
+              && (reservation_id_retry_count < IPMI_SDR_CACHE_MAX_RESERVATION_ID_RETRY))
+            {
+              if (_sdr_cache_reservation_id (ctx,
+                                             ipmi_ctx,
+                                             reservation_id) < 0)
+                goto cleanup;
+              reservation_id_retry_count++;
+              continue;
+            }
+
+          goto cleanup;
+        }
+      break;
+    }
+
+  if ((record_header_len = fiid_obj_get_data (obj_cmd_rs,
+                                              "record_data",
+                                              record_header_buf,
+                                              IPMI_SDR_MAX_RECORD_LENGTH)) < 0)
+    goto cleanup;
+
+  if (record_header_len < IPMI_SDR_RECORD_HEADER_LENGTH)
+    goto cleanup;
+
+  /* Record ID stored little endian, record_id requested may be
+   * IPMI_SDR_RECORD_ID_FIRST, so use the one returned
+   */
+  key.record_id = ((uint16_t)record_header_buf[IPMI_SDR_RECORD_ID_INDEX_LS] & 0xFF);
+  key.record_id |= ((uint16_t)record_header_buf[IPMI_SDR_RECORD_ID_INDEX_MS] & 0xFF) << 8;
+
+  if (!(old_record = bsearch (&key,
+                              old_records,
+                              old_records_count,
+                              sizeof (struct ipmi_sdr_cache_old_record),
+                              _sdr_cache_old_record_cmp)))
+    goto cleanup;
+
+  /* Record ID, version, type, and length must all be identical */
+  if (memcmp (old_record->record, record_header_buf, IPMI_SDR_RECORD_HEADER_LENGTH)
+      || (((uint8_t)record_header_buf[IPMI_SDR_RECORD_LENGTH_INDEX]) + IPMI_SDR_RECORD_HEADER_LENGTH) != old_record->record_length
+      || old_record->record_length > record_buf_len)
+    goto cleanup;
+
+  if (FIID_OBJ_GET (obj_cmd_rs,
+                    "next_record_id",
+                    &val) < 0)
+    goto cleanup;
+  *next_record_id = val;
+
+  memcpy (record_buf, old_record->record, old_record->record_length);
+  rv = old_record->record_length;
+ cleanup:
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
 static int
 _sdr_cache_record_write (ipmi_sdr_ctx_t ctx,
                          int fd,
@@ -658,6 +1324,7 @@ _sdr_cache_record_write (ipmi_sdr_ctx_t ctx,
                          unsigned int *record_ids_count,
                          uint8_t *buf,
                          unsigned int buflen,
+			 uint8_t *record_index_entry,
 			 uint8_t *trailer_checksum)
 {
   ssize_t n;
@@ -669,6 +1336,7 @@ _sdr_cache_record_write (ipmi_sdr_ctx_t ctx,
   assert (!record_ids || (record_ids && record_ids_count));
   assert (buf);
   assert (buflen);
+  assert (record_index_entry);
   assert (trailer_checksum);
 
   /* Record header bytes are 5 bytes */
@@ -721,6 +1389,12 @@ _sdr_cache_record_write (ipmi_sdr_ctx_t ctx,
       (*record_ids_count)++;
     }
 
+  _sdr_cache_record_index_entry (ctx,
+                                 buf,
+                                 buflen,
+                                 (*total_bytes_written),
+                                 record_index_entry);
+
   if ((n = fd_write_n (fd, buf, buflen)) < 0)
     {
       SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
@@ -758,9 +1432,15 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
   unsigned int total_bytes_written = 0;
   uint16_t *record_ids = NULL;
   unsigned int record_ids_count = 0;
+  uint8_t *record_index = NULL;
+  struct ipmi_sdr_cache_old_record *old_records = NULL;
+  unsigned int old_records_count = 0;
+  struct ipmi_sdr_cache_read_state read_state;
+  uint8_t sdr_read_size = 0;
   unsigned int cache_create_flags_mask = (IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE
 					  | IPMI_SDR_CACHE_CREATE_FLAGS_DUPLICATE_RECORD_ID
-					  | IPMI_SDR_CACHE_CREATE_FLAGS_ASSUME_MAX_SDR_RECORD_COUNT);
+					  | IPMI_SDR_CACHE_CREATE_FLAGS_ASSUME_MAX_SDR_RECORD_COUNT
+					  | IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL);
   uint8_t trailer_checksum = 0;
   int fd = -1;
   int rv = -1;
@@ -791,6 +1471,26 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
     }
   
   ctx->operation = IPMI_SDR_OPERATION_CREATE_CACHE;
+
+  /* must be loaded before the old cache is truncated below */
+  if (cache_create_flags & (IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE | IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL))
+    _sdr_cache_old_cache_load (filename,
+                               (cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL) ? &old_records : NULL,
+                               &old_records_count,
+                               &sdr_read_size);
+
+  memset (&read_state, '\0', sizeof (struct ipmi_sdr_cache_read_state));
+  read_state.bytes_to_read = IPMI_SDR_CACHE_BYTES_TO_READ_START;
+  read_state.bytes_to_read_max = IPMI_SDR_CACHE_BYTES_TO_READ_MAX;
+
+  /* Start where the last cache create for this host left off.  Still
+   * try one entire record read, firmware may have been updated.
+   */
+  if (sdr_read_size)
+    {
+      read_state.bytes_to_read = sdr_read_size;
+      read_state.entire_record_read_failures = IPMI_SDR_CACHE_ENTIRE_RECORD_READ_FAILURES_MAX - 1;
+    }
   
   if (cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
     open_flags = O_CREAT | O_TRUNC | O_WRONLY;
@@ -860,6 +1560,12 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
       record_ids_count = 0;
     }
 
+  if (!(record_index = (uint8_t *)malloc (ctx->record_count * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH)))
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_OUT_OF_MEMORY);
+      goto cleanup;
+    }
+
   if (_sdr_cache_reservation_id (ctx,
                                  ipmi_ctx,
                                  &reservation_id) < 0)
@@ -892,13 +1598,27 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
         }
 
       record_id = next_record_id;
-      if ((record_len = _sdr_cache_get_record (ctx,
-                                               ipmi_ctx,
-                                               record_id,
-                                               record_buf,
-                                               IPMI_SDR_MAX_RECORD_LENGTH,
-                                               &reservation_id,
-                                               &next_record_id)) < 0)
+      record_len = 0;
+      if (old_records_count)
+        record_len = _sdr_cache_get_old_record (ctx,
+                                                ipmi_ctx,
+                                                record_id,
+                                                old_records,
+                                                old_records_count,
+                                                record_buf,
+                                                IPMI_SDR_MAX_RECORD_LENGTH,
+                                                &reservation_id,
+                                                &next_record_id);
+
+      if (!record_len
+          && (record_len = _sdr_cache_get_record (ctx,
+                                                  ipmi_ctx,
+                                                  record_id,
+                                                  record_buf,
+                                                  IPMI_SDR_MAX_RECORD_LENGTH,
+                                                  &reservation_id,
+                                                  &next_record_id,
+                                                  &read_state)) < 0)
         goto cleanup;
 
       if (record_len)
@@ -936,6 +1656,7 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
                                        &record_ids_count,
                                        record_buf,
                                        record_len,
+				       record_index + (record_count_written * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH),
 				       &trailer_checksum) < 0)
             goto cleanup;
 
@@ -1010,6 +1731,21 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
         }
     }
 
+  /* 0 if entire record reads worked, so they are tried first next time */
+  if (read_state.entire_record_reads_ok || !read_state.entire_record_read_failures)
+    sdr_read_size = 0;
+  else
+    sdr_read_size = read_state.bytes_to_read;
+
+  if (_sdr_cache_record_index_write (ctx,
+                                     fd,
+                                     &total_bytes_written,
+                                     record_index,
+                                     record_count_written,
+                                     sdr_read_size,
+                                     &trailer_checksum) < 0)
+    goto cleanup;
+
   if (_sdr_cache_trailer_write (ctx,
 				ipmi_ctx,
 				fd,
@@ -1043,6 +1779,8 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
       close (fd);
     }
   free (record_ids);
+  free (record_index);
+  free (old_records);
   sdr_init_ctx (ctx);
   return (rv);
 }
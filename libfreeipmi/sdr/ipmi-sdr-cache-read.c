@@ -67,6 +67,304 @@ _sdr_set_current_offset (ipmi_sdr_ctx_t ctx, off_t new_offset)
   ctx->current_offset.offset_dumped = 0;
 }
 
+static unsigned int
+_sdr_cache_index_hash (uint32_t key, unsigned int search_index_len)
+{
+  /* Knuth multiplicative hash, search_index_len is a power of 2 */
+  return ((key * 2654435761U) & (search_index_len - 1));
+}
+
+/* returns 1 if inserted, 0 if key already present (earlier records
+ * in the cache win, same as a linear search)
+ */
+static int
+_sdr_cache_index_insert (ipmi_sdr_ctx_t ctx, uint32_t key, off_t offset)
+{
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ctx->search_index);
+
+  i = _sdr_cache_index_hash (key, ctx->search_index_len);
+  while (ctx->search_index[i].used)
+    {
+      if (ctx->search_index[i].key == key)
+        return (0);
+      i = (i + 1) & (ctx->search_index_len - 1);
+    }
+
+  ctx->search_index[i].key = key;
+  ctx->search_index[i].used = 1;
+  ctx->search_index[i].offset = offset;
+  return (1);
+}
+
+static int
+_sdr_cache_index_find (ipmi_sdr_ctx_t ctx, uint32_t key, off_t *offset)
+{
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ctx->index_built);
+  assert (offset);
+
+  i = _sdr_cache_index_hash (key, ctx->search_index_len);
+  while (ctx->search_index[i].used)
+    {
+      if (ctx->search_index[i].key == key)
+        {
+          *offset = ctx->search_index[i].offset;
+          return (1);
+        }
+      i = (i + 1) & (ctx->search_index_len - 1);
+    }
+
+  return (0);
+}
+
+/* Load the record index stored in a version 2.0 or 2.1 cache.  The
+ * index is used in place, straight out of the mmap'd cache.  Check it
+ * describes the records actually in the cache, and that every record
+ * matches its crc, before trusting it.  Records are not checked again
+ * when read.
+ */
+static int
+_sdr_cache_record_index_load (ipmi_sdr_ctx_t ctx, int version_2_1)
+{
+  uint32_t record_index_offset;
+  uint32_t record_index_count;
+  off_t offset;
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ctx->sdr_cache);
+
+  /* records_end_offset currently at the start of the trailer */
+  record_index_offset = sdr_cache_get_uint32 (ctx->sdr_cache + ctx->records_end_offset);
+  record_index_count = sdr_cache_get_uint32 (ctx->sdr_cache + ctx->records_end_offset + 4);
+  /* only version 2.1 caches store a read size */
+  if (version_2_1)
+    ctx->sdr_read_size = (ctx->sdr_cache + ctx->records_end_offset)[8];
+  else
+    ctx->sdr_read_size = 0;
+
+  if (record_index_offset < ctx->records_start_offset
+      || record_index_offset > ctx->records_end_offset
+      || record_index_count > ((ctx->records_end_offset - record_index_offset) / IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH)
+      || (record_index_offset + record_index_count * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH) != ctx->records_end_offset)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
+      return (-1);
+    }
+
+  ctx->record_index = ctx->sdr_cache + record_index_offset;
+  ctx->record_index_count = record_index_count;
+  ctx->records_end_offset = record_index_offset;
+
+  offset = ctx->records_start_offset;
+  for (i = 0; i < ctx->record_index_count; i++)
+    {
+      const uint8_t *entry = ctx->record_index + (i * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH);
+      unsigned int record_length;
+
+      if ((offset + IPMI_SDR_RECORD_HEADER_LENGTH) > ctx->records_end_offset
+          || sdr_cache_get_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_OFFSET) != offset)
+        {
+          SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
+          return (-1);
+        }
+
+      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
+
+      if ((offset + IPMI_SDR_RECORD_HEADER_LENGTH + record_length) > ctx->records_end_offset
+          || (sdr_cache_get_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_CRC32)
+              != sdr_crc32 (ctx->sdr_cache + offset,
+                            record_length + IPMI_SDR_RECORD_HEADER_LENGTH)))
+        {
+          SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
+          return (-1);
+        }
+
+      offset += IPMI_SDR_RECORD_HEADER_LENGTH;
+      offset += record_length;
+    }
+
+  if (offset != ctx->records_end_offset)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
+      return (-1);
+    }
+
+  return (0);
+}
+
+static void
+_sdr_cache_index_add_record (ipmi_sdr_ctx_t ctx,
+                             off_t offset,
+                             uint16_t record_id,
+                             uint8_t sensor_owner_id,
+                             uint8_t sensor_number,
+                             unsigned int sensor_count)
+{
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+
+  _sdr_cache_index_insert (ctx, record_id, offset);
+
+  for (i = 0; i < sensor_count; i++)
+    {
+      /* sensor numbers do not wrap */
+      if ((sensor_number + i) > 0xFF)
+        break;
+
+      _sdr_cache_index_insert (ctx,
+                               IPMI_SDR_CACHE_INDEX_SENSOR_KEY (sensor_owner_id, sensor_number + i),
+                               offset);
+    }
+}
+
+/* achu: Walk the cache once and record the offset of every record,
+ * plus a hash of record ids and (sensor owner id, sensor number)
+ * pairs.  Shared sensor records are entered once for every sensor
+ * number they cover.  Afterwards seeks and searches no longer need to
+ * walk the cache.
+ *
+ * Version 2.0 and 2.1 caches carry their own record index, so the
+ * records themselves need not be walked and no offsets need to be
+ * stored.
+ */
+static int
+_sdr_cache_index_build (ipmi_sdr_ctx_t ctx)
+{
+  unsigned int keys_count = 0;
+  off_t offset;
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ctx->operation == IPMI_SDR_OPERATION_READ_CACHE);
+
+  if (ctx->index_built)
+    return (0);
+
+  /* first pass, count records and keys */
+  if (ctx->record_index)
+    {
+      for (i = 0; i < ctx->record_index_count; i++)
+        {
+          const uint8_t *entry = ctx->record_index + (i * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH);
+
+          keys_count += 1 + entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_COUNT];
+        }
+    }
+  else
+    {
+      offset = ctx->records_start_offset;
+      while (offset < ctx->records_end_offset)
+        {
+          uint8_t *ptr = ctx->sdr_cache + offset;
+          unsigned int record_length;
+
+          record_length = (uint8_t)ptr[IPMI_SDR_RECORD_LENGTH_INDEX];
+
+          ctx->record_offsets_count++;
+          keys_count += 1 + sdr_cache_record_sensor_count (ptr, IPMI_SDR_RECORD_HEADER_LENGTH + record_length);
+
+          if ((offset + record_length + IPMI_SDR_RECORD_HEADER_LENGTH) >= ctx->records_end_offset)
+            break;
+
+          offset += IPMI_SDR_RECORD_HEADER_LENGTH;
+          offset += record_length;
+        }
+
+      if (ctx->record_offsets_count)
+        {
+          if (!(ctx->record_offsets = (off_t *)malloc (sizeof (off_t) * ctx->record_offsets_count)))
+            {
+              SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_OUT_OF_MEMORY);
+              goto cleanup;
+            }
+        }
+    }
+
+  /* table at most half full, always atleast one empty slot */
+  ctx->search_index_len = 1;
+  while (ctx->search_index_len < (keys_count * 2))
+    ctx->search_index_len <<= 1;
+
+  if (!(ctx->search_index = (struct ipmi_sdr_cache_index_entry *)malloc (sizeof (struct ipmi_sdr_cache_index_entry) * ctx->search_index_len)))
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_OUT_OF_MEMORY);
+      goto cleanup;
+    }
+  memset (ctx->search_index, '\0', sizeof (struct ipmi_sdr_cache_index_entry) * ctx->search_index_len);
+
+  /* second pass, fill in */
+  if (ctx->record_index)
+    {
+      for (i = 0; i < ctx->record_index_count; i++)
+        {
+          const uint8_t *entry = ctx->record_index + (i * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH);
+
+          _sdr_cache_index_add_record (ctx,
+                                       sdr_cache_get_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_OFFSET),
+                                       sdr_cache_get_uint16 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_ID),
+                                       entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_OWNER_ID],
+                                       entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_NUMBER],
+                                       entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_COUNT]);
+        }
+    }
+  else
+    {
+      ctx->record_offsets_count = 0;
+      offset = ctx->records_start_offset;
+      while (offset < ctx->records_end_offset)
+        {
+          uint8_t *ptr = ctx->sdr_cache + offset;
+          uint16_t record_id;
+          unsigned int record_length;
+
+          record_length = (uint8_t)ptr[IPMI_SDR_RECORD_LENGTH_INDEX];
+
+          ctx->record_offsets[ctx->record_offsets_count++] = offset;
+
+          /* Record ID stored little-endian */
+          record_id = (uint16_t)ptr[IPMI_SDR_RECORD_ID_INDEX_LS] & 0xFF;
+          record_id |= ((uint16_t)ptr[IPMI_SDR_RECORD_ID_INDEX_MS] & 0xFF) << 8;
+
+          _sdr_cache_index_add_record (ctx,
+                                       offset,
+                                       record_id,
+                                       ptr[IPMI_SDR_RECORD_SENSOR_OWNER_ID_INDEX],
+                                       ptr[IPMI_SDR_RECORD_SENSOR_NUMBER_INDEX],
+                                       sdr_cache_record_sensor_count (ptr, IPMI_SDR_RECORD_HEADER_LENGTH + record_length));
+
+          if ((offset + record_length + IPMI_SDR_RECORD_HEADER_LENGTH) >= ctx->records_end_offset)
+            break;
+
+          offset += IPMI_SDR_RECORD_HEADER_LENGTH;
+          offset += record_length;
+        }
+    }
+
+  ctx->index_built = 1;
+  return (0);
+
+ cleanup:
+  free (ctx->record_offsets);
+  ctx->record_offsets = NULL;
+  ctx->record_offsets_count = 0;
+  free (ctx->search_index);
+  ctx->search_index = NULL;
+  ctx->search_index_len = 0;
+  return (-1);
+}
+
 int
 ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
                      ipmi_ctx_t ipmi_ctx,
@@ -82,6 +380,8 @@ ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
   char most_recent_addition_timestamp_buf[4];
   char most_recent_erase_timestamp_buf[4];
   struct stat stat_buf;
+  int version_2_0 = 0;
+  int version_2_1 = 0;
 
   if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
     {
@@ -171,7 +471,15 @@ ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
       && ((uint8_t)sdr_cache_version_buf[0] != IPMI_SDR_CACHE_FILE_VERSION_1_2_0
 	  || (uint8_t)sdr_cache_version_buf[1] != IPMI_SDR_CACHE_FILE_VERSION_1_2_1
 	  || (uint8_t)sdr_cache_version_buf[2] != IPMI_SDR_CACHE_FILE_VERSION_1_2_2
-	  || (uint8_t)sdr_cache_version_buf[3] != IPMI_SDR_CACHE_FILE_VERSION_1_2_3))
+	  || (uint8_t)sdr_cache_version_buf[3] != IPMI_SDR_CACHE_FILE_VERSION_1_2_3)
+      && ((uint8_t)sdr_cache_version_buf[0] != IPMI_SDR_CACHE_FILE_VERSION_2_0_0
+	  || (uint8_t)sdr_cache_version_buf[1] != IPMI_SDR_CACHE_FILE_VERSION_2_0_1
+	  || (uint8_t)sdr_cache_version_buf[2] != IPMI_SDR_CACHE_FILE_VERSION_2_0_2
+	  || (uint8_t)sdr_cache_version_buf[3] != IPMI_SDR_CACHE_FILE_VERSION_2_0_3)
+      && ((uint8_t)sdr_cache_version_buf[0] != IPMI_SDR_CACHE_FILE_VERSION_2_1_0
+	  || (uint8_t)sdr_cache_version_buf[1] != IPMI_SDR_CACHE_FILE_VERSION_2_1_1
+	  || (uint8_t)sdr_cache_version_buf[2] != IPMI_SDR_CACHE_FILE_VERSION_2_1_2
+	  || (uint8_t)sdr_cache_version_buf[3] != IPMI_SDR_CACHE_FILE_VERSION_2_1_3))
     {
       SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
       goto cleanup;
@@ -208,10 +516,24 @@ ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
 	}
     }
 
-  if ((uint8_t)sdr_cache_version_buf[0] == IPMI_SDR_CACHE_FILE_VERSION_1_2_0
-      && (uint8_t)sdr_cache_version_buf[1] == IPMI_SDR_CACHE_FILE_VERSION_1_2_1
-      && (uint8_t)sdr_cache_version_buf[2] == IPMI_SDR_CACHE_FILE_VERSION_1_2_2
-      && (uint8_t)sdr_cache_version_buf[3] == IPMI_SDR_CACHE_FILE_VERSION_1_2_3)
+  if ((uint8_t)sdr_cache_version_buf[0] == IPMI_SDR_CACHE_FILE_VERSION_2_0_0
+      && (uint8_t)sdr_cache_version_buf[1] == IPMI_SDR_CACHE_FILE_VERSION_2_0_1
+      && (uint8_t)sdr_cache_version_buf[2] == IPMI_SDR_CACHE_FILE_VERSION_2_0_2
+      && (uint8_t)sdr_cache_version_buf[3] == IPMI_SDR_CACHE_FILE_VERSION_2_0_3)
+    version_2_0 = 1;
+
+  if ((uint8_t)sdr_cache_version_buf[0] == IPMI_SDR_CACHE_FILE_VERSION_2_1_0
+      && (uint8_t)sdr_cache_version_buf[1] == IPMI_SDR_CACHE_FILE_VERSION_2_1_1
+      && (uint8_t)sdr_cache_version_buf[2] == IPMI_SDR_CACHE_FILE_VERSION_2_1_2
+      && (uint8_t)sdr_cache_version_buf[3] == IPMI_SDR_CACHE_FILE_VERSION_2_1_3)
+    version_2_1 = 1;
+
+  if (version_2_0
+      || version_2_1
+      || ((uint8_t)sdr_cache_version_buf[0] == IPMI_SDR_CACHE_FILE_VERSION_1_2_0
+	  && (uint8_t)sdr_cache_version_buf[1] == IPMI_SDR_CACHE_FILE_VERSION_1_2_1
+	  && (uint8_t)sdr_cache_version_buf[2] == IPMI_SDR_CACHE_FILE_VERSION_1_2_2
+	  && (uint8_t)sdr_cache_version_buf[3] == IPMI_SDR_CACHE_FILE_VERSION_1_2_3))
     {
       uint8_t header_checksum_buf[512];
       unsigned int header_checksum_buf_len = 0;
@@ -230,7 +552,12 @@ ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
        */
       
       header_bytes_len = 4 + 4 + 1 + 2 + 4 + 4 + 1;
-      trailer_bytes_len = 4 + 1;
+      if (version_2_1)
+	trailer_bytes_len = IPMI_SDR_CACHE_FILE_VERSION_2_1_TRAILER_LENGTH;
+      else if (version_2_0)
+	trailer_bytes_len = IPMI_SDR_CACHE_FILE_VERSION_2_0_TRAILER_LENGTH;
+      else
+	trailer_bytes_len = 4 + 1;
 
       if (ctx->file_size < (header_bytes_len + trailer_bytes_len))
 	{
@@ -288,6 +615,12 @@ ipmi_sdr_cache_open (ipmi_sdr_ctx_t ctx,
 	}
 
       ctx->records_end_offset = ctx->file_size - trailer_bytes_len;
+
+      if (version_2_0 || version_2_1)
+	{
+	  if (_sdr_cache_record_index_load (ctx, version_2_1) < 0)
+	    goto cleanup;
+	}
     }
   else /* (uint8_t)sdr_cache_version_buf[0] == IPMI_SDR_CACHE_FILE_VERSION_1_0
 	  && (uint8_t)sdr_cache_version_buf[1] == IPMI_SDR_CACHE_FILE_VERSION_1_1
@@ -468,7 +801,6 @@ int
 ipmi_sdr_cache_seek (ipmi_sdr_ctx_t ctx, unsigned int index)
 {
   off_t offset;
-  unsigned int i;
 
   if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
     {
@@ -488,19 +820,32 @@ ipmi_sdr_cache_seek (ipmi_sdr_ctx_t ctx, unsigned int index)
       return (-1);
     }
 
-  offset = ctx->records_start_offset;
-  for (i = 0; i < index; i++)
-    {
-      unsigned int record_length;
-
-      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
+  if (_sdr_cache_index_build (ctx) < 0)
+    return (-1);
 
-      if ((offset + record_length + IPMI_SDR_RECORD_HEADER_LENGTH) >= ctx->records_end_offset)
-	break;
+  /* record count in the header may not match the records in the
+   * cache, stop at the last record like ipmi_sdr_cache_next()
+   */
+  if (ctx->record_index)
+    {
+      const uint8_t *entry;
 
-      offset += IPMI_SDR_RECORD_HEADER_LENGTH;
-      offset += record_length;
+      if (!ctx->record_index_count)
+        offset = ctx->records_start_offset;
+      else
+        {
+          if (index >= ctx->record_index_count)
+            index = ctx->record_index_count - 1;
+          entry = ctx->record_index + (index * IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH);
+          offset = sdr_cache_get_uint32 (entry + IPMI_SDR_CACHE_RECORD_INDEX_RECORD_OFFSET);
+        }
     }
+  else if (!ctx->record_offsets_count)
+    offset = ctx->records_start_offset;
+  else if (index >= ctx->record_offsets_count)
+    offset = ctx->record_offsets[ctx->record_offsets_count - 1];
+  else
+    offset = ctx->record_offsets[index];
 
   _sdr_set_current_offset (ctx, offset);
 
@@ -512,7 +857,6 @@ int
 ipmi_sdr_cache_search_record_id (ipmi_sdr_ctx_t ctx, uint16_t record_id)
 {
   off_t offset;
-  int found = 0;
 
   if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
     {
@@ -526,39 +870,16 @@ ipmi_sdr_cache_search_record_id (ipmi_sdr_ctx_t ctx, uint16_t record_id)
       return (-1);
     }
 
-  offset = ctx->records_start_offset;
-  while (offset < ctx->records_end_offset)
-    {
-      uint8_t *ptr = ctx->sdr_cache + offset;
-      uint16_t record_id_current;
-      unsigned int record_length;
-
-      /* Record ID stored little-endian */
-      record_id_current = (uint16_t)ptr[IPMI_SDR_RECORD_ID_INDEX_LS] & 0xFF;
-      record_id_current |= ((uint16_t)ptr[IPMI_SDR_RECORD_ID_INDEX_MS] & 0xFF) << 8;
-
-      if (record_id == record_id_current)
-        {
-          found++;
-	  _sdr_set_current_offset (ctx, offset);
-          break;
-        }
-
-      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
-
-      if ((offset + record_length + IPMI_SDR_RECORD_HEADER_LENGTH) >= ctx->records_end_offset)
-	break;
-
-      offset += IPMI_SDR_RECORD_HEADER_LENGTH;
-      offset += record_length;
-    }
+  if (_sdr_cache_index_build (ctx) < 0)
+    return (-1);
 
-  if (!found)
+  if (!_sdr_cache_index_find (ctx, record_id, &offset))
     {
       SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_NOT_FOUND);
       return (-1);
     }
 
+  _sdr_set_current_offset (ctx, offset);
   ctx->errnum = IPMI_SDR_ERR_SUCCESS;
   return (0);
 }
@@ -567,7 +888,6 @@ int
 ipmi_sdr_cache_search_sensor (ipmi_sdr_ctx_t ctx, uint8_t sensor_number, uint8_t sensor_owner_id)
 {
   off_t offset;
-  int found = 0;
 
   if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
     {
@@ -581,87 +901,18 @@ ipmi_sdr_cache_search_sensor (ipmi_sdr_ctx_t ctx, uint8_t sensor_number, uint8_t
       return (-1);
     }
 
-  offset = ctx->records_start_offset;
-  while (offset < ctx->records_end_offset)
-    {
-      uint8_t *ptr = ctx->sdr_cache + offset;
-      uint8_t record_type_current;
-      unsigned int record_length;
-
-      record_type_current = ptr[IPMI_SDR_RECORD_TYPE_INDEX];
-
-      if (record_type_current == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
-          || record_type_current == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD
-          || record_type_current == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD)
-        {
-          uint8_t sensor_number_current;
-          uint8_t sensor_owner_id_current;
-
-          sensor_owner_id_current = ptr[IPMI_SDR_RECORD_SENSOR_OWNER_ID_INDEX];
-          sensor_number_current = ptr[IPMI_SDR_RECORD_SENSOR_NUMBER_INDEX];
-
-          if (sensor_owner_id_current == sensor_owner_id
-              && sensor_number_current == sensor_number)
-            {
-              found++;
-	      _sdr_set_current_offset (ctx, offset);
-              break;
-            }
-
-          /* Compact sensor records can do record sharing, so check
-           * for this case if the sensor_owner_id matches up.
-           */
-          if (sensor_owner_id_current == sensor_owner_id
-              && (record_type_current == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD
-                  || record_type_current == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD))
-            {
-              uint8_t share_count;
-              
-	      if (record_type_current == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
-		{
-		  share_count = ptr[IPMI_SDR_RECORD_COMPACT_SHARE_COUNT];
-		  share_count &= IPMI_SDR_RECORD_COMPACT_SHARE_COUNT_BITMASK;
-		  share_count >>= IPMI_SDR_RECORD_COMPACT_SHARE_COUNT_SHIFT;
-		}
-	      else
-		{
-		  share_count = ptr[IPMI_SDR_RECORD_EVENT_SHARE_COUNT];
-		  share_count &= IPMI_SDR_RECORD_EVENT_SHARE_COUNT_BITMASK;
-		  share_count >>= IPMI_SDR_RECORD_EVENT_SHARE_COUNT_SHIFT;
-		}
-              
-              /* IPMI spec gives the following example:
-               *
-               * "If the starting sensor number was 10, and the share
-               * count was 3, then sensors 10, 11, and 12 would share
-               * the record"
-               */
-              if (share_count > 1
-                  && (sensor_number > sensor_number_current
-                      && sensor_number <= (sensor_number_current + (share_count - 1))))
-                {
-                  found++;
-		  _sdr_set_current_offset (ctx, offset);
-                  break;
-                }
-            }
-        }
-
-      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
-
-      if ((offset + record_length + IPMI_SDR_RECORD_HEADER_LENGTH) >= ctx->records_end_offset)
-	break;
-
-      offset += IPMI_SDR_RECORD_HEADER_LENGTH;
-      offset += record_length;
-    }
+  if (_sdr_cache_index_build (ctx) < 0)
+    return (-1);
 
-  if (!found)
+  if (!_sdr_cache_index_find (ctx,
+                              IPMI_SDR_CACHE_INDEX_SENSOR_KEY (sensor_owner_id, sensor_number),
+                              &offset))
     {
       SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_NOT_FOUND);
       return (-1);
     }
 
+  _sdr_set_current_offset (ctx, offset);
   ctx->errnum = IPMI_SDR_ERR_SUCCESS;
   return (0);
 }
@@ -50,4 +50,19 @@ const char *sdr_record_type_str (ipmi_sdr_ctx_t ctx,
 
 void sdr_check_read_status (ipmi_sdr_ctx_t ctx);
 
+uint16_t sdr_cache_get_uint16 (const uint8_t *ptr);
+
+uint32_t sdr_cache_get_uint32 (const uint8_t *ptr);
+
+uint32_t sdr_crc32 (const uint8_t *buf, unsigned int buflen);
+
+/* returns number of sensor numbers a record covers, 0 if not a
+ * sensor record
+ */
+unsigned int sdr_cache_record_sensor_count (const uint8_t *sdr_record,
+                                            unsigned int sdr_record_len);
+
+/* returns NULL if the cache has no record index or no entry for offset */
+const uint8_t *sdr_cache_record_index_entry (ipmi_sdr_ctx_t ctx, off_t offset);
+
 #endif /* IPMI_SDR_COMMON_H */
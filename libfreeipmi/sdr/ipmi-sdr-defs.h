@@ -38,6 +38,7 @@
 #include <unistd.h>             /* off_t */
 #endif /* HAVE_UNISTD_H */
 
+#include "freeipmi/fiid/fiid.h"
 #include "freeipmi/sdr/ipmi-sdr.h"
 
 #include "list.h"
@@ -118,6 +119,129 @@
 #define IPMI_SDR_CACHE_FILE_VERSION_1_2_2 0x00
 #define IPMI_SDR_CACHE_FILE_VERSION_1_2_3 0x02
 
+/* Cache Version 2.0 format
+ *
+ * magic bytes (4 bytes)
+ * version bytes (4)
+ * sdr version (1)
+ * record count (2)
+ * most recent addition timestamp (4)
+ * most recent erase timestamp (4)
+ * header checksum (1) [all bytes above]
+ * records (variable)
+ * record index (record index count * record index entry length)
+ * record index offset (4)
+ * record index count (4)
+ * total bytes of file (4)
+ * trailer checksum (1) [records + all bytes above]
+ *
+ * All multi-byte values are stored little endian.
+ */
+
+#define IPMI_SDR_CACHE_FILE_VERSION_2_0_0 0x00
+#define IPMI_SDR_CACHE_FILE_VERSION_2_0_1 0x02
+#define IPMI_SDR_CACHE_FILE_VERSION_2_0_2 0x00
+#define IPMI_SDR_CACHE_FILE_VERSION_2_0_3 0x00
+
+/* Cache Version 2.1 format
+ *
+ * Same as Cache Version 2.0, with one more trailer byte after the
+ * record index count
+ *
+ * sdr read size (1) [bytes per partial Get SDR read, 0 if entire records could be read]
+ */
+
+#define IPMI_SDR_CACHE_FILE_VERSION_2_1_0 0x00
+#define IPMI_SDR_CACHE_FILE_VERSION_2_1_1 0x02
+#define IPMI_SDR_CACHE_FILE_VERSION_2_1_2 0x00
+#define IPMI_SDR_CACHE_FILE_VERSION_2_1_3 0x01
+
+/* Cache Version 2.0 record index entry
+ *
+ * One fixed width entry per record, in record order.  Sensor fields
+ * are stored already decoded so they can be read straight out of the
+ * mmap'd cache.  Fields are only valid if the appropriate flag is set.
+ *
+ * record offset (4) [from beginning of file]
+ * record crc32 (4) [record header + record body]
+ * record id (2)
+ * record type (1)
+ * flags (1)
+ * sensor owner id (1)
+ * sensor number (1)
+ * sensor count (1) [sensor numbers covered by record sharing]
+ * sensor type (1)
+ * event reading type code (1)
+ * id string offset (1) [from beginning of record]
+ * id string length (1)
+ * sensor units percentage (1)
+ * sensor units modifier (1)
+ * sensor units rate (1)
+ * sensor base unit type (1)
+ * sensor modifier unit type (1)
+ * r exponent (1)
+ * b exponent (1)
+ * m (2)
+ * b (2)
+ * linearization (1)
+ * analog data format (1)
+ * lower non critical threshold (1)
+ * lower critical threshold (1)
+ * lower non recoverable threshold (1)
+ * upper non critical threshold (1)
+ * upper critical threshold (1)
+ * upper non recoverable threshold (1)
+ */
+
+#define IPMI_SDR_CACHE_RECORD_INDEX_ENTRY_LENGTH                   38
+
+#define IPMI_SDR_CACHE_RECORD_INDEX_RECORD_OFFSET                  0
+#define IPMI_SDR_CACHE_RECORD_INDEX_RECORD_CRC32                   4
+#define IPMI_SDR_CACHE_RECORD_INDEX_RECORD_ID                      8
+#define IPMI_SDR_CACHE_RECORD_INDEX_RECORD_TYPE                    10
+#define IPMI_SDR_CACHE_RECORD_INDEX_FLAGS                          11
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_OWNER_ID                12
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_NUMBER                  13
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_COUNT                   14
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_TYPE                    15
+#define IPMI_SDR_CACHE_RECORD_INDEX_EVENT_READING_TYPE_CODE        16
+#define IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_OFFSET               17
+#define IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_LENGTH               18
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_PERCENTAGE        19
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_MODIFIER          20
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_RATE              21
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_BASE_UNIT_TYPE          22
+#define IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_MODIFIER_UNIT_TYPE      23
+#define IPMI_SDR_CACHE_RECORD_INDEX_R_EXPONENT                     24
+#define IPMI_SDR_CACHE_RECORD_INDEX_B_EXPONENT                     25
+#define IPMI_SDR_CACHE_RECORD_INDEX_M                              26
+#define IPMI_SDR_CACHE_RECORD_INDEX_B                              28
+#define IPMI_SDR_CACHE_RECORD_INDEX_LINEARIZATION                  30
+#define IPMI_SDR_CACHE_RECORD_INDEX_ANALOG_DATA_FORMAT             31
+#define IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_CRITICAL_THRESHOLD   32
+#define IPMI_SDR_CACHE_RECORD_INDEX_LOWER_CRITICAL_THRESHOLD       33
+#define IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_RECOVERABLE_THRESHOLD 34
+#define IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_CRITICAL_THRESHOLD   35
+#define IPMI_SDR_CACHE_RECORD_INDEX_UPPER_CRITICAL_THRESHOLD       36
+#define IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_RECOVERABLE_THRESHOLD 37
+
+/* sensor owner id, sensor number, sensor count, sensor type, event
+ * reading type code, id string
+ */
+#define IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR                   0x01
+/* sensor units */
+#define IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_UNITS                    0x02
+/* r/b exponent, m, b, linearization, analog data format */
+#define IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_DECODING_DATA            0x04
+/* raw thresholds */
+#define IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_THRESHOLDS               0x08
+
+/* record index offset + record index count + total bytes + checksum */
+#define IPMI_SDR_CACHE_FILE_VERSION_2_0_TRAILER_LENGTH             13
+
+/* record index offset + record index count + sdr read size + total bytes + checksum */
+#define IPMI_SDR_CACHE_FILE_VERSION_2_1_TRAILER_LENGTH             14
+
 #define IPMI_MAX_ENTITY_IDS          256
 #define IPMI_MAX_ENTITY_ID_INSTANCES 256
 
@@ -126,6 +250,18 @@ struct ipmi_sdr_offset {
   int offset_dumped;
 };
 
+/* key is the record id, or IPMI_SDR_CACHE_INDEX_SENSOR_KEY() for
+ * sensor owner id / sensor number lookups.  Both live in one table.
+ */
+#define IPMI_SDR_CACHE_INDEX_SENSOR_KEY(__sensor_owner_id, __sensor_number) \
+  (0x10000 | ((uint32_t)(__sensor_owner_id) << 8) | (uint32_t)(__sensor_number))
+
+struct ipmi_sdr_cache_index_entry {
+  uint32_t key;
+  int used;
+  off_t offset;
+};
+
 struct ipmi_sdr_entity_count {
   uint8_t entity_instances[IPMI_MAX_ENTITY_ID_INSTANCES];
   unsigned int entity_instances_count;
@@ -152,9 +288,24 @@ struct ipmi_sdr_ctx {
   struct ipmi_sdr_offset current_offset;
   int callback_lock;
 
+  /* Cache Version 2.0/2.1 record index, points into sdr_cache */
+  const uint8_t *record_index;
+  unsigned int record_index_count;
+  uint8_t sdr_read_size;
+
+  /* Cache Search Index - built on first search/seek */
+  int index_built;
+  off_t *record_offsets;
+  unsigned int record_offsets_count;
+  struct ipmi_sdr_cache_index_entry *search_index;
+  unsigned int search_index_len;
+
   /* for saving/reset */
   List saved_offsets;
 
+  /* record objects, reused across parse calls */
+  fiid_obj_pool_t obj_pool;
+
   /* Stats */
   int stats_compiled;
   struct ipmi_sdr_entity_count entity_counts[IPMI_MAX_ENTITY_IDS];
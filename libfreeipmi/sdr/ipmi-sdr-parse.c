@@ -122,7 +122,7 @@ ipmi_sdr_parse_record_id_and_type (ipmi_sdr_ctx_t ctx,
       goto cleanup;
     }
 
-  if (!(obj_sdr_record_header = fiid_obj_create (tmpl_sdr_record_header)))
+  if (!(obj_sdr_record_header = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_record_header)))
     {
       SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
       goto cleanup;
@@ -259,7 +259,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
 
   if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_full_sensor_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_full_sensor_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -267,7 +267,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_compact_sensor_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_compact_sensor_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -275,7 +275,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_event_only_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_event_only_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -283,7 +283,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_ENTITY_ASSOCIATION_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_entity_association_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_entity_association_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -291,7 +291,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_DEVICE_RELATIVE_ENTITY_ASSOCIATION_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_device_relative_entity_association_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_device_relative_entity_association_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -299,7 +299,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_GENERIC_DEVICE_LOCATOR_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_generic_device_locator_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_generic_device_locator_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -307,7 +307,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_FRU_DEVICE_LOCATOR_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_fru_device_locator_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_fru_device_locator_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -315,7 +315,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_management_controller_device_locator_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_management_controller_device_locator_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -323,7 +323,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_MANAGEMENT_CONTROLLER_CONFIRMATION_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_management_controller_confirmation_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_management_controller_confirmation_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -331,7 +331,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_BMC_MESSAGE_CHANNEL_INFO_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_bmc_message_channel_info_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_bmc_message_channel_info_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -339,7 +339,7 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
     }
   else if (record_type == IPMI_SDR_FORMAT_OEM_RECORD)
     {
-      if (!(obj_sdr_record = fiid_obj_create (tmpl_sdr_oem_record)))
+      if (!(obj_sdr_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sdr_oem_record)))
         {
           SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
           goto cleanup;
@@ -363,6 +363,35 @@ _sdr_record_get_common (ipmi_sdr_ctx_t ctx,
   return (NULL);
 }
 
+/* When the caller asks about the current record of a version 2.0
+ * cache, the fields may already be decoded in the cache's record
+ * index.  Returns NULL if the slow path through fiid must be taken.
+ */
+static const uint8_t *
+_sdr_record_index_entry (ipmi_sdr_ctx_t ctx,
+                         const void *sdr_record,
+                         unsigned int sdr_record_len,
+                         uint8_t flags)
+{
+  const uint8_t *entry;
+
+  if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
+    return (NULL);
+
+  if (sdr_record || sdr_record_len)
+    return (NULL);
+
+  if (!(entry = sdr_cache_record_index_entry (ctx, ctx->current_offset.offset)))
+    return (NULL);
+
+  if ((entry[IPMI_SDR_CACHE_RECORD_INDEX_FLAGS] & flags) != flags)
+    return (NULL);
+
+  sdr_check_read_status (ctx);
+
+  return (entry);
+}
+
 int
 ipmi_sdr_parse_sensor_owner_id (ipmi_sdr_ctx_t ctx,
                                 const void *sdr_record,
@@ -475,11 +504,23 @@ ipmi_sdr_parse_sensor_number (ipmi_sdr_ctx_t ctx,
                               unsigned int sdr_record_len,
                               uint8_t *sensor_number)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   uint64_t val;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR)))
+    {
+      if (sensor_number)
+        *sensor_number = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_NUMBER];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_COMPACT_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_EVENT_ONLY_RECORD;
@@ -581,11 +622,23 @@ ipmi_sdr_parse_sensor_type (ipmi_sdr_ctx_t ctx,
                             unsigned int sdr_record_len,
                             uint8_t *sensor_type)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   uint64_t val;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR)))
+    {
+      if (sensor_type)
+        *sensor_type = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_TYPE];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_COMPACT_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_EVENT_ONLY_RECORD;
@@ -621,11 +674,23 @@ ipmi_sdr_parse_event_reading_type_code (ipmi_sdr_ctx_t ctx,
                                         unsigned int sdr_record_len,
                                         uint8_t *event_reading_type_code)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   uint64_t val;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR)))
+    {
+      if (event_reading_type_code)
+        *event_reading_type_code = entry[IPMI_SDR_CACHE_RECORD_INDEX_EVENT_READING_TYPE_CODE];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_COMPACT_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_EVENT_ONLY_RECORD;
@@ -662,11 +727,34 @@ ipmi_sdr_parse_id_string (ipmi_sdr_ctx_t ctx,
                           char *id_string,
                           unsigned int id_string_len)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   int len = 0;
   int rv = -1;
 
+  /* fall through to fiid for the overflow error */
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_SENSOR))
+      && (!id_string
+          || id_string_len >= entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_LENGTH]))
+    {
+      if (id_string
+          && id_string_len
+          && entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_LENGTH])
+        {
+          len = entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_LENGTH];
+          memset (id_string, '\0', id_string_len);
+          memcpy (id_string,
+                  ctx->sdr_cache + ctx->current_offset.offset + entry[IPMI_SDR_CACHE_RECORD_INDEX_ID_STRING_OFFSET],
+                  len);
+        }
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (len);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_COMPACT_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_EVENT_ONLY_RECORD;
@@ -706,11 +794,31 @@ ipmi_sdr_parse_sensor_units (ipmi_sdr_ctx_t ctx,
                              uint8_t *sensor_base_unit_type,
                              uint8_t *sensor_modifier_unit_type)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   uint64_t val;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_UNITS)))
+    {
+      if (sensor_units_percentage)
+        *sensor_units_percentage = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_PERCENTAGE];
+      if (sensor_units_modifier)
+        *sensor_units_modifier = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_MODIFIER];
+      if (sensor_units_rate)
+        *sensor_units_rate = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_UNITS_RATE];
+      if (sensor_base_unit_type)
+        *sensor_base_unit_type = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_BASE_UNIT_TYPE];
+      if (sensor_modifier_unit_type)
+        *sensor_modifier_unit_type = entry[IPMI_SDR_CACHE_RECORD_INDEX_SENSOR_MODIFIER_UNIT_TYPE];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
   acceptable_record_types |= IPMI_SDR_PARSE_RECORD_TYPE_COMPACT_SENSOR_RECORD;
 
@@ -2189,11 +2297,33 @@ ipmi_sdr_parse_sensor_decoding_data (ipmi_sdr_ctx_t ctx,
                                      uint8_t *linearization,
                                      uint8_t *analog_data_format)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   uint32_t acceptable_record_types;
   uint64_t val, val1, val2;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_DECODING_DATA)))
+    {
+      if (r_exponent)
+        *r_exponent = (int8_t)entry[IPMI_SDR_CACHE_RECORD_INDEX_R_EXPONENT];
+      if (b_exponent)
+        *b_exponent = (int8_t)entry[IPMI_SDR_CACHE_RECORD_INDEX_B_EXPONENT];
+      if (m)
+        *m = (int16_t)sdr_cache_get_uint16 (entry + IPMI_SDR_CACHE_RECORD_INDEX_M);
+      if (b)
+        *b = (int16_t)sdr_cache_get_uint16 (entry + IPMI_SDR_CACHE_RECORD_INDEX_B);
+      if (linearization)
+        *linearization = entry[IPMI_SDR_CACHE_RECORD_INDEX_LINEARIZATION];
+      if (analog_data_format)
+        *analog_data_format = entry[IPMI_SDR_CACHE_RECORD_INDEX_ANALOG_DATA_FORMAT];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
 
   if (!(obj_sdr_record = _sdr_record_get_common (ctx,
@@ -2858,6 +2988,7 @@ ipmi_sdr_parse_thresholds_raw (ipmi_sdr_ctx_t ctx,
                                uint8_t *upper_critical_threshold,
                                uint8_t *upper_non_recoverable_threshold)
 {
+  const uint8_t *entry;
   fiid_obj_t obj_sdr_record = NULL;
   fiid_obj_t obj_sdr_record_threshold = NULL;
   uint32_t acceptable_record_types;
@@ -2865,6 +2996,27 @@ ipmi_sdr_parse_thresholds_raw (ipmi_sdr_ctx_t ctx,
   uint64_t val;
   int rv = -1;
 
+  if ((entry = _sdr_record_index_entry (ctx,
+                                        sdr_record,
+                                        sdr_record_len,
+                                        IPMI_SDR_CACHE_RECORD_INDEX_FLAGS_THRESHOLDS)))
+    {
+      if (lower_non_critical_threshold)
+        *lower_non_critical_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_CRITICAL_THRESHOLD];
+      if (lower_critical_threshold)
+        *lower_critical_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_CRITICAL_THRESHOLD];
+      if (lower_non_recoverable_threshold)
+        *lower_non_recoverable_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_LOWER_NON_RECOVERABLE_THRESHOLD];
+      if (upper_non_critical_threshold)
+        *upper_non_critical_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_CRITICAL_THRESHOLD];
+      if (upper_critical_threshold)
+        *upper_critical_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_CRITICAL_THRESHOLD];
+      if (upper_non_recoverable_threshold)
+        *upper_non_recoverable_threshold = entry[IPMI_SDR_CACHE_RECORD_INDEX_UPPER_NON_RECOVERABLE_THRESHOLD];
+      ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+      return (0);
+    }
+
   acceptable_record_types = IPMI_SDR_PARSE_RECORD_TYPE_FULL_SENSOR_RECORD;
 
   if (!(obj_sdr_record = _sdr_record_get_common (ctx,
@@ -104,6 +104,12 @@ ipmi_sdr_ctx_create (void)
       goto cleanup;
     }
 
+  if (!(ctx->obj_pool = fiid_obj_pool_create ()))
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
   sdr_init_ctx (ctx);
   return (ctx);
 
@@ -112,6 +118,7 @@ ipmi_sdr_ctx_create (void)
     {
       if (ctx->saved_offsets)
 	list_destroy (ctx->saved_offsets);
+      fiid_obj_pool_destroy (ctx->obj_pool);
       free (ctx);
     }
   return (NULL);
@@ -136,7 +143,11 @@ ipmi_sdr_ctx_destroy (ipmi_sdr_ctx_t ctx)
   if (ctx->sdr_cache)
     munmap (ctx->sdr_cache, ctx->file_size);
 
+  free (ctx->record_offsets);
+  free (ctx->search_index);
+
   list_destroy (ctx->saved_offsets);
+  fiid_obj_pool_destroy (ctx->obj_pool);
 
   ctx->magic = ~IPMI_SDR_CTX_MAGIC;
   ctx->operation = IPMI_SDR_OPERATION_UNINITIALIZED;
@@ -63,7 +63,7 @@ sel_get_reservation_id (ipmi_sel_ctx_t ctx,
   if (is_insufficient_privilege_level)
     (*is_insufficient_privilege_level) = 0;
 
-  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_reserve_sel_rs)))
+  if (!(obj_cmd_rs = fiid_obj_create_in (ctx->obj_pool, tmpl_cmd_reserve_sel_rs)))
     {
       SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
       goto cleanup;
@@ -120,19 +120,45 @@ sel_get_reservation_id (ipmi_sel_ctx_t ctx,
   return (rv);
 }
 
-int
-sel_get_record_header_info (ipmi_sel_ctx_t ctx,
-			    struct ipmi_sel_entry *sel_entry,
-			    uint16_t *record_id,
-			    uint8_t *record_type)
+/* Decode the record header, and the timestamp, manufacturer id, or
+ * system event fields for the record types that have them, through
+ * the fiid templates.  The result is kept in the ctx, so the many
+ * lookups made while formatting one record decode it only once.
+ */
+static int
+_sel_decode_record (ipmi_sel_ctx_t ctx,
+		    struct ipmi_sel_entry *sel_entry,
+		    struct ipmi_sel_decoded_record **decoded_record)
 {
+  struct ipmi_sel_decoded_record *dr;
   fiid_obj_t obj_sel_record_header = NULL;
+  fiid_obj_t obj_sel_record = NULL;
+  fiid_obj_t obj_sel_system_event_record_event_fields = NULL;
+  uint8_t generator_id_type;
+  uint8_t generator_id_address;
   uint64_t val;
   int rv = -1;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
   assert (sel_entry);
+  assert (sel_entry->sel_event_record_len <= IPMI_SEL_RECORD_LENGTH);
+  assert (decoded_record);
+
+  dr = &ctx->decoded_record;
+
+  if (dr->valid
+      && dr->flags == ctx->flags
+      && dr->sel_event_record_len == sel_entry->sel_event_record_len
+      && !memcmp (dr->sel_event_record,
+		  sel_entry->sel_event_record,
+		  sel_entry->sel_event_record_len))
+    {
+      (*decoded_record) = dr;
+      return (0);
+    }
+
+  dr->valid = 0;
 
   if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_HEADER_LENGTH)
     {
@@ -140,7 +166,7 @@ sel_get_record_header_info (ipmi_sel_ctx_t ctx,
       goto cleanup;
     }
 
-  if (!(obj_sel_record_header = fiid_obj_create (tmpl_sel_record_header)))
+  if (!(obj_sel_record_header = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_record_header)))
     {
       SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
       goto cleanup;
@@ -154,50 +180,297 @@ sel_get_record_header_info (ipmi_sel_ctx_t ctx,
       goto cleanup;
     }
 
-  if (record_id)
+  if (FIID_OBJ_GET (obj_sel_record_header,
+                    "record_id",
+                    &val) < 0)
+    {
+      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
+      goto cleanup;
+    }
+  dr->record_id = val;
+
+  if (FIID_OBJ_GET (obj_sel_record_header,
+                    "record_type",
+                    &val) < 0)
+    {
+      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
+      goto cleanup;
+    }
+  dr->record_type = val;
+
+  if (ctx->flags & IPMI_SEL_FLAGS_ASSUME_SYTEM_EVENT_RECORDS
+      && !IPMI_SEL_RECORD_TYPE_VALID (dr->record_type))
+    dr->record_type = IPMI_SEL_RECORD_TYPE_SYSTEM_EVENT_RECORD;
+
+  dr->record_type_class = ipmi_sel_record_type_class (dr->record_type);
+
+  /* remaining fields only exist in complete records */
+  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
+    goto out;
+
+  if (dr->record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
     {
-      if (FIID_OBJ_GET (obj_sel_record_header,
-                        "record_id",
+      struct ipmi_sel_system_event_record_data *system_event_record_data;
+
+      system_event_record_data = &dr->system_event_record_data;
+
+      if (!(obj_sel_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_system_event_record)))
+        {
+          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (!(obj_sel_system_event_record_event_fields = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_system_event_record_event_fields)))
+        {
+          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (fiid_obj_set_all (obj_sel_record,
+                            sel_entry->sel_event_record,
+                            sel_entry->sel_event_record_len) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+
+      if (fiid_obj_set_all (obj_sel_system_event_record_event_fields,
+                            sel_entry->sel_event_record,
+                            sel_entry->sel_event_record_len) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
+          goto cleanup;
+        }
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "timestamp",
                         &val) < 0)
         {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
           goto cleanup;
         }
-      (*record_id) = val;
-    }
+      system_event_record_data->timestamp = val;
 
-  if (record_type)
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "generator_id.id_type",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      generator_id_type = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "generator_id.id",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      generator_id_address = val;
+
+      system_event_record_data->generator_id = ((generator_id_address << 1) | generator_id_type);
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "ipmb_device_lun",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->ipmb_device_lun = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "channel_number",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->channel_number = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_message_format_version",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_message_format_version = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "sensor_type",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->sensor_type = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "sensor_number",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->sensor_number = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_type_code",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_type_code = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_dir",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_direction = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_data1",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_data1 = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_data2",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_data2 = val;
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "event_data3",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      system_event_record_data->event_data3 = val;
+
+      if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
+                        "offset_from_event_reading_type_code",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
+          goto cleanup;
+        }
+      system_event_record_data->offset_from_event_reading_type_code = val;
+
+      if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
+                        "event_data2_flag",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
+          goto cleanup;
+        }
+      system_event_record_data->event_data2_flag = val;
+
+      if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
+                        "event_data3_flag",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
+          goto cleanup;
+        }
+      system_event_record_data->event_data3_flag = val;
+
+      dr->timestamp = system_event_record_data->timestamp;
+    }
+  else if (dr->record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
-      if (FIID_OBJ_GET (obj_sel_record_header,
-                        "record_type",
+      if (!(obj_sel_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_timestamped_oem_record)))
+        {
+          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (fiid_obj_set_all (obj_sel_record,
+                            sel_entry->sel_event_record,
+                            sel_entry->sel_event_record_len) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "timestamp",
                         &val) < 0)
         {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
           goto cleanup;
         }
-      (*record_type) = val;
+      dr->timestamp = val;
 
-      if (ctx->flags & IPMI_SEL_FLAGS_ASSUME_SYTEM_EVENT_RECORDS
-	  && !IPMI_SEL_RECORD_TYPE_VALID ((*record_type)))
-	(*record_type) = IPMI_SEL_RECORD_TYPE_SYSTEM_EVENT_RECORD;
+      if (FIID_OBJ_GET (obj_sel_record,
+                        "manufacturer_id",
+                        &val) < 0)
+        {
+          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
+          goto cleanup;
+        }
+      dr->manufacturer_id = val;
     }
 
+ out:
+  memcpy (dr->sel_event_record,
+          sel_entry->sel_event_record,
+          sel_entry->sel_event_record_len);
+  dr->sel_event_record_len = sel_entry->sel_event_record_len;
+  dr->flags = ctx->flags;
+  dr->valid = 1;
+  (*decoded_record) = dr;
   rv = 0;
  cleanup:
   fiid_obj_destroy (obj_sel_record_header);
+  fiid_obj_destroy (obj_sel_record);
+  fiid_obj_destroy (obj_sel_system_event_record_event_fields);
   return (rv);
 }
 
+int
+sel_get_record_header_info (ipmi_sel_ctx_t ctx,
+			    struct ipmi_sel_entry *sel_entry,
+			    uint16_t *record_id,
+			    uint8_t *record_type)
+{
+  struct ipmi_sel_decoded_record *dr;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+  assert (sel_entry);
+
+  if (_sel_decode_record (ctx, sel_entry, &dr) < 0)
+    return (-1);
+
+  if (record_id)
+    (*record_id) = dr->record_id;
+
+  if (record_type)
+    (*record_type) = dr->record_type;
+
+  return (0);
+}
+
 int
 sel_get_timestamp (ipmi_sel_ctx_t ctx,
 		   struct ipmi_sel_entry *sel_entry,
 		   uint32_t *timestamp)
 {
-  fiid_obj_t obj_sel_record = NULL;
-  uint8_t record_type;
-  int record_type_class;
-  uint64_t val;
-  int rv = -1;
+  struct ipmi_sel_decoded_record *dr;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
@@ -206,65 +479,23 @@ sel_get_timestamp (ipmi_sel_ctx_t ctx,
   if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
+      return (-1);
     }
 
-  if (sel_get_record_header_info (ctx,
-				  sel_entry,
-				  NULL,
-				  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if (_sel_decode_record (ctx, sel_entry, &dr) < 0)
+    return (-1);
 
-  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD
-      && record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
+  if (dr->record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD
+      && dr->record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
-    {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_system_event_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
-    }
-  else
-    {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
-    }
-
-  if (fiid_obj_set_all (obj_sel_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-      goto cleanup;
+      return (-1);
     }
 
   if (timestamp)
-    {
-      if (FIID_OBJ_GET (obj_sel_record,
-			"timestamp",
-			&val) < 0)
-	{
-	  SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-	  goto cleanup;
-	}
-      (*timestamp) = val;
-    }
+    (*timestamp) = dr->timestamp;
 
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_record);
-  return (rv);
+  return (0);
 }
 
 int
@@ -272,11 +503,7 @@ sel_get_manufacturer_id (ipmi_sel_ctx_t ctx,
 			 struct ipmi_sel_entry *sel_entry,
 			 uint32_t *manufacturer_id)
 {
-  fiid_obj_t obj_sel_record = NULL;
-  uint8_t record_type;
-  int record_type_class;
-  uint64_t val;
-  int rv = -1;
+  struct ipmi_sel_decoded_record *dr;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
@@ -285,53 +512,22 @@ sel_get_manufacturer_id (ipmi_sel_ctx_t ctx,
   if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
+      return (-1);
     }
 
-  if (sel_get_record_header_info (ctx,
-				  sel_entry,
-				  NULL,
-				  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if (_sel_decode_record (ctx, sel_entry, &dr) < 0)
+    return (-1);
 
-  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
+  if (dr->record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-      goto cleanup;
+      return (-1);
     }
 
   if (manufacturer_id)
-    {
-      if (FIID_OBJ_GET (obj_sel_record,
-			"manufacturer_id",
-			&val) < 0)
-	{
-	  SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-	  goto cleanup;
-	}
-      (*manufacturer_id) = val;
-    }
+    (*manufacturer_id) = dr->manufacturer_id;
 
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_record);
-  return (rv);
+  return (0);
 }
 
 int
@@ -375,7 +571,7 @@ sel_get_oem (ipmi_sel_ctx_t ctx,
 
   if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
+      if (!(obj_sel_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_timestamped_oem_record)))
         {
           SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
           goto cleanup;
@@ -383,7 +579,7 @@ sel_get_oem (ipmi_sel_ctx_t ctx,
     }
   else
     {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_non_timestamped_oem_record)))
+      if (!(obj_sel_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_non_timestamped_oem_record)))
         {
           SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
           goto cleanup;
@@ -418,14 +614,7 @@ sel_get_system_event_record (ipmi_sel_ctx_t ctx,
 			     struct ipmi_sel_entry *sel_entry,
 			     struct ipmi_sel_system_event_record_data *system_event_record_data)
 {
-  fiid_obj_t obj_sel_system_event_record = NULL;
-  fiid_obj_t obj_sel_system_event_record_event_fields = NULL;
-  int record_type_class;
-  uint8_t record_type;
-  uint8_t generator_id_type;
-  uint8_t generator_id_address;
-  uint64_t val;
-  int rv = -1;
+  struct ipmi_sel_decoded_record *dr;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
@@ -435,200 +624,21 @@ sel_get_system_event_record (ipmi_sel_ctx_t ctx,
   if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
+      return (-1);
     }
 
-  if (sel_get_record_header_info (ctx,
-				  sel_entry,
-				  NULL,
-				  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if (_sel_decode_record (ctx, sel_entry, &dr) < 0)
+    return (-1);
 
-  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
+  if (dr->record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
+      return (-1);
     }
 
-  if (!(obj_sel_system_event_record = fiid_obj_create (tmpl_sel_system_event_record)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
+  memcpy (system_event_record_data,
+	  &dr->system_event_record_data,
+	  sizeof (struct ipmi_sel_system_event_record_data));
 
-  if (!(obj_sel_system_event_record_event_fields = fiid_obj_create (tmpl_sel_system_event_record_event_fields)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_system_event_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_system_event_record_event_fields,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "timestamp",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->timestamp = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "generator_id.id_type",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  generator_id_type = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "generator_id.id",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  generator_id_address = val;
-
-  system_event_record_data->generator_id = ((generator_id_address << 1) | generator_id_type);
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "ipmb_device_lun",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->ipmb_device_lun = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "channel_number",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->channel_number = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_message_format_version",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_message_format_version = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "sensor_type",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->sensor_type = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "sensor_number",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->sensor_number = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_type_code",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_type_code = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_dir",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_direction = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data1",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data1 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data2",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data2 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data3",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data3 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "offset_from_event_reading_type_code",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->offset_from_event_reading_type_code = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "event_data2_flag",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->event_data2_flag = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "event_data3_flag",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->event_data3_flag = val;
-
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_system_event_record);
-  fiid_obj_destroy (obj_sel_system_event_record_event_fields);
-  return (rv);
+  return (0);
 }
@@ -26,12 +26,11 @@
 #include <stdint.h>
 #include <sys/param.h>
 
+#include "freeipmi/fiid/fiid.h"
 #include "freeipmi/interpret/ipmi-interpret.h"
 #include "freeipmi/sdr/ipmi-sdr.h"
 #include "freeipmi/sel/ipmi-sel.h"
 
-#include "list.h"
-
 #ifndef MAXPATHLEN
 #define MAXPATHLEN 4096
 #endif /* MAXPATHLEN */
@@ -44,6 +43,8 @@
 
 #define IPMI_SEL_RESERVATION_ID_RETRY         4
 
+#define IPMI_SEL_RECORDS_MIN                 64
+
 #define IPMI_SEL_FLAGS_MASK			\
   (IPMI_SEL_FLAGS_DEBUG_DUMP			\
    | IPMI_SEL_FLAGS_ASSUME_SYTEM_EVENT_RECORDS)
@@ -68,6 +69,58 @@ struct ipmi_sel_entry {
   unsigned int sel_event_record_len; /* should always be 16, but just in case */
 };
 
+/* convenience struct */
+struct ipmi_sel_system_event_record_data
+{
+  uint32_t timestamp;
+  uint8_t generator_id;
+  uint8_t ipmb_device_lun;
+  uint8_t channel_number;
+  uint8_t event_message_format_version;
+  uint8_t sensor_type;
+  uint8_t sensor_number;
+  uint8_t event_type_code;
+  uint8_t event_direction;
+  uint8_t offset_from_event_reading_type_code;
+  uint8_t event_data2_flag;
+  uint8_t event_data3_flag;
+  uint8_t event_data1;
+  uint8_t event_data2;
+  uint8_t event_data3;
+};
+
+/* record decoded once, reused by lookups on the same record */
+struct ipmi_sel_decoded_record {
+  int valid;
+  unsigned int flags;
+  uint8_t sel_event_record[IPMI_SEL_RECORD_LENGTH];
+  unsigned int sel_event_record_len;
+  uint16_t record_id;
+  uint8_t record_type;
+  int record_type_class;
+  uint32_t timestamp;           /* system event and timestamped OEM */
+  uint32_t manufacturer_id;     /* timestamped OEM */
+  struct ipmi_sel_system_event_record_data system_event_record_data;
+};
+
+#define IPMI_SEL_FORMAT_MAGIC 0x5E1F0A7C
+
+/* compiled format string, see ipmi_sel_format_compile() */
+struct ipmi_sel_format_op {
+  char conversion;              /* 0 for literal text */
+  const char *literal;
+};
+
+struct ipmi_sel_format {
+  uint32_t magic;
+  char *fmt;
+  struct ipmi_sel_format_op *ops;
+  unsigned int ops_count;
+  char *literals;
+};
+
+#define IPMI_SEL_FORMAT_CACHE_SIZE 16
+
 struct ipmi_sel_oem_intel_node_manager {
   int node_manager_data_parsed;
   int node_manager_data_found;
@@ -97,12 +150,25 @@ struct ipmi_sel_ctx {
   int utc_offset;
 
   int sel_entries_loaded;
-  List sel_entries;
-  ListIterator sel_entries_itr;
-  struct ipmi_sel_entry *current_sel_entry;
+  /* records packed IPMI_SEL_RECORD_LENGTH bytes apart */
+  uint8_t *sel_records;
+  uint8_t *sel_records_len;
+  unsigned int sel_records_count;
+  unsigned int sel_records_size;
+  unsigned int current_sel_record;
+  struct ipmi_sel_entry current_sel_entry;
 
   struct ipmi_sel_entry *callback_sel_entry;
 
+  /* record objects, reused across parse calls */
+  fiid_obj_pool_t obj_pool;
+
+  struct ipmi_sel_decoded_record decoded_record;
+
+  /* formats compiled for ipmi_sel_parse_read_record_string() */
+  struct ipmi_sel_format *format_cache[IPMI_SEL_FORMAT_CACHE_SIZE];
+  unsigned int format_cache_next;
+
   struct ipmi_sel_oem_intel_node_manager intel_node_manager;
 };
 
@@ -619,7 +619,7 @@ _get_previous_state_or_severity (ipmi_sel_ctx_t ctx,
   assert (previous_offset_from_event_reading_type_code);
   assert (offset_from_severity_event_reading_type_code);
 
-  if (!(obj_sel_system_event_record = fiid_obj_create (tmpl_sel_system_event_record_discrete_previous_state_severity)))
+  if (!(obj_sel_system_event_record = fiid_obj_create_in (ctx->obj_pool, tmpl_sel_system_event_record_discrete_previous_state_severity)))
     {
       SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
       goto cleanup;
@@ -2701,9 +2701,111 @@ _output_oem_string (ipmi_sel_ctx_t ctx,
   return (0);
 }
 
+struct ipmi_sel_format *
+sel_format_compile (const char *fmt)
+{
+  struct ipmi_sel_format *format = NULL;
+  struct ipmi_sel_format_op *op = NULL;
+  unsigned int fmt_len;
+  char *lptr;
+  int percent_flag = 0;
+
+  assert (fmt);
+
+  fmt_len = strlen (fmt);
+
+  if (!(format = (struct ipmi_sel_format *)malloc (sizeof (struct ipmi_sel_format))))
+    return (NULL);
+  memset (format, '\0', sizeof (struct ipmi_sel_format));
+  format->magic = IPMI_SEL_FORMAT_MAGIC;
+
+  /* Every character yields at most one op.  Literal text is never
+   * longer than the characters it came from, and each literal's NUL
+   * fits in the two characters of the conversion that ends it.
+   */
+  if (!(format->fmt = strdup (fmt))
+      || !(format->ops = (struct ipmi_sel_format_op *)malloc (sizeof (struct ipmi_sel_format_op) * (fmt_len + 1)))
+      || !(format->literals = (char *)malloc (fmt_len + 1)))
+    goto cleanup;
+
+  lptr = format->literals;
+
+  while (*fmt)
+    {
+      char literal[2];
+      unsigned int literal_len = 0;
+
+      if (*fmt == '%' && !percent_flag)
+        {
+          percent_flag = 1;
+          fmt++;
+          continue;
+        }
+
+      if (percent_flag && strchr ("iItdTsefhcpSEkmoO", *fmt))
+        {
+          op = &format->ops[format->ops_count++];
+          op->conversion = *fmt;
+          op->literal = NULL;
+          op = NULL;
+        }
+      else
+        {
+          if (percent_flag && *fmt == '%')
+            literal[literal_len++] = '%';
+          else if (percent_flag)
+            {
+              literal[literal_len++] = '%';
+              literal[literal_len++] = *fmt;
+            }
+          else
+            literal[literal_len++] = *fmt;
+
+          /* coalesce adjacent literal text into one op */
+          if (!op)
+            {
+              op = &format->ops[format->ops_count++];
+              op->conversion = 0;
+              op->literal = lptr;
+            }
+          else
+            lptr--;             /* overwrite previous NUL */
+
+          memcpy (lptr, literal, literal_len);
+          lptr += literal_len;
+          *lptr++ = '\0';
+        }
+
+      percent_flag = 0;
+      fmt++;
+    }
+
+  return (format);
+
+ cleanup:
+  sel_format_destroy (format);
+  errno = ENOMEM;
+  return (NULL);
+}
+
+void
+sel_format_destroy (struct ipmi_sel_format *format)
+{
+  if (!format)
+    return;
+
+  assert (format->magic == IPMI_SEL_FORMAT_MAGIC);
+
+  format->magic = ~IPMI_SEL_FORMAT_MAGIC;
+  free (format->fmt);
+  free (format->ops);
+  free (format->literals);
+  free (format);
+}
+
 int
 sel_format_record_string (ipmi_sel_ctx_t ctx,
-			  const char *fmt,
+			  const struct ipmi_sel_format *format,
 			  const void *sel_record,
 			  unsigned int sel_record_len,
 			  char *buf,
@@ -2713,15 +2815,16 @@ sel_format_record_string (ipmi_sel_ctx_t ctx,
   struct ipmi_sel_entry sel_entry;
   uint16_t record_id;
   uint8_t sel_record_type;
-  int percent_flag = 0;
   unsigned int wlen = 0;
   struct sel_string_oem *sel_string_oem = NULL;
+  unsigned int i;
   int rv = -1;
   int ret;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
-  assert (fmt);
+  assert (format);
+  assert (format->magic == IPMI_SEL_FORMAT_MAGIC);
   assert (sel_record);
   assert (sel_record_len >= IPMI_SEL_RECORD_LENGTH);
   assert (buf);
@@ -2731,6 +2834,7 @@ sel_format_record_string (ipmi_sel_ctx_t ctx,
   memcpy (sel_entry.sel_event_record, sel_record, IPMI_SEL_RECORD_LENGTH);
   sel_entry.sel_event_record_len = IPMI_SEL_RECORD_LENGTH;
 
+  /* decodes the record, the _output functions below reuse it */
   if (sel_get_record_header_info (ctx,
 				  &sel_entry,
 				  &record_id,
@@ -2745,274 +2849,177 @@ sel_format_record_string (ipmi_sel_ctx_t ctx,
 	goto cleanup;
     }
 
-  while (*fmt)
+  for (i = 0; i < format->ops_count; i++)
     {
-      if (*fmt == '%')
-        {
-          if (percent_flag)
-            {
-              if (sel_string_snprintf (buf, buflen, &wlen, "%%"))
-                goto out;
-              percent_flag = 0;
-            }
-          else
-            percent_flag = 1;
-          goto end_loop;
-        }
-      else if (percent_flag && *fmt == 'i') /* record id */
-        {
-          if (sel_string_snprintf (buf, buflen, &wlen, "%u", record_id))
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'I') /* event interpretation */
-	{
-          if ((ret = _output_event_interpretation (ctx,
-						   &sel_entry,
-						   sel_record_type,
-						   buf,
-						   buflen,
-						   flags,
-						   &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-	}
-      else if (percent_flag && *fmt == 't') /* time */
-        {
-          if ((ret = _output_time (ctx,
-                                   &sel_entry,
-                                   sel_record_type,
-                                   buf,
-                                   buflen,
-                                   flags,
-                                   &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'd') /* date */
-        {
-          if ((ret = _output_date (ctx,
-                                   &sel_entry,
-                                   sel_record_type,
-                                   buf,
-                                   buflen,
-                                   flags,
-                                   &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'T') /* sensor type */
-        {
-          if ((ret = _output_sensor_type (ctx,
-                                          &sel_entry,
-                                          sel_record_type,
-                                          buf,
-                                          buflen,
-                                          flags,
-                                          &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 's') /* sensor name */
-        {
-          if ((ret = _output_sensor_name (ctx,
-                                          &sel_entry,
-                                          sel_record_type,
-                                          buf,
-                                          buflen,
-                                          flags,
-                                          &wlen,
-					  sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'e') /* event data1 */
+      switch (format->ops[i].conversion)
         {
-          if ((ret = _output_event_data1 (ctx,
-                                          &sel_entry,
-                                          sel_record_type,
-                                          buf,
-                                          buflen,
-                                          flags,
-                                          &wlen,
-					  sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'f') /* event data2  */
-        {
-          if ((ret = _output_event_data2 (ctx,
-                                          &sel_entry,
-                                          sel_record_type,
-                                          buf,
-                                          buflen,
-                                          flags,
-                                          &wlen,
-					  sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'h') /* event data3 */
-        {
-          if ((ret = _output_event_data3 (ctx,
-                                          &sel_entry,
-                                          sel_record_type,
-                                          buf,
-                                          buflen,
-                                          flags,
-                                          &wlen,
-					  sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'c') /* combined event data 2 and event data 3 string */
-        {
-          if ((ret = _output_event_data2_event_data3 (ctx,
-                                                      &sel_entry,
-                                                      sel_record_type,
-                                                      buf,
-                                                      buflen,
-                                                      flags,
-                                                      &wlen,
-						      sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-        }
-      else if (percent_flag && *fmt == 'p') /* event data2 previous state */
-        {
-          if ((ret = _output_event_data2_previous_state (ctx,
-                                                         &sel_entry,
-                                                         sel_record_type,
-                                                         buf,
-                                                         buflen,
-                                                         flags,
-                                                         &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'S') /* event data3 severity */
-        {
-          if ((ret = _output_event_data2_severity (ctx,
-                                                   &sel_entry,
-                                                   sel_record_type,
-                                                   buf,
-                                                   buflen,
-                                                   flags,
-                                                   &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'E') /* combined event data 1, 2, and 3 string */
-	{
-	  if ((ret = _output_event_data1_event_data2_event_data3 (ctx,
-								  &sel_entry,
-								  sel_record_type,
-								  buf,
-								  buflen,
-								  flags,
-								  &wlen,
-								  sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-	}
-      else if (percent_flag && *fmt == 'k') /* event direction */
-        {
-          if ((ret = _output_event_direction (ctx,
-                                              &sel_entry,
-                                              sel_record_type,
-                                              buf,
-                                              buflen,
-                                              flags,
-                                              &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'm') /* manufacturer id */
-        {
-          if ((ret = _output_manufacturer_id (ctx,
+        case 0:
+          ret = sel_string_snprintf (buf, buflen, &wlen, "%s", format->ops[i].literal);
+          break;
+        case 'i':               /* record id */
+          ret = sel_string_snprintf (buf, buflen, &wlen, "%u", record_id);
+          break;
+        case 'I':               /* event interpretation */
+          ret = _output_event_interpretation (ctx,
                                               &sel_entry,
                                               sel_record_type,
                                               buf,
                                               buflen,
                                               flags,
-                                              &wlen)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'o') /* oem data */
-        {
-          if ((ret = _output_oem_record_data (ctx,
+                                              &wlen);
+          break;
+        case 't':               /* time */
+          ret = _output_time (ctx,
+                              &sel_entry,
+                              sel_record_type,
+                              buf,
+                              buflen,
+                              flags,
+                              &wlen);
+          break;
+        case 'd':               /* date */
+          ret = _output_date (ctx,
+                              &sel_entry,
+                              sel_record_type,
+                              buf,
+                              buflen,
+                              flags,
+                              &wlen);
+          break;
+        case 'T':               /* sensor type */
+          ret = _output_sensor_type (ctx,
+                                     &sel_entry,
+                                     sel_record_type,
+                                     buf,
+                                     buflen,
+                                     flags,
+                                     &wlen);
+          break;
+        case 's':               /* sensor name */
+          ret = _output_sensor_name (ctx,
+                                     &sel_entry,
+                                     sel_record_type,
+                                     buf,
+                                     buflen,
+                                     flags,
+                                     &wlen,
+                                     sel_string_oem);
+          break;
+        case 'e':               /* event data1 */
+          ret = _output_event_data1 (ctx,
+                                     &sel_entry,
+                                     sel_record_type,
+                                     buf,
+                                     buflen,
+                                     flags,
+                                     &wlen,
+                                     sel_string_oem);
+          break;
+        case 'f':               /* event data2 */
+          ret = _output_event_data2 (ctx,
+                                     &sel_entry,
+                                     sel_record_type,
+                                     buf,
+                                     buflen,
+                                     flags,
+                                     &wlen,
+                                     sel_string_oem);
+          break;
+        case 'h':               /* event data3 */
+          ret = _output_event_data3 (ctx,
+                                     &sel_entry,
+                                     sel_record_type,
+                                     buf,
+                                     buflen,
+                                     flags,
+                                     &wlen,
+                                     sel_string_oem);
+          break;
+        case 'c':               /* combined event data 2 and event data 3 string */
+          ret = _output_event_data2_event_data3 (ctx,
+                                                 &sel_entry,
+                                                 sel_record_type,
+                                                 buf,
+                                                 buflen,
+                                                 flags,
+                                                 &wlen,
+                                                 sel_string_oem);
+          break;
+        case 'p':               /* event data2 previous state */
+          ret = _output_event_data2_previous_state (ctx,
+                                                    &sel_entry,
+                                                    sel_record_type,
+                                                    buf,
+                                                    buflen,
+                                                    flags,
+                                                    &wlen);
+          break;
+        case 'S':               /* event data3 severity */
+          ret = _output_event_data2_severity (ctx,
                                               &sel_entry,
                                               sel_record_type,
                                               buf,
                                               buflen,
                                               flags,
-                                              &wlen,
-					      sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else if (percent_flag && *fmt == 'O') /* OEM string */
-        {
-          if ((ret = _output_oem_string (ctx,
+                                              &wlen);
+          break;
+        case 'E':               /* combined event data 1, 2, and 3 string */
+          ret = _output_event_data1_event_data2_event_data3 (ctx,
+                                                             &sel_entry,
+                                                             sel_record_type,
+                                                             buf,
+                                                             buflen,
+                                                             flags,
+                                                             &wlen,
+                                                             sel_string_oem);
+          break;
+        case 'k':               /* event direction */
+          ret = _output_event_direction (ctx,
+                                         &sel_entry,
+                                         sel_record_type,
+                                         buf,
+                                         buflen,
+                                         flags,
+                                         &wlen);
+          break;
+        case 'm':               /* manufacturer id */
+          ret = _output_manufacturer_id (ctx,
+                                         &sel_entry,
+                                         sel_record_type,
+                                         buf,
+                                         buflen,
+                                         flags,
+                                         &wlen);
+          break;
+        case 'o':               /* oem data */
+          ret = _output_oem_record_data (ctx,
                                          &sel_entry,
                                          sel_record_type,
                                          buf,
                                          buflen,
                                          flags,
                                          &wlen,
-					 sel_string_oem)) < 0)
-            goto cleanup;
-          if (ret)
-            goto out;
-          percent_flag = 0;
-        }
-      else
-        {
-          if (percent_flag)
-            {
-              if (sel_string_snprintf (buf, buflen, &wlen, "%%%c", *fmt))
-                goto out;
-              percent_flag = 0;
-            }
-          else
-            {
-              if (sel_string_snprintf (buf, buflen, &wlen, "%c", *fmt))
-                goto out;
-            }
+                                         sel_string_oem);
+          break;
+        case 'O':               /* OEM string */
+          ret = _output_oem_string (ctx,
+                                    &sel_entry,
+                                    sel_record_type,
+                                    buf,
+                                    buflen,
+                                    flags,
+                                    &wlen,
+                                    sel_string_oem);
+          break;
+        default:
+          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
+          goto cleanup;
         }
 
-    end_loop:
-      fmt++;
+      if (ret < 0)
+        goto cleanup;
+      if (ret)
+        goto out;
     }
 
  out:
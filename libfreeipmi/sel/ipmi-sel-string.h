@@ -175,8 +175,13 @@ int sel_string_strcat_comma_separate (char *buf,
 				      unsigned int *wlen,
 				      const char *str);
 
+/* compiles fmt into a list of ops, returns NULL w/ errno set on error */
+struct ipmi_sel_format *sel_format_compile (const char *fmt);
+
+void sel_format_destroy (struct ipmi_sel_format *format);
+
 int sel_format_record_string (ipmi_sel_ctx_t ctx,
-			      const char *fmt,
+			      const struct ipmi_sel_format *format,
 			      const void *sel_record,
 			      unsigned int sel_record_len,
 			      char *buf,
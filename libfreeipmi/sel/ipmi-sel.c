@@ -132,7 +132,7 @@ ipmi_sel_ctx_create (ipmi_ctx_t ipmi_ctx, ipmi_sdr_ctx_t sdr_ctx)
 
   ctx->sel_entries_loaded = 0;
 
-  if (!(ctx->sel_entries = list_create ((ListDelF)free)))
+  if (!(ctx->obj_pool = fiid_obj_pool_create ()))
     {
       ERRNO_TRACE (errno);
       goto cleanup;
@@ -143,51 +143,109 @@ ipmi_sel_ctx_create (ipmi_ctx_t ipmi_ctx, ipmi_sdr_ctx_t sdr_ctx)
  cleanup:
   if (ctx)
     {
-      if (ctx->sel_entries)
-        list_destroy (ctx->sel_entries);
+      fiid_obj_pool_destroy (ctx->obj_pool);
       free (ctx);
     }
   return (NULL);
 }
 
-static int
-_sel_entries_delete_all (void *x, void *y)
-{
-  return (1);
-}
-
+/* storage is kept for the next parse */
 static void
 _sel_entries_clear (ipmi_sel_ctx_t ctx)
 {
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
 
-  list_delete_all (ctx->sel_entries, _sel_entries_delete_all, "dummyvalue");
+  ctx->sel_records_count = 0;
+  ctx->sel_entries_loaded = 0;
 
-  if (ctx->sel_entries_itr)
+  ctx->current_sel_record = 0;
+  ctx->callback_sel_entry = NULL;
+}
+
+static int
+_sel_entries_append (ipmi_sel_ctx_t ctx, struct ipmi_sel_entry *sel_entry)
+{
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+  assert (sel_entry);
+  assert (sel_entry->sel_event_record_len <= IPMI_SEL_RECORD_LENGTH);
+
+  if (ctx->sel_records_count == ctx->sel_records_size)
     {
-      list_iterator_destroy (ctx->sel_entries_itr);
-      ctx->sel_entries_itr = NULL;
+      unsigned int size;
+      uint8_t *records;
+      uint8_t *records_len;
+
+      size = ctx->sel_records_size ? ctx->sel_records_size * 2 : IPMI_SEL_RECORDS_MIN;
+
+      if (!(records = (uint8_t *)realloc (ctx->sel_records, size * IPMI_SEL_RECORD_LENGTH)))
+        {
+          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+      ctx->sel_records = records;
+
+      if (!(records_len = (uint8_t *)realloc (ctx->sel_records_len, size)))
+        {
+          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+      ctx->sel_records_len = records_len;
+
+      ctx->sel_records_size = size;
     }
-  ctx->sel_entries_loaded = 0;
 
-  ctx->current_sel_entry = NULL;
-  ctx->callback_sel_entry = NULL;
+  /* short records are zero padded, so the packed records are always
+   * IPMI_SEL_RECORD_LENGTH apart
+   */
+  memset (ctx->sel_records + ctx->sel_records_count * IPMI_SEL_RECORD_LENGTH,
+          '\0',
+          IPMI_SEL_RECORD_LENGTH);
+  memcpy (ctx->sel_records + ctx->sel_records_count * IPMI_SEL_RECORD_LENGTH,
+          sel_entry->sel_event_record,
+          sel_entry->sel_event_record_len);
+  ctx->sel_records_len[ctx->sel_records_count] = sel_entry->sel_event_record_len;
+  ctx->sel_records_count++;
+  return (0);
+}
+
+/* the current record, or NULL at the end of the list */
+static struct ipmi_sel_entry *
+_sel_entries_current (ipmi_sel_ctx_t ctx)
+{
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+
+  if (ctx->current_sel_record >= ctx->sel_records_count)
+    return (NULL);
+
+  memcpy (ctx->current_sel_entry.sel_event_record,
+          ctx->sel_records + ctx->current_sel_record * IPMI_SEL_RECORD_LENGTH,
+          IPMI_SEL_RECORD_LENGTH);
+  ctx->current_sel_entry.sel_event_record_len = ctx->sel_records_len[ctx->current_sel_record];
+  return (&ctx->current_sel_entry);
 }
 
 void
 ipmi_sel_ctx_destroy (ipmi_sel_ctx_t ctx)
 {
+  unsigned int i;
+
   if (!ctx || ctx->magic != IPMI_SEL_CTX_MAGIC)
     {
       ERR_TRACE (ipmi_sel_ctx_errormsg (ctx), ipmi_sel_ctx_errnum (ctx));
       return;
     }
 
+  for (i = 0; i < IPMI_SEL_FORMAT_CACHE_SIZE; i++)
+    sel_format_destroy (ctx->format_cache[i]);
   free (ctx->debug_prefix);
   free (ctx->separator);
   _sel_entries_clear (ctx);
-  list_destroy (ctx->sel_entries);
+  free (ctx->sel_records);
+  free (ctx->sel_records_len);
+  fiid_obj_pool_destroy (ctx->obj_pool);
   ctx->magic = ~IPMI_SEL_CTX_MAGIC;
   free (ctx);
 }
@@ -905,7 +963,7 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
                 Ipmi_Sel_Parse_Callback callback,
                 void *callback_data)
 {
-  struct ipmi_sel_entry *sel_entry = NULL;
+  struct ipmi_sel_entry sel_entry;
   uint16_t reservation_id = 0;
   int reservation_id_initialized = 0;
   uint16_t record_id = 0;
@@ -1008,29 +1066,23 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
 	  goto cleanup;
 	}
 
-      if (!(sel_entry = (struct ipmi_sel_entry *)malloc (sizeof (struct ipmi_sel_entry))))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OUT_OF_MEMORY);
-          goto cleanup;
-        }
-
       if ((len = fiid_obj_get_data (obj_cmd_rs,
                                     "record_data",
-                                    sel_entry->sel_event_record,
+                                    sel_entry.sel_event_record,
                                     IPMI_SEL_RECORD_LENGTH)) < 0)
         {
           SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_cmd_rs);
           goto cleanup;
         }
       
-      sel_entry->sel_event_record_len = len;
+      sel_entry.sel_event_record_len = len;
      
-      _sel_entry_dump (ctx, sel_entry);
+      _sel_entry_dump (ctx, &sel_entry);
       
-      /* achu: should come before list_append to avoid having a freed entry on the list */
+      /* achu: should come before append to avoid having a bad entry on the list */
       if (callback)
         {
-          ctx->callback_sel_entry = sel_entry;
+          ctx->callback_sel_entry = &sel_entry;
           if ((*callback)(ctx, callback_data) < 0)
             {
               SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_CALLBACK_ERROR);
@@ -1038,12 +1090,8 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
             }
         }
 
-      if (!list_append (ctx->sel_entries, sel_entry))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
-          goto cleanup;
-        }
-      sel_entry = NULL;
+      if (_sel_entries_append (ctx, &sel_entry) < 0)
+        goto cleanup;
 
       goto out;
     }
@@ -1090,29 +1138,23 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
         }
       next_record_id = val;
 
-      if (!(sel_entry = (struct ipmi_sel_entry *)malloc (sizeof (struct ipmi_sel_entry))))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OUT_OF_MEMORY);
-          goto cleanup;
-        }
-
       if ((len = fiid_obj_get_data (obj_cmd_rs,
                                     "record_data",
-                                    sel_entry->sel_event_record,
+                                    sel_entry.sel_event_record,
                                     IPMI_SEL_RECORD_LENGTH)) < 0)
         {
           SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_cmd_rs);
           goto cleanup;
         }
       
-      sel_entry->sel_event_record_len = len;
+      sel_entry.sel_event_record_len = len;
       
-      _sel_entry_dump (ctx, sel_entry);
+      _sel_entry_dump (ctx, &sel_entry);
       
-      /* achu: should come before list_append to avoid having a freed entry on the list */
+      /* achu: should come before append to avoid having a bad entry on the list */
       if (callback)
         {
-          ctx->callback_sel_entry = sel_entry;
+          ctx->callback_sel_entry = &sel_entry;
           if ((*callback)(ctx, callback_data) < 0)
             {
               SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_CALLBACK_ERROR);
@@ -1120,31 +1162,19 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
             }
         }
 
-      if (!list_append (ctx->sel_entries, sel_entry))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
-          goto cleanup;
-        }
-      sel_entry = NULL;
+      if (_sel_entries_append (ctx, &sel_entry) < 0)
+        goto cleanup;
     }
 
  out:
 
-  if ((rv = list_count (ctx->sel_entries)) > 0)
-    {
-      if (!(ctx->sel_entries_itr = list_iterator_create (ctx->sel_entries)))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
-          goto cleanup;
-        }
-      ctx->current_sel_entry = list_next (ctx->sel_entries_itr);
-    }
-  ctx->sel_entries_loaded = 1; 
+  rv = ctx->sel_records_count;
+  ctx->current_sel_record = 0;
+  ctx->sel_entries_loaded = 1;
 
   ctx->errnum = IPMI_SEL_ERR_SUCCESS;
  cleanup:
   ctx->callback_sel_entry = NULL;
-  free (sel_entry);
   fiid_obj_destroy (obj_cmd_rs);
   return (rv);
 }
@@ -1156,7 +1186,7 @@ ipmi_sel_parse_record_ids (ipmi_sel_ctx_t ctx,
                            Ipmi_Sel_Parse_Callback callback,
                            void *callback_data)
 {
-  struct ipmi_sel_entry *sel_entry = NULL;
+  struct ipmi_sel_entry sel_entry;
   uint16_t reservation_id = 0;
   int reservation_id_initialized = 0;
   unsigned int i;
@@ -1209,29 +1239,23 @@ ipmi_sel_parse_record_ids (ipmi_sel_ctx_t ctx,
           goto cleanup;
         }
 
-      if (!(sel_entry = (struct ipmi_sel_entry *)malloc (sizeof (struct ipmi_sel_entry))))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OUT_OF_MEMORY);
-          goto cleanup;
-        }
-
       if ((len = fiid_obj_get_data (obj_cmd_rs,
                                     "record_data",
-                                    sel_entry->sel_event_record,
+                                    sel_entry.sel_event_record,
                                     IPMI_SEL_RECORD_LENGTH)) < 0)
         {
           SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_cmd_rs);
           goto cleanup;
         }
       
-      sel_entry->sel_event_record_len = len;
+      sel_entry.sel_event_record_len = len;
       
-      _sel_entry_dump (ctx, sel_entry);
+      _sel_entry_dump (ctx, &sel_entry);
       
-      /* achu: should come before list_append to avoid having a freed entry on the list */
+      /* achu: should come before append to avoid having a bad entry on the list */
       if (callback)
         {
-          ctx->callback_sel_entry = sel_entry;
+          ctx->callback_sel_entry = &sel_entry;
           if ((*callback)(ctx, callback_data) < 0)
             {
               SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_CALLBACK_ERROR);
@@ -1239,30 +1263,77 @@ ipmi_sel_parse_record_ids (ipmi_sel_ctx_t ctx,
             }
         }
 
-      if (!list_append (ctx->sel_entries, sel_entry))
-        {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
-          goto cleanup;
-        }
-      sel_entry = NULL;
+      if (_sel_entries_append (ctx, &sel_entry) < 0)
+        goto cleanup;
     }
 
-  if ((rv = list_count (ctx->sel_entries)) > 0)
+  rv = ctx->sel_records_count;
+  ctx->current_sel_record = 0;
+  ctx->sel_entries_loaded = 1;
+
+  ctx->errnum = IPMI_SEL_ERR_SUCCESS;
+ cleanup:
+  ctx->callback_sel_entry = NULL;
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
+int
+ipmi_sel_parse_records (ipmi_sel_ctx_t ctx,
+                        const void *sel_records,
+                        unsigned int sel_records_count,
+                        Ipmi_Sel_Parse_Callback callback,
+                        void *callback_data)
+{
+  struct ipmi_sel_entry sel_entry;
+  unsigned int i;
+  int rv = -1;
+
+  if (!ctx || ctx->magic != IPMI_SEL_CTX_MAGIC)
     {
-      if (!(ctx->sel_entries_itr = list_iterator_create (ctx->sel_entries)))
+      ERR_TRACE (ipmi_sel_ctx_errormsg (ctx), ipmi_sel_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!sel_records && sel_records_count)
+    {
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  _sel_entries_clear (ctx);
+
+  for (i = 0; i < sel_records_count; i++)
+    {
+      memcpy (sel_entry.sel_event_record,
+              (const uint8_t *)sel_records + i * IPMI_SEL_RECORD_LENGTH,
+              IPMI_SEL_RECORD_LENGTH);
+      sel_entry.sel_event_record_len = IPMI_SEL_RECORD_LENGTH;
+
+      _sel_entry_dump (ctx, &sel_entry);
+
+      /* achu: should come before append to avoid having a bad entry on the list */
+      if (callback)
         {
-          SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
-          goto cleanup;
+          ctx->callback_sel_entry = &sel_entry;
+          if ((*callback)(ctx, callback_data) < 0)
+            {
+              SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_CALLBACK_ERROR);
+              goto cleanup;
+            }
         }
-      ctx->current_sel_entry = list_next (ctx->sel_entries_itr);
+
+      if (_sel_entries_append (ctx, &sel_entry) < 0)
+        goto cleanup;
     }
-  ctx->sel_entries_loaded = 1; 
+
+  rv = ctx->sel_records_count;
+  ctx->current_sel_record = 0;
+  ctx->sel_entries_loaded = 1;
 
   ctx->errnum = IPMI_SEL_ERR_SUCCESS;
  cleanup:
   ctx->callback_sel_entry = NULL;
-  free (sel_entry);
-  fiid_obj_destroy (obj_cmd_rs);
   return (rv);
 }
 
@@ -1281,14 +1352,13 @@ ipmi_sel_parse_first (ipmi_sel_ctx_t ctx)
       return (-1);
     }
 
-  if (!ctx->sel_entries_itr)
+  if (!ctx->sel_records_count)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NO_SEL_ENTRIES);
       return (-1);
     }
 
-  list_iterator_reset (ctx->sel_entries_itr);
-  ctx->current_sel_entry = list_next (ctx->sel_entries_itr);
+  ctx->current_sel_record = 0;
   return (0);
 }
 
@@ -1307,14 +1377,15 @@ ipmi_sel_parse_next (ipmi_sel_ctx_t ctx)
       return (-1);
     }
 
-  if (!ctx->sel_entries_itr)
+  if (!ctx->sel_records_count)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NO_SEL_ENTRIES);
       return (-1);
     }
 
-  ctx->current_sel_entry = list_next (ctx->sel_entries_itr);
-  return ((ctx->current_sel_entry) ? 1 : 0);
+  if (ctx->current_sel_record < ctx->sel_records_count)
+    ctx->current_sel_record++;
+  return ((ctx->current_sel_record < ctx->sel_records_count) ? 1 : 0);
 }
 
 int
@@ -1332,13 +1403,39 @@ ipmi_sel_parse_sel_entry_count (ipmi_sel_ctx_t ctx)
       return (-1);
     }
 
-  if (!ctx->sel_entries_itr)
+  if (!ctx->sel_records_count)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NO_SEL_ENTRIES);
       return (-1);
     }
 
-  return (list_count (ctx->sel_entries));
+  return (ctx->sel_records_count);
+}
+
+int
+ipmi_sel_parse_get_records (ipmi_sel_ctx_t ctx, const void **sel_records)
+{
+  if (!ctx || ctx->magic != IPMI_SEL_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_sel_ctx_errormsg (ctx), ipmi_sel_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!sel_records)
+    {
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (!ctx->sel_entries_loaded)
+    {
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_SEL_ENTRIES_NOT_LOADED);
+      return (-1);
+    }
+
+  *sel_records = ctx->sel_records;
+  ctx->errnum = IPMI_SEL_ERR_SUCCESS;
+  return (ctx->sel_records_count);
 }
 
 static int
@@ -1346,7 +1443,8 @@ _ipmi_sel_parse_find_record_id (ipmi_sel_ctx_t ctx,
                                 uint16_t record_id,
                                 unsigned int exact_match_flag)
 {
-  struct ipmi_sel_entry *sel_entry;
+  struct ipmi_sel_entry sel_entry;
+  unsigned int i;
   int rv = -1;
 
   if (!ctx || ctx->magic != IPMI_SEL_CTX_MAGIC)
@@ -1361,20 +1459,23 @@ _ipmi_sel_parse_find_record_id (ipmi_sel_ctx_t ctx,
       return (-1);
     }
 
-  if (!ctx->sel_entries_itr)
+  if (!ctx->sel_records_count)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NO_SEL_ENTRIES);
       return (-1);
     }
 
-  list_iterator_reset (ctx->sel_entries_itr);
-
-  while ((sel_entry = list_next (ctx->sel_entries_itr)))
+  for (i = 0; i < ctx->sel_records_count; i++)
     {
       uint16_t current_record_id;
 
+      memcpy (sel_entry.sel_event_record,
+              ctx->sel_records + i * IPMI_SEL_RECORD_LENGTH,
+              IPMI_SEL_RECORD_LENGTH);
+      sel_entry.sel_event_record_len = ctx->sel_records_len[i];
+
       if (sel_get_record_header_info (ctx,
-				      sel_entry,
+				      &sel_entry,
 				      &current_record_id,
 				      NULL) < 0)
         {
@@ -1391,13 +1492,13 @@ _ipmi_sel_parse_find_record_id (ipmi_sel_ctx_t ctx,
         {
           rv = 0;
           ctx->errnum = IPMI_SEL_ERR_SUCCESS;
-          ctx->current_sel_entry = sel_entry;
+          ctx->current_sel_record = i;
           goto cleanup;
         }
     }
 
   SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NOT_FOUND);
-  list_iterator_reset (ctx->sel_entries_itr);
+  ctx->current_sel_record = 0;
  cleanup:
   return (rv);
 }
@@ -1436,13 +1537,13 @@ _get_parse_sel_entry_common (ipmi_sel_ctx_t ctx,
 	  return (-1);
 	}
       
-      if (!ctx->sel_entries_itr)
+      if (!ctx->sel_records_count)
 	{
 	  SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_NO_SEL_ENTRIES);
 	  return (-1);
 	}
 
-      *sel_entry = ctx->current_sel_entry;
+      *sel_entry = _sel_entries_current (ctx);
     }
 
   if (!(*sel_entry))
@@ -2018,6 +2119,82 @@ ipmi_sel_parse_read_oem (ipmi_sel_ctx_t ctx,
   return (rv);
 }
 
+static int
+_get_sel_record_to_use (ipmi_sel_ctx_t ctx,
+			const void *sel_record,
+			unsigned int sel_record_len,
+			void **sel_record_to_use,
+			unsigned int *sel_record_len_to_use)
+{
+  struct ipmi_sel_entry *sel_entry = NULL;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+  assert (sel_record_to_use);
+  assert (sel_record_len_to_use);
+
+  if (!sel_record && !sel_record_len)
+    {
+      if (_get_parse_sel_entry_common (ctx, &sel_entry) < 0)
+	return (-1);
+
+      (*sel_record_to_use) = sel_entry->sel_event_record;
+      (*sel_record_len_to_use) = sel_entry->sel_event_record_len;
+    }
+  else
+    {
+      if (!sel_record
+	  || !sel_record_len)
+	{
+	  SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_PARAMETERS);
+	  return (-1);
+	}
+
+      (*sel_record_to_use) = (void *)sel_record;
+      (*sel_record_len_to_use) = sel_record_len;
+    }
+
+  if ((*sel_record_len_to_use) < IPMI_SEL_RECORD_LENGTH)
+    {
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* Callers pass a handful of constant format strings over and over,
+ * keep them compiled.
+ */
+static struct ipmi_sel_format *
+_sel_format_cache_get (ipmi_sel_ctx_t ctx, const char *fmt)
+{
+  struct ipmi_sel_format *format;
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+  assert (fmt);
+
+  for (i = 0; i < IPMI_SEL_FORMAT_CACHE_SIZE; i++)
+    {
+      if (ctx->format_cache[i]
+	  && !strcmp (ctx->format_cache[i]->fmt, fmt))
+	return (ctx->format_cache[i]);
+    }
+
+  if (!(format = sel_format_compile (fmt)))
+    {
+      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
+      return (NULL);
+    }
+
+  sel_format_destroy (ctx->format_cache[ctx->format_cache_next]);
+  ctx->format_cache[ctx->format_cache_next] = format;
+  ctx->format_cache_next = (ctx->format_cache_next + 1) % IPMI_SEL_FORMAT_CACHE_SIZE;
+  return (format);
+}
+
 int
 ipmi_sel_parse_read_record_string (ipmi_sel_ctx_t ctx,
                                    const char *fmt,
@@ -2027,7 +2204,7 @@ ipmi_sel_parse_read_record_string (ipmi_sel_ctx_t ctx,
                                    unsigned int buflen,
                                    unsigned int flags)
 {
-  struct ipmi_sel_entry *sel_entry = NULL;
+  struct ipmi_sel_format *format;
   void *sel_record_to_use;
   unsigned int sel_record_len_to_use;
 
@@ -2046,35 +2223,91 @@ ipmi_sel_parse_read_record_string (ipmi_sel_ctx_t ctx,
       return (-1);
     }
 
-  if (!sel_record && !sel_record_len)
-    {
-      if (_get_parse_sel_entry_common (ctx, &sel_entry) < 0)
-	return (-1);
+  if (_get_sel_record_to_use (ctx,
+			      sel_record,
+			      sel_record_len,
+			      &sel_record_to_use,
+			      &sel_record_len_to_use) < 0)
+    return (-1);
+
+  if (!(format = _sel_format_cache_get (ctx, fmt)))
+    return (-1);
 
-      sel_record_to_use = sel_entry->sel_event_record;
-      sel_record_len_to_use = sel_entry->sel_event_record_len;
+  return (sel_format_record_string (ctx,
+				    format,
+				    sel_record_to_use,
+				    sel_record_len_to_use,
+				    buf,
+				    buflen,
+				    flags));
+}
+
+ipmi_sel_format_t
+ipmi_sel_format_compile (const char *fmt)
+{
+  struct ipmi_sel_format *format;
+
+  if (!fmt)
+    {
+      SET_ERRNO (EINVAL);
+      return (NULL);
     }
-  else
+
+  if (!(format = sel_format_compile (fmt)))
     {
-      if (!sel_record
-	  || !sel_record_len)
-	{
-	  SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_PARAMETERS);
-	  return (-1);
-	}
+      ERRNO_TRACE (errno);
+      return (NULL);
+    }
+
+  return (format);
+}
+
+void
+ipmi_sel_format_destroy (ipmi_sel_format_t format)
+{
+  if (!format || format->magic != IPMI_SEL_FORMAT_MAGIC)
+    return;
+
+  sel_format_destroy (format);
+}
+
+int
+ipmi_sel_parse_format_record_string (ipmi_sel_ctx_t ctx,
+				     ipmi_sel_format_t format,
+				     const void *sel_record,
+				     unsigned int sel_record_len,
+				     char *buf,
+				     unsigned int buflen,
+				     unsigned int flags)
+{
+  void *sel_record_to_use;
+  unsigned int sel_record_len_to_use;
 
-      sel_record_to_use = (void *)sel_record;
-      sel_record_len_to_use = sel_record_len;
+  if (!ctx || ctx->magic != IPMI_SEL_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_sel_ctx_errormsg (ctx), ipmi_sel_ctx_errnum (ctx));
+      return (-1);
     }
 
-  if (sel_record_len_to_use < IPMI_SEL_RECORD_LENGTH)
+  if (!format
+      || format->magic != IPMI_SEL_FORMAT_MAGIC
+      || !buf
+      || !buflen
+      || (flags & ~IPMI_SEL_STRING_FLAGS_MASK))
     {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_PARAMETERS);
       return (-1);
     }
 
+  if (_get_sel_record_to_use (ctx,
+			      sel_record,
+			      sel_record_len,
+			      &sel_record_to_use,
+			      &sel_record_len_to_use) < 0)
+    return (-1);
+
   return (sel_format_record_string (ctx,
-				    fmt,
+				    format,
 				    sel_record_to_use,
 				    sel_record_len_to_use,
 				    buf,
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <sys/param.h>
 
+#include "freeipmi/fiid/fiid.h"
 #include "freeipmi/sdr/ipmi-sdr.h"
 #include "freeipmi/sensor-read/ipmi-sensor-read.h"
 
@@ -37,6 +38,11 @@
 
 #define IPMI_SENSOR_READ_CTX_MAGIC 0xABCD1246
 
+/* one Get Sensor Reading response per sensor number */
+#define IPMI_SENSOR_READ_PREFETCH_MAX    256
+
+#define IPMI_SENSOR_READ_PREFETCH_BUFLEN 256
+
 #define IPMI_SENSOR_READ_FLAGS_MASK                  \
   (IPMI_SENSOR_READ_FLAGS_BRIDGE_SENSORS             \
    | IPMI_SENSOR_READ_FLAGS_DISCRETE_READING         \
@@ -50,6 +56,11 @@ struct ipmi_sensor_read_ctx {
 
   ipmi_ctx_t ipmi_ctx;
   ipmi_sdr_ctx_t sdr_ctx;
+
+  /* responses from ipmi_sensor_read_prefetch(), indexed by sensor
+   * number, NULL if none or already consumed
+   */
+  fiid_obj_t prefetch_rs[IPMI_SENSOR_READ_PREFETCH_MAX];
 };
 
 #endif /* IPMI_SENSOR_READ_DEFS_H */
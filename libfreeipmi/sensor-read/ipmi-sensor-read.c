@@ -40,6 +40,8 @@
 #include "freeipmi/record-format/ipmi-sdr-record-format.h"
 #include "freeipmi/spec/ipmi-channel-spec.h"
 #include "freeipmi/spec/ipmi-comp-code-spec.h"
+#include "freeipmi/spec/ipmi-ipmb-lun-spec.h"
+#include "freeipmi/spec/ipmi-netfn-spec.h"
 #include "freeipmi/spec/ipmi-slave-address-spec.h"
 #include "freeipmi/spec/ipmi-sensor-units-spec.h"
 #include "freeipmi/util/ipmi-sensor-and-event-code-tables-util.h"
@@ -127,12 +129,28 @@ ipmi_sensor_read_ctx_create (ipmi_ctx_t ipmi_ctx)
   return (NULL);
 }
 
+static void
+_sensor_read_prefetch_clear (ipmi_sensor_read_ctx_t ctx)
+{
+  unsigned int i;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SENSOR_READ_CTX_MAGIC);
+
+  for (i = 0; i < IPMI_SENSOR_READ_PREFETCH_MAX; i++)
+    {
+      fiid_obj_destroy (ctx->prefetch_rs[i]);
+      ctx->prefetch_rs[i] = NULL;
+    }
+}
+
 void
 ipmi_sensor_read_ctx_destroy (ipmi_sensor_read_ctx_t ctx)
 {
   if (!ctx || ctx->magic != IPMI_SENSOR_READ_CTX_MAGIC)
     return;
 
+  _sensor_read_prefetch_clear (ctx);
   ctx->magic = ~IPMI_SENSOR_READ_CTX_MAGIC;
   ipmi_sdr_ctx_destroy (ctx->sdr_ctx);
   free (ctx);
@@ -314,6 +332,51 @@ _get_sensor_reading (ipmi_sensor_read_ctx_t ctx,
   assert (ctx->magic == IPMI_SENSOR_READ_CTX_MAGIC);
   assert (obj_cmd_rs);
 
+  if (ctx->prefetch_rs[sensor_number])
+    {
+      fiid_obj_t obj_prefetch_rs = ctx->prefetch_rs[sensor_number];
+      uint8_t buf[IPMI_SENSOR_READ_PREFETCH_BUFLEN];
+      int len;
+      int ret;
+
+      /* a prefetched reading is used only once */
+      ctx->prefetch_rs[sensor_number] = NULL;
+
+      if ((len = fiid_obj_get_all (obj_prefetch_rs,
+                                   buf,
+                                   IPMI_SENSOR_READ_PREFETCH_BUFLEN)) < 0)
+        {
+          SENSOR_READ_FIID_OBJECT_ERROR_TO_SENSOR_READ_ERRNUM (ctx, obj_prefetch_rs);
+          fiid_obj_destroy (obj_prefetch_rs);
+          goto cleanup;
+        }
+      fiid_obj_destroy (obj_prefetch_rs);
+
+      if (fiid_obj_set_all (obj_cmd_rs, buf, len) < 0)
+        {
+          SENSOR_READ_FIID_OBJECT_ERROR_TO_SENSOR_READ_ERRNUM (ctx, obj_cmd_rs);
+          goto cleanup;
+        }
+
+      /* ipmi_cmd_pipeline() does not check completion codes */
+      if ((ret = ipmi_check_completion_code_success (obj_cmd_rs)) < 0)
+        {
+          SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (!ret)
+        {
+          if (_sensor_reading_corner_case_checks (ctx, obj_cmd_rs) < 0)
+            goto cleanup;
+          SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_IPMI_ERROR);
+          goto cleanup;
+        }
+
+      rv = 0;
+      goto cleanup;
+    }
+
   if (ipmi_cmd_get_sensor_reading (ctx->ipmi_ctx,
                                    sensor_number,
                                    obj_cmd_rs) < 0)
@@ -380,6 +443,136 @@ _get_sensor_reading_ipmb (ipmi_sensor_read_ctx_t ctx,
   return (rv);
 }
 
+int
+ipmi_sensor_read_prefetch (ipmi_sensor_read_ctx_t ctx,
+                           const uint8_t *sensor_numbers,
+                           unsigned int sensor_numbers_len)
+{
+  fiid_obj_t *obj_cmd_rq = NULL;
+  fiid_obj_t *obj_cmd_rs = NULL;
+  unsigned int ctx_flags_orig;
+  int ctx_flags_set = 0;
+  unsigned int i;
+  int rv = -1;
+
+  if (!ctx || ctx->magic != IPMI_SENSOR_READ_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_sensor_read_ctx_errormsg (ctx), ipmi_sensor_read_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!sensor_numbers
+      || !sensor_numbers_len)
+    {
+      SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  _sensor_read_prefetch_clear (ctx);
+
+  if (!(obj_cmd_rq = (fiid_obj_t *)calloc (sensor_numbers_len, sizeof (fiid_obj_t))))
+    {
+      SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+      goto cleanup;
+    }
+
+  if (!(obj_cmd_rs = (fiid_obj_t *)calloc (sensor_numbers_len, sizeof (fiid_obj_t))))
+    {
+      SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+      goto cleanup;
+    }
+
+  for (i = 0; i < sensor_numbers_len; i++)
+    {
+      if (!(obj_cmd_rq[i] = fiid_obj_create (tmpl_cmd_get_sensor_reading_rq)))
+        {
+          SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (!(obj_cmd_rs[i] = fiid_obj_create (tmpl_cmd_get_sensor_reading_rs)))
+        {
+          SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+
+      if (fill_cmd_get_sensor_reading (sensor_numbers[i], obj_cmd_rq[i]) < 0)
+        {
+          SENSOR_READ_ERRNO_TO_SENSOR_READ_ERRNUM (ctx, errno);
+          goto cleanup;
+        }
+    }
+
+  /* 
+   * IPMI Workaround (achu)
+   *
+   * See comments in ipmi_sensor_read() concerning
+   * sensor_event_bitmask.
+   */
+
+  if (ipmi_ctx_get_flags (ctx->ipmi_ctx, &ctx_flags_orig) < 0)
+    {
+      SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_INTERNAL_ERROR);
+      goto cleanup;
+    }
+
+  if (ipmi_ctx_set_flags (ctx->ipmi_ctx, ctx_flags_orig | IPMI_FLAGS_NO_VALID_CHECK) < 0)
+    {
+      SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_INTERNAL_ERROR);
+      goto cleanup;
+    }
+  ctx_flags_set++;
+
+  if (ipmi_cmd_pipeline (ctx->ipmi_ctx,
+                         IPMI_BMC_IPMB_LUN_BMC,
+                         IPMI_NET_FN_SENSOR_EVENT_RQ,
+                         obj_cmd_rq,
+                         obj_cmd_rs,
+                         sensor_numbers_len) < 0)
+    {
+      SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_IPMI_ERROR);
+      goto cleanup;
+    }
+
+  /* duplicate sensor numbers keep the first response, later reads
+   * of the same sensor go to the BMC
+   */
+  for (i = 0; i < sensor_numbers_len; i++)
+    {
+      if (ctx->prefetch_rs[sensor_numbers[i]])
+        continue;
+
+      ctx->prefetch_rs[sensor_numbers[i]] = obj_cmd_rs[i];
+      obj_cmd_rs[i] = NULL;
+    }
+
+  rv = 0;
+  ctx->errnum = IPMI_SENSOR_READ_ERR_SUCCESS;
+ cleanup:
+  if (ctx_flags_set)
+    {
+      if (ipmi_ctx_set_flags (ctx->ipmi_ctx, ctx_flags_orig) < 0)
+        {
+          SENSOR_READ_SET_ERRNUM (ctx, IPMI_SENSOR_READ_ERR_INTERNAL_ERROR);
+          _sensor_read_prefetch_clear (ctx);
+          rv = -1;
+        }
+    }
+  if (obj_cmd_rq)
+    {
+      for (i = 0; i < sensor_numbers_len; i++)
+        fiid_obj_destroy (obj_cmd_rq[i]);
+      free (obj_cmd_rq);
+    }
+  if (obj_cmd_rs)
+    {
+      for (i = 0; i < sensor_numbers_len; i++)
+        fiid_obj_destroy (obj_cmd_rs[i]);
+      free (obj_cmd_rs);
+    }
+  return (rv);
+}
+
 int
 ipmi_sensor_read (ipmi_sensor_read_ctx_t ctx,
                   const void *sdr_record,
@@ -855,6 +855,16 @@ __ipmiconsole_ctx_connection_cleanup (ipmiconsole_ctx_t c, int session_submitted
 
   secure_malloc_flag = (c->config.engine_flags & IPMICONSOLE_ENGINE_LOCK_MEMORY) ? 1 : 0;
 
+  /* If the engine is torn down from another thread, the engine
+   * thread's cached handles are closed when it exits.
+   */
+  if (c->session.crypt_cache_flag)
+    {
+      if (pthread_equal (c->session.crypt_cache_thread, pthread_self ()))
+        ipmi_rmcpplus_crypt_cache_end ();
+      c->session.crypt_cache_flag = 0;
+    }
+
   /* We have to cleanup, so in general continue on even if locking fails */
 
   if ((perr = pthread_mutex_lock (&(c->signal.status_mutex))) != 0)
@@ -372,6 +372,12 @@ struct ipmiconsole_ctx_session {
   int close_timeout_flag;
   int deactivate_only_succeeded_flag;
 
+  /* Crypt handles are cached in the engine thread processing this
+   * session, see ipmi_rmcpplus_crypt_cache_start().
+   */
+  int crypt_cache_flag;
+  pthread_t crypt_cache_thread;
+
   /*
    * Protocol Maintenance Variables
    */
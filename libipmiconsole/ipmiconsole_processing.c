@@ -3028,6 +3028,22 @@ _process_protocol_state_start (ipmiconsole_ctx_t c)
   assert (c);
   assert (c->magic == IPMICONSOLE_CTX_MAGIC);
 
+  /* Keep keyed crypt handles open for the session's packets, this is
+   * the engine thread that assembles and unassembles them.  Not
+   * fatal, handles are opened per packet otherwise.  May start over
+   * on a new port, the session is only counted once.
+   */
+  if (!c->session.crypt_cache_flag)
+    {
+      if (!ipmi_rmcpplus_crypt_cache_start ())
+        {
+          c->session.crypt_cache_flag++;
+          c->session.crypt_cache_thread = pthread_self ();
+        }
+      else
+        IPMICONSOLE_CTX_DEBUG (c, ("ipmi_rmcpplus_crypt_cache_start: %s", strerror (errno)));
+    }
+
   if (_send_ipmi_packet (c, IPMICONSOLE_PACKET_TYPE_GET_AUTHENTICATION_CAPABILITIES_RQ) < 0)
     /* The session isn't setup, no need to attempt to close it cleanly */
     return (-1);
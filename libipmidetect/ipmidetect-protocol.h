@@ -0,0 +1,171 @@
+/*****************************************************************************\
+ *  Copyright (C) 2007-2015 Lawrence Livermore National Security, LLC.
+ *  Copyright (C) 2007 The Regents of the University of California.
+ *  Produced at Lawrence Livermore National Laboratory (cf, DISCLAIMER).
+ *  Written by Albert Chu <chu11@llnl.gov>
+ *  UCRL-CODE-228523
+ *
+ *  This file is part of Ipmidetect, tools and libraries for detecting
+ *  IPMI nodes in a cluster. For details, see http://www.llnl.gov/linux/.
+ *
+ *  Ipmidetect is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  Ipmidetect is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Ipmidetect.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#ifndef IPMIDETECT_PROTOCOL_H
+#define IPMIDETECT_PROTOCOL_H
+
+#include <stdint.h>
+
+/* Binary query protocol, served by ipmidetectd on a unix socket.
+ *
+ * The client sends one request and the daemon answers with one
+ * response, then closes the connection.  All integers are in network
+ * byte order.
+ *
+ * Request:
+ *   uint32_t magic
+ *   uint32_t version
+ *   uint64_t epoch          - epoch of the client's node table, 0 if none
+ *   uint64_t generation     - generation of the client's node table
+ *
+ * Response:
+ *   uint32_t magic
+ *   uint32_t version
+ *   uint64_t epoch          - epoch of the daemon's node table
+ *   uint64_t generation     - current generation of the daemon's node table
+ *   uint32_t flags
+ *   uint32_t nodes_count    - number of nodes the daemon pings
+ *   uint32_t names_len      - length of names, 0 if FLAGS_FULL not set
+ *   uint32_t records_count
+ *   char names[names_len]   - nodes_count NUL terminated hostnames,
+ *                             ordered by node id
+ *   records_count records of
+ *     uint32_t node_id
+ *     uint64_t last_received - seconds since the Epoch, 0 if never
+ *
+ * Node ids index the daemon's node table and are only valid for the
+ * epoch they were sent with.  If the request's epoch does not match
+ * the daemon's, the response has FLAGS_FULL set and carries the names
+ * and a record for every node.  Otherwise the response carries a
+ * record for each node whose last_received changed after the
+ * request's generation.
+ */
+
+#define IPMIDETECT_PROTOCOL_MAGIC             0x49504454
+#define IPMIDETECT_PROTOCOL_VERSION           1
+
+#define IPMIDETECT_PROTOCOL_FLAGS_FULL        0x00000001
+
+#define IPMIDETECT_PROTOCOL_REQUEST_LEN       24
+#define IPMIDETECT_PROTOCOL_RESPONSE_HDR_LEN  40
+#define IPMIDETECT_PROTOCOL_RECORD_LEN        12
+
+#define IPMIDETECT_PROTOCOL_SOCKET_DEFAULT    IPMIDETECT_LOCALSTATEDIR "/run/ipmidetectd.sock"
+
+#define IPMIDETECT_PROTOCOL_PUT_U32(__buf, __val)             \
+  do {                                                        \
+    (__buf)[0] = ((uint32_t)(__val) >> 24) & 0xFF;            \
+    (__buf)[1] = ((uint32_t)(__val) >> 16) & 0xFF;            \
+    (__buf)[2] = ((uint32_t)(__val) >> 8) & 0xFF;             \
+    (__buf)[3] = (uint32_t)(__val) & 0xFF;                    \
+  } while (0)
+
+#define IPMIDETECT_PROTOCOL_PUT_U64(__buf, __val)                     \
+  do {                                                                \
+    IPMIDETECT_PROTOCOL_PUT_U32 ((__buf), (uint64_t)(__val) >> 32);   \
+    IPMIDETECT_PROTOCOL_PUT_U32 ((__buf) + 4, (__val));               \
+  } while (0)
+
+#define IPMIDETECT_PROTOCOL_GET_U32(__buf)    \
+  (((uint32_t)(__buf)[0] << 24)               \
+   | ((uint32_t)(__buf)[1] << 16)             \
+   | ((uint32_t)(__buf)[2] << 8)              \
+   | (uint32_t)(__buf)[3])
+
+#define IPMIDETECT_PROTOCOL_GET_U64(__buf)                    \
+  (((uint64_t)IPMIDETECT_PROTOCOL_GET_U32 ((__buf)) << 32)    \
+   | IPMIDETECT_PROTOCOL_GET_U32 ((__buf) + 4))
+
+/* Shared detection table, optionally published by ipmidetectd in a
+ * file readers map read-only.  Integers are in host byte order, the
+ * table is only for clients on the same host.
+ *
+ * Layout, offsets in bytes from the start of the file:
+ *
+ *   struct ipmidetect_table_header
+ *   uint64_t timestamps[nodes_count]     - last received, seconds since
+ *                                          the Epoch, 0 if never
+ *   uint32_t index[index_size]           - hash of hostnames, node id + 1
+ *                                          or 0 if empty, linear probing
+ *                                          from ipmidetect_table_hash()
+ *                                          mod index_size
+ *   uint32_t name_offsets[nodes_count]   - offset of each hostname in names
+ *   char names[names_len]                - NUL terminated hostnames
+ *
+ * Only timestamps, seq, and closed change after the table is
+ * published.  The daemon makes seq odd while it updates timestamps
+ * and even again when done.  Readers retry a read if seq was odd or
+ * changed across it.  When the daemon exits, it sets closed and
+ * removes the file, so readers know to attach to the next daemon's
+ * table.
+ */
+
+#define IPMIDETECT_TABLE_MAGIC                0x49504454
+#define IPMIDETECT_TABLE_VERSION              1
+
+#define IPMIDETECT_TABLE_DEFAULT              IPMIDETECT_LOCALSTATEDIR "/run/ipmidetectd.table"
+
+struct ipmidetect_table_header
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t epoch;
+  volatile uint64_t seq;
+  volatile uint32_t closed;
+  uint32_t nodes_count;
+  uint32_t timestamps_offset;
+  uint32_t index_offset;
+  uint32_t index_size;
+  uint32_t name_offsets_offset;
+  uint32_t names_offset;
+  uint32_t names_len;
+  uint32_t table_len;
+  uint32_t reserved;
+};
+
+/* 32-bit FNV-1a of a hostname.  Part of the table format, daemon and
+ * readers must hash identically, so it may only change along with
+ * IPMIDETECT_TABLE_VERSION.
+ */
+static inline uint32_t
+ipmidetect_table_hash (const char *str)
+{
+  const unsigned char *p;
+  uint32_t hval = 2166136261U;
+
+  for (p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+      hval ^= *p;
+      hval *= 16777619U;
+    }
+  return (hval);
+}
+
+#if defined (__GNUC__)
+#define IPMIDETECT_TABLE_BARRIER() __sync_synchronize ()
+#else /* !__GNUC__ */
+#define IPMIDETECT_TABLE_BARRIER()
+#endif /* !__GNUC__ */
+
+#endif /* IPMIDETECT_PROTOCOL_H */
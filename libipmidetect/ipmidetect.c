@@ -38,6 +38,7 @@
 #endif /* HAVE_STRINGS_H */
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #if HAVE_FCNTL_H
 #include <fcntl.h>
 #endif /* HAVE_FCNTL_H */
@@ -47,6 +48,7 @@
 #include <netinet/in.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/types.h>
 #include <sys/select.h>
 #if TIME_WITH_SYS_TIME
@@ -63,10 +65,12 @@
 #include <errno.h>
 
 #include "ipmidetect.h"
+#include "ipmidetect-protocol.h"
 
 #include "conffile.h"
 #include "fd.h"
 #include "freeipmi-portability.h"
+#include "hash.h"
 #include "hostlist.h"
 
 /*
@@ -112,6 +116,7 @@ static char * ipmidetect_errmsg[] =
 #define IPMIDETECT_PORT_DEFAULT         9225
 #define IPMIDETECT_TIMEOUT_LEN_DEFAULT  60
 #define IPMIDETECT_BACKEND_CONNECT_LEN  5
+#define IPMIDETECT_TABLE_READ_RETRIES   1000
 
 
 struct ipmidetect {
@@ -120,6 +125,21 @@ struct ipmidetect {
   int load_state;
   hostlist_t detected_nodes;
   hostlist_t undetected_nodes;
+  /* node table kept by ipmidetect_update_data() */
+  uint64_t epoch;
+  uint64_t generation;
+  unsigned int nodes_count;
+  char *names;
+  char **nodes;
+  uint64_t *last_received;
+  hash_t nodes_index;
+  /* shared table mapped by ipmidetect_attach_data() */
+  char *table_path;
+  struct ipmidetect_table_header *table;
+  unsigned int table_len;
+  time_t load_time;
+  int timeout_len;
+  int conffile_timeout_len;
 };
 
 struct ipmidetect_config
@@ -217,6 +237,19 @@ _initialize_handle (ipmidetect_t handle)
   handle->load_state = IPMIDETECT_LOAD_STATE_UNLOADED;
   handle->detected_nodes = NULL;
   handle->undetected_nodes = NULL;
+  handle->epoch = 0;
+  handle->generation = 0;
+  handle->nodes_count = 0;
+  handle->names = NULL;
+  handle->nodes = NULL;
+  handle->last_received = NULL;
+  handle->nodes_index = NULL;
+  handle->table_path = NULL;
+  handle->table = NULL;
+  handle->table_len = 0;
+  handle->load_time = 0;
+  handle->timeout_len = 0;
+  handle->conffile_timeout_len = 0;
 }
 
 ipmidetect_t
@@ -242,6 +275,14 @@ _free_handle_data (ipmidetect_t handle)
 {
   hostlist_destroy (handle->detected_nodes);
   hostlist_destroy (handle->undetected_nodes);
+  if (handle->nodes_index)
+    hash_destroy (handle->nodes_index);
+  free (handle->names);
+  free (handle->nodes);
+  free (handle->last_received);
+  if (handle->table)
+    munmap (handle->table, handle->table_len);
+  free (handle->table_path);
   _initialize_handle (handle);
 }
 
@@ -669,6 +710,526 @@ ipmidetect_load_data (ipmidetect_t handle,
   return (-1);
 }
 
+static int
+_unix_connect (ipmidetect_t handle, const char *socket_path)
+{
+  struct sockaddr_un addr;
+  struct timeval tv;
+  int fd = -1;
+
+  if (strlen (socket_path) >= sizeof (addr.sun_path))
+    {
+      handle->errnum = IPMIDETECT_ERR_PARAMETERS;
+      return (-1);
+    }
+
+  if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  memset (&addr, '\0', sizeof (struct sockaddr_un));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, socket_path);
+
+  if (connect (fd, (struct sockaddr *)&addr, sizeof (struct sockaddr_un)) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_CONNECT;
+      goto cleanup;
+    }
+
+  tv.tv_sec = IPMIDETECT_BACKEND_CONNECT_LEN;
+  tv.tv_usec = 0;
+  if (setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv)) < 0
+      || setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof (tv)) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  return (fd);
+
+ cleanup:
+  /* ignore potential error, error path */
+  close (fd);
+  return (-1);
+}
+
+/*
+ * _read_all
+ *
+ * read exactly len bytes, a short read is a protocol error
+ *
+ * Returns 0 on success, -1 on error
+ */
+static int
+_read_all (ipmidetect_t handle, int fd, void *buf, unsigned int len)
+{
+  ssize_t n;
+
+  if ((n = fd_read_n (fd, buf, len)) < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        handle->errnum = IPMIDETECT_ERR_CONNECT_TIMEOUT;
+      else
+        handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      return (-1);
+    }
+
+  if (n != len)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      return (-1);
+    }
+
+  return (0);
+}
+
+/*
+ * _load_names
+ *
+ * build a new node table from the names of a full response, the
+ * handle is only modified on success
+ *
+ * Returns 0 on success, -1 on error
+ */
+static int
+_load_names (ipmidetect_t handle,
+             int fd,
+             unsigned int nodes_count,
+             unsigned int names_len)
+{
+  char *names = NULL;
+  char **nodes = NULL;
+  uint64_t *last_received = NULL;
+  hash_t nodes_index = NULL;
+  unsigned int i, offset = 0;
+
+  if (!nodes_count
+      || names_len < nodes_count * 2)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  if (!(names = (char *)malloc (names_len))
+      || !(nodes = (char **)malloc (nodes_count * sizeof (char *)))
+      || !(last_received = (uint64_t *)calloc (nodes_count, sizeof (uint64_t)))
+      || !(nodes_index = hash_create (nodes_count,
+                                      (hash_key_f)hash_key_string,
+                                      (hash_cmp_f)strcmp,
+                                      NULL)))
+    {
+      handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+      goto cleanup;
+    }
+
+  if (_read_all (handle, fd, names, names_len) < 0)
+    goto cleanup;
+
+  if (names[names_len - 1] != '\0')
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  for (i = 0; i < nodes_count; i++)
+    {
+      if (offset >= names_len)
+        {
+          handle->errnum = IPMIDETECT_ERR_INTERNAL;
+          goto cleanup;
+        }
+
+      nodes[i] = names + offset;
+      offset += strlen (nodes[i]) + 1;
+
+      if (!hash_insert (nodes_index, nodes[i], &nodes[i]))
+        {
+          if (errno == ENOMEM)
+            handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+          else
+            handle->errnum = IPMIDETECT_ERR_INTERNAL;
+          goto cleanup;
+        }
+    }
+
+  if (handle->nodes_index)
+    hash_destroy (handle->nodes_index);
+  free (handle->names);
+  free (handle->nodes);
+  free (handle->last_received);
+
+  handle->nodes_count = nodes_count;
+  handle->names = names;
+  handle->nodes = nodes;
+  handle->last_received = last_received;
+  handle->nodes_index = nodes_index;
+  return (0);
+
+ cleanup:
+  if (nodes_index)
+    hash_destroy (nodes_index);
+  free (names);
+  free (nodes);
+  free (last_received);
+  return (-1);
+}
+
+static int
+_update_data (ipmidetect_t handle, const char *socket_path)
+{
+  uint8_t buf[IPMIDETECT_PROTOCOL_RESPONSE_HDR_LEN];
+  uint8_t *records = NULL;
+  uint32_t flags, nodes_count, names_len, records_count;
+  uint64_t epoch, generation;
+  struct timeval tv;
+  unsigned int i;
+  int fd, rv = -1;
+
+  if ((fd = _unix_connect (handle, socket_path)) < 0)
+    goto cleanup;
+
+  IPMIDETECT_PROTOCOL_PUT_U32 (buf, IPMIDETECT_PROTOCOL_MAGIC);
+  IPMIDETECT_PROTOCOL_PUT_U32 (buf + 4, IPMIDETECT_PROTOCOL_VERSION);
+  IPMIDETECT_PROTOCOL_PUT_U64 (buf + 8, handle->epoch);
+  IPMIDETECT_PROTOCOL_PUT_U64 (buf + 16, handle->generation);
+
+  /* Call gettimeofday at the latest point right before getting data. */
+  if (gettimeofday (&tv, NULL) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  if (fd_write_n (fd, buf, IPMIDETECT_PROTOCOL_REQUEST_LEN) != IPMIDETECT_PROTOCOL_REQUEST_LEN)
+    {
+      handle->errnum = IPMIDETECT_ERR_CONNECT;
+      goto cleanup;
+    }
+
+  if (_read_all (handle, fd, buf, IPMIDETECT_PROTOCOL_RESPONSE_HDR_LEN) < 0)
+    goto cleanup;
+
+  if (IPMIDETECT_PROTOCOL_GET_U32 (buf) != IPMIDETECT_PROTOCOL_MAGIC
+      || IPMIDETECT_PROTOCOL_GET_U32 (buf + 4) != IPMIDETECT_PROTOCOL_VERSION)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  epoch = IPMIDETECT_PROTOCOL_GET_U64 (buf + 8);
+  generation = IPMIDETECT_PROTOCOL_GET_U64 (buf + 16);
+  flags = IPMIDETECT_PROTOCOL_GET_U32 (buf + 24);
+  nodes_count = IPMIDETECT_PROTOCOL_GET_U32 (buf + 28);
+  names_len = IPMIDETECT_PROTOCOL_GET_U32 (buf + 32);
+  records_count = IPMIDETECT_PROTOCOL_GET_U32 (buf + 36);
+
+  if (flags & IPMIDETECT_PROTOCOL_FLAGS_FULL)
+    {
+      if (_load_names (handle, fd, nodes_count, names_len) < 0)
+        goto cleanup;
+      /* a failure below must not leave a half loaded table behind */
+      handle->epoch = 0;
+    }
+  else if (epoch != handle->epoch
+           || nodes_count != handle->nodes_count
+           || names_len)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  if (records_count > nodes_count)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  if (records_count)
+    {
+      if (!(records = (uint8_t *)malloc (records_count * IPMIDETECT_PROTOCOL_RECORD_LEN)))
+        {
+          handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+          goto cleanup;
+        }
+
+      if (_read_all (handle,
+                     fd,
+                     records,
+                     records_count * IPMIDETECT_PROTOCOL_RECORD_LEN) < 0)
+        goto cleanup;
+
+      for (i = 0; i < records_count; i++)
+        {
+          uint8_t *record = records + i * IPMIDETECT_PROTOCOL_RECORD_LEN;
+          uint32_t node_id = IPMIDETECT_PROTOCOL_GET_U32 (record);
+
+          if (node_id >= handle->nodes_count)
+            {
+              handle->errnum = IPMIDETECT_ERR_INTERNAL;
+              goto cleanup;
+            }
+
+          handle->last_received[node_id] = IPMIDETECT_PROTOCOL_GET_U64 (record + 4);
+        }
+    }
+
+  handle->epoch = epoch;
+  handle->generation = generation;
+  handle->load_time = tv.tv_sec;
+  rv = 0;
+ cleanup:
+  free (records);
+  /* ignore potential error, done w/ fd */
+  close (fd);
+  return (rv);
+}
+
+/*
+ * _resolve_timeout_len
+ *
+ * fall back to the config file or default timeout length, the config
+ * file is only read once per handle
+ *
+ * Returns timeout length on success, -1 on error
+ */
+static int
+_resolve_timeout_len (ipmidetect_t handle, int timeout_len)
+{
+  if (timeout_len > 0)
+    return (timeout_len);
+
+  if (!handle->conffile_timeout_len)
+    {
+      struct ipmidetect_config conffile_config;
+
+      memset (&conffile_config, '\0', sizeof (struct ipmidetect_config));
+
+      if (_read_conffile (handle, &conffile_config) < 0)
+        return (-1);
+
+      if (conffile_config.timeout_len_flag)
+        {
+          if (conffile_config.timeout_len <= 0)
+            {
+              handle->errnum = IPMIDETECT_ERR_CONF_INPUT;
+              return (-1);
+            }
+          handle->conffile_timeout_len = conffile_config.timeout_len;
+        }
+      else
+        handle->conffile_timeout_len = IPMIDETECT_TIMEOUT_LEN_DEFAULT;
+    }
+
+  return (handle->conffile_timeout_len);
+}
+
+int
+ipmidetect_update_data (ipmidetect_t handle,
+                        const char *socket_path,
+                        int timeout_len)
+{
+  if (_ipmidetect_handle_error_check (handle) < 0)
+    return (-1);
+
+  /* data loaded with ipmidetect_load_data() can't be updated */
+  if (handle->load_state != IPMIDETECT_LOAD_STATE_UNLOADED
+      && !handle->nodes_index)
+    {
+      handle->errnum = IPMIDETECT_ERR_ISLOADED;
+      return (-1);
+    }
+
+  if ((timeout_len = _resolve_timeout_len (handle, timeout_len)) < 0)
+    return (-1);
+
+  if (!socket_path)
+    socket_path = IPMIDETECT_PROTOCOL_SOCKET_DEFAULT;
+
+  if (_update_data (handle, socket_path) < 0)
+    {
+      /* keep data from a previous update, if there is any */
+      if (handle->load_state == IPMIDETECT_LOAD_STATE_LOADED
+          && !handle->epoch)
+        {
+          int errnum = handle->errnum;
+
+          _free_handle_data (handle);
+          handle->errnum = errnum;
+        }
+      return (-1);
+    }
+
+  handle->timeout_len = timeout_len;
+
+  /* loading complete */
+  handle->load_state = IPMIDETECT_LOAD_STATE_LOADED;
+
+  handle->errnum = IPMIDETECT_ERR_SUCCESS;
+  return (0);
+}
+
+/*
+ * _table_map
+ *
+ * map and validate the shared table at handle->table_path
+ *
+ * Returns 0 on success, -1 on error
+ */
+static int
+_table_map (ipmidetect_t handle)
+{
+  struct ipmidetect_table_header *table;
+  struct stat st;
+  uint64_t n;
+  int fd;
+
+  assert (handle->table_path);
+  assert (!handle->table);
+
+  if ((fd = open (handle->table_path, O_RDONLY)) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_CONNECT;
+      return (-1);
+    }
+
+  if (fstat (fd, &st) < 0)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  if (st.st_size < sizeof (struct ipmidetect_table_header))
+    {
+      handle->errnum = IPMIDETECT_ERR_CONNECT;
+      goto cleanup;
+    }
+
+  if ((table = mmap (NULL,
+                     st.st_size,
+                     PROT_READ,
+                     MAP_SHARED,
+                     fd,
+                     0)) == MAP_FAILED)
+    {
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      goto cleanup;
+    }
+
+  /* ignore potential error, mapping stays valid */
+  close (fd);
+  fd = -1;
+
+  n = table->nodes_count;
+  if (table->magic != IPMIDETECT_TABLE_MAGIC
+      || table->version != IPMIDETECT_TABLE_VERSION
+      || table->table_len != st.st_size
+      || !n
+      || !table->index_size
+      || (table->index_size & (table->index_size - 1))
+      || table->index_size < n
+      || table->timestamps_offset < sizeof (struct ipmidetect_table_header)
+      || table->timestamps_offset % sizeof (uint64_t)
+      || table->index_offset < table->timestamps_offset + n * sizeof (uint64_t)
+      || table->name_offsets_offset < table->index_offset + (uint64_t)table->index_size * sizeof (uint32_t)
+      || table->names_offset < table->name_offsets_offset + n * sizeof (uint32_t)
+      || !table->names_len
+      || (uint64_t)table->names_offset + table->names_len > table->table_len
+      || ((char *)table)[table->names_offset + table->names_len - 1] != '\0')
+    {
+      munmap (table, st.st_size);
+      handle->errnum = IPMIDETECT_ERR_INTERNAL;
+      return (-1);
+    }
+
+  handle->table = table;
+  handle->table_len = st.st_size;
+  handle->nodes_count = n;
+  return (0);
+
+ cleanup:
+  /* ignore potential error, error path */
+  close (fd);
+  return (-1);
+}
+
+/*
+ * _table_check
+ *
+ * move to the next daemon's table if the daemon that published the
+ * mapped one exited, or retry mapping one after that failed
+ *
+ * Returns 0 on success, -1 on error
+ */
+static int
+_table_check (ipmidetect_t handle)
+{
+  assert (handle->table_path);
+
+  if (handle->table && !handle->table->closed)
+    return (0);
+
+  if (handle->table)
+    {
+      munmap (handle->table, handle->table_len);
+      handle->table = NULL;
+      handle->table_len = 0;
+      handle->nodes_count = 0;
+    }
+
+  return (_table_map (handle));
+}
+
+int
+ipmidetect_attach_data (ipmidetect_t handle,
+                        const char *table_path,
+                        int timeout_len)
+{
+  if (_ipmidetect_handle_error_check (handle) < 0)
+    return (-1);
+
+  /* a handle attached before may attach again */
+  if (handle->load_state != IPMIDETECT_LOAD_STATE_UNLOADED
+      && !handle->table_path)
+    {
+      handle->errnum = IPMIDETECT_ERR_ISLOADED;
+      return (-1);
+    }
+
+  if ((timeout_len = _resolve_timeout_len (handle, timeout_len)) < 0)
+    return (-1);
+
+  if (!table_path)
+    table_path = IPMIDETECT_TABLE_DEFAULT;
+
+  _free_handle_data (handle);
+
+  if (!(handle->table_path = strdup (table_path)))
+    {
+      handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+      return (-1);
+    }
+
+  if (_table_map (handle) < 0)
+    {
+      int errnum = handle->errnum;
+
+      _free_handle_data (handle);
+      handle->errnum = errnum;
+      return (-1);
+    }
+
+  handle->timeout_len = timeout_len;
+
+  /* loading complete */
+  handle->load_state = IPMIDETECT_LOAD_STATE_LOADED;
+
+  handle->errnum = IPMIDETECT_ERR_SUCCESS;
+  return (0);
+}
+
 int
 ipmidetect_errnum (ipmidetect_t handle)
 {
@@ -706,6 +1267,146 @@ ipmidetect_perror (ipmidetect_t handle, const char *msg)
     fprintf (stderr, "%s: %s\n", msg, errormsg);
 }
 
+/*
+ * _node_name
+ *
+ * name of a node of the node table or shared table
+ *
+ * Returns name, NULL if the shared table is inconsistent
+ */
+static const char *
+_node_name (ipmidetect_t handle, unsigned int node_id)
+{
+  uint32_t *name_offsets;
+
+  assert (node_id < handle->nodes_count);
+
+  if (!handle->table)
+    return (handle->nodes[node_id]);
+
+  name_offsets = (uint32_t *)((uint8_t *)handle->table + handle->table->name_offsets_offset);
+  if (name_offsets[node_id] >= handle->table->names_len)
+    return (NULL);
+
+  return ((char *)handle->table + handle->table->names_offset + name_offsets[node_id]);
+}
+
+/*
+ * _node_find
+ *
+ * look up a node in the node table or shared table
+ *
+ * Returns node id on success, -1 if not found
+ */
+static int
+_node_find (ipmidetect_t handle, const char *node)
+{
+  uint32_t *index;
+  uint32_t mask, slot;
+  unsigned int i;
+
+  if (!handle->table)
+    {
+      char **nodep;
+
+      if (!(nodep = hash_find (handle->nodes_index, node)))
+        return (-1);
+
+      return (nodep - handle->nodes);
+    }
+
+  index = (uint32_t *)((uint8_t *)handle->table + handle->table->index_offset);
+  mask = handle->table->index_size - 1;
+  slot = ipmidetect_table_hash (node) & mask;
+
+  /* bounded, the table may not be trusted to have an empty slot */
+  for (i = 0; i <= mask && index[slot]; i++)
+    {
+      const char *name;
+
+      if (index[slot] <= handle->nodes_count
+          && (name = _node_name (handle, index[slot] - 1))
+          && !strcmp (name, node))
+        return (index[slot] - 1);
+
+      slot = (slot + 1) & mask;
+    }
+
+  return (-1);
+}
+
+/*
+ * _node_last_received
+ *
+ * last received time of a node, read under the shared table's
+ * seqlock in case the daemon is updating it
+ *
+ * Returns seconds since the Epoch, 0 if never
+ */
+static uint64_t
+_node_last_received (ipmidetect_t handle, unsigned int node_id)
+{
+  volatile uint64_t *timestamps;
+  uint64_t seq, last_received = 0;
+  unsigned int i;
+
+  assert (node_id < handle->nodes_count);
+
+  if (!handle->table)
+    return (handle->last_received[node_id]);
+
+  timestamps = (uint64_t *)((uint8_t *)handle->table + handle->table->timestamps_offset);
+
+  /* a daemon stopped in the middle of a write must not hang us */
+  for (i = 0; i < IPMIDETECT_TABLE_READ_RETRIES; i++)
+    {
+      seq = handle->table->seq;
+      IPMIDETECT_TABLE_BARRIER ();
+      last_received = timestamps[node_id];
+      IPMIDETECT_TABLE_BARRIER ();
+      if (!(seq & 1) && seq == handle->table->seq)
+        break;
+    }
+
+  return (last_received);
+}
+
+/*
+ * _node_detected
+ *
+ * determine if a node of the ipmidetect_update_data() node table or
+ * the ipmidetect_attach_data() shared table is detected at time now
+ *
+ * Returns bool
+ */
+static int
+_node_detected (ipmidetect_t handle, unsigned int node_id, time_t now)
+{
+  int64_t diff;
+
+  assert (node_id < handle->nodes_count);
+
+  diff = (int64_t)_node_last_received (handle, node_id) - (int64_t)now;
+  if (diff < 0)
+    diff = -diff;
+
+  return (diff < handle->timeout_len);
+}
+
+/*
+ * _node_now
+ *
+ * time detection is judged at, the shared table is live
+ */
+static time_t
+_node_now (ipmidetect_t handle)
+{
+  if (handle->table)
+    return (time (NULL));
+
+  return (handle->load_time);
+}
+
 /*
  * _get_nodes_string
  *
@@ -728,6 +1429,57 @@ _get_nodes_string (ipmidetect_t handle, char *buf, int buflen, int which)
       return (-1);
     }
 
+  if (handle->nodes_index || handle->table_path)
+    {
+      const char *name;
+      unsigned int i;
+      time_t now;
+      int rv = -1;
+
+      if (handle->table_path && _table_check (handle) < 0)
+        return (-1);
+
+      if (!(hl = hostlist_create (NULL)))
+        {
+          handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+          return (-1);
+        }
+
+      now = _node_now (handle);
+
+      for (i = 0; i < handle->nodes_count; i++)
+        {
+          if (_node_detected (handle, i, now) != (which == IPMIDETECT_DETECTED_NODES))
+            continue;
+
+          if (!(name = _node_name (handle, i)))
+            {
+              handle->errnum = IPMIDETECT_ERR_INTERNAL;
+              goto cleanup;
+            }
+
+          if (!hostlist_push (hl, name))
+            {
+              handle->errnum = IPMIDETECT_ERR_OUT_OF_MEMORY;
+              goto cleanup;
+            }
+        }
+
+      hostlist_sort (hl);
+
+      if (hostlist_ranged_string (hl, buflen, buf) < 0)
+        {
+          handle->errnum = IPMIDETECT_ERR_OVERFLOW;
+          goto cleanup;
+        }
+
+      handle->errnum = IPMIDETECT_ERR_SUCCESS;
+      rv = 0;
+    cleanup:
+      hostlist_destroy (hl);
+      return (rv);
+    }
+
   if (which == IPMIDETECT_DETECTED_NODES)
     hl = handle->detected_nodes;
   else
@@ -777,6 +1529,29 @@ _is_node (ipmidetect_t handle, const char *node, int which)
       return (-1);
     }
 
+  if (handle->nodes_index || handle->table_path)
+    {
+      int node_id;
+
+      if (handle->table_path && _table_check (handle) < 0)
+        return (-1);
+
+      if ((node_id = _node_find (handle, node)) < 0)
+        {
+          handle->errnum = IPMIDETECT_ERR_NOTFOUND;
+          return (-1);
+        }
+
+      temp = _node_detected (handle, node_id, _node_now (handle));
+      if (which == IPMIDETECT_DETECTED_NODES)
+        rv = temp;
+      else
+        rv = !temp;
+
+      handle->errnum = IPMIDETECT_ERR_SUCCESS;
+      return (rv);
+    }
+
   if (hostlist_find (handle->detected_nodes, node) < 0
       && hostlist_find (handle->undetected_nodes, node) < 0)
     {
@@ -290,8 +290,7 @@ ipmi_monitoring_sdr_cache_load (ipmi_monitoring_ctx_t c,
           if (_ipmi_monitoring_sdr_cache_retrieve (c, hostname, filename, sdr_create_flags) < 0)
             goto cleanup;
         }
-      else if (ipmi_sdr_ctx_errnum (c->sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID
-               || ipmi_sdr_ctx_errnum (c->sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+      else if (ipmi_sdr_ctx_errnum (c->sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID)
         {
           if (_ipmi_monitoring_sdr_cache_delete (c, hostname, filename) < 0)
             goto cleanup;
@@ -299,6 +298,17 @@ ipmi_monitoring_sdr_cache_load (ipmi_monitoring_ctx_t c,
           if (_ipmi_monitoring_sdr_cache_retrieve (c, hostname, filename, sdr_create_flags) < 0)
             goto cleanup;
         }
+      else if (ipmi_sdr_ctx_errnum (c->sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+        {
+          /* only download records that changed */
+          if (_ipmi_monitoring_sdr_cache_retrieve (c,
+                                                   hostname,
+                                                   filename,
+                                                   sdr_create_flags
+                                                   | IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE
+                                                   | IPMI_SDR_CACHE_CREATE_FLAGS_INCREMENTAL) < 0)
+            goto cleanup;
+        }
       else if (ipmi_sdr_ctx_errnum (c->sdr_ctx) == IPMI_SDR_ERR_FILESYSTEM)
         {
           c->errnum = IPMI_MONITORING_ERR_SDR_CACHE_FILESYSTEM;